@@ -8,6 +8,8 @@ RESET = \033[0m
 
 V ?= 2
 D ?= 1
+# scheduling class to boot with, prio, fair or mlfq
+SCHED ?= prio
 MAKEFLAGS += --no-print-directory
 
 # Verbosity control. Inspired from the Contiki-NG build system. A few hacks here and there, will probably improve later.
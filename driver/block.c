@@ -18,6 +18,27 @@ static block_device_t** block_devices = NULL;
 static size_t 		   	num_block_devices = 0;
 static size_t 		   	max_block_devices = 16;
 
+/* A device split off the tail of another one, its blocks are forwarded to
+	the parent at an offset. */
+typedef struct _block_slice {
+
+	block_device_t* 	parent;
+	block_lba_t 		start;
+
+} block_slice_t;
+
+/* Implementation private helper routines. */
+
+static int32_t _blkdev_slice_read  (void* private, block_lba_t lba,
+									void* buffer);
+static int32_t _blkdev_slice_write (void* private, block_lba_t lba,
+									const void* buffer);
+
+static const block_device_ops_t _slice_ops = {
+	.read  = _blkdev_slice_read,
+	.write = _blkdev_slice_write,
+};
+
 /* Implementation of public facing functions */
 
 int32_t blkdev_register (const char* name, size_t block_size, size_t num_blocks,
@@ -154,4 +175,59 @@ int32_t blkwrite (block_device_t* dev, block_lba_t lba, const void* buffer) {
 
 	return dev->ops->write (dev->driver_private, lba, buffer);
 
-}
\ No newline at end of file
+}
+
+int32_t blkdev_split (const char* name, const char* new_name, size_t num_blocks)
+{
+	block_device_t* dev = blkdev_get_by_name (name);
+	if (!dev) {
+		return -1;
+	}
+
+	if (num_blocks == 0 || num_blocks >= dev->num_blocks) {
+		LOG_ERROR ("blkdev_split: cannot split %u blocks off '%s' (%u blocks)",
+				   num_blocks, name, dev->num_blocks);
+		return -1;
+	}
+
+	block_slice_t* slice = malloc (sizeof(block_slice_t));
+	if (!slice) {
+		LOG_ERROR ("blkdev_split: malloc failed for slice struct");
+		return -1;
+	}
+
+	slice->parent = dev;
+	slice->start  = dev->num_blocks - num_blocks;
+
+	if (blkdev_register (new_name, dev->block_size, num_blocks, &_slice_ops,
+						 slice) != 0) {
+		free (slice);
+		return -1;
+	}
+
+	// the parent no longer owns the blocks handed to the slice
+	dev->num_blocks = slice->start;
+	return 0;
+
+}
+
+/* Private helpers */
+
+int32_t _blkdev_slice_read (void* private, block_lba_t lba, void* buffer) {
+
+	block_slice_t* slice = private;
+
+	// blkread bounds checks against the shrunk parent, so go to its ops
+	return slice->parent->ops->read (slice->parent->driver_private,
+									 slice->start + lba, buffer);
+
+}
+
+int32_t _blkdev_slice_write (void* private, block_lba_t lba,
+							 const void* buffer) {
+
+	block_slice_t* slice = private;
+	return slice->parent->ops->write (slice->parent->driver_private,
+									  slice->start + lba, buffer);
+
+}
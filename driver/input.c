@@ -0,0 +1,218 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <driver/input.h>
+#include <driver/keyboard.h>
+#include <driver/timer.h>
+#include <init/syscall.h>
+#include <init/tty.h>
+#include <mm/uaccess.h>
+#include <proc/sched.h>
+#include <interrupts.h>
+#include <utils.h>
+
+#define LOG_MOD_NAME 	"INP"
+#define LOG_MOD_ENABLE  1
+#include <log.h>
+
+/* The prebuilt terminal keeps terminal_getc as a weak symbol, so the version
+	here serves terminal_read and the shell. The keyboard interrupt handler
+	is wrapped: after the driver has buffered the key, the wrapper stamps it
+	and wakes every thread waiting for one. The driver exports the flag it
+	sets for key releases, which are not stamped.
+
+	A waiting thread is on the list through its ready queue link, which is
+	free while it is blocked. A woken thread may still be on the cpu when it
+	is posted, so it does not touch the link again before the scheduler has
+	picked it, at which point it is running and off the ready queue. */
+
+//! set by the keyboard driver when the last scancode was a release
+extern bool 	_kbd_key_released;
+
+/* Private variables */
+
+static list_t 				_input_waiters;
+
+//! tick of the first key press nobody has read yet
+static bool 				_input_pending = false;
+static uint32_t 			_input_pending_since;
+
+static interrupt_service_t 	_kbd_next 	  = NULL;
+static interrupt_service_t 	_syscall_next = NULL;
+static input_stats_t 		_input_stats;
+
+/* Implementation private helper routines. */
+
+//! runs the keyboard driver, then stamps the key and wakes the readers
+static void 	_input_kbd_irq (interrupt_context_t* context);
+
+//! sleeps the current thread until a key arrives, with interrupts off
+static void 	_input_wait (void);
+
+//! records the latency of a key that is handed to a reader
+static void 	_input_account (void);
+
+//! serves kbdlat(buf) and passes every other syscall on
+static void 	_input_syscall (interrupt_context_t* context);
+
+/* Public functions of the interface */
+
+void input_init (void) {
+
+	list_init (&_input_waiters);
+
+	if (get_interrupt_handler (IRQ1_KEYBOARD) != _input_kbd_irq) {
+		_kbd_next = get_interrupt_handler (IRQ1_KEYBOARD);
+		register_interrupt_handler (IRQ1_KEYBOARD, _input_kbd_irq);
+	}
+
+	if (get_interrupt_handler (ISR128_SYSCALL) != _input_syscall) {
+		_syscall_next = get_interrupt_handler (ISR128_SYSCALL);
+		register_interrupt_handler (ISR128_SYSCALL, _input_syscall);
+	}
+
+}
+
+char terminal_getc (void) {
+
+	uint32_t eflags;
+	asm volatile ("pushfl; popl %0; cli" : "=r" (eflags) :: "memory");
+
+	KBD_ENTRY entry = kbd_getlastkey_buf ();
+	while (!entry.ascii) {
+		_input_wait ();
+		entry = kbd_getlastkey_buf ();
+	}
+
+	_input_account ();
+
+	if (eflags & 0x200) {
+		sti ();
+	}
+
+	return entry.ascii;
+
+}
+
+bool kbd_is_key_released (void) {
+
+	return _kbd_key_released;
+
+}
+
+const input_stats_t* input_get_stats (void) {
+
+	strncpy (_input_stats.sched, sched_get_class (),
+			 sizeof(_input_stats.sched) - 1);
+
+	return &_input_stats;
+
+}
+
+void input_reset_stats (void) {
+
+	memset (&_input_stats, 0, sizeof(input_stats_t));
+
+}
+
+void input_stats (void) {
+
+	const input_stats_t* s = input_get_stats ();
+
+	printk ("input: %u keys under %s, %u sleeps, average %u ms, max %u ms\n",
+			s->keys, s->sched, s->sleeps, s->keys ? s->total_ms / s->keys : 0,
+			s->max_ms);
+
+	printk ("input:");
+	for (uint32_t i = 0; i < INPUT_LAT_BUCKETS - 1; i++) {
+		printk (" <%ums %u,", INPUT_LAT_BUCKET_MS (i), s->buckets[i]);
+	}
+	printk (" more %u\n", s->buckets[INPUT_LAT_BUCKETS - 1]);
+
+}
+
+/* Private helpers */
+
+void _input_kbd_irq (interrupt_context_t* context) {
+
+	if (_kbd_next) {
+		_kbd_next (context);
+	}
+
+	/* key releases and modifiers do not give the reader anything */
+	if (!_input_pending && !kbd_is_key_released () &&
+		kbd_keycode_to_ascii (kbd_get_lastkey ())) {
+		_input_pending 		 = true;
+		_input_pending_since = get_system_tick_count ();
+	}
+
+	list_element_t* entry;
+	while ((entry = list_remove_head (&_input_waiters)) != NULL) {
+		sched_wake (LIST_ENTRY (thread_t, entry, list_all));
+	}
+
+}
+
+void _input_wait (void) {
+
+	thread_t* self = get_current_thread ();
+
+	/* before the scheduler runs there is nobody to hand the cpu to */
+	if (!self) {
+		asm volatile ("sti; hlt; cli" ::: "memory");
+		return;
+	}
+
+	self->state = STATE_BLOCKED;
+	list_append (&_input_waiters, &self->list_all);
+	_input_stats.sleeps++;
+
+	while (self->state != STATE_RUNNING) {
+		asm volatile ("sti; hlt; cli" ::: "memory");
+	}
+
+}
+
+void _input_account (void) {
+
+	uint32_t latency = 0;
+
+	if (_input_pending) {
+		latency = get_system_tick_count () - _input_pending_since;
+		_input_pending = false;
+	}
+
+	uint32_t bucket = 0;
+	while (bucket < INPUT_LAT_BUCKETS - 1 &&
+		   latency >= INPUT_LAT_BUCKET_MS (bucket)) {
+		bucket++;
+	}
+
+	_input_stats.keys++;
+	_input_stats.total_ms += latency;
+	_input_stats.buckets[bucket]++;
+
+	if (latency > _input_stats.max_ms) {
+		_input_stats.max_ms = latency;
+	}
+
+}
+
+void _input_syscall (interrupt_context_t* context) {
+
+	if (context->eax != SYSCALL_KBDLAT) {
+		_syscall_next (context);
+		return;
+	}
+
+	/* kbdlat(buf) */
+	if (copy_to_user ((void*) context->ebx, input_get_stats (),
+					  sizeof(input_stats_t)) != 0) {
+		context->eax = (uint32_t) -1;
+		return;
+	}
+
+	context->eax = 0;
+
+}
@@ -2,6 +2,8 @@
 #include <driver/fdc.h>
 #include <driver/block.h>
 #include <mm/kheap.h>
+#include <mm/slab.h>
+#include <mm/vmalloc.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -41,6 +43,13 @@ static vnode_ops_t  fat12_vnode_ops = {
 
 };
 
+/* Implementation private variables */
+
+//! object caches for the vnodes and inodes handed out by lookups, created on
+//! the first mount. files are opened and closed far more often than mounted.
+static kmem_cache_t* _fat12_vnode_cache = NULL;
+static kmem_cache_t* _fat12_inode_cache = NULL;
+
 /* Implementation private helper functions declarations */
 
 //! return the FAT12 entry value for the given cluster number
@@ -207,7 +216,7 @@ vnode* 		_fat12_lookup (vnode* dir_node, const char* name) {
 				LOG_DEBUG ("found entry %.11s in root dir\n", fat_name);
 
 				/* create and setup a vnode for this entry */
-				vnode* new_node = malloc (sizeof(vnode));
+				vnode* new_node = kmem_cache_alloc (_fat12_vnode_cache);
 				if (!new_node) {
 					LOG_ERROR ("failed to allocate memory for vnode\n");
 					return NULL;
@@ -224,10 +233,10 @@ vnode* 		_fat12_lookup (vnode* dir_node, const char* name) {
 				/* create and setup the inode object, the internal data for the
 					vnode */
 				
-				inode* new_inode = malloc (sizeof(inode));
+				inode* new_inode = kmem_cache_alloc (_fat12_inode_cache);
 				if (!new_inode) {
 					LOG_ERROR ("failed to allocate memory for inode\n");
-					free (new_node);
+					kmem_cache_free (_fat12_vnode_cache, new_node);
 					return NULL;
 				}
 
@@ -254,6 +263,18 @@ vnode* 		_fat12_lookup (vnode* dir_node, const char* name) {
 //! mounts a FAT12 filesystem from the given device
 vfs* fat12_mount (const char* device) {
 
+	if (!_fat12_vnode_cache) {
+		_fat12_vnode_cache = kmem_cache_create ("fat12_vnode", sizeof(vnode),
+												0, NULL);
+		_fat12_inode_cache = kmem_cache_create ("fat12_inode", sizeof(inode),
+												0, NULL);
+	}
+
+	if (!_fat12_vnode_cache || !_fat12_inode_cache) {
+		LOG_ERROR ("failed to create FAT12 object caches\n");
+		return NULL;
+	}
+
 	fat12_handle_t* fs = malloc (sizeof(fat12_handle_t));
 	if (!fs) {
 		LOG_ERROR ("failed to allocate memory for FAT12 handle\n");
@@ -295,7 +316,7 @@ vfs* fat12_mount (const char* device) {
 	/* allocate and load the FAT */
 
 	size_t fat_size = fs->bpb->sectors_per_fat * fs->bpb->bytes_per_sector;
-	fs->fat_table 	= malloc (fat_size);
+	fs->fat_table 	= vmalloc (fat_size);
 	if (!fs->fat_table) {
 
 		LOG_ERROR ("failed to allocate memory for FAT table\n");
@@ -332,7 +353,7 @@ vfs* fat12_mount (const char* device) {
 	vfs* fsys = malloc (sizeof(vfs));
 	if (!fsys) {
 		LOG_ERROR ("failed to allocate memory for vfs structure\n");
-		free (fs->fat_table);
+		vfree (fs->fat_table);
 		free (bootsector);
 		free (fs);
 		return NULL;
@@ -381,7 +402,7 @@ int32_t fat12_unmount (vfs* fsys) {
 		return -1;
 	}
 	if (fs->fat_table) {
-		free (fs->fat_table);
+		vfree (fs->fat_table);
 		fs->fat_table = NULL;
 	}
 	/* should free the entire bootsector */
@@ -532,6 +553,25 @@ int32_t fat12_read (vnode* node, uint32_t offs, uint32_t size, void* buf) {
 
 // empty impls of the remaining ones
 
-int32_t fat12_close (vnode* node) {return -1;}
+//! close a vnode returned by open, releasing its vnode and inode objects
+int32_t fat12_close (vnode* node) {
+
+	if (!node || !node->vfs_ptr) {
+		LOG_ERROR ("invalid node specified for close\n");
+		return -1;
+	}
+
+	/* the root vnode is owned by the mount, and freed on unmount */
+	if (node == node->vfs_ptr->vroot) {
+		return 0;
+	}
+
+	kmem_cache_free (_fat12_inode_cache, node->data);
+	kmem_cache_free (_fat12_vnode_cache, node);
+
+	return 0;
+
+}
+
 int32_t fat12_write (vnode* node, uint32_t offs, uint32_t size, void* buf) {return -1;}
 int32_t fat12_readdir (vnode* node, vnode** dirents, uint32_t* count) {return -1;}
@@ -5,6 +5,7 @@
 #include <fs/vfs.h>
 #include <fs/fat12.h>
 #include <mm/kheap.h>
+#include <mm/slab.h>
 
 #define LOG_MOD_NAME 	"VFS"
 #define LOG_MOD_ENABLE  0
@@ -40,6 +41,9 @@ static 	size_t		_curr_size 	 = 0;
 //! current root vnode of the VFS (will be deprecated)
 static 	vnode* 		_vfs_root_vnode = NULL;
 
+//! cache for the opened file objects
+static kmem_cache_t* _file_cache = NULL;
+
 //! add a newly created entry to the list of mount points
 static void 		_add_to_mpoints (vfs* _v);
 
@@ -56,6 +60,8 @@ void vfs_init () {
 	memset (_mountpoints, 0, INIT_MPOINTS * sizeof (vfs*));
 	_curr_size 		= 0;
 
+	_file_cache 	= kmem_cache_create ("file_t", sizeof(file_t), 0, NULL);
+
 }
 
 int32_t vfs_mount (const char* src_dev, const char* mount_path, const char* fs_type) {
@@ -208,7 +214,13 @@ file_t* vfs_open (const char* path, uint32_t flags) {
 		return NULL;
 	}
 
-	file_t* file 	= malloc (sizeof(file_t));
+	file_t* file 	= kmem_cache_alloc (_file_cache);
+	if (!file) {
+		LOG_ERROR ("vfs_open: failed to allocate file object for %s\n", path);
+		result->ops->close (result);
+		return NULL;
+	}
+
 	file->vnode_ptr = result;
 	file->f_offset  = 0;
 	file->f_flags   = flags;
@@ -226,7 +238,7 @@ int32_t vfs_close (file_t* file) {
 	}
 
 	int32_t ret = file->vnode_ptr->ops->close (file->vnode_ptr);
-	free (file);
+	kmem_cache_free (_file_cache, file);
 
 	return ret;
 	
@@ -100,6 +100,11 @@ int32_t 		blkread  (block_device_t* dev, block_lba_t lba, void* buffer);
 int32_t 		blkwrite (block_device_t* dev, block_lba_t lba, 
 						  const void* buffer);
 
+//! carves the last num_blocks of a device into a new device of its own, the
+//! original device shrinks accordingly
+int32_t 		blkdev_split (const char* name, const char* new_name,
+							  size_t num_blocks);
+
 //*****************************************************************************
 //**
 //** 	END _[filename]
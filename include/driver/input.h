@@ -0,0 +1,70 @@
+#ifndef _INPUT_H
+#define _INPUT_H
+//*****************************************************************************
+//*
+//*  @file		input.h
+//*  @author    Abdul Rafay (abdul.rafay@lums.edu.pk)
+//*  @brief		Blocking keyboard input. A thread reading the terminal sleeps
+//*				until the keyboard interrupt brings a key instead of polling
+//*				the keyboard buffer for its whole time slice, and the time
+//*				from the key press to the moment the key is handed to the
+//*				reader, right before the terminal echoes it, is recorded.
+//*  @version
+//*
+//****************************************************************************/
+//-----------------------------------------------------------------------------
+// 		REQUIRED HEADERS
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stddef.h>
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE DEFINES/TYPES
+//-----------------------------------------------------------------------------
+
+//! the latencies are sorted into buckets below 1, 4, 16 and 64ms and above
+#define INPUT_LAT_BUCKETS 		5
+#define INPUT_LAT_BUCKET_MS(i) 	(1u << (2 * (i)))
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE DATA STRUCTURES
+//-----------------------------------------------------------------------------
+
+/* Keyboard to echo latency. The layout is shared with struct kbdlat of the
+	C library. */
+typedef struct _input_stats {
+
+	char 		sched[8];		//! scheduling class the numbers were taken in
+	uint32_t 	keys;			//! keys handed to readers
+	uint32_t 	sleeps;			//! times a reader slept for a key
+	uint32_t 	total_ms;		//! sum of the key latencies
+	uint32_t 	max_ms;			//! longest key latency
+	uint32_t 	buckets[ INPUT_LAT_BUCKETS ];
+
+} input_stats_t;
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE FUNCTION PROTOTYPES
+//-----------------------------------------------------------------------------
+
+//! hooks the keyboard interrupt and installs the kbdlat syscall, must be
+//! called after the keyboard and syscall_init
+void 		input_init (void);
+
+//! returns the keyboard latency statistics
+const input_stats_t* 	input_get_stats (void);
+
+//! clears the keyboard latency statistics
+void 		input_reset_stats (void);
+
+//! display the keyboard latency statistics
+void 		input_stats (void);
+
+//*****************************************************************************
+//**
+//** 	END input.h
+//**
+//*****************************************************************************
+
+#endif // !_INPUT_H
@@ -18,6 +18,7 @@
 //-----------------------------------------------------------------------------
 
 #include <stdint.h>
+#include <proc/tss.h>
 
 //-----------------------------------------------------------------------------
 // 		PUBLIC INTERFACE DEFINES/TYPES
@@ -54,6 +55,10 @@
 #define GDT_ACCESS_TSS32        0x09        //32-bit TSS segment
 #define GDT_ACCESS_TSS32_BUSY   0x0B        //Busy 32-bit TSS segment
 
+//! Selectors of the kernel segments
+#define GDT_KERNEL_CODE_SEL     0x08
+#define GDT_KERNEL_DATA_SEL     0x10
+
 //-----------------------------------------------------------------------------
 // 		PUBLIC INTERFACE DATA STRUCTURES
 //-----------------------------------------------------------------------------
@@ -136,6 +141,18 @@ void    create_gdt_entry (gdt_entry_t *entry, uint32_t base, uint32_t limit,
 void    gdt_init_flat_protected ();
 
 
+/*******************************************************************************
+*	 
+*  @brief   Installs the TSS of a task that is only entered through a task gate,
+*           such as the double fault handler, which needs a stack of its own.
+*
+*  @param   tss Pointer to the TSS of the task, must stay valid.
+*  @return  The selector of the TSS, for the task gate.
+*	
+*******************************************************************************/
+uint16_t    gdt_set_task_tss (tss_t *tss);
+
+
 /*******************************************************************************
 * 
 * @brief	Initializes the Global Descriptor Table (GDT) using a flat protected
@@ -27,6 +27,17 @@ typedef enum {
 	SYSCALL_WRITE,      //? syscall number for write
 	SYSCALL_FORK,       //? syscall number for fork
 	SYSCALL_EXEC,       //? syscall number for exec
+
+	SYSCALL_SHMGET = 7, //? create or look up a shared memory segment
+	SYSCALL_SHMAT,      //? attach a shared memory segment
+	SYSCALL_SHMDT,      //? detach a shared memory segment
+	SYSCALL_PROCMEM,    //? memory used by the index-th process
+	SYSCALL_KBDLAT,     //? keyboard to echo latency statistics
+	SYSCALL_SCHED_DEADLINE, //? reserve cpu time with a deadline
+	SYSCALL_SCHED_YIELD,    //? done with the current period
+	SYSCALL_SHMRM,      //? remove a shared memory segment
+	SYSCALL_MMAP,       //? reserve user memory backed on first touch
+	SYSCALL_MUNMAP,     //? release a reservation
 	
 } syscall_nr;
 
@@ -24,9 +24,38 @@
 /* low memory below 640 KB for initial kernel stack */
 #define KERNEL_STACK_EARLY 	  0x00090000 // ~128KB stack space.
 
-/* memory region for the kernel heap */
-#define KERNEL_HEAP_VIRT   	  0xC0200000 // 3GB + 2MB
+/* the physmap may cover at most this much memory, kernel virtual ranges that
+	are not part of it are placed above */
+#define PHYSMAP_MAX_SIZE 	  0x10000000 // 256MB
+
+/* memory region for the kernel heap. the window has its own virtual range, of
+	which only KERNEL_HEAP_SIZE is backed at boot, the rest is mapped on demand
+	as the heap grows, up to KERNEL_HEAP_MAX_SIZE */
+#define KERNEL_HEAP_VIRT   	  0xD0000000 // 3GB + 256MB
 #define KERNEL_HEAP_SIZE   	  0x00100000 // 1MB
+#define KERNEL_HEAP_MAX_SIZE  0x00800000 // 8MB
+
+/* range for the vmalloc allocator, large kernel buffers that are built from
+	individual frames and only contiguous in virtual memory */
+#define VMALLOC_START 		  0xE0000000 // 3.5GB
+#define VMALLOC_END 		  0xE4000000 // 64MB range
+
+/* one large page right above it through which the kernel reaches physical
+	memory above 4GB, see highmem.h */
+#define HIGHMEM_WINDOW 		  0xE4000000 // 4MB window
+
+/* kernel stacks, each in a slot of its own whose pages below the stack stay
+	unmapped as guard pages */
+#define KSTACK_AREA_START 	  0xE4400000
+#define KSTACK_AREA_END 	  0xE5400000 // 16MB range
+
+/* the last page directory entry of the current address space points back at
+	the directory, which makes its page tables show up at RECURSIVE_BASE and
+	the directory itself in the last page. the fixmap window right below holds
+	a few kernel pages that are remapped to arbitrary frames on the fly */
+#define FIXMAP_BASE 		  0xFFBF0000 // 64KB window
+#define FIXMAP_END 			  0xFFC00000
+#define RECURSIVE_BASE 		  0xFFC00000 // last 4MB
 
 /* we keep the low 1MB identity mapped to enable easy access to legacy
 	features such as DMA buffers or video memory */
@@ -38,5 +67,20 @@
 #define USER_STACK_SIZE      0x1000
 #define USER_STACK_TOP	   	 0xBFFFE000 // just below 3GB
 
+/* the initial stack page grows downward on demand, at most to the limit. the
+	guard gap below the limit is never mapped, so an overflow faults */
+#define USER_STACK_MAX_SIZE  0x00100000 // 1MB
+#define USER_STACK_LIMIT 	 (USER_STACK_TOP + USER_STACK_SIZE - USER_STACK_MAX_SIZE)
+#define USER_STACK_GUARD 	 0x00010000 // 64KB
+
+/* shared memory segments are attached inside this window unless the process
+	asks for a specific address */
+#define USER_SHM_BASE 		 0x60000000
+#define USER_SHM_END 		 0x70000000 // 256MB window
+
+/* and the regions a process reserves with mmap inside this one */
+#define USER_MMAP_BASE 		 0x70000000
+#define USER_MMAP_END 		 0xB0000000 // 1GB window
+
 
 #endif
\ No newline at end of file
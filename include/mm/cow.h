@@ -0,0 +1,73 @@
+#ifndef _COW_H
+#define _COW_H
+//*****************************************************************************
+//*
+//*  @file		[cow.h]
+//*  @author    Abdul Rafay (abdul.rafay@lums.edu.pk)
+//*  @brief		Copy on write address space cloning. Fork shares the user
+//*				frames of the parent with the child read-only, and a private
+//*				copy is only made when either side first writes to a page.
+//*  @version
+//*
+//****************************************************************************/
+//-----------------------------------------------------------------------------
+// 		REQUIRED HEADERS
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stddef.h>
+#include <mm/vmm.h>
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE DATA STRUCTURES
+//-----------------------------------------------------------------------------
+
+/* Copy on write statistics */
+typedef struct _cow_stats {
+
+	uint32_t 	clones;			//! address spaces cloned copy on write
+	uint32_t 	pages_shared;	//! pages shared by all clones
+	uint32_t 	faults;			//! write faults on copy on write pages
+	uint32_t 	copies;			//! faults that copied the frame
+	uint32_t 	reuses;			//! faults that found the frame unshared
+	uint32_t 	zero_copies;	//! faults on the zero page
+	uint32_t 	failures;		//! faults that ran out of memory
+
+} cow_stats_t;
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE FUNCTION PROTOTYPES
+//-----------------------------------------------------------------------------
+
+//! registers the copy on write fault handler and sets CR0.WP, so that
+//! supervisor writes fault on shared pages too. must be called after
+//! vmm_fault_init
+void 		cow_init (void);
+
+//! clones the current page directory, sharing the user pages copy on write.
+//! process_fork is linked against this in place of vmm_clone_pagedir.
+pagedir_t* 	vmm_clone_pagedir_cow (void);
+
+//! gives the current address space a private writable copy of every copy on
+//! write page in the range, returns -1 if memory ran out
+int32_t 	cow_break_range (void* start, size_t size);
+
+//! memcpy and memset for the elf loader, which fills its segments before it
+//! protects them. the pages of the current address space are written
+//! whatever their protection, shared ones are copied first.
+void* 		cow_load_copy (void* dst, const void* src, size_t n);
+void* 		cow_load_fill (void* dst, int c, size_t n);
+
+//! returns the copy on write statistics
+const cow_stats_t* 	cow_get_stats (void);
+
+//! display the copy on write statistics
+void 		cow_stats (void);
+
+//*****************************************************************************
+//**
+//** 	END _[filename]
+//**
+//*****************************************************************************
+
+#endif // !_COW_H
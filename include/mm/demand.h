@@ -0,0 +1,82 @@
+#ifndef _DEMAND_H
+#define _DEMAND_H
+//*****************************************************************************
+//*
+//*  @file		[demand.h]
+//*  @author    Abdul Rafay (abdul.rafay@lums.edu.pk)
+//*  @brief		Demand paging for anonymous user memory. A reserved region
+//*				is an area of an address space without frames, each page is
+//*				backed with a zeroed frame when it is first touched. Processes
+//*				reserve regions with mmap. The user stack is handled the
+//*				same way and grows down to its limit.
+//*  @version
+//*
+//****************************************************************************/
+//-----------------------------------------------------------------------------
+// 		REQUIRED HEADERS
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <mm/vmm.h>
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE DEFINES/TYPES
+//-----------------------------------------------------------------------------
+
+//! how far below the user stack pointer an access may be and still grow the
+//! stack, enough for pusha and the return frame of an interrupt
+#define STACK_GROW_SLACK 	32
+
+//! protection bits of vmm_mmap, as the mmap syscall takes them
+#define MMAP_PROT_READ 		0x1
+#define MMAP_PROT_WRITE 	0x2
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE DATA STRUCTURES
+//-----------------------------------------------------------------------------
+
+/* Demand paging statistics */
+typedef struct _demand_stats {
+
+	uint32_t 	reserved_pages;	//! pages currently reserved
+	uint32_t 	faults;			//! pages populated on first touch
+	uint32_t 	stack_pages;	//! pages the user stacks grew by
+	uint32_t 	zero_pages;		//! reads served with the shared zero page
+	uint32_t 	failures;		//! faults that ran out of memory
+
+} demand_stats_t;
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE FUNCTION PROTOTYPES
+//-----------------------------------------------------------------------------
+
+//! registers the demand paging fault handler and installs the mmap syscalls,
+//! must be called after vma_init, vmm_fault_init and syscall_init
+void 		demand_init (void);
+
+//! reserves a user range of the address space without backing it. the range
+//! must not overlap another area or the stack window.
+bool 		vmm_reserve_region (pagedir_t* pdir, void* virtual, size_t size,
+								uint32_t flags);
+
+//! reserves size bytes of user memory at virtual, or anywhere in the mmap
+//! window for NULL, readable and writable as prot says. returns the start of
+//! the reservation, NULL on failure.
+void* 		vmm_mmap (pagedir_t* pdir, void* virtual, size_t size, uint32_t prot);
+
+//! releases a reservation made by vmm_reserve_region or vmm_mmap, along with
+//! the frames of the pages that were touched
+bool 		vmm_unreserve_region (pagedir_t* pdir, void* virtual, size_t size);
+
+//! returns the demand paging statistics
+const demand_stats_t* 	demand_get_stats (void);
+
+//*****************************************************************************
+//**
+//** 	END _[filename]
+//**
+//*****************************************************************************
+
+#endif // !_DEMAND_H
@@ -0,0 +1,125 @@
+#ifndef _FAULT_H
+#define _FAULT_H
+//*****************************************************************************
+//*
+//*  @file		[fault.h]
+//*  @author    Abdul Rafay (abdul.rafay@lums.edu.pk)
+//*  @brief		Page fault dispatcher. Subsystems that map memory lazily
+//*				register a handler here, the dispatcher offers each fault to
+//*				them in order before falling back to the vmm's fatal handler.
+//*				Every fault is counted by its cause and by what resolved it,
+//*				globally and per address space, and can be traced.
+//*  @version
+//*
+//****************************************************************************/
+//-----------------------------------------------------------------------------
+// 		REQUIRED HEADERS
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <interrupts.h>
+#include <mm/vmm.h>
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE DEFINES/TYPES
+//-----------------------------------------------------------------------------
+
+//! interrupt vector of the page fault exception
+#define PAGE_FAULT_INT 			14
+
+//! bits of the error code pushed by the cpu on a page fault
+#define PF_ERR_PRESENT 			0x01	//! protection fault on a present page
+#define PF_ERR_WRITE 			0x02	//! the access was a write
+#define PF_ERR_USER 			0x04	//! the access came from ring 3
+#define PF_ERR_RSVD 			0x08	//! reserved bit set in a paging entry
+#define PF_ERR_FETCH 			0x10	//! instruction fetch
+
+//! maximum number of registered fault handlers
+#define VMM_MAX_FAULT_HANDLERS 	8
+
+//! entries of the fault trace, a power of two
+#define VMM_FAULT_TRACE_SIZE 	64
+
+//! what resolved a fault, handlers name their kind when they register
+typedef enum {
+
+	FAULT_KIND_OTHER = 0,
+	FAULT_KIND_DEMAND,		//! user memory populated on first touch
+	FAULT_KIND_COW,			//! write to a copy on write page
+	FAULT_KIND_SWAP,		//! page read back from swap
+	FAULT_KIND_KHEAP,		//! kernel heap grown
+	FAULT_KIND_FIXUP,		//! bad user pointer caught by a user copy
+	FAULT_KIND_FATAL,		//! nobody, handed to the vmm's fatal handler
+	FAULT_KINDS
+
+} fault_kind_t;
+
+//! a fault handler returns 0 if it resolved the fault and the faulting
+//! instruction can be restarted, or -1 if the fault is not its concern
+typedef int32_t (*fault_handler_t) (uintptr_t addr, uint32_t error,
+									interrupt_context_t* context);
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE DATA STRUCTURES
+//-----------------------------------------------------------------------------
+
+/* Page fault counters, kept globally and for every address space */
+typedef struct _fault_counts {
+
+	uint32_t 	total;				//! faults taken
+	uint32_t 	not_present;		//! on pages that were not present
+	uint32_t 	protection;			//! protection violations on present pages
+	uint32_t 	user;				//! raised in user mode
+	uint32_t 	kernel;				//! raised in kernel mode
+	uint32_t 	writes;				//! caused by a write
+	uint32_t 	kinds[FAULT_KINDS];	//! by what resolved them
+
+} fault_counts_t;
+
+/* One traced fault */
+typedef struct _fault_trace_entry {
+
+	uint32_t 	eip;		//! faulting instruction
+	uintptr_t 	addr;		//! faulting address, cr2
+	uint16_t 	error;		//! error code pushed by the cpu
+	uint16_t 	kind;		//! what resolved it
+
+} fault_trace_entry_t;
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE FUNCTION PROTOTYPES
+//-----------------------------------------------------------------------------
+
+//! installs the dispatcher in front of the vmm's page fault handler, must be
+//! called after vmm_init
+void 		vmm_fault_init (void);
+
+//! adds a handler to the end of the dispatch chain, faults it resolves are
+//! counted under kind
+int32_t 	vmm_fault_register (fault_handler_t handler, fault_kind_t kind);
+
+//! returns the fault counters of an address space, or the global ones for
+//! NULL. NULL is returned for a page directory without an address space.
+const fault_counts_t* 	vmm_fault_get_counts (pagedir_t* pdir);
+
+//! starts or stops recording faults in the trace, starting clears it
+void 		vmm_fault_trace (bool enabled);
+
+//! copies up to max of the most recent traced faults, oldest first, and
+//! returns the number copied
+uint32_t 	vmm_fault_trace_read (fault_trace_entry_t* entries, uint32_t max);
+
+//! writes the traced faults to the serial port
+void 		vmm_fault_trace_dump (void);
+
+//! display the global fault counters
+void 		vmm_fault_stats (void);
+
+//*****************************************************************************
+//**
+//** 	END _[filename]
+//**
+//*****************************************************************************
+
+#endif // !_FAULT_H
@@ -0,0 +1,79 @@
+#ifndef _FIXMAP_H
+#define _FIXMAP_H
+//*****************************************************************************
+//*
+//*  @file		[fixmap.h]
+//*  @author    Abdul Rafay (abdul.rafay@lums.edu.pk)
+//*  @brief		Fixed virtual windows onto page tables. The current address
+//*				space maps its own directory recursively, so its tables are
+//*				reached at fixed addresses, and a handful of fixmap slots map
+//*				any other frame for a short while.
+//*  @version
+//*
+//****************************************************************************/
+//-----------------------------------------------------------------------------
+// 		REQUIRED HEADERS
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <mm/vmm.h>
+#include <mem.h>
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE DEFINES/TYPES
+//-----------------------------------------------------------------------------
+
+//! directory entry holding the recursive mapping
+#define RECURSIVE_PDE 			VMM_DIR_INDEX (RECURSIVE_BASE)
+
+//! the page directory of the current address space
+#define RECURSIVE_PD 			((pagedir_t*) (RECURSIVE_BASE + \
+									RECURSIVE_PDE * VMM_PAGE_SIZE))
+
+//! the page table of the current address space mapping an address
+#define RECURSIVE_PT(virt) 		((pagetable_t*) (RECURSIVE_BASE + \
+									VMM_DIR_INDEX (virt) * VMM_PAGE_SIZE))
+
+/* Fixmap slots, each one is a single page at a fixed address. A user of a
+	slot maps it, works on it without sleeping and unmaps it again. */
+enum fixmap_slot {
+
+	FIX_PGTABLE_SRC = 0,	//! page table being read
+	FIX_PGTABLE_DST,		//! page table being written
+	FIX_PAGE_SRC,			//! page being copied from
+	FIX_PAGE_DST,			//! page being copied to
+	FIX_SLOTS
+
+};
+
+//! virtual address of a fixmap slot
+#define FIXMAP_ADDR(slot) 		(FIXMAP_BASE + (slot) * VMM_PAGE_SIZE)
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE FUNCTION PROTOTYPES
+//-----------------------------------------------------------------------------
+
+//! creates the fixmap page table and turns on the recursive mapping of the
+//! current address space. must run before any address space copies the
+//! kernel directory.
+void 		fixmap_init (void);
+
+//! true once the current address space can be walked through the recursive
+//! mapping
+bool 		fixmap_recursive_ready (void);
+
+//! maps a physical frame at a fixmap slot and returns its address
+void* 		fixmap_map (enum fixmap_slot slot, void* phys);
+
+//! removes the mapping of a fixmap slot
+void 		fixmap_unmap (enum fixmap_slot slot);
+
+//*****************************************************************************
+//**
+//** 	END _[filename]
+//**
+//*****************************************************************************
+
+#endif // !_FIXMAP_H
@@ -0,0 +1,75 @@
+#ifndef _FRAME_H
+#define _FRAME_H
+//*****************************************************************************
+//*
+//*  @file		[frame.h]
+//*  @author    Abdul Rafay (abdul.rafay@lums.edu.pk)
+//*  @brief		Per frame metadata for physical memory. The kmm only knows
+//*				whether a frame is used, this table tracks how many mappings
+//*				share it so that a shared frame is only given back to the kmm
+//*				when the last of them goes away.
+//*  @version
+//*
+//****************************************************************************/
+//-----------------------------------------------------------------------------
+// 		REQUIRED HEADERS
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE DEFINES/TYPES
+//-----------------------------------------------------------------------------
+
+//! frame number of a physical address
+#define FRAME_NUMBER(phys) 	((uintptr_t)(phys) >> 12)
+
+//! frame_meta flags
+#define FRAME_PINNED 		0x0001	//! never freed, references are not counted
+#define FRAME_KSM 			0x0002	//! merged page shared by identical mappings
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE DATA STRUCTURES
+//-----------------------------------------------------------------------------
+
+/* Metadata kept for every physical frame. A frame fresh out of the kmm has a
+	single owner and a zeroed entry, so the kmm never has to touch the table. */
+typedef struct _frame_meta {
+
+	uint16_t 	refs;		//! references held in addition to the owner
+	uint16_t 	flags;		//! FRAME_* state flags
+	uint32_t 	checksum;	//! contents when the merge scanner last saw it
+
+} frame_meta_t;
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE FUNCTION PROTOTYPES
+//-----------------------------------------------------------------------------
+
+//! allocates the metadata table, must be called after vmalloc_init
+void 			frame_init (void);
+
+//! returns the metadata of the frame at the given physical address
+frame_meta_t* 	frame_meta (void* phys);
+
+//! takes an additional reference on a frame
+void 			frame_get (void* phys);
+
+//! drops a reference, the frame goes back to the kmm with the last one
+void 			frame_put (void* phys);
+
+//! pins a frame for good. a pinned frame may be mapped any number of times
+//! and always reports itself as shared.
+void 			frame_pin (void* phys);
+
+//! number of references on a frame, including the owner
+uint32_t 		frame_refcount (void* phys);
+
+//*****************************************************************************
+//**
+//** 	END _[filename]
+//**
+//*****************************************************************************
+
+#endif // !_FRAME_H
@@ -0,0 +1,115 @@
+#ifndef _HIGHMEM_H
+#define _HIGHMEM_H
+//*****************************************************************************
+//*
+//*  @file		[highmem.h]
+//*  @author    Abdul Rafay (abdul.rafay@lums.edu.pk)
+//*  @brief		Physical memory above 4GB. The kmm only knows the low 32 bits
+//*				of the e820 map, everything beyond is handed out here in 4MB
+//*				chunks. 4MB directory entries carry address bits 32 to 35
+//*				(PSE-36), so the chunks back large user pages without leaving
+//*				32 bit paging. The kernel reaches a chunk through a window.
+//*				This is PSE-36, not PAE: only large user pages live up there,
+//*				page tables and everything the kernel allocates stay below
+//*				4GB. Physical lookups return the 36 bit address through
+//*				vmm_get_phys_addr, while swap and page merging leave large
+//*				pages alone wherever they are.
+//*  @version
+//*
+//****************************************************************************/
+//-----------------------------------------------------------------------------
+// 		REQUIRED HEADERS
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <mm/vmm.h>
+#include <mm/pse.h>
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE DEFINES/TYPES
+//-----------------------------------------------------------------------------
+
+//! first physical address the kmm cannot describe
+#define HIGHMEM_START 			0x100000000ULL
+
+//! PSE-36 reaches 64GB
+#define HIGHMEM_END 			0x1000000000ULL
+
+//! the high memory is managed in large page sized chunks
+#define HIGHMEM_CHUNK_SIZE 		PSE_PAGE_SIZE
+#define HIGHMEM_MAX_CHUNKS 		((uint32_t) ((HIGHMEM_END - HIGHMEM_START) / \
+									HIGHMEM_CHUNK_SIZE))
+
+//! bits 13 to 16 of a 4MB directory entry hold address bits 32 to 35
+#define PDE_PSE36_SHIFT 		13
+#define PDE_PSE36_MASK 			0x0001E000
+
+//! true if the entry maps a large page above 4GB
+#define PDE_IS_HIGH(pde) 		(PDE_IS_PRESENT (pde) && PDE_IS_4MB (pde) && \
+									((pde) & PDE_PSE36_MASK))
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE DATA STRUCTURES
+//-----------------------------------------------------------------------------
+
+/* High memory statistics */
+typedef struct _highmem_stats {
+
+	uint32_t 	chunks_total;	//! usable chunks found in the e820 map
+	uint32_t 	chunks_free;	//! chunks not handed out
+	uint32_t 	allocs;			//! chunks handed out so far
+
+} highmem_stats_t;
+
+/* What a map of the window replaced, restored when it is unmapped. Every
+	caller keeps its own, so maps can nest. */
+typedef struct _highmem_kmap {
+
+	uint32_t 	eflags;			//! interrupt flag before the map
+	pde_t 		saved;			//! window entry before the map
+
+} highmem_kmap_t;
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE FUNCTION PROTOTYPES
+//-----------------------------------------------------------------------------
+
+//! collects the usable memory above 4GB from the e820 map. needs PSE-36 and
+//! must run after pse_init.
+void 		highmem_init (void);
+
+//! true if there is memory above 4GB to hand out
+bool 		highmem_enabled (void);
+
+//! returns the physical address of a free chunk, 0 if there is none
+uint64_t 	highmem_chunk_alloc (void);
+
+//! returns a chunk to the free pool
+void 		highmem_chunk_free (uint64_t phys);
+
+//! builds a large user page directory entry for a chunk
+pde_t 		highmem_make_pde (uint64_t phys, uint32_t flags);
+
+//! physical address of the chunk behind a large directory entry
+uint64_t 	highmem_pde_addr (pde_t pde);
+
+//! maps a chunk at the kernel window and returns its address. interrupts
+//! stay off until highmem_kunmap, the window belongs to the current space.
+//! a nested map hides the chunk of the outer one until it is unmapped.
+void* 		highmem_kmap (uint64_t phys, highmem_kmap_t* km);
+
+//! puts back what the window held and the interrupt flag before the map
+void 		highmem_kunmap (highmem_kmap_t* km);
+
+//! returns the high memory statistics
+const highmem_stats_t* 	highmem_get_stats (void);
+
+//*****************************************************************************
+//**
+//** 	END _[filename]
+//**
+//*****************************************************************************
+
+#endif // !_HIGHMEM_H
@@ -0,0 +1,95 @@
+#ifndef _HUGEPAGE_H
+#define _HUGEPAGE_H
+//*****************************************************************************
+//*
+//*  @file		[hugepage.h]
+//*  @author    Abdul Rafay (abdul.rafay@lums.edu.pk)
+//*  @brief		Transparent 4MB user pages. Aligned 4MB pieces of user regions
+//*				are backed by a single large page when the kmm has a free
+//*				contiguous block, and split back into a page table as soon as
+//*				part of one is unmapped, protected differently or shared.
+//*  @version
+//*
+//****************************************************************************/
+//-----------------------------------------------------------------------------
+// 		REQUIRED HEADERS
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include <mm/vmm.h>
+#include <mm/pse.h>
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE DEFINES/TYPES
+//-----------------------------------------------------------------------------
+
+//! kmm order of the block behind a large page
+#define HUGEPAGE_ORDER 		10
+
+//! true if the entry maps a large user page
+#define PDE_IS_HUGE(pde) 	(PDE_IS_PRESENT (pde) && PDE_IS_4MB (pde))
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE DATA STRUCTURES
+//-----------------------------------------------------------------------------
+
+/* Large user page statistics */
+typedef struct _hugepage_stats {
+
+	uint32_t 	hits;		//! 4MB pieces backed by a large page
+	uint32_t 	fallbacks;	//! pieces that got 4KB pages, no free block
+	uint32_t 	splits;		//! large pages turned back into page tables
+	uint32_t 	releases;	//! large pages unmapped as a whole
+	uint32_t 	migrations;	//! large pages moved below 4GB to be split
+
+} hugepage_stats_t;
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE FUNCTION PROTOTYPES
+//-----------------------------------------------------------------------------
+
+//! turns large user pages on or off, they are on whenever pse is available
+void 		hugepage_set_enabled (bool enabled);
+
+//! true if new user mappings may use large pages
+bool 		hugepage_enabled (void);
+
+//! backs the 4MB aligned address with a zeroed large page, taken from above
+//! 4GB while there is memory there. the directory entry must be empty.
+//! returns false, counting a fallback if the kmm had no block, when the
+//! caller has to use 4KB pages.
+bool 		hugepage_map (pagedir_t* pdir, uintptr_t virt, uint32_t flags);
+
+//! vmm_alloc_region that backs every aligned 4MB piece of the region with a
+//! large page where it can
+bool 		hugepage_alloc_region (pagedir_t* pdir, void* virtual, size_t size,
+								   uint32_t flags);
+
+//! replaces the large page at virt with a page table mapping the same frames.
+//! a large page above 4GB is moved into a low block first.
+int32_t 	hugepage_split (pagedir_t* pdir, uintptr_t virt);
+
+//! moves the large page at virt into a low block if it lies above 4GB.
+//! returns -1 if the kmm has no block for it.
+int32_t 	hugepage_migrate_low (pagedir_t* pdir, uintptr_t virt);
+
+//! unmaps the large page at virt and frees its frames. the caller flushes
+//! the tlb.
+void 		hugepage_release (pagedir_t* pdir, uintptr_t virt);
+
+//! releases every large page of the user half of an address space
+void 		hugepage_release_space (pagedir_t* pdir);
+
+//! returns the large page statistics
+const hugepage_stats_t* 	hugepage_get_stats (void);
+
+//*****************************************************************************
+//**
+//** 	END _[filename]
+//**
+//*****************************************************************************
+
+#endif // !_HUGEPAGE_H
@@ -24,6 +24,13 @@
 //! the heap allocator always aligns the sizes to the word size 
 #define ALLOCATOR_ALIGNMENT sizeof(void*)
 
+//! granularity at which a growable heap is backed with frames on demand
+#define KHEAP_GROW_CHUNK 		0x10000
+
+//! requests of at least this size are served by whole pages instead of the
+//! buddy heap, whose header would double a page sized request
+#define KMALLOC_PAGES_THRESHOLD 4096
+
 //-----------------------------------------------------------------------------
 // 		INTERFACE DATA STRUCTURES
 //-----------------------------------------------------------------------------
@@ -68,9 +75,32 @@ void* 		realloc (void* ptr, size_t size);
 //! gets the kernel heap descriptor
 heap_t* 	get_kernel_heap(void);
 
-//! display heap usage statistics
+//! display heap usage statistics, followed by the utilization of every
+//! object cache
 void 		kheap_stats(heap_t* heap);
 
+//! backs only initial_size of the heap with frames, the rest of the window up
+//! to max_size is mapped on demand when first touched
+void 		kheap_enable_growth(heap_t* heap, size_t initial_size);
+
+//! gives the frames of large free blocks back to the kmm, returns the count
+uint32_t 	kheap_trim(heap_t* heap);
+
+//! number of bytes of the heap currently backed by frames
+size_t 		kheap_backed_size(heap_t* heap);
+
+//! allocates count whole pages without a header, the memory is page aligned
+void* 		kmalloc_pages(uint32_t count);
+void 		kfree_pages(void* ptr);
+
+//! allocates from the heap or from whole pages depending on the size
+void* 		kvmalloc(size_t size);
+void 		kvfree(void* ptr);
+
+//! resizes a kvmalloc block, moving it between the heap and whole pages when
+//! it crosses KMALLOC_PAGES_THRESHOLD
+void* 		kvrealloc(void* ptr, size_t old_size, size_t new_size);
+
 //*****************************************************************************
 //**
 //** 	END _[filename]
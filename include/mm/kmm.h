@@ -69,6 +69,10 @@ typedef struct {
 //!     responsible for managing the physical memory of the system.
 void     kmm_init(void);
 
+//! limits the kmm to the first max_frames frames, the frames above are never
+//!     handed out. must be called right after kmm_init.
+void     kmm_limit(uint32_t max_frames);
+
 //! The function allocates one block and returns its physical address
 void*    kmm_frame_alloc(void);
 
@@ -91,4 +95,12 @@ void*    kmm_get_bitmap_start (void);
 //! returns the size of the bitmap in bytes
 uint32_t kmm_get_bitmap_size ();
 
+//! allocates 2^order physically contiguous frames, aligned to the size of the
+//! block. returns the physical address of the first frame or NULL. the frames
+//! are ordinary frames afterwards and may be freed one at a time.
+void*    kmm_block_alloc (uint32_t order);
+
+//! frees all the frames of a block returned by kmm_block_alloc
+void     kmm_block_free (void* phys_addr, uint32_t order);
+
 #endif // !_KMM_H
@@ -0,0 +1,79 @@
+#ifndef _KSM_H
+#define _KSM_H
+//*****************************************************************************
+//*
+//*  @file		[ksm.h]
+//*  @author    Abdul Rafay (abdul.rafay@lums.edu.pk)
+//*  @brief		Same page merging. A scanner walks the user pages of every
+//*				address space, and pages whose contents stayed the same for a
+//*				whole pass are merged with identical pages of any address
+//*				space into one read-only frame, shared copy on write. Pages
+//*				full of zeroes are merged into the zero page.
+//*  @version
+//*
+//****************************************************************************/
+//-----------------------------------------------------------------------------
+// 		REQUIRED HEADERS
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE DEFINES/TYPES
+//-----------------------------------------------------------------------------
+
+//! the scanner is off until enabled
+#define KSM_DEFAULT_ENABLED 	false
+
+//! pages looked at every time the timer runs the scanner
+#define KSM_SCAN_PAGES 			64
+
+//! timer ticks between two runs of the scanner
+#define KSM_SCAN_INTERVAL 		100
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE DATA STRUCTURES
+//-----------------------------------------------------------------------------
+
+/* Same page merging statistics */
+typedef struct _ksm_stats {
+
+	uint32_t 	pages_shared;	//! merged frames currently in use
+	uint32_t 	pages_sharing;	//! frames saved by them
+	uint32_t 	zero_merges;	//! pages replaced by the zero page
+	uint32_t 	merges;			//! pages replaced by a merged frame
+	uint32_t 	scanned;		//! pages looked at
+	uint32_t 	full_scans;		//! passes over all address spaces
+
+} ksm_stats_t;
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE FUNCTION PROTOTYPES
+//-----------------------------------------------------------------------------
+
+//! creates the scanner caches and hooks it to the timer, must be called
+//! after kmem_cache_init and init_system_timer
+void 		ksm_init (void);
+
+//! turns the periodic scanner on or off
+void 		ksm_set_enabled (bool enabled);
+bool 		ksm_enabled (void);
+
+//! looks at up to nr user pages, returns the number of pages merged
+uint32_t 	ksm_scan (uint32_t nr);
+
+//! returns the merging statistics, the sharing counts are computed on the fly
+const ksm_stats_t* 	ksm_get_stats (void);
+
+//! display the merging statistics
+void 		ksm_stats (void);
+
+//*****************************************************************************
+//**
+//** 	END _[filename]
+//**
+//*****************************************************************************
+
+#endif // !_KSM_H
@@ -0,0 +1,87 @@
+#ifndef _KSTACK_H
+#define _KSTACK_H
+//*****************************************************************************
+//*
+//*  @file		[kstack.h]
+//*  @author    Abdul Rafay (abdul.rafay@lums.edu.pk)
+//*  @brief		Kernel stacks. Every stack lives at the top of a fixed size
+//*				slot of a dedicated kernel range, the pages of the slot below
+//*				it are never mapped and turn an overflow into a fault instead
+//*				of silently overwriting the neighbour. Freed stacks stay mapped
+//*				on a free list per size and are handed out again as they are.
+//*  @version
+//*
+//****************************************************************************/
+//-----------------------------------------------------------------------------
+// 		REQUIRED HEADERS
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include <mm/vmm.h>
+#include <mem.h>
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE DEFINES/TYPES
+//-----------------------------------------------------------------------------
+
+//! largest stack, in pages
+#define KSTACK_MAX_PAGES 		4
+
+//! a slot holds the largest stack and at least one guard page
+#define KSTACK_SLOT_SIZE 		((KSTACK_MAX_PAGES + 1) * VMM_PAGE_SIZE)
+#define KSTACK_MAX_SLOTS 		((KSTACK_AREA_END - KSTACK_AREA_START) / \
+									KSTACK_SLOT_SIZE)
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE DATA STRUCTURES
+//-----------------------------------------------------------------------------
+
+/* Kernel stack statistics */
+typedef struct _kstack_stats {
+
+	uint32_t 	allocs;			//! stacks handed out
+	uint32_t 	frees;			//! stacks given back
+	uint32_t 	cache_hits;		//! allocations served from a free list
+	uint32_t 	in_use;			//! stacks currently handed out
+	uint32_t 	cached;			//! stacks on the free lists
+	uint32_t 	reclaimed;		//! pages released by the shrinker
+	uint32_t 	guard_hits;		//! faults on a guard page, overflows included
+
+} kstack_stats_t;
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE FUNCTION PROTOTYPES
+//-----------------------------------------------------------------------------
+
+//! creates the page tables of the stack range, registers the guard page
+//! fault handler and the shrinker of the free lists, and sends the double
+//! fault of an overflow to a task with its own stack. must run after
+//! vmm_fault_init and idt_init and before the first thread is created.
+void 		kstack_init (void);
+
+//! returns a stack of size bytes, rounded up to pages, NULL if size is too
+//! large or there is no memory. the contents are not cleared.
+void* 		kstack_alloc (size_t size);
+
+//! puts a stack back on the free list of its size
+void 		kstack_free (void* stack);
+
+//! true if the address lies in the stack range
+bool 		kstack_owns (const void* addr);
+
+//! returns the stack statistics
+const kstack_stats_t* 	kstack_get_stats (void);
+
+//! display the stack statistics
+void 		kstack_stats (void);
+
+//*****************************************************************************
+//**
+//** 	END _[filename]
+//**
+//*****************************************************************************
+
+#endif // !_KSTACK_H
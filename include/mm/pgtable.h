@@ -0,0 +1,60 @@
+#ifndef _PGTABLE_H
+#define _PGTABLE_H
+//*****************************************************************************
+//*
+//*  @file		[pgtable.h]
+//*  @author    Abdul Rafay (abdul.rafay@lums.edu.pk)
+//*  @brief		Helpers to walk and edit page table entries directly, for the
+//*				memory subsystems that manage mappings outside of the vmm.
+//*  @version
+//*
+//****************************************************************************/
+//-----------------------------------------------------------------------------
+// 		REQUIRED HEADERS
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include <mm/vmm.h>
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE DEFINES/TYPES
+//-----------------------------------------------------------------------------
+
+//! size of the region mapped by one page directory entry
+#define PGTABLE_SPAN 			(VMM_PAGE_SIZE * VMM_PAGES_PER_TABLE)
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE FUNCTION PROTOTYPES
+//-----------------------------------------------------------------------------
+
+//! returns the page table mapping the given address, NULL if there is none
+pagetable_t* 	pgtable_get_table (pagedir_t* pdir, void* virtual);
+
+//! returns the pte mapping the given address, NULL if it has no page table
+pte_t* 			pgtable_get_pte (pagedir_t* pdir, void* virtual);
+
+//! clears the pte of a page, drops its frame reference and flushes the tlb
+//! entry. the page table itself is kept, a large page is split first. returns true if a page was mapped.
+bool 			pgtable_unmap_page (pagedir_t* pdir, void* virtual);
+
+//! unmaps every page of a range like pgtable_unmap_page, but invalidates the
+//! tlb once for the whole range. large pages inside it are freed whole. returns the number of pages unmapped.
+uint32_t 		pgtable_unmap_range (pagedir_t* pdir, uintptr_t start,
+									 size_t size);
+
+//! changes the writable and user bits of every present page of a range to
+//! those in flags. copy on write pages stay read-only. returns the number
+//! of pages changed.
+uint32_t 		pgtable_protect_range (pagedir_t* pdir, uintptr_t start,
+									   size_t size, uint32_t flags);
+
+//*****************************************************************************
+//**
+//** 	END _[filename]
+//**
+//*****************************************************************************
+
+#endif // !_PGTABLE_H
@@ -0,0 +1,74 @@
+#ifndef _PSE_H
+#define _PSE_H
+//*****************************************************************************
+//*
+//*  @file		[pse.h]
+//*  @author    Abdul Rafay (abdul.rafay@lums.edu.pk)
+//*  @brief		4MB pages (CR4.PSE). The kernel linear map is rebuilt out of
+//*				large page directory entries once the vmm has set it up, which
+//*				frees its page tables and needs one TLB entry per 4MB.
+//*  @version
+//*
+//****************************************************************************/
+//-----------------------------------------------------------------------------
+// 		REQUIRED HEADERS
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <mm/vmm.h>
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE DEFINES/TYPES
+//-----------------------------------------------------------------------------
+
+//! size of the region mapped by a large page directory entry
+#define PSE_PAGE_SIZE 			0x400000
+
+//! offset of an address inside its large page
+#define PSE_PAGE_OFFSET(addr) 	((uintptr_t)(addr) & (PSE_PAGE_SIZE - 1))
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE DATA STRUCTURES
+//-----------------------------------------------------------------------------
+
+/* Large page statistics */
+typedef struct _pse_stats {
+
+	uint32_t 	kernel_pdes;	//! linear map entries turned into 4MB pages
+	uint32_t 	tables_freed;	//! page tables released by doing so
+
+} pse_stats_t;
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE FUNCTION PROTOTYPES
+//-----------------------------------------------------------------------------
+
+//! enables CR4.PSE if the cpu has it and maps the physmap with 4MB pages.
+//! must run after frame_init and before any address space copies the kernel
+//! directory.
+void 		pse_init (void);
+
+//! true if 4MB pages are in use
+bool 		pse_enabled (void);
+
+//! replaces the page table behind a 4MB aligned address with a large entry
+//! if the table maps one physically contiguous, present 4MB block. returns
+//! true if the entry was collapsed. the caller flushes the tlb.
+bool 		pse_collapse_linear (pagedir_t* pdir, uintptr_t virt);
+
+//! physical address of the page mapping virtual, frames of large pages above
+//! 4GB included. returns 0 if nothing is mapped there.
+uint64_t 	vmm_get_phys_addr (pagedir_t* pdir, void* virtual);
+
+//! returns the large page statistics
+const pse_stats_t* 	pse_get_stats (void);
+
+//*****************************************************************************
+//**
+//** 	END _[filename]
+//**
+//*****************************************************************************
+
+#endif // !_PSE_H
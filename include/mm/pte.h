@@ -14,6 +14,8 @@
 #define PTE_PAT             0x080
 #define PTE_GLOBAL          0x100 // Page is global (not flushed on context switch)
 #define PTE_LV4_GLOBAL      0x200
+#define PTE_COW             0x400 // Software: shared page, copy on write
+#define PTE_SWAPPED         0x800 // Software: not present, contents in swap
 
 #define PTE_FRAME_MASK      0xFFFFF000 // Mask for the frame address in the PTE
 
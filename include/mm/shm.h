@@ -0,0 +1,117 @@
+#ifndef _SHM_H
+#define _SHM_H
+//*****************************************************************************
+//*
+//*  @file		[shm.h]
+//*  @author    Abdul Rafay (abdul.rafay@lums.edu.pk)
+//*  @brief		Shared memory segments. A segment is a set of frames that
+//*				processes attach into their address spaces, every attachment
+//*				maps the very same frames so data written by one process is
+//*				seen by the others without any copying.
+//*  @version
+//*
+//****************************************************************************/
+//-----------------------------------------------------------------------------
+// 		REQUIRED HEADERS
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include <mm/vmm.h>
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE DEFINES/TYPES
+//-----------------------------------------------------------------------------
+
+//! maximum number of segments in the system at once
+#define SHM_MAX_SEGMENTS 	16
+
+//! largest segment, in bytes
+#define SHM_MAX_SIZE 		0x00400000
+
+//! live segments created by one address space at once
+#define SHM_MAX_PER_SPACE 	4
+
+//! key that always creates a new segment instead of looking one up
+#define SHM_KEY_PRIVATE 	0
+
+//! pte flags the pages of an attachment are mapped with
+#define SHM_PAGE_FLAGS 		(PTE_PRESENT | PTE_WRITABLE | PTE_USER)
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE DATA STRUCTURES
+//-----------------------------------------------------------------------------
+
+/* A segment owns one reference on each of its frames, every attachment
+	holds one more per page it maps. A segment lives until its last
+	attachment is detached. One that is removed, or whose creator exits,
+	while nothing is attached goes away right then. */
+typedef struct _shm_segment {
+
+	bool 		used;		//! slot holds a live segment
+	bool 		removed;	//! key dropped, freed with the last attachment
+	uint32_t 	key;		//! key it was created under
+	pagedir_t* 	owner;		//! space that created it, NULL for the kernel
+	size_t 		size;		//! size rounded up to whole pages
+	uint32_t 	nattch;		//! address spaces it is attached to
+	void** 		frames;		//! physical frames, size / page size of them
+
+} shm_segment_t;
+
+/* Shared memory statistics */
+typedef struct _shm_stats {
+
+	uint32_t 	segments;	//! live segments
+	uint32_t 	pages;		//! frames owned by live segments
+	uint32_t 	attaches;	//! attachments made, including by fork
+	uint32_t 	detaches;	//! attachments removed, including on exit
+
+} shm_stats_t;
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE FUNCTION PROTOTYPES
+//-----------------------------------------------------------------------------
+
+//! installs the shm syscalls in front of the syscall handler, must be called
+//! after syscall_init
+void 		shm_init (void);
+
+//! returns the id of the segment with the given key, creating a zeroed one
+//! of size bytes for pdir if there is none. a space may own at most
+//! SHM_MAX_PER_SPACE segments, a NULL pdir creates one for the kernel.
+//! returns -1 on failure.
+int32_t 	shm_create (pagedir_t* pdir, uint32_t key, size_t size);
+
+//! drops the key of a segment, so it is neither found nor attached again.
+//! it is freed now if nothing is attached, else with the last detach. only
+//! the creator, or the kernel, may remove a segment. returns -1 on failure.
+int32_t 	shm_remove (pagedir_t* pdir, int32_t id);
+
+//! maps a segment into an address space at addr, or anywhere in the shm
+//! window for NULL. returns the address it is attached at, NULL on failure.
+void* 		shm_attach (pagedir_t* pdir, int32_t id, void* addr);
+
+//! unmaps the segment attached at addr. a segment goes away once the last
+//! attachment to it is gone, whether or not it was removed.
+int32_t 	shm_detach (pagedir_t* pdir, void* addr);
+
+//! lets a forked child share the segments of its parent instead of copying
+//! them, called once the areas and pages were cloned
+void 		shm_clone_space (pagedir_t* src, pagedir_t* dst);
+
+//! drops every attachment of an address space before it is destroyed, and
+//! frees the segments it created that nothing is attached to
+void 		shm_release_space (pagedir_t* pdir);
+
+//! returns the shared memory statistics
+const shm_stats_t* 	shm_get_stats (void);
+
+//*****************************************************************************
+//**
+//** 	END _[filename]
+//**
+//*****************************************************************************
+
+#endif // !_SHM_H
@@ -0,0 +1,119 @@
+#ifndef _SHRINKER_H
+#define _SHRINKER_H
+//*****************************************************************************
+//*
+//*  @file		[shrinker.h]
+//*  @author    Abdul Rafay (abdul.rafay@lums.edu.pk)
+//*  @brief		Memory pressure handling. Kernel caches register a shrinker
+//*				that reports how many pages they could give back and releases
+//*				them on request. The shrinkers are run when free frames drop
+//*				below the low watermark, and once more before a frame
+//*				allocation is allowed to fail.
+//*  @version
+//*
+//****************************************************************************/
+//-----------------------------------------------------------------------------
+// 		REQUIRED HEADERS
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <kernel/list.h>
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE DEFINES/TYPES
+//-----------------------------------------------------------------------------
+
+//! default watermarks, in frames. below low the shrinkers are run until the
+//! free frame count is back at high.
+#define SHRINKER_LOW_WATERMARK 		64
+#define SHRINKER_HIGH_WATERMARK 	128
+
+//! maximum length of a shrinker name (including the terminator)
+#define SHRINKER_NAME_LEN 			16
+
+//! the shrinker works on the kernel heap, so it must not run
+//! while the heap itself is allocating
+#define SHRINKER_USES_HEAP 			0x01
+
+//! flags for reclaim_frame_alloc
+#define RECLAIM_NOHEAP 				0x01	//! skip SHRINKER_USES_HEAP shrinkers
+#define RECLAIM_NORECLAIM 			0x02	//! never run the shrinkers
+
+//! returns the number of pages the cache could release right now
+typedef uint32_t (*shrink_count_t) (void* priv);
+
+//! releases up to nr_to_scan pages, returns the number actually released
+typedef uint32_t (*shrink_scan_t) (void* priv, uint32_t nr_to_scan);
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE DATA STRUCTURES
+//-----------------------------------------------------------------------------
+
+/* A shrinker is owned by the cache that registers it, usually as a static. */
+typedef struct _shrinker {
+
+	char 			name[SHRINKER_NAME_LEN];	//! name used in the statistics
+	shrink_count_t 	count;				//! reports freeable pages
+	shrink_scan_t 	scan;				//! releases pages
+	void* 			priv;				//! passed back to the callbacks
+	uint32_t 		flags;				//! SHRINKER_* flags
+
+	uint32_t 		calls;				//! number of times scan was invoked
+	uint32_t 		reclaimed;			//! pages released since registration
+
+	list_element_t 	link;				//! link in the shrinker list
+
+} shrinker_t;
+
+/* System wide reclaim statistics */
+typedef struct _reclaim_stats {
+
+	uint32_t 		low_wmark_hits;		//! allocations that found free < low
+	uint32_t 		direct_reclaims;	//! allocations that failed and reclaimed
+	uint32_t 		direct_rescues;		//! failed allocations saved by reclaim
+	uint32_t 		alloc_failures;		//! allocations that failed after reclaim
+	uint32_t 		pages_reclaimed;	//! pages released by all shrinkers
+
+} reclaim_stats_t;
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE FUNCTION PROTOTYPES
+//-----------------------------------------------------------------------------
+
+//! adds a shrinker to the registry, count and scan are both required
+int32_t 	shrinker_register (shrinker_t* shrinker);
+
+//! removes a previously registered shrinker
+void 		shrinker_unregister (shrinker_t* shrinker);
+
+//! sets the watermarks in frames, high must not be below low
+int32_t 	shrinker_set_watermarks (uint32_t low, uint32_t high);
+void 		shrinker_get_watermarks (uint32_t* low, uint32_t* high);
+
+//! runs the shrinkers until nr_pages are released or nothing is left to
+//! release, returns the number of pages released
+uint32_t 	shrink_memory (uint32_t nr_pages, uint32_t flags);
+
+//! allocates a frame like kmm_frame_alloc, but runs the shrinkers under
+//! memory pressure and before giving up
+void* 		reclaim_frame_alloc (uint32_t flags);
+
+//! reclaim_frame_alloc for the prebuilt vmm, which is linked against this in
+//! place of kmm_frame_alloc. the vmm maps the pages of the heap from inside
+//! its fault handler, so the shrinkers that use the heap are left out.
+void* 		kmm_frame_alloc_reclaim (void);
+
+//! returns the reclaim statistics
+const reclaim_stats_t* 	reclaim_get_stats (void);
+
+//! display the watermarks and the per-shrinker statistics
+void 		shrinker_stats (void);
+
+//*****************************************************************************
+//**
+//** 	END _[filename]
+//**
+//*****************************************************************************
+
+#endif // !_SHRINKER_H
@@ -0,0 +1,129 @@
+#ifndef _SLAB_H
+#define _SLAB_H
+//*****************************************************************************
+//*
+//*  @file		[slab.h]
+//*  @author    Abdul Rafay (abdul.rafay@lums.edu.pk)
+//*  @brief		Slab allocator for fixed size kernel objects. Each cache hands
+//*				out objects of a single size carved out of page sized slabs,
+//*				which are taken directly from the physical memory manager.
+//*  @version
+//*
+//****************************************************************************/
+//-----------------------------------------------------------------------------
+// 		REQUIRED HEADERS
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <kernel/list.h>
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE DEFINES/TYPES
+//-----------------------------------------------------------------------------
+
+//! every slab spans exactly one page frame
+#define KMEM_SLAB_SIZE 			4096
+
+//! maximum length of a cache name (including the terminator)
+#define KMEM_CACHE_NAME_LEN 	24
+
+//! minimum object alignment, the free list link is stored inside free objects
+#define KMEM_MIN_ALIGN 			sizeof(void*)
+
+//! number of completely free slabs a cache holds on to before giving pages
+//! back to the physical memory manager
+#define KMEM_FREE_SLABS_MAX 	1
+
+//! magic stored in each slab header, used to validate frees
+#define KMEM_SLAB_MAGIC 		0x51AB51AB
+
+//! object constructor, invoked on every object before it is handed out by
+//! kmem_cache_alloc. the free list link reuses the first word of free objects.
+typedef void (*kmem_ctor_t) (void* obj);
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE DATA STRUCTURES
+//-----------------------------------------------------------------------------
+
+/* A cache manages all the objects of one kind. Slabs are kept on one of three
+	lists depending on how many of their objects are in use, so allocation
+	only ever has to look at the head of the partial (or free) list. */
+typedef struct _kmem_cache {
+
+	char 			name[KMEM_CACHE_NAME_LEN];	//! name used in the statistics
+	size_t 			obj_size;			//! size requested by the creator
+	size_t 			slot_size;			//! aligned size of each object slot
+	uint32_t 		objs_per_slab;		//! number of objects in each slab
+	uint32_t 		first_offset;		//! offset of first object in a slab
+	kmem_ctor_t 	ctor;				//! optional object constructor
+
+	list_t 			slabs_full;			//! slabs with no free objects
+	list_t 			slabs_partial;		//! slabs with some free objects
+	list_t 			slabs_free;			//! slabs with all objects free
+
+	uint32_t 		num_slabs;			//! slabs currently owned by the cache
+	uint32_t 		num_active;			//! objects currently handed out
+	uint32_t 		total_allocs;		//! allocations served since creation
+	uint32_t 		total_frees;		//! frees served since creation
+	uint32_t 		slabs_reclaimed;	//! slabs given back to the kmm
+
+	list_element_t 	cache_link;			//! link in the global cache list
+
+} kmem_cache_t;
+
+/* Header placed at the start of every slab page, objects follow it. Free
+	objects are chained through their first word. */
+typedef struct _kmem_slab {
+
+	list_element_t 	link;				//! link in one of the cache lists
+	kmem_cache_t* 	cache;				//! owning cache
+	void* 			free_list;			//! first free object in this slab
+	uint32_t 		in_use;				//! number of allocated objects
+	uint32_t 		magic;				//! KMEM_SLAB_MAGIC
+
+} kmem_slab_t;
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE FUNCTION PROTOTYPES
+//-----------------------------------------------------------------------------
+
+//! initializes the slab allocator, must be called after the kmm and vmm
+void 			kmem_cache_init (void);
+
+//! creates a new cache of objects of the given size. align of 0 selects the
+//! default word alignment. returns NULL if the object cannot fit in a slab.
+kmem_cache_t* 	kmem_cache_create (const char* name, size_t size, size_t align,
+								   kmem_ctor_t ctor);
+
+//! destroys a cache, fails if it still has objects in use
+int32_t 		kmem_cache_destroy (kmem_cache_t* cache);
+
+//! allocates one object from the cache, NULL if out of memory
+void* 			kmem_cache_alloc (kmem_cache_t* cache);
+
+//! returns an object to the cache it was allocated from
+void 			kmem_cache_free (kmem_cache_t* cache, void* obj);
+
+//! returns the cache an object was allocated from, NULL for memory that is
+//! not part of a slab. the slab pages are recorded as they come and go, so
+//! any pointer can be asked about.
+kmem_cache_t* 	kmem_cache_of (const void* obj);
+
+//! releases all completely free slabs of the cache, returns number of pages
+uint32_t 		kmem_cache_shrink (kmem_cache_t* cache);
+
+//! shrinks every cache in the system, returns number of pages released
+uint32_t 		kmem_cache_reap (void);
+
+//! display per-cache utilization statistics
+void 			kmem_cache_stats (void);
+
+//*****************************************************************************
+//**
+//** 	END _[filename]
+//**
+//*****************************************************************************
+
+#endif // !_SLAB_H
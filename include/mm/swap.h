@@ -0,0 +1,109 @@
+#ifndef _SWAP_H
+#define _SWAP_H
+//*****************************************************************************
+//*
+//*  @file		[swap.h]
+//*  @author    Abdul Rafay (abdul.rafay@lums.edu.pk)
+//*  @brief		Swapping of user pages to a block device. A CLOCK hand sweeps
+//*				the areas of every address space, giving recently accessed
+//*				pages a second chance and writing the others out to a swap
+//*				slot. The pte of an evicted page keeps the slot number, and
+//*				the page is read back by the fault that touches it next.
+//*  @version
+//*
+//****************************************************************************/
+//-----------------------------------------------------------------------------
+// 		REQUIRED HEADERS
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include <mm/vmm.h>
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE DEFINES/TYPES
+//-----------------------------------------------------------------------------
+
+//! device the swap area is split off, and its size in blocks
+#define SWAP_PARENT_DEVICE 		"hd1"
+#define SWAP_DEVICE 			"swap0"
+#define SWAP_AREA_BLOCKS 		4096
+
+//! default share of the pages asked of the swap shrinker that it evicts
+#define SWAP_DEFAULT_SWAPPINESS 60
+#define SWAP_MAX_SWAPPINESS 	100
+
+//! most ptes the clock hand looks at in one call to swap_out
+#define SWAP_SCAN_MAX 			4096
+
+//! a swap entry is a non-present pte holding the slot number in its frame
+//! bits and the writable and user bits the page had
+#define PTE_IS_SWAP(pte) 		(!PTE_IS_PRESENT (pte) && ((pte) & PTE_SWAPPED))
+#define SWAP_ENTRY(slot, flags) \
+	( ((slot) << 12) | ((flags) & (PTE_WRITABLE | PTE_USER)) | PTE_SWAPPED )
+#define SWAP_SLOT(pte) 			((pte) >> 12)
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE DATA STRUCTURES
+//-----------------------------------------------------------------------------
+
+/* Swap statistics */
+typedef struct _swap_stats {
+
+	uint32_t 	slots;		//! page sized slots in the swap area
+	uint32_t 	used;		//! slots holding a page
+	uint32_t 	swap_ins;	//! pages read back on a fault
+	uint32_t 	swap_outs;	//! pages written out and unmapped
+	uint32_t 	scanned;	//! ptes looked at by the clock hand
+	uint32_t 	failures;	//! evictions or faults that hit an i/o error
+
+} swap_stats_t;
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE FUNCTION PROTOTYPES
+//-----------------------------------------------------------------------------
+
+//! installs the swap fault handler and shrinker, must be called after
+//! vmm_fault_init and kmem_cache_init. nothing is swapped until swap_on.
+void 		swap_init (void);
+
+//! uses the named block device as the swap area
+int32_t 	swap_on (const char* dev_name);
+
+//! true once a swap area is in use
+bool 		swap_enabled (void);
+
+//! advances the clock hand until nr pages are written out or the scan budget
+//! is used up, returns the number of pages evicted
+uint32_t 	swap_out (uint32_t nr);
+
+//! share of the pages asked of the swap shrinker that it evicts, in percent.
+//! 0 keeps user pages in memory whatever the pressure.
+int32_t 	swap_set_swappiness (uint32_t swappiness);
+uint32_t 	swap_get_swappiness (void);
+
+//! takes an additional reference on the slot of a swap entry, for a pte
+//! copied into another address space
+void 		swap_dup_entry (pte_t pte);
+
+//! drops a reference on the slot of a swap entry
+void 		swap_free_entry (pte_t pte);
+
+//! drops every swap entry of a user address space before it is destroyed
+void 		swap_release_space (pagedir_t* pdir);
+
+//! returns the swap statistics
+const swap_stats_t* swap_get_stats (void);
+
+//! display the swap statistics
+void 		swap_stats (void);
+
+//*****************************************************************************
+//**
+//** 	END _[filename]
+//**
+//*****************************************************************************
+
+#endif // !_SWAP_H
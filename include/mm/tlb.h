@@ -0,0 +1,88 @@
+#ifndef _TLB_H
+#define _TLB_H
+//*****************************************************************************
+//*
+//*  @file		[tlb.h]
+//*  @author    Abdul Rafay (abdul.rafay@lums.edu.pk)
+//*  @brief		TLB management. Kernel mappings are global so that they survive
+//*				address space switches, and invalidations of whole regions are
+//*				batched and turned into a single flush when there are many.
+//*  @version
+//*
+//****************************************************************************/
+//-----------------------------------------------------------------------------
+// 		REQUIRED HEADERS
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE DEFINES/TYPES
+//-----------------------------------------------------------------------------
+
+//! number of pages above which a batch flushes the whole TLB instead of
+//! invalidating the pages one at a time
+#define TLB_FLUSH_THRESHOLD 	32
+
+//! pte flags for kernel mappings made after boot
+#define KERNEL_PTE_FLAGS 		(PTE_PRESENT | PTE_WRITABLE | PTE_GLOBAL)
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE DATA STRUCTURES
+//-----------------------------------------------------------------------------
+
+/* Pages waiting to be invalidated, usually lives on the stack of a region
+	operation */
+typedef struct _tlb_batch {
+
+	uintptr_t 	pages[TLB_FLUSH_THRESHOLD];
+	uint32_t 	count;		//! pages recorded so far
+	bool 		full;		//! threshold exceeded, flush everything
+	bool 		global;		//! a kernel page is part of the batch
+
+} tlb_batch_t;
+
+/* TLB statistics */
+typedef struct _tlb_stats {
+
+	uint32_t 	batches;		//! batches flushed
+	uint32_t 	pages;			//! pages invalidated one at a time
+	uint32_t 	full_flushes;	//! flushes of all non global entries
+	uint32_t 	global_flushes;	//! flushes including the global entries
+
+} tlb_stats_t;
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE FUNCTION PROTOTYPES
+//-----------------------------------------------------------------------------
+
+//! marks the kernel mappings global and enables CR4.PGE if the cpu has it.
+//! kernel ranges mapped later must use KERNEL_PTE_FLAGS.
+void 		tlb_init (void);
+
+//! true if global pages are in use
+bool 		tlb_global_enabled (void);
+
+//! starts an empty batch
+void 		tlb_batch_init (tlb_batch_t* batch);
+
+//! records a page whose mapping changed
+void 		tlb_batch_add (tlb_batch_t* batch, uintptr_t virt);
+
+//! invalidates everything recorded in the batch and empties it
+void 		tlb_batch_flush (tlb_batch_t* batch);
+
+//! flushes the whole TLB, global entries included
+void 		tlb_flush_all (void);
+
+//! returns the TLB statistics
+const tlb_stats_t* 	tlb_get_stats (void);
+
+//*****************************************************************************
+//**
+//** 	END _[filename]
+//**
+//*****************************************************************************
+
+#endif // !_TLB_H
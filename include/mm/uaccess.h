@@ -0,0 +1,99 @@
+#ifndef _UACCESS_H
+#define _UACCESS_H
+//*****************************************************************************
+//*
+//*  @file		[uaccess.h]
+//*  @author    Abdul Rafay (abdul.rafay@lums.edu.pk)
+//*  @brief		Copying between the kernel and user memory. The copies do not
+//*				walk the page tables up front, they just run and a fault that
+//*				nobody can resolve is caught through the exception table: the
+//*				fault handler moves the copy to its recovery code and the
+//*				routine returns an error instead of the kernel going down.
+//*  @version
+//*
+//****************************************************************************/
+//-----------------------------------------------------------------------------
+// 		REQUIRED HEADERS
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include <mem.h>
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE DEFINES/TYPES
+//-----------------------------------------------------------------------------
+
+//! user pointers must lie inside this range, below it is the identity map
+#define USER_SPACE_START 		IDENTITY_MAP_END
+#define USER_SPACE_END 			PHYSMAP_BASE
+
+//! syscall buffers are passed through a bounce buffer of this size
+#define UACCESS_CHUNK_SIZE 		256
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE DATA STRUCTURES
+//-----------------------------------------------------------------------------
+
+/* An exception table entry. A fault on insn that no fault handler resolves
+	continues at fixup. The entries are emitted next to the instructions into
+	the __ex_table section, which the linker script gathers. */
+typedef struct _exception_entry {
+
+	uintptr_t 	insn;		//! address of the instruction allowed to fault
+	uintptr_t 	fixup;		//! where to continue if it does
+
+} exception_entry_t;
+
+/* User copy statistics */
+typedef struct _uaccess_stats {
+
+	uint32_t 	copies_from;	//! copies from user memory
+	uint32_t 	copies_to;		//! copies to user memory
+	uint32_t 	bytes;			//! bytes copied either way
+	uint32_t 	rejected;		//! pointers outside the user range
+	uint32_t 	fixups;			//! faults recovered through the table
+
+} uaccess_stats_t;
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE FUNCTION PROTOTYPES
+//-----------------------------------------------------------------------------
+
+//! registers the fixup fault handler and checks the buffers of the read and
+//! write syscalls, which reach the original handler through a bounce buffer.
+//! the fixup handler has to run after every handler that can resolve a
+//! fault, so this must be called after the other fault handlers have been
+//! registered.
+void 		uaccess_init (void);
+
+//! true if the whole range lies in user memory, the pages are not checked
+bool 		uaccess_range_ok (const void* addr, size_t size);
+
+//! copies size bytes from user memory, returns 0 or -1 if the source is bad
+int32_t 	copy_from_user (void* dst, const void* src, size_t size);
+
+//! copies size bytes to user memory, returns 0 or -1 if the destination is
+//! bad. read-only and copy on write pages are honoured.
+int32_t 	copy_to_user (void* dst, const void* src, size_t size);
+
+//! copies a string of at most size bytes from user memory. returns its length
+//! without the terminator, size if none was found within size bytes (dst is
+//! then not terminated) or -1 if the source is bad.
+int32_t 	strncpy_from_user (char* dst, const char* src, size_t size);
+
+//! returns the fixup for a faulting instruction, 0 if it has none
+uintptr_t 	uaccess_search_fixup (uintptr_t eip);
+
+//! returns the user copy statistics
+const uaccess_stats_t* 	uaccess_get_stats (void);
+
+//*****************************************************************************
+//**
+//** 	END _[filename]
+//**
+//*****************************************************************************
+
+#endif // !_UACCESS_H
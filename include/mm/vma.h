@@ -0,0 +1,152 @@
+#ifndef _VMA_H
+#define _VMA_H
+//*****************************************************************************
+//*
+//*  @file		[vma.h]
+//*  @author    Abdul Rafay (abdul.rafay@lums.edu.pk)
+//*  @brief		Virtual memory areas. Every user address space keeps a tree
+//*				of the ranges it uses (code, data, heap, stack, mappings)
+//*				ordered by address, so the fault handler and everything else
+//*				can find the area of an address without walking page tables.
+//*  @version
+//*
+//****************************************************************************/
+//-----------------------------------------------------------------------------
+// 		REQUIRED HEADERS
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <kernel/list.h>
+#include <kernel/rbtree.h>
+#include <mm/vmm.h>
+#include <mm/fault.h>
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE DEFINES/TYPES
+//-----------------------------------------------------------------------------
+
+//! kind of an area, exactly one of these is set
+#define VMA_CODE 		0x0001	//! read-only segment of the executable
+#define VMA_DATA 		0x0002	//! writable segment of the executable
+#define VMA_HEAP 		0x0004	//! program break
+#define VMA_STACK 		0x0008	//! user stack
+#define VMA_MMAP 		0x0010	//! mapping made by the process
+#define VMA_KIND_MASK 	0x00FF
+
+//! behaviour of an area
+#define VMA_DEMAND 		0x0100	//! pages are backed on first touch
+#define VMA_GROWSDOWN 	0x0200	//! only grows below the stack pointer
+#define VMA_SHARED 		0x0400	//! frames are shared, not copied on fork
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE DATA STRUCTURES
+//-----------------------------------------------------------------------------
+
+/* One contiguous range of an address space with uniform attributes */
+typedef struct _vm_area {
+
+	rb_node_t 		node;		//! node in the tree of the address space
+	uintptr_t 		start;		//! first address, page aligned
+	uintptr_t 		end;		//! address past the last byte, page aligned
+	uint32_t 		prot;		//! pte flags the pages are mapped with
+	uint32_t 		flags;		//! VMA_* kind and behaviour
+	void* 			backing;	//! object the contents come from, if any
+	uint32_t 		offset;		//! offset of start within the backing
+
+} vm_area_t;
+
+/* Memory charged to an address space. The page counts follow the mappings
+	as they are made, unmapped and moved to swap, so reading them never walks
+	the page tables. */
+typedef struct _vm_usage {
+
+	uint32_t 		rss;		//! resident user pages, shared ones included
+	uint32_t 		swapped;	//! user pages in the swap area
+	uint32_t 		pgtables;	//! frames of user page tables
+	uint32_t 		kobjects;	//! bytes of kernel objects describing it
+
+} vm_usage_t;
+
+/* The areas of one address space. process_t is laid out by the prebuilt
+	process object, so spaces are looked up by their page directory. */
+typedef struct _vm_space {
+
+	pagedir_t* 		pdir;		//! page directory of the address space
+	rb_tree_t 		areas;		//! areas ordered by start address
+	vm_area_t* 		last_hit;	//! area found by the previous lookup
+	fault_counts_t 	faults;		//! page faults taken in the address space
+	vm_usage_t 		usage;		//! memory charged to the address space
+
+	list_element_t 	link;		//! link in the list of spaces
+
+} vm_space_t;
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE FUNCTION PROTOTYPES
+//-----------------------------------------------------------------------------
+
+//! creates the descriptor caches, must be called after kmem_cache_init
+void 		vma_init (void);
+
+//! returns the space of a page directory, creating it if asked to
+vm_space_t* vma_get_space (pagedir_t* pdir, bool create);
+
+//! returns the space following the given one in the list of spaces, the
+//! first one for NULL. used to walk every address space in turn.
+vm_space_t* vma_next_space (vm_space_t* space);
+
+//! returns the area containing addr, NULL if it is not part of any area
+vm_area_t* 	vma_find (vm_space_t* space, uintptr_t addr);
+
+//! returns the first area ending above addr, NULL if there is none
+vm_area_t* 	vma_find_next (vm_space_t* space, uintptr_t addr);
+
+//! adds an area covering [start, start + size). fails if the range is not
+//! page aligned or overlaps another area.
+vm_area_t* 	vma_insert (vm_space_t* space, uintptr_t start, size_t size,
+						uint32_t prot, uint32_t flags, void* backing,
+						uint32_t offset);
+
+//! removes an area, the pages it maps are left alone
+void 		vma_remove (vm_space_t* space, vm_area_t* area);
+
+//! copies every area of one address space to another
+int32_t 	vma_clone_space (pagedir_t* src, pagedir_t* dst);
+
+//! drops the areas of an address space
+void 		vma_destroy_space (pagedir_t* pdir);
+
+//! drops the areas of an address space and destroys it. process teardown is
+//! linked against this in place of vmm_destroy_pagedir.
+void 		vmm_destroy_space (pagedir_t* pdir);
+
+//! maps a region like vmm_alloc_region, using large pages for aligned 4MB
+//! pieces, and records it as an area. the elf
+//! loader and stack setup are linked against this in place of
+//! vmm_alloc_region.
+bool 		vma_alloc_region (pagedir_t* pdir, void* virtual, size_t size,
+							  uint32_t flags);
+
+//! adjusts the resident and swapped page counts of an address space, a
+//! directory without one is ignored
+void 		vma_charge (pagedir_t* pdir, int32_t rss, int32_t swapped);
+
+//! counts page tables created for the user half of an address space, a
+//! directory without one is ignored
+void 		vma_charge_tables (pagedir_t* pdir, int32_t tables);
+
+//! returns the memory charged to an address space, NULL if it has none
+const vm_usage_t* 	vma_get_usage (pagedir_t* pdir);
+
+//! display the areas of an address space
+void 		vma_dump (pagedir_t* pdir);
+
+//*****************************************************************************
+//**
+//** 	END _[filename]
+//**
+//*****************************************************************************
+
+#endif // !_VMA_H
@@ -0,0 +1,70 @@
+#ifndef _VMALLOC_H
+#define _VMALLOC_H
+//*****************************************************************************
+//*
+//*  @file		[vmalloc.h]
+//*  @author    Abdul Rafay (abdul.rafay@lums.edu.pk)
+//*  @brief		Allocator for large kernel buffers that only need to be
+//*				contiguous virtually. Frames are taken one at a time from the
+//*				kmm and mapped back to back in a dedicated kernel range, so big
+//*				buffers neither need contiguous memory nor fragment the heap.
+//*  @version
+//*
+//****************************************************************************/
+//-----------------------------------------------------------------------------
+// 		REQUIRED HEADERS
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stddef.h>
+#include <kernel/rbtree.h>
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE DEFINES/TYPES
+//-----------------------------------------------------------------------------
+
+//! an unmapped guard page follows every region to catch overruns
+#define VMALLOC_GUARD_SIZE 		4096
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE DATA STRUCTURES
+//-----------------------------------------------------------------------------
+
+/* A region of the vmalloc range handed out by one vmalloc call. Regions are
+	kept in an interval tree, an rbtree ordered by start address where every
+	node also records the largest end address in its subtree. */
+typedef struct _vm_region {
+
+	rb_node_t 		node;			//! node in the region tree
+	uintptr_t 		start;			//! first address of the region
+	size_t 			size;			//! mapped size, excluding the guard page
+	uintptr_t 		max_end;		//! largest end of any region in subtree
+
+} vm_region_t;
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE FUNCTION PROTOTYPES
+//-----------------------------------------------------------------------------
+
+//! sets up the vmalloc range, must be called after the slab allocator
+void 			vmalloc_init (void);
+
+//! allocates a virtually contiguous, page aligned buffer of at least size bytes
+void* 			vmalloc (size_t size);
+
+//! frees a buffer returned by vmalloc
+void 			vfree (void* addr);
+
+//! returns the region containing the given address, NULL if there is none
+vm_region_t* 	vmalloc_find (void* addr);
+
+//! display usage statistics of the vmalloc range
+void 			vmalloc_stats (void);
+
+//*****************************************************************************
+//**
+//** 	END _[filename]
+//**
+//*****************************************************************************
+
+#endif // !_VMALLOC_H
@@ -0,0 +1,67 @@
+#ifndef _ZEROPAGE_H
+#define _ZEROPAGE_H
+//*****************************************************************************
+//*
+//*  @file		[zeropage.h]
+//*  @author    Abdul Rafay (abdul.rafay@lums.edu.pk)
+//*  @brief		The shared zero page. User pages that are known to be zero,
+//*				the .bss of a program or anonymous memory that has only been
+//*				read, all map one pinned zeroed frame read-only. The first
+//*				write gives the page a frame of its own through copy on write.
+//*  @version
+//*
+//****************************************************************************/
+//-----------------------------------------------------------------------------
+// 		REQUIRED HEADERS
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include <mm/vmm.h>
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE DATA STRUCTURES
+//-----------------------------------------------------------------------------
+
+/* Zero page statistics */
+typedef struct _zero_page_stats {
+
+	uint32_t 	bss_pages;		//! program pages replaced by the zero page
+
+} zero_page_stats_t;
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE FUNCTION PROTOTYPES
+//-----------------------------------------------------------------------------
+
+//! allocates and pins the zero frame, must be called after frame_init
+void 		zero_page_init (void);
+
+//! physical address of the zero frame, NULL before init
+void* 		zero_page_frame (void);
+
+//! true if the physical address is the zero frame
+bool 		zero_page_is (void* phys);
+
+//! maps the zero page at a user address. writable pages are mapped copy on
+//! write, the protection is otherwise taken from flags.
+bool 		zero_page_map (pagedir_t* pdir, uintptr_t virt, uint32_t flags);
+
+//! memset for the elf loader, which is linked against it. zeroing whole
+//! privately owned pages of the current address space puts their frames back
+//! and maps the zero page instead, anything else goes through
+//! cow_load_fill.
+void* 		zero_page_fill (void* dst, int c, size_t n);
+
+//! returns the zero page statistics
+const zero_page_stats_t* zero_page_get_stats (void);
+
+//*****************************************************************************
+//**
+//** 	END _[filename]
+//**
+//*****************************************************************************
+
+#endif // !_ZEROPAGE_H
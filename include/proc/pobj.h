@@ -0,0 +1,56 @@
+#ifndef _POBJ_H
+#define _POBJ_H
+//*****************************************************************************
+//*
+//*  @file		pobj.h
+//*  @author    Abdul Rafay (abdul.rafay@lums.edu.pk)
+//*  @brief		Memory of the prebuilt process code. Its malloc and free are
+//*				redirected here: processes and threads come from object
+//*				caches, thread stacks from the kernel stack cache and
+//*				everything else from the kernel heap. Every thread carries
+//*				the bytes of the scheduler behind it, and what a process
+//*				allocates is charged to it.
+//*  @version
+//*
+//****************************************************************************/
+//-----------------------------------------------------------------------------
+// 		REQUIRED HEADERS
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include <proc/process.h>
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE FUNCTION PROTOTYPES
+//-----------------------------------------------------------------------------
+
+//! creates the process and thread caches, must be called after kstack_init
+//! and before the first process is created
+void 		pobj_init (void);
+
+//! a process from the process cache, charged to itself
+process_t* 	pobj_process_alloc (void);
+
+//! a cleared thread from the thread cache, with the scheduler bytes behind it
+thread_t* 	pobj_thread_alloc (void);
+
+//! malloc and free of the process code. malloc serves the calls that
+//! allocate processes, threads and stacks from their caches and sends the
+//! rest to the kernel heap. free gives memory back to whatever owns it.
+void* 		pobj_malloc (size_t size);
+void 		pobj_free (void* ptr);
+
+//! charges the object and the stack of a thread to its process, or gives
+//! them back
+void 		pobj_charge_thread (thread_t* thread, bool charge);
+
+//*****************************************************************************
+//**
+//** 	END pobj.h
+//**
+//*****************************************************************************
+
+#endif // !_POBJ_H
@@ -0,0 +1,70 @@
+#ifndef _PROCMEM_H
+#define _PROCMEM_H
+//*****************************************************************************
+//*
+//*  @file		procmem.h
+//*  @author    Abdul Rafay (abdul.rafay@lums.edu.pk)
+//*  @brief		Per process memory accounting. Collects what the memory
+//*				manager charges to the address space of a process together
+//*				with the kernel stacks and objects of the process, for the
+//*				ps command of the shell and the procmem syscall.
+//*  @version
+//*
+//****************************************************************************/
+//-----------------------------------------------------------------------------
+// 		REQUIRED HEADERS
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stddef.h>
+#include <proc/process.h>
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE DATA STRUCTURES
+//-----------------------------------------------------------------------------
+
+/* Memory used by one process. The layout is shared with struct procmem of
+	the C library. */
+typedef struct _proc_mem {
+
+	uint32_t 	pid;							//! process id
+	char 		name[ PROCESS_NAME_MAX_LEN ];	//! process name
+	uint32_t 	rss;			//! resident user pages
+	uint32_t 	swapped;		//! user pages in the swap area
+	uint32_t 	pgtables;		//! page directory and user page table frames
+	uint32_t 	kstack;			//! bytes of kernel stack
+	uint32_t 	kheap;			//! bytes of kernel objects
+
+} proc_mem_t;
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE FUNCTION PROTOTYPES
+//-----------------------------------------------------------------------------
+
+//! installs the procmem syscall, must be called after syscall_init
+void 		procmem_init (void);
+
+//! charges bytes of kernel stack and of kernel objects to a process, negative
+//! amounts give them back
+void 		procmem_charge (process_t* process, int32_t kstack, int32_t kheap);
+
+//! drops what is charged to a process whose object is freed
+void 		procmem_release (process_t* process);
+
+//! fills in the memory used by a process, returns -1 for NULL
+int32_t 	procmem_get (process_t* process, proc_mem_t* mem);
+
+//! fills in the memory used by the index-th process, returns -1 past the
+//! last one
+int32_t 	procmem_get_nth (uint32_t index, proc_mem_t* mem);
+
+//! display the memory used by every process
+void 		procmem_ps (void);
+
+//*****************************************************************************
+//**
+//** 	END procmem.h
+//**
+//*****************************************************************************
+
+#endif // !_PROCMEM_H
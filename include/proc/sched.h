@@ -0,0 +1,219 @@
+#ifndef _SCHED_H
+#define _SCHED_H
+//*****************************************************************************
+//*
+//*  @file		sched.h
+//*  @author    Abdul Rafay (abdul.rafay@lums.edu.pk)
+//*  @brief		Scheduling classes. The scheduler core switches threads on
+//*				the timer and leaves the choice of the next thread to the
+//*				selected class: "prio" runs the highest priority ready thread
+//*				round robin, "fair" shares the cpu by weighted virtual runtime
+//*				and "mlfq" favours threads that block over those that use up
+//*				their time slice.
+//*				The class is picked at boot and can be changed at runtime, the
+//*				ready threads then move over to the new one.
+//*				Threads with a deadline are above all of them, the "dl" class
+//*				runs them earliest deadline first within the cpu time they
+//*				reserved.
+//*  @version
+//*
+//****************************************************************************/
+//-----------------------------------------------------------------------------
+// 		REQUIRED HEADERS
+//-----------------------------------------------------------------------------
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <proc/process.h>
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE DEFINES/TYPES
+//-----------------------------------------------------------------------------
+
+//! class selected at boot, set with make SCHED=<name>
+#ifndef SCHED_DEFAULT_CLASS
+#define SCHED_DEFAULT_CLASS 	"prio"
+#endif
+
+//! the timer runs the scheduler every 4 ticks of 1ms
+#define SCHED_TICK_US 			4000
+
+//! bytes behind every thread object that belong to the scheduler
+#define SCHED_DATA_SIZE 		128
+
+//! bit of a priority in the ready bitmap, the highest priority is bit 0
+#define SCHED_PRIO_BIT(prio) 	(1u << (PROCESS_PRI_MAX - (prio)))
+
+//! fair class: every ready thread runs once within the target latency, but
+//! for no less than the minimum granularity
+#define SCHED_LATENCY_US 		24000
+#define SCHED_MIN_GRANULARITY_US 	SCHED_TICK_US
+
+//! fair class: weight of the default priority, each priority step above or
+//! below it gives 25% more or less cpu
+#define SCHED_WEIGHT_DEFAULT 	1024
+
+//! mlfq class: number of levels, the time slice in ticks doubles with every
+//! level down, and everything goes back to the top level once a second
+#define SCHED_MLFQ_LEVELS 		4
+#define SCHED_MLFQ_SLICE(level) (1u << (level))
+#define SCHED_MLFQ_BOOST_TICKS 	250
+
+//! deadline class: periods are given in microseconds and are at most a second
+#define SCHED_DL_PERIOD_MAX 	1000000
+
+//! deadline class: cpu bandwidth is counted in 1/4096, and the deadline
+//! threads together may reserve up to 95% of the cpu
+#define SCHED_DL_BW_SHIFT 		12
+#define SCHED_DL_BW_LIMIT 		((95 << SCHED_DL_BW_SHIFT) / 100)
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE DATA STRUCTURES
+//-----------------------------------------------------------------------------
+
+/* A scheduling class. The core calls the class with interrupts off. The
+	running thread is not on the class' queues, it is posted back when it is
+	switched out. */
+typedef struct _sched_class {
+
+	const char* 	name;
+
+	//! sets up the queues, called when the class is selected
+	void 		(*init) (void);
+
+	//! adds a ready thread and takes it off again
+	void 		(*enqueue) (thread_t* thread);
+	void 		(*dequeue) (thread_t* thread);
+
+	//! removes and returns the thread to run next, NULL if none is ready
+	thread_t* 	(*pick_next) (void);
+
+	//! charges a tick to the running thread, true if it should be switched
+	//! out for a ready thread
+	bool 		(*tick) (thread_t* curr);
+
+	//! runs on every tick, whatever the running thread, may be NULL
+	void 		(*clock) (uint64_t now);
+
+	//! prints the class statistics, may be NULL
+	void 		(*stats) (void);
+
+} sched_class_t;
+
+/* Scheduler statistics */
+typedef struct _sched_stats {
+
+	uint32_t 	ticks;			//! scheduler ticks with a current thread
+	uint32_t 	switches;		//! ticks that switched to another thread
+	uint32_t 	idle_ticks;		//! ticks that found no thread ready
+	uint32_t 	nr_running;		//! threads on the ready queues
+	uint32_t 	max_running;	//! longest the ready queues have been
+	uint32_t 	dl_misses;		//! deadlines passed before the runtime was used
+	uint32_t 	dl_throttles;	//! deadline threads stopped for using up runtime
+
+} sched_stats_t;
+
+/* Reservation of a deadline thread, all times in microseconds */
+typedef struct _sched_dl_attr {
+
+	uint32_t 	runtime;		//! cpu time the thread gets every period
+	uint32_t 	period;			//! time between the starts of two periods
+	uint32_t 	deadline;		//! time after the start the runtime is due
+	uint32_t 	misses;			//! deadlines the thread missed
+
+} sched_dl_attr_t;
+
+/* Multi level feedback queue statistics */
+typedef struct _sched_mlfq_stats {
+
+	uint32_t 	demotions;		//! threads moved down for using up a slice
+	uint32_t 	preemptions;	//! threads switched out for a higher level
+	uint32_t 	boosts;			//! times every thread went back to the top
+
+} sched_mlfq_stats_t;
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE FUNCTION PROTOTYPES
+//-----------------------------------------------------------------------------
+
+//! selects SCHED_DEFAULT_CLASS and installs the deadline syscalls, must be
+//! called after syscall_init and before scheduler_init
+void 		sched_init (void);
+
+//! switches to the class of that name and moves the ready threads over.
+//! returns 0, or -1 if there is no such class.
+int32_t 	sched_set_class (const char* name);
+
+//! name of the selected class
+const char* sched_get_class (void);
+
+//! takes a thread that is waiting on a ready queue off it again, does
+//! nothing for a thread that is not queued
+void 		sched_dequeue (thread_t* thread);
+
+//! true while a thread waits on the queues of its class
+bool 		sched_is_queued (thread_t* thread);
+
+//! makes a blocked thread ready again, does nothing for other states
+void 		sched_wake (thread_t* thread);
+
+//! number of threads waiting on the ready queues, deadline threads waiting
+//! for their next period included
+uint32_t 	sched_nr_running (void);
+
+//! microseconds the scheduler has been running
+uint64_t 	sched_clock (void);
+
+//! the scheduler bytes of a thread for a class. they are cleared whenever
+//! another class than the last one asks for them.
+void* 		sched_thread_data (thread_t* thread, const sched_class_t* class);
+
+//! class the scheduler bytes of a thread belong to, NULL if none
+const sched_class_t* 	sched_thread_owner (thread_t* thread);
+
+//! bitmap of the priorities with a ready thread in the prio class, see
+//! SCHED_PRIO_BIT
+uint32_t 	sched_ready_bitmap (void);
+
+//! gives a thread a deadline reservation, a deadline of 0 is the period.
+//! a runtime of 0 returns the thread to the selected class. returns 0, or -1
+//! if the reservation is invalid or does not fit in SCHED_DL_BW_LIMIT.
+int32_t 	sched_set_deadline (thread_t* thread, uint32_t runtime,
+								uint32_t period, uint32_t deadline);
+
+//! fills in the reservation of a thread, returns -1 if it has none
+int32_t 	sched_get_deadline (thread_t* thread, sched_dl_attr_t* attr);
+
+//! the running deadline thread is done for this period, it continues when
+//! the next one starts
+void 		sched_dl_yield (void);
+
+//! bandwidth reserved by the deadline threads, see SCHED_DL_BW_SHIFT
+uint32_t 	sched_dl_bandwidth (void);
+
+//! level of a thread in the mlfq class, 0 is the top
+uint32_t 	sched_mlfq_level (thread_t* thread);
+
+//! returns the mlfq class statistics
+const sched_mlfq_stats_t* 	sched_mlfq_get_stats (void);
+
+//! returns the scheduler statistics
+const sched_stats_t* 	sched_get_stats (void);
+
+//! display the scheduler statistics
+void 		sched_stats (void);
+
+/* the classes */
+
+extern const sched_class_t 	sched_prio_class;
+extern const sched_class_t 	sched_fair_class;
+extern const sched_class_t 	sched_mlfq_class;
+extern const sched_class_t 	sched_dl_class;
+
+//*****************************************************************************
+//**
+//** 	END _[filename]
+//**
+//*****************************************************************************
+
+#endif // !_SCHED_H
@@ -195,6 +195,76 @@ static inline void sti(void) {
     asm volatile ("sti" :::);
 }
 
+//! reads the faulting linear address of the last page fault
+static inline uintptr_t read_cr2(void) {
+    uintptr_t val;
+    asm volatile ("mov %%cr2, %0" : "=r"(val));
+    return val;
+}
+
+//! reads the physical address of the current page directory
+static inline uintptr_t read_cr3(void) {
+    uintptr_t val;
+    asm volatile ("mov %%cr3, %0" : "=r"(val));
+    return val;
+}
+
+//! control register bits used by the memory manager
+#define CR0_WP 	0x00010000 	//! supervisor writes honour read-only pages
+#define CR4_PSE 0x00000010 	//! 4MB pages
+#define CR4_PAE 0x00000020 	//! physical address extension
+#define CR4_PGE 0x00000080 	//! global pages
+
+static inline uint32_t read_cr0(void) {
+    uint32_t val;
+    asm volatile ("mov %%cr0, %0" : "=r"(val));
+    return val;
+}
+
+static inline void write_cr0(uint32_t val) {
+    asm volatile ("mov %0, %%cr0" :: "r"(val) : "memory");
+}
+
+static inline uint32_t read_cr4(void) {
+    uint32_t val;
+    asm volatile ("mov %%cr4, %0" : "=r"(val));
+    return val;
+}
+
+static inline void write_cr4(uint32_t val) {
+    asm volatile ("mov %0, %%cr4" :: "r"(val) : "memory");
+}
+
+//! executes cpuid for the given leaf
+static inline void cpuid(uint32_t leaf, uint32_t* eax, uint32_t* ebx,
+                         uint32_t* ecx, uint32_t* edx) {
+    asm volatile ("cpuid"
+                  : "=a"(*eax), "=b"(*ebx), "=c"(*ecx), "=d"(*edx)
+                  : "a"(leaf), "c"(0));
+}
+
+//! loads a new page directory, which also flushes all non global TLB entries
+static inline void write_cr3(uintptr_t val) {
+    asm volatile ("mov %0, %%cr3" :: "r"(val) : "memory");
+}
+
+//! invalidates the TLB entry for a single page
+static inline void invlpg(void* addr) {
+    asm volatile ("invlpg (%0)" :: "r"(addr) : "memory");
+}
+
+//! flushes all non global TLB entries
+static inline void flush_tlb(void) {
+    write_cr3(read_cr3());
+}
+
+//! reads the cpu's time stamp counter
+static inline uint64_t rdtsc(void) {
+    uint32_t lo, hi;
+    asm volatile ("rdtsc" : "=a"(lo), "=d"(hi));
+    return ((uint64_t) hi << 32) | lo;
+}
+
 
 //! macro to get esp value into specified var
 #define GET_ESP(var) \
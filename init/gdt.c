@@ -32,20 +32,22 @@
 #define TSS_GRANULARITY       0x00 // TSS does not use granularity
 
 //! defines for the number and index of specific entries
-#define GDT_ENTRIES           6
+#define GDT_ENTRIES           7
 #define GDT_NULL_ENTRY        0
 #define GDT_KERNEL_CODE_ENTRY 1
 #define GDT_KERNEL_DATA_ENTRY 2
 #define GDT_USER_CODE_ENTRY   3
 #define GDT_USER_DATA_ENTRY   4
 #define GDT_TSS_ENTRY         5
+#define GDT_TASK_TSS_ENTRY    6
 
 //! Returns the offset of a GDT entry in the GDT array 
 #define GDT_SEG_OFFSET(entry) (entry * sizeof(gdt_entry_t))
 
 //! the global descriptor table will be created with 5 segment descriptor
-//! entries and 1 TSS entry. provides separation between user and kernel mode
-//! and provides a TSS to enable software task switching.
+//! entries and 2 TSS entries. provides separation between user and kernel mode
+//! and provides a TSS to enable software task switching. the second TSS is
+//! left empty for a task that an exception switches to through a task gate.
 static gdt_entry_t         gdt[GDT_ENTRIES];
 static gdt_ptr_t           gdt_ptr;    // Pointer to the GDT
 
@@ -126,6 +128,18 @@ void gdt_init_flat_protected()
 
 }
 
+// Installs the TSS of the task that a task gate switches to
+uint16_t gdt_set_task_tss(tss_t *tss)
+{
+    // the task runs in the kernel, it is only ever entered through its gate
+    create_gdt_entry(&gdt[ GDT_TASK_TSS_ENTRY ], (uint32_t)tss,
+                     sizeof(tss_t) - 1,
+                     GDT_ACCESS_PRESENT | GDT_ACCESS_RING0 | GDT_ACCESS_TSS32,
+                     TSS_GRANULARITY);
+
+    return GDT_SEG_OFFSET(GDT_TASK_TSS_ENTRY);
+}
+
 gdt_ptr_t* get_gdt_ptr(void)
 {
     return &gdt_ptr; // Return the pointer to the GDT pointer structure
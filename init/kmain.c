@@ -11,14 +11,35 @@
 #include <driver/ide.h>
 #include <driver/serial.h>
 #include <driver/block.h>
+#include <driver/input.h>
 #include <init/gdt.h>
 #include <init/idt.h>
 #include <init/tty.h>
 #include <mm/vmm.h>
 #include <mm/kmm.h>
 #include <mm/kheap.h>
+#include <mm/slab.h>
+#include <mm/fault.h>
+#include <mm/vmalloc.h>
+#include <mm/frame.h>
+#include <mm/cow.h>
+#include <mm/vma.h>
+#include <mm/demand.h>
+#include <mm/tlb.h>
+#include <mm/pse.h>
+#include <mm/highmem.h>
+#include <mm/kstack.h>
+#include <mm/fixmap.h>
+#include <mm/swap.h>
+#include <mm/shm.h>
+#include <mm/zeropage.h>
+#include <mm/ksm.h>
+#include <mm/uaccess.h>
 #include <init/syscall.h>
 #include <proc/process.h>
+#include <proc/pobj.h>
+#include <proc/procmem.h>
+#include <proc/sched.h>
 #include <fs/fat12.h>
 #include <fs/hfs.h>
 #include <fs/vfs.h>
@@ -75,19 +96,47 @@ void kmain ()
 
 	LOG_P ("Initializing kernel memory manager...\n");
 	kmm_init (); // Initialize the kernel memory manager
+
+	/* vmm_init maps every frame of the kmm into the physmap, and the kernel's
+		own virtual ranges start right above it */
+	kmm_limit (PHYSMAP_MAX_SIZE / VMM_PAGE_SIZE);
 	
 	LOG_P ("Initializing virtual memory manager...\n");
 	vmm_init (); // Initialize the virtual memory manager
 
+	vmm_fault_init (); // chain the page fault dispatcher
+
 	LOG_P ("Initializing kernel heap...\n");
 	kheap_init (&kernel_heap, 
-				(void*)KERNEL_HEAP_VIRT, KERNEL_HEAP_SIZE,
-	 			KERNEL_HEAP_SIZE, true, false); // Initialize Kernel heap
+				(void*)KERNEL_HEAP_VIRT, KERNEL_HEAP_MAX_SIZE,
+	 			KERNEL_HEAP_MAX_SIZE, true, false); // Initialize Kernel heap
+	kheap_enable_growth (&kernel_heap, KERNEL_HEAP_SIZE);
+
+	LOG_P ("Initializing slab allocator...\n");
+	kmem_cache_init (); // Initialize the object caches
+	vmalloc_init ();	// Initialize the large buffer allocator
+	kstack_init ();		// Kernel stacks with guard pages
+	frame_init ();		// Initialize the frame reference counts
+	zero_page_init ();	// Back untouched user pages with one zero frame
+	vma_init ();		// Initialize the address space areas
+	cow_init ();		// Share user pages copy on write on fork
+	demand_init ();		// Populate reserved user memory on first touch
+	pse_init ();		// Map the kernel linear map with 4MB pages
+	highmem_init ();	// Back large user pages with memory above 4GB
+	tlb_init ();		// Keep kernel translations across address switches
+	fixmap_init ();		// Map page tables at fixed addresses
+	swap_init ();		// Page user memory out under pressure
+	shm_init ();		// Shared memory segments between processes
+	uaccess_init ();	// Fault safe user copies, after all fault handlers
+	pobj_init ();		// Processes and threads from object caches
+	procmem_init ();	// Report the memory used by each process
+	input_init ();		// Sleep on keyboard reads and time the echo
 	
 	//! --- pa2 ^
 
 	LOG_P ("Initializing system timer at 1000 Hz...\n");
 	init_system_timer (1000); // Initialize the system timer with 1000Hz freq
+	ksm_init (); // Merge identical user pages from the timer, once enabled
 
 	LOG_P ("Initializing floppy disk controller...\n");
 	fdc_init (); // Initialize the floppy disk controller
@@ -101,11 +150,17 @@ void kmain ()
 	LOG_P ("Mounting initfs FAT12 on /fd0\n");
 	vfs_mount ("fd0", "/fd0", "fat12"); // mount the floppy disk as root fs
 
+	LOG_P ("Enabling swap on the tail of %s...\n", SWAP_PARENT_DEVICE);
+	if (blkdev_split (SWAP_PARENT_DEVICE, SWAP_DEVICE, SWAP_AREA_BLOCKS) == 0) {
+		swap_on (SWAP_DEVICE);
+	}
+
 	LOG_P ("Formatting and mounting HFS filesystem on /hd1...\n");
 	hfs_format ("hd1");
 	vfs_mount ("hd1", "/hd1", "hfs");
 	
 	LOG_P ("Initializing scheduler...\n");
+	sched_init (); // Scheduling class, make SCHED= picks it
 	scheduler_init (); // Initialize the process scheduler
 
 #ifdef TESTING
@@ -0,0 +1,106 @@
+#ifndef __LIBC_RBTREE_H
+#define __LIBC_RBTREE_H
+//*****************************************************************************
+//*
+//*  @file		rbtree.h
+//*  @author    Abdul Rafay (abdul.rafay@lums.edu.pk)
+//*  @brief		Defines an intrusive red-black tree and its operations. The
+//*				tree optionally maintains augmented per-node data (e.g. the
+//*				max end of an interval tree) through a user callback.
+//*  @version	
+//*
+//****************************************************************************/
+//-----------------------------------------------------------------------------
+// 		REQUIRED HEADERS
+//-----------------------------------------------------------------------------
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE DEFINES/TYPES
+//-----------------------------------------------------------------------------
+
+#define RB_RED 		0
+#define RB_BLACK 	1
+
+//! gets the struct containing the tree node, same as LIST_ENTRY
+//! type corresponds to the struct type that contains the tree node
+//! node is the tree node pointer
+//! member is the name of the tree node in the struct
+#define RB_ENTRY(type, node, member) \
+	((type*)((uint8_t*)(node) - offsetof (type, member)))
+
+typedef struct _rb_node rb_node_t;
+
+//! orders two nodes, negative if a sorts before b
+typedef int  (*rb_compare_func_t)(const rb_node_t* a, const rb_node_t* b);
+
+//! compares a search key against a node, negative if key sorts before it
+typedef int  (*rb_key_compare_func_t)(const void* key, const rb_node_t* node);
+
+//! recomputes the augmented data of a node from its children
+typedef void (*rb_augment_func_t)(rb_node_t* node);
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE DATA STRUCTURES
+//-----------------------------------------------------------------------------
+
+//! this struct is embedded inside any other struct that needs to be a part
+//!  of a tree
+struct _rb_node {
+
+	//!< parent and children of the node, NULL where absent
+	struct _rb_node* 	parent;
+	struct _rb_node* 	left;
+	struct _rb_node* 	right;
+
+	//!< RB_RED or RB_BLACK
+	uint32_t 			color;
+
+};
+
+//! this struct represents a red-black tree
+typedef struct _rb_tree {
+
+	//!< root node of the tree
+	rb_node_t* 			root;
+
+	//!< number of nodes in the tree
+	size_t 				size;
+
+	//!< optional callback maintaining augmented data, may be NULL
+	rb_augment_func_t 	augment;
+
+} rb_tree_t;
+
+//-----------------------------------------------------------------------------
+// 		INTERFACE FUNCTION PROTOTYPES
+//-----------------------------------------------------------------------------
+
+//! functions to manipulate trees
+void 		rb_init (rb_tree_t*, rb_augment_func_t);
+void 		rb_insert (rb_tree_t*, rb_node_t*, rb_compare_func_t);
+void 		rb_remove (rb_tree_t*, rb_node_t*);
+
+//! re-runs the augment callback from the node up to the root, to be used
+//! when the augmented data of a node changes without a structural change
+void 		rb_augment_propagate (rb_tree_t*, rb_node_t*);
+
+//! functions to access trees
+rb_node_t* 	rb_find (const rb_tree_t*, const void* key, rb_key_compare_func_t);
+rb_node_t* 	rb_first (const rb_tree_t*);
+rb_node_t* 	rb_last (const rb_tree_t*);
+rb_node_t* 	rb_next (const rb_node_t*);
+rb_node_t* 	rb_prev (const rb_node_t*);
+bool 		rb_is_empty (const rb_tree_t*);
+size_t 		rb_size (const rb_tree_t*);
+
+//*****************************************************************************
+//**
+//** 	END rbtree.h
+//**
+//*****************************************************************************
+
+#endif // __LIBC_RBTREE_H
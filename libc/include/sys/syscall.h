@@ -11,5 +11,15 @@
 #define SYS_getpid  4
 #define SYS_sleep   5
 #define SYS_execve  6
+#define SYS_shmget  7
+#define SYS_shmat   8
+#define SYS_shmdt   9
+#define SYS_procmem 10
+#define SYS_kbdlat  11
+#define SYS_sched_deadline 12
+#define SYS_sched_yield    13
+#define SYS_shmrm   14
+#define SYS_mmap    15
+#define SYS_munmap  16
 
 #endif /* __LIBC_SYSCALL_H */
\ No newline at end of file
@@ -28,5 +28,57 @@ pid_t getpid(void);
 unsigned sleep(unsigned seconds);
 int execve(const char *path, char *const argv[], char *const envp[]);
 
+/* shared memory, key 0 always creates a new segment. shmat returns
+   (void *)-1 on failure, a NULL addr lets the kernel pick the address.
+   a segment goes away with its last shmdt. shmrm drops its key, and frees
+   it right away if nothing is attached, as does the exit of its creator. */
+int shmget(int key, size_t size);
+void *shmat(int shmid, const void *addr);
+int shmdt(const void *addr);
+int shmrm(int shmid);
+
+/* anonymous memory, zeroed and backed a page at a time on first touch.
+   mmap returns (void *)-1 on failure, a NULL addr lets the kernel pick the
+   address. munmap takes a whole reservation, with the size it was made. */
+#define PROT_READ   0x1
+#define PROT_WRITE  0x2
+void *mmap(void *addr, size_t size, int prot);
+int munmap(void *addr, size_t size);
+
+/* memory used by a process, as reported by procmem */
+struct procmem {
+    uint32_t pid;
+    char     name[16];
+    uint32_t rss;       /* resident user pages */
+    uint32_t swapped;   /* user pages in swap */
+    uint32_t pgtables;  /* page directory and page table frames */
+    uint32_t kstack;    /* bytes of kernel stack */
+    uint32_t kheap;     /* bytes of kernel objects */
+};
+
+/* fills in the memory used by the index-th process, -1 past the last one */
+int procmem(int index, struct procmem *buf);
+
+/* time from a key press until the key is handed to the reader, in ms */
+struct kbdlat {
+    char     sched[8];   /* scheduling class of the kernel */
+    uint32_t keys;       /* keys read */
+    uint32_t sleeps;     /* times a reader slept for a key */
+    uint32_t total_ms;   /* sum of the latencies */
+    uint32_t max_ms;     /* longest latency */
+    uint32_t buckets[5]; /* below 1, 4, 16 and 64 ms, and above */
+};
+
+/* fills in the keyboard latency statistics */
+int kbdlat(struct kbdlat *buf);
+
+/* reserves runtime microseconds of cpu every period, due deadline after the
+   period starts (0 for the period). the reservation is refused with -1 if
+   it does not fit, a runtime of 0 gives it up. */
+int sched_deadline(unsigned runtime, unsigned period, unsigned deadline);
+
+/* done with this period, returns when the next one starts */
+int sched_yield(void);
+
 
 #endif /* __LIBC_UNISTD_H */
@@ -0,0 +1,443 @@
+//*****************************************************************************
+//*
+//*  @file       rbtree.c
+//*  @author     Abdul Rafay (abdul.rafay@lums.edu.pk)
+//*  @brief      Implementation of red-black tree operations.
+//*  @version    1.0
+//*
+//****************************************************************************/
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#include <kernel/rbtree.h>
+
+#define IS_RED(n) 	((n) && (n)->color == RB_RED)
+#define IS_BLACK(n) (!IS_RED (n))
+
+//-----------------------------------------------------------------------------
+// 		PRIVATE HELPERS
+//-----------------------------------------------------------------------------
+
+//! points the parent's link (or the root) that referred to old at new
+static void _rb_replace_child (rb_tree_t* tree, rb_node_t* parent,
+							   rb_node_t* old, rb_node_t* new)
+{
+	if (!parent) {
+		tree->root = new;
+	} else if (parent->left == old) {
+		parent->left = new;
+	} else {
+		parent->right = new;
+	}
+}
+
+//! rotations only change the subtrees of the two nodes involved, so only those
+//! two need their augmented data refreshed, the lower one first
+static void _rb_rotate_left (rb_tree_t* tree, rb_node_t* x)
+{
+	rb_node_t* y = x->right;
+
+	x->right = y->left;
+	if (y->left) {
+		y->left->parent = x;
+	}
+
+	y->parent = x->parent;
+	_rb_replace_child (tree, x->parent, x, y);
+
+	y->left   = x;
+	x->parent = y;
+
+	if (tree->augment) {
+		tree->augment (x);
+		tree->augment (y);
+	}
+}
+
+static void _rb_rotate_right (rb_tree_t* tree, rb_node_t* x)
+{
+	rb_node_t* y = x->left;
+
+	x->left = y->right;
+	if (y->right) {
+		y->right->parent = x;
+	}
+
+	y->parent = x->parent;
+	_rb_replace_child (tree, x->parent, x, y);
+
+	y->right  = x;
+	x->parent = y;
+
+	if (tree->augment) {
+		tree->augment (x);
+		tree->augment (y);
+	}
+}
+
+static void _rb_insert_fixup (rb_tree_t* tree, rb_node_t* node)
+{
+	rb_node_t* parent;
+
+	while ((parent = node->parent) && parent->color == RB_RED) {
+
+		/* a red parent is never the root, so the grandparent exists */
+		rb_node_t* gparent = parent->parent;
+
+		if (parent == gparent->left) {
+
+			rb_node_t* uncle = gparent->right;
+			if (IS_RED (uncle)) {
+				parent->color  = RB_BLACK;
+				uncle->color   = RB_BLACK;
+				gparent->color = RB_RED;
+				node = gparent;
+				continue;
+			}
+
+			if (node == parent->right) {
+				_rb_rotate_left (tree, parent);
+				node   = parent;
+				parent = node->parent;
+			}
+
+			parent->color  = RB_BLACK;
+			gparent->color = RB_RED;
+			_rb_rotate_right (tree, gparent);
+
+		} else {
+
+			rb_node_t* uncle = gparent->left;
+			if (IS_RED (uncle)) {
+				parent->color  = RB_BLACK;
+				uncle->color   = RB_BLACK;
+				gparent->color = RB_RED;
+				node = gparent;
+				continue;
+			}
+
+			if (node == parent->left) {
+				_rb_rotate_right (tree, parent);
+				node   = parent;
+				parent = node->parent;
+			}
+
+			parent->color  = RB_BLACK;
+			gparent->color = RB_RED;
+			_rb_rotate_left (tree, gparent);
+		}
+	}
+
+	tree->root->color = RB_BLACK;
+}
+
+//! node is the child that replaced a removed black node, may be NULL in which
+//! case its parent is passed separately
+static void _rb_remove_fixup (rb_tree_t* tree, rb_node_t* node,
+							  rb_node_t* parent)
+{
+	while (node != tree->root && IS_BLACK (node)) {
+
+		if (node == parent->left) {
+
+			rb_node_t* sibling = parent->right;
+			if (IS_RED (sibling)) {
+				sibling->color = RB_BLACK;
+				parent->color  = RB_RED;
+				_rb_rotate_left (tree, parent);
+				sibling = parent->right;
+			}
+
+			if (IS_BLACK (sibling->left) && IS_BLACK (sibling->right)) {
+				sibling->color = RB_RED;
+				node   = parent;
+				parent = node->parent;
+				continue;
+			}
+
+			if (IS_BLACK (sibling->right)) {
+				sibling->left->color = RB_BLACK;
+				sibling->color 		 = RB_RED;
+				_rb_rotate_right (tree, sibling);
+				sibling = parent->right;
+			}
+
+			sibling->color 		  = parent->color;
+			parent->color 		  = RB_BLACK;
+			sibling->right->color = RB_BLACK;
+			_rb_rotate_left (tree, parent);
+			node = tree->root;
+
+		} else {
+
+			rb_node_t* sibling = parent->left;
+			if (IS_RED (sibling)) {
+				sibling->color = RB_BLACK;
+				parent->color  = RB_RED;
+				_rb_rotate_right (tree, parent);
+				sibling = parent->left;
+			}
+
+			if (IS_BLACK (sibling->left) && IS_BLACK (sibling->right)) {
+				sibling->color = RB_RED;
+				node   = parent;
+				parent = node->parent;
+				continue;
+			}
+
+			if (IS_BLACK (sibling->left)) {
+				sibling->right->color = RB_BLACK;
+				sibling->color 		  = RB_RED;
+				_rb_rotate_left (tree, sibling);
+				sibling = parent->left;
+			}
+
+			sibling->color 		 = parent->color;
+			parent->color 		 = RB_BLACK;
+			sibling->left->color = RB_BLACK;
+			_rb_rotate_right (tree, parent);
+			node = tree->root;
+		}
+	}
+
+	if (node) {
+		node->color = RB_BLACK;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// 		TREE MANIPULATION FUNCTIONS
+//-----------------------------------------------------------------------------
+
+/**
+ * @brief Initialize a tree to an empty state
+ * @param tree Pointer to the tree to initialize
+ * @param augment Callback maintaining augmented node data, or NULL
+ */
+void rb_init (rb_tree_t* tree, rb_augment_func_t augment)
+{
+	if (!tree) {
+		return;
+	}
+
+	tree->root 	  = NULL;
+	tree->size 	  = 0;
+	tree->augment = augment;
+}
+
+/**
+ * @brief Insert a node in its sorted position, equal keys go to the right
+ * @param tree Pointer to the tree
+ * @param node Pointer to the node to insert
+ * @param cmp Function ordering two nodes
+ */
+void rb_insert (rb_tree_t* tree, rb_node_t* node, rb_compare_func_t cmp)
+{
+	if (!tree || !node || !cmp) {
+		return;
+	}
+
+	rb_node_t*  parent = NULL;
+	rb_node_t** link   = &tree->root;
+
+	while (*link) {
+		parent = *link;
+		link   = (cmp (node, parent) < 0) ? &parent->left : &parent->right;
+	}
+
+	node->parent = parent;
+	node->left 	 = NULL;
+	node->right  = NULL;
+	node->color  = RB_RED;
+	*link 		 = node;
+	tree->size++;
+
+	rb_augment_propagate (tree, node);
+	_rb_insert_fixup (tree, node);
+}
+
+/**
+ * @brief Remove a node from the tree
+ * @param tree Pointer to the tree
+ * @param node Pointer to the node to remove, must be in the tree
+ */
+void rb_remove (rb_tree_t* tree, rb_node_t* node)
+{
+	if (!tree || !node) {
+		return;
+	}
+
+	rb_node_t* child;
+	rb_node_t* parent;
+	uint32_t   color;
+
+	if (!node->left || !node->right) {
+
+		/* at most one child, splice the node out */
+		child  = node->left ? node->left : node->right;
+		parent = node->parent;
+		color  = node->color;
+
+		if (child) {
+			child->parent = parent;
+		}
+		_rb_replace_child (tree, parent, node, child);
+
+		rb_augment_propagate (tree, parent);
+
+	} else {
+
+		/* two children, the in-order successor takes the node's place */
+		rb_node_t* succ = node->right;
+		while (succ->left) {
+			succ = succ->left;
+		}
+
+		color = succ->color;
+		child = succ->right;
+
+		if (succ->parent == node) {
+			parent = succ;
+		} else {
+			parent 		 = succ->parent;
+			parent->left = child;
+			if (child) {
+				child->parent = parent;
+			}
+			succ->right 		= node->right;
+			node->right->parent = succ;
+		}
+
+		succ->left 		   = node->left;
+		node->left->parent = succ;
+		succ->parent 	   = node->parent;
+		succ->color 	   = node->color;
+		_rb_replace_child (tree, node->parent, node, succ);
+
+		rb_augment_propagate (tree, parent);
+	}
+
+	tree->size--;
+	node->parent = node->left = node->right = NULL;
+
+	if (color == RB_BLACK) {
+		_rb_remove_fixup (tree, child, parent);
+	}
+}
+
+/**
+ * @brief Refresh the augmented data from a node up to the root
+ * @param tree Pointer to the tree
+ * @param node Lowest node whose augmented data may be stale
+ */
+void rb_augment_propagate (rb_tree_t* tree, rb_node_t* node)
+{
+	if (!tree || !tree->augment) {
+		return;
+	}
+
+	for (; node; node = node->parent) {
+		tree->augment (node);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// 		TREE ACCESS FUNCTIONS
+//-----------------------------------------------------------------------------
+
+rb_node_t* rb_find (const rb_tree_t* tree, const void* key,
+					rb_key_compare_func_t cmp)
+{
+	if (!tree || !cmp) {
+		return NULL;
+	}
+
+	rb_node_t* node = tree->root;
+	while (node) {
+		int res = cmp (key, node);
+		if (res == 0) {
+			return node;
+		}
+		node = (res < 0) ? node->left : node->right;
+	}
+
+	return NULL;
+}
+
+rb_node_t* rb_first (const rb_tree_t* tree)
+{
+	if (!tree || !tree->root) {
+		return NULL;
+	}
+
+	rb_node_t* node = tree->root;
+	while (node->left) {
+		node = node->left;
+	}
+	return node;
+}
+
+rb_node_t* rb_last (const rb_tree_t* tree)
+{
+	if (!tree || !tree->root) {
+		return NULL;
+	}
+
+	rb_node_t* node = tree->root;
+	while (node->right) {
+		node = node->right;
+	}
+	return node;
+}
+
+rb_node_t* rb_next (const rb_node_t* node)
+{
+	if (!node) {
+		return NULL;
+	}
+
+	if (node->right) {
+		node = node->right;
+		while (node->left) {
+			node = node->left;
+		}
+		return (rb_node_t*) node;
+	}
+
+	/* go up until we come from a left subtree */
+	while (node->parent && node == node->parent->right) {
+		node = node->parent;
+	}
+	return node->parent;
+}
+
+rb_node_t* rb_prev (const rb_node_t* node)
+{
+	if (!node) {
+		return NULL;
+	}
+
+	if (node->left) {
+		node = node->left;
+		while (node->right) {
+			node = node->right;
+		}
+		return (rb_node_t*) node;
+	}
+
+	while (node->parent && node == node->parent->left) {
+		node = node->parent;
+	}
+	return node->parent;
+}
+
+bool rb_is_empty (const rb_tree_t* tree)
+{
+	return !tree || tree->size == 0;
+}
+
+size_t rb_size (const rb_tree_t* tree)
+{
+	return tree ? tree->size : 0;
+}
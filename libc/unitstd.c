@@ -64,4 +64,22 @@
 _DEFN_SYSCALL_P2 ( write, SYS_write, const char*, size_t );
 _DEFN_SYSCALL_P2 ( read,  SYS_read, char*, size_t );
 _DEFN_SYSCALL_P0 ( fork,  SYS_fork );
-_DEFN_SYSCALL_P1 ( exec,  SYS_exec, const char* );
\ No newline at end of file
+_DEFN_SYSCALL_P1 ( exec,  SYS_exec, const char* );
+_DEFN_SYSCALL_P2 ( shmget, SYS_shmget, int, size_t );
+_DEFN_SYSCALL_P2 ( _shmat, SYS_shmat, int, const void* );
+_DEFN_SYSCALL_P1 ( shmdt, SYS_shmdt, const void* );
+_DEFN_SYSCALL_P2 ( procmem, SYS_procmem, int, struct procmem* );
+_DEFN_SYSCALL_P1 ( kbdlat, SYS_kbdlat, struct kbdlat* );
+_DEFN_SYSCALL_P3 ( sched_deadline, SYS_sched_deadline, unsigned, unsigned, unsigned );
+_DEFN_SYSCALL_P0 ( sched_yield, SYS_sched_yield );
+_DEFN_SYSCALL_P1 ( shmrm, SYS_shmrm, int );
+_DEFN_SYSCALL_P3 ( _mmap, SYS_mmap, void*, size_t, int );
+_DEFN_SYSCALL_P2 ( munmap, SYS_munmap, void*, size_t );
+
+void* shmat (int shmid, const void* addr) {
+    return (void*) _shmat (shmid, addr);
+}
+
+void* mmap (void* addr, size_t size, int prot) {
+    return (void*) _mmap (addr, size, prot);
+}
@@ -0,0 +1,365 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <mm/cow.h>
+#include <mm/vma.h>
+#include <mm/frame.h>
+#include <mm/fault.h>
+#include <mm/kmm.h>
+#include <mm/pgtable.h>
+#include <mm/hugepage.h>
+#include <mm/fixmap.h>
+#include <mm/shrinker.h>
+#include <mm/swap.h>
+#include <mm/shm.h>
+#include <mm/zeropage.h>
+#include <interrupts.h>
+#include <mem.h>
+#include <utils.h>
+
+#define LOG_MOD_NAME 	"COW"
+#define LOG_MOD_ENABLE  1
+#include <log.h>
+
+/* Writable user pages are shared by clearing PTE_WRITABLE and setting PTE_COW
+	in both address spaces, read-only pages are simply shared. Each extra
+	mapping holds a frame reference, and the vmm returns frames through
+	frame_put, so tearing down either side leaves the other intact.
+
+	CR0.WP is set, so supervisor writes fault on shared pages just like user
+	writes. The elf loader fills read-only segments through cow_load_copy and
+	cow_load_fill, which make each page writable only while they write it. */
+
+/* Private variables */
+
+static cow_stats_t 			_cow_stats;
+
+/* Implementation private helper routines. */
+
+//! clones a user page table, sharing every present page with the child
+static pde_t 	_cow_clone_table (pagetable_t* src, pde_t src_pde);
+
+//! gives the page behind the pte a private writable frame
+static int32_t 	_cow_break (pte_t* pte, void* virt);
+
+//! writes n bytes of src, or of c if src is NULL, to user memory of the
+//! current address space whatever its protection
+static int32_t 	_cow_load (uintptr_t addr, const uint8_t* src, int c, size_t n);
+
+//! page fault handler for writes to copy on write pages
+static int32_t 	_cow_fault (uintptr_t addr, uint32_t error,
+							interrupt_context_t* context);
+
+/* Public functions of the interface */
+
+void cow_init (void) {
+
+	vmm_fault_register (_cow_fault, FAULT_KIND_COW);
+	write_cr0 (read_cr0 () | CR0_WP);
+
+}
+
+pagedir_t* vmm_clone_pagedir_cow (void) {
+
+	pagedir_t* src 	= vmm_get_current_pagedir ();
+	pagedir_t* kdir = vmm_get_kerneldir ();
+
+	if (!src) {
+		return NULL;
+	}
+
+	pagedir_t* dst = vmm_create_address_space ();
+	if (!dst) {
+		return NULL;
+	}
+
+	uint32_t i, tables = 0;
+	for (i = 0; i < VMM_PAGES_PER_DIR; i++) {
+
+		pde_t pde = src->table[i];
+		if (!pde) {
+			continue;
+		}
+
+		/* kernel tables are the same in every address space, and so is the
+			recursive entry of any directory that is not current */
+		if (pde == kdir->table[i] || i == RECURSIVE_PDE) {
+			dst->table[i] = kdir->table[i];
+			continue;
+		}
+
+		/* large pages are shared page by page like everything else */
+		if (PDE_IS_4MB (pde)) {
+			if (hugepage_split (src, i * PSE_PAGE_SIZE) != 0) {
+				break;
+			}
+			pde = src->table[i];
+		}
+
+		/* the source is current, its tables are walked in place */
+		dst->table[i] = _cow_clone_table (
+							pgtable_get_table (src, (void*) (i * PGTABLE_SPAN)),
+							pde);
+		if (!dst->table[i]) {
+			break;
+		}
+		tables++;
+	}
+
+	int32_t err = (i < VMM_PAGES_PER_DIR) ? -1 : vma_clone_space (src, dst);
+	vma_charge_tables (dst, tables);
+
+	/* shared memory stays shared with the child, the attachments copied so
+		far are counted even on failure since the teardown drops them */
+	shm_clone_space (src, dst);
+
+	if (err != 0) {
+		/* the references taken so far are dropped by the teardown, the
+			parent's pages stay write protected and are reclaimed on the next
+			write fault */
+		vmm_destroy_space (dst);
+		flush_tlb ();
+		return NULL;
+	}
+
+	/* the parent's writable pages just became read-only */
+	flush_tlb ();
+	_cow_stats.clones++;
+
+	return dst;
+
+}
+
+int32_t cow_break_range (void* start, size_t size) {
+
+	pagedir_t* pdir = vmm_get_current_pagedir ();
+	uintptr_t  page = (uintptr_t) start & ~(VMM_PAGE_SIZE - 1);
+	uintptr_t  end 	= (uintptr_t) start + size;
+
+	/* only user pages are ever shared */
+	if (end < (uintptr_t) start || end > PHYSMAP_BASE) {
+		end = PHYSMAP_BASE;
+	}
+
+	for (; page < end; page += VMM_PAGE_SIZE) {
+
+		pte_t* pte = pgtable_get_pte (pdir, (void*) page);
+		if (pte && PTE_IS_PRESENT (*pte) && (*pte & PTE_COW)) {
+			if (_cow_break (pte, (void*) page) != 0) {
+				return -1;
+			}
+		}
+	}
+
+	return 0;
+
+}
+
+void* cow_load_copy (void* dst, const void* src, size_t n) {
+
+	if (_cow_load ((uintptr_t) dst, src, 0, n) != 0) {
+		LOG_ERROR ("could not load %u bytes at %x\n", n, dst);
+	}
+
+	return dst;
+
+}
+
+void* cow_load_fill (void* dst, int c, size_t n) {
+
+	if (_cow_load ((uintptr_t) dst, NULL, c, n) != 0) {
+		LOG_ERROR ("could not fill %u bytes at %x\n", n, dst);
+	}
+
+	return dst;
+
+}
+
+const cow_stats_t* cow_get_stats (void) {
+
+	return &_cow_stats;
+
+}
+
+void cow_stats (void) {
+
+	printk ("cow: clones %u, pages shared %u\n", _cow_stats.clones,
+			_cow_stats.pages_shared);
+	printk ("cow: faults %u, copies %u (%u of the zero page), reuses %u, "
+			"failures %u\n", _cow_stats.faults, _cow_stats.copies,
+			_cow_stats.zero_copies, _cow_stats.reuses, _cow_stats.failures);
+
+}
+
+/* Private helpers */
+
+pde_t _cow_clone_table (pagetable_t* src, pde_t src_pde) {
+
+	void* frame = reclaim_frame_alloc (0);
+	if (!frame) {
+		return 0;
+	}
+
+	pagetable_t* dst = PHYS_TO_VIRT (frame);
+
+	for (uint32_t i = 0; i < VMM_PAGES_PER_TABLE; i++) {
+
+		pte_t pte = src->table[i];
+		if (!PTE_IS_PRESENT (pte)) {
+			/* a page in swap is shared through its slot instead */
+			if (PTE_IS_SWAP (pte)) {
+				swap_dup_entry (pte);
+				dst->table[i] = pte;
+			} else {
+				dst->table[i] = 0;
+			}
+			continue;
+		}
+
+		if (pte & PTE_WRITABLE) {
+			pte = (pte & ~PTE_WRITABLE) | PTE_COW;
+			src->table[i] = pte;
+		}
+
+		frame_get ((void*) PTE_FRAME_ADDR (pte));
+		dst->table[i] = pte;
+		_cow_stats.pages_shared++;
+	}
+
+	return pde_create (frame, PDE_FLAGS (src_pde));
+
+}
+
+int32_t _cow_break (pte_t* pte, void* virt) {
+
+	void* 	 old_frame = (void*) PTE_FRAME_ADDR (*pte);
+	uint32_t flags 	   = (PTE_FLAGS (*pte) & ~PTE_COW) | PTE_WRITABLE;
+
+	/* the other sharers are gone already, the frame can be written in place */
+	if (frame_refcount (old_frame) == 1) {
+		*pte = pte_create (old_frame, flags);
+		invlpg (virt);
+		_cow_stats.reuses++;
+		return 0;
+	}
+
+	void* new_frame = reclaim_frame_alloc (0);
+	if (!new_frame) {
+		_cow_stats.failures++;
+		return -1;
+	}
+
+	if (zero_page_is (old_frame)) {
+		memset (PHYS_TO_VIRT (new_frame), 0, VMM_PAGE_SIZE);
+		_cow_stats.zero_copies++;
+	} else {
+		memcpy (PHYS_TO_VIRT (new_frame), PHYS_TO_VIRT (old_frame),
+				VMM_PAGE_SIZE);
+	}
+
+	*pte = pte_create (new_frame, flags);
+	invlpg (virt);
+	frame_put (old_frame);
+
+	_cow_stats.copies++;
+	return 0;
+
+}
+
+int32_t _cow_load (uintptr_t addr, const uint8_t* src, int c, size_t n) {
+
+	uintptr_t end = addr + n;
+
+	/* kernel memory is written like any other */
+	if (end < addr || end > PHYSMAP_BASE) {
+		if (src) {
+			memcpy ((void*) addr, src, n);
+		} else {
+			memset ((void*) addr, c, n);
+		}
+		return 0;
+	}
+
+	pagedir_t* pdir = vmm_get_current_pagedir ();
+
+	while (addr < end) {
+
+		uintptr_t page = addr & ~(VMM_PAGE_SIZE - 1);
+		size_t 	  len  = ((page + VMM_PAGE_SIZE < end) ? page + VMM_PAGE_SIZE :
+															end) - addr;
+
+		/* a page that is not there yet is brought in by the fault handlers */
+		(void) *(volatile uint8_t*) addr;
+
+		pde_t* pde = &pdir->table[ VMM_DIR_INDEX (page) ];
+		pte_t* pte = pgtable_get_pte (pdir, (void*) page);
+
+		/* shared pages get their private copy first */
+		if (pte && PTE_IS_PRESENT (*pte) && (*pte & PTE_COW) &&
+			_cow_break (pte, (void*) page) != 0) {
+			return -1;
+		}
+
+		uint32_t eflags;
+		asm volatile ("pushfl; popl %0; cli" : "=r" (eflags) :: "memory");
+
+		/* a large page has no table, its directory entry protects it */
+		bool pde_ro = !(*pde & PDE_WRITABLE);
+		bool pte_ro = pte && !(*pte & PTE_WRITABLE);
+
+		*pde |= PDE_WRITABLE;
+		if (pte_ro) {
+			*pte |= PTE_WRITABLE;
+		}
+		invlpg ((void*) page);
+
+		if (src) {
+			memcpy ((void*) addr, src, len);
+			src += len;
+		} else {
+			memset ((void*) addr, c, len);
+		}
+
+		if (pde_ro) {
+			*pde &= ~PDE_WRITABLE;
+		}
+		if (pte_ro) {
+			*pte &= ~PTE_WRITABLE;
+		}
+		invlpg ((void*) page);
+
+		if (eflags & 0x200) {
+			sti ();
+		}
+
+		addr += len;
+	}
+
+	return 0;
+
+}
+
+int32_t _cow_fault (uintptr_t addr, uint32_t error,
+					interrupt_context_t* context) {
+
+	if ((error & (PF_ERR_PRESENT | PF_ERR_WRITE)) !=
+		(PF_ERR_PRESENT | PF_ERR_WRITE)) {
+		return -1;
+	}
+
+	pte_t* pte = pgtable_get_pte (vmm_get_current_pagedir (), (void*) addr);
+	if (!pte || !PTE_IS_PRESENT (*pte) || !(*pte & PTE_COW)) {
+		return -1;
+	}
+
+	_cow_stats.faults++;
+
+	if (_cow_break (pte, (void*) (addr & ~(VMM_PAGE_SIZE - 1))) != 0) {
+		LOG_ERROR ("out of memory copying page %x\n", addr);
+		return -1;
+	}
+
+	return 0;
+
+}
@@ -0,0 +1,262 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <mm/demand.h>
+#include <mm/vma.h>
+#include <mm/fault.h>
+#include <mm/pgtable.h>
+#include <mm/hugepage.h>
+#include <mm/shrinker.h>
+#include <mm/zeropage.h>
+#include <init/syscall.h>
+#include <interrupts.h>
+#include <mem.h>
+#include <utils.h>
+
+#define LOG_MOD_NAME 	"DMD"
+#define LOG_MOD_ENABLE  1
+#include <log.h>
+
+/* Some helpful macros to help reduce verbosity */
+
+//! lowest address a reservation may reach up to, the stack window and its
+//! guard gap lie above it
+#define RESERVE_CEILING (USER_STACK_LIMIT - USER_STACK_GUARD)
+
+/* Private variables */
+
+static demand_stats_t 	_demand_stats;
+
+//! the syscall isr that was installed before ours
+static interrupt_service_t 	_syscall_next = NULL;
+
+/* Implementation private helper routines. */
+
+//! backs the page at addr with a zeroed frame
+static int32_t 	_demand_populate (pagedir_t* pdir, uintptr_t addr,
+								  uint32_t flags);
+
+//! page fault handler for first touches of demand paged areas
+static int32_t 	_demand_fault (uintptr_t addr, uint32_t error,
+							   interrupt_context_t* context);
+
+//! finds a free range for size bytes in the mmap window
+static uintptr_t 	_demand_find_range (vm_space_t* space, size_t size);
+
+//! serves mmap(addr, size, prot) and munmap(addr, size) and passes every
+//! other syscall on
+static void 	_demand_syscall (interrupt_context_t* context);
+
+/* Public functions of the interface */
+
+void demand_init (void) {
+
+	vmm_fault_register (_demand_fault, FAULT_KIND_DEMAND);
+
+	if (get_interrupt_handler (ISR128_SYSCALL) != _demand_syscall) {
+		_syscall_next = get_interrupt_handler (ISR128_SYSCALL);
+		register_interrupt_handler (ISR128_SYSCALL, _demand_syscall);
+	}
+
+}
+
+bool vmm_reserve_region (pagedir_t* pdir, void* virtual, size_t size,
+						 uint32_t flags) {
+
+	uintptr_t start = (uintptr_t) virtual;
+
+	if (!pdir || size == 0 || !IS_ALIGNED (start, VMM_PAGE_SIZE)) {
+		return false;
+	}
+
+	size = ALIGN_SIZE (size, VMM_PAGE_SIZE);
+	if (start + size < start || start + size > RESERVE_CEILING) {
+		LOG_ERROR ("cannot reserve %x+%x, outside of user space\n", start, size);
+		return false;
+	}
+
+	vm_space_t* space = vma_get_space (pdir, true);
+	if (!vma_insert (space, start, size, flags | PTE_PRESENT | PTE_USER,
+					 VMA_MMAP | VMA_DEMAND, NULL, 0)) {
+		LOG_ERROR ("reservation %x+%x overlaps another area\n", start, size);
+		return false;
+	}
+
+	_demand_stats.reserved_pages += size / VMM_PAGE_SIZE;
+	return true;
+
+}
+
+void* vmm_mmap (pagedir_t* pdir, void* virtual, size_t size, uint32_t prot) {
+
+	vm_space_t* space = pdir ? vma_get_space (pdir, true) : NULL;
+	uintptr_t 	start = (uintptr_t) virtual;
+
+	if (!space || pdir == vmm_get_kerneldir () || size == 0 ||
+		size > USER_MMAP_END - USER_MMAP_BASE) {
+		return NULL;
+	}
+
+	size = ALIGN_SIZE (size, VMM_PAGE_SIZE);
+
+	if (!start && !(start = _demand_find_range (space, size))) {
+		return NULL;
+	}
+
+	uint32_t flags = (prot & MMAP_PROT_WRITE) ? PTE_WRITABLE : 0;
+	if (!vmm_reserve_region (pdir, (void*) start, size, flags)) {
+		return NULL;
+	}
+
+	return (void*) start;
+
+}
+
+bool vmm_unreserve_region (pagedir_t* pdir, void* virtual, size_t size) {
+
+	vm_space_t* space = vma_get_space (pdir, false);
+	vm_area_t*  area  = vma_find (space, (uintptr_t) virtual);
+
+	if (!area || !(area->flags & VMA_DEMAND) ||
+		area->start != (uintptr_t) virtual ||
+		area->end - area->start != ALIGN_SIZE (size, VMM_PAGE_SIZE)) {
+		LOG_ERROR ("no reservation at %p of size %x\n", virtual, size);
+		return false;
+	}
+
+	pgtable_unmap_range (pdir, area->start, area->end - area->start);
+
+	_demand_stats.reserved_pages -= (area->end - area->start) / VMM_PAGE_SIZE;
+	vma_remove (space, area);
+
+	return true;
+
+}
+
+const demand_stats_t* demand_get_stats (void) {
+
+	return &_demand_stats;
+
+}
+
+/* Private helpers */
+
+uintptr_t _demand_find_range (vm_space_t* space, size_t size) {
+
+	uintptr_t start = USER_MMAP_BASE;
+
+	while (start + size <= USER_MMAP_END) {
+
+		vm_area_t* next = vma_find_next (space, start);
+		if (!next || next->start >= start + size) {
+			return start;
+		}
+
+		start = next->end;
+	}
+
+	return 0;
+
+}
+
+int32_t _demand_populate (pagedir_t* pdir, uintptr_t addr, uint32_t flags) {
+
+	void* frame = reclaim_frame_alloc (0);
+	if (!frame) {
+		_demand_stats.failures++;
+		return -1;
+	}
+
+	/* anonymous memory must never leak what the frame held before */
+	memset (PHYS_TO_VIRT (frame), 0, VMM_PAGE_SIZE);
+
+	vmm_map_page (pdir, (void*) (addr & ~(VMM_PAGE_SIZE - 1)), frame, flags);
+	return 0;
+
+}
+
+int32_t _demand_fault (uintptr_t addr, uint32_t error,
+					   interrupt_context_t* context) {
+
+	if ((error & PF_ERR_PRESENT) || addr >= PHYSMAP_BASE) {
+		return -1;
+	}
+
+	/* user tables populated in the kernel directory would be shared by every
+		address space cloned from it later */
+	pagedir_t* pdir = vmm_get_current_pagedir ();
+	if (pdir == vmm_get_kerneldir ()) {
+		return -1;
+	}
+
+	vm_area_t* area = vma_find (vma_get_space (pdir, false), addr);
+	if (!area || !(area->flags & VMA_DEMAND)) {
+		return -1;
+	}
+
+	/* a page that was written out to swap is not a first touch */
+	pte_t* pte = pgtable_get_pte (pdir, (void*) addr);
+	if (pte && *pte) {
+		return -1;
+	}
+
+	/* a user access far below the stack pointer is a stray pointer, not a
+		push. the kernel may fill a user buffer anywhere in the stack. */
+	if ((area->flags & VMA_GROWSDOWN) && (error & PF_ERR_USER) &&
+		addr + STACK_GROW_SLACK < context->useresp) {
+		return -1;
+	}
+
+	/* reads share the zero page until the first write */
+	if (!(error & PF_ERR_WRITE) && !(area->flags & VMA_GROWSDOWN) &&
+		zero_page_map (pdir, addr, area->prot)) {
+		vma_charge (pdir, 1, 0);
+		_demand_stats.zero_pages++;
+		return 0;
+	}
+
+	/* large reservations are filled a large page at a time where they can */
+	uintptr_t huge = addr & ~(PSE_PAGE_SIZE - 1);
+	if (!(area->flags & VMA_GROWSDOWN) && huge >= area->start &&
+		huge + PSE_PAGE_SIZE <= area->end &&
+		hugepage_map (pdir, huge, area->prot)) {
+		vma_charge (pdir, VMM_PAGES_PER_TABLE, 0);
+		_demand_stats.faults++;
+		return 0;
+	}
+
+	if (_demand_populate (pdir, addr, area->prot) != 0) {
+		return -1;
+	}
+
+	vma_charge (pdir, 1, 0);
+
+	if (area->flags & VMA_STACK) {
+		_demand_stats.stack_pages++;
+	} else {
+		_demand_stats.faults++;
+	}
+
+	return 0;
+
+}
+
+void _demand_syscall (interrupt_context_t* context) {
+
+	pagedir_t* pdir = vmm_get_current_pagedir ();
+
+	if (context->eax == SYSCALL_MMAP) {
+		void* addr 	 = vmm_mmap (pdir, (void*) context->ebx, context->ecx,
+								 context->edx);
+		context->eax = addr ? (uint32_t) addr : (uint32_t) -1;
+	}
+	else if (context->eax == SYSCALL_MUNMAP) {
+		context->eax = vmm_unreserve_region (pdir, (void*) context->ebx,
+											 context->ecx) ? 0 : (uint32_t) -1;
+	}
+	else {
+		_syscall_next (context);
+	}
+
+}
@@ -0,0 +1,231 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#include <mm/fault.h>
+#include <mm/vma.h>
+#include <driver/serial.h>
+#include <interrupts.h>
+#include <utils.h>
+
+#define LOG_MOD_NAME 	"PGF"
+#define LOG_MOD_ENABLE  1
+#include <log.h>
+
+/* Private variables */
+
+//! the handler installed by vmm_init, reports the fault and halts
+static interrupt_service_t 	_fault_fallback = NULL;
+
+//! registered handlers, consulted in order
+static fault_handler_t 		_fault_handlers[VMM_MAX_FAULT_HANDLERS];
+static fault_kind_t 		_fault_kinds[VMM_MAX_FAULT_HANDLERS];
+static uint32_t 			_num_fault_handlers = 0;
+
+static fault_counts_t 		_fault_counts;
+
+//! ring of the most recent faults, _trace_next counts every recorded one
+static fault_trace_entry_t 	_trace[VMM_FAULT_TRACE_SIZE];
+static uint32_t 			_trace_next = 0;
+static bool 				_trace_enabled = false;
+
+static const char* 			_kind_names[FAULT_KINDS] = {
+	"other", "demand", "cow", "swap", "kheap", "fixup", "fatal"
+};
+
+/* Implementation private helper routines. */
+
+//! the actual isr for the page fault exception
+static void 	_vmm_fault_dispatch (interrupt_context_t* context);
+
+//! counts a fault in the global counters and those of its address space
+static void 	_vmm_fault_account (fault_counts_t* counts, uint32_t error,
+									fault_kind_t kind);
+
+//! writes a value as eight hex digits to the serial port
+static void 	_vmm_fault_serial_hex (uint32_t value);
+
+/* Public functions of the interface */
+
+void vmm_fault_init (void) {
+
+	/* only chain once, a second call would make us our own fallback */
+	if (get_interrupt_handler (PAGE_FAULT_INT) == _vmm_fault_dispatch) {
+		return;
+	}
+
+	_fault_fallback = get_interrupt_handler (PAGE_FAULT_INT);
+	register_interrupt_handler (PAGE_FAULT_INT, _vmm_fault_dispatch);
+
+}
+
+int32_t vmm_fault_register (fault_handler_t handler, fault_kind_t kind) {
+
+	if (!handler || _num_fault_handlers >= VMM_MAX_FAULT_HANDLERS) {
+		LOG_ERROR ("cannot register page fault handler %p\n", handler);
+		return -1;
+	}
+
+	if (kind >= FAULT_KINDS) {
+		kind = FAULT_KIND_OTHER;
+	}
+
+	_fault_kinds[_num_fault_handlers] 	 = kind;
+	_fault_handlers[_num_fault_handlers++] = handler;
+	return 0;
+
+}
+
+const fault_counts_t* vmm_fault_get_counts (pagedir_t* pdir) {
+
+	if (!pdir) {
+		return &_fault_counts;
+	}
+
+	vm_space_t* space = vma_get_space (pdir, false);
+	return space ? &space->faults : NULL;
+
+}
+
+void vmm_fault_trace (bool enabled) {
+
+	if (enabled && !_trace_enabled) {
+		_trace_next = 0;
+	}
+
+	_trace_enabled = enabled;
+
+}
+
+uint32_t vmm_fault_trace_read (fault_trace_entry_t* entries, uint32_t max) {
+
+	uint32_t count = _trace_next < VMM_FAULT_TRACE_SIZE ? _trace_next
+														: VMM_FAULT_TRACE_SIZE;
+	if (max < count) {
+		count = max;
+	}
+
+	uint32_t first = _trace_next - count;
+	for (uint32_t i = 0; i < count; i++) {
+		entries[i] = _trace[(first + i) & (VMM_FAULT_TRACE_SIZE - 1)];
+	}
+
+	return count;
+
+}
+
+void vmm_fault_trace_dump (void) {
+
+	fault_trace_entry_t entries[VMM_FAULT_TRACE_SIZE];
+	uint32_t count = vmm_fault_trace_read (entries, VMM_FAULT_TRACE_SIZE);
+
+	serial_puts ("page fault trace, eip cr2 error kind\n");
+
+	for (uint32_t i = 0; i < count; i++) {
+		_vmm_fault_serial_hex (entries[i].eip);
+		serial_putc (' ');
+		_vmm_fault_serial_hex (entries[i].addr);
+		serial_putc (' ');
+		_vmm_fault_serial_hex (entries[i].error);
+		serial_putc (' ');
+		serial_puts (_kind_names[entries[i].kind]);
+		serial_putc ('\n');
+	}
+
+}
+
+void vmm_fault_stats (void) {
+
+	const fault_counts_t* c = &_fault_counts;
+
+	printk ("faults: %u, not present %u, protection %u, user %u, kernel %u, "
+			"writes %u\n", c->total, c->not_present, c->protection, c->user,
+			c->kernel, c->writes);
+	printk ("faults: demand %u, cow %u, swap %u, kheap %u, fixup %u, "
+			"other %u, fatal %u\n", c->kinds[FAULT_KIND_DEMAND],
+			c->kinds[FAULT_KIND_COW], c->kinds[FAULT_KIND_SWAP],
+			c->kinds[FAULT_KIND_KHEAP], c->kinds[FAULT_KIND_FIXUP],
+			c->kinds[FAULT_KIND_OTHER], c->kinds[FAULT_KIND_FATAL]);
+
+}
+
+/* Private helpers */
+
+void _vmm_fault_dispatch (interrupt_context_t* context) {
+
+	uintptr_t 	 addr  = read_cr2 ();
+	uint32_t 	 error = context->error_code;
+	uint32_t 	 eip   = context->eip;	// a fixup moves it
+	fault_kind_t kind  = FAULT_KIND_FATAL;
+
+	for (uint32_t i = 0; i < _num_fault_handlers; i++) {
+		if (_fault_handlers[i] (addr, error, context) == 0) {
+			kind = _fault_kinds[i];
+			break;
+		}
+	}
+
+	/* the space is looked up after the handlers, which may have created it */
+	vm_space_t* space = vma_get_space (vmm_get_current_pagedir (), false);
+
+	_vmm_fault_account (&_fault_counts, error, kind);
+	if (space) {
+		_vmm_fault_account (&space->faults, error, kind);
+	}
+
+	if (_trace_enabled) {
+		fault_trace_entry_t* entry =
+			&_trace[_trace_next++ & (VMM_FAULT_TRACE_SIZE - 1)];
+		entry->eip 	 = eip;
+		entry->addr  = addr;
+		entry->error = error;
+		entry->kind  = kind;
+	}
+
+	if (kind != FAULT_KIND_FATAL) {
+		return;
+	}
+
+	/* nobody claimed it, this is a genuine fault */
+	if (_trace_enabled) {
+		vmm_fault_trace_dump ();
+	}
+
+	if (_fault_fallback) {
+		_fault_fallback (context);
+	}
+
+}
+
+void _vmm_fault_account (fault_counts_t* counts, uint32_t error,
+						 fault_kind_t kind) {
+
+	counts->total++;
+	counts->kinds[kind]++;
+
+	if (error & PF_ERR_PRESENT) {
+		counts->protection++;
+	}
+	else {
+		counts->not_present++;
+	}
+
+	if (error & PF_ERR_USER) {
+		counts->user++;
+	}
+	else {
+		counts->kernel++;
+	}
+
+	if (error & PF_ERR_WRITE) {
+		counts->writes++;
+	}
+
+}
+
+void _vmm_fault_serial_hex (uint32_t value) {
+
+	for (int32_t shift = 28; shift >= 0; shift -= 4) {
+		serial_putc ("0123456789abcdef"[(value >> shift) & 0xF]);
+	}
+
+}
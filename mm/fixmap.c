@@ -0,0 +1,118 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#include <mm/fixmap.h>
+#include <mm/pgtable.h>
+#include <mm/tlb.h>
+#include <mem.h>
+#include <utils.h>
+
+#define LOG_MOD_NAME 	"FIX"
+#define LOG_MOD_ENABLE  1
+#include <log.h>
+
+/* The vmm is linked with its vmm_switch_pagedir renamed to
+	_vmm_switch_pagedir, the version here keeps the recursive entry right.
+
+	Only the current directory points back at itself. Every other directory
+	holds the kernel's entry in the recursive slot, so code that copies the
+	kernel entries or skips them on teardown treats the slot like any other
+	shared kernel table. */
+
+/* Some helpful macros to help reduce verbosity */
+
+//! recursive entry of a directory, pointing at the directory itself
+#define RECURSIVE_ENTRY(pdir) \
+	pde_create (VIRT_TO_PHYS (pdir), PDE_PRESENT | PDE_WRITABLE)
+
+/* Private variables */
+
+static bool 	_fixmap_ready = false;
+
+//! ptes of the fixmap slots, inside the kernel table covering the window
+static pte_t* 	_fixmap_ptes = NULL;
+
+//! the prebuilt switch, only loads cr3
+extern bool 	_vmm_switch_pagedir (pagedir_t* new_pagedir);
+
+/* Public functions of the interface */
+
+void fixmap_init (void) {
+
+	pagedir_t* kdir = vmm_get_kerneldir ();
+
+	/* the fixmap table is a kernel table like any other, created before any
+		address space copies the kernel entries */
+	vmm_create_pt (kdir, (void*) FIXMAP_BASE, PDE_PRESENT | PDE_WRITABLE);
+
+	_fixmap_ptes = pgtable_get_pte (kdir, (void*) FIXMAP_BASE);
+	if (!_fixmap_ptes) {
+		LOG_ERROR ("cannot create the fixmap table\n");
+		return;
+	}
+
+	kdir->table[ RECURSIVE_PDE ] = RECURSIVE_ENTRY (kdir);
+	_fixmap_ready = true;
+
+	LOG_DEBUG ("page tables at %x, %u fixmap slots at %x\n", RECURSIVE_BASE,
+				FIX_SLOTS, FIXMAP_BASE);
+
+}
+
+bool fixmap_recursive_ready (void) {
+
+	return _fixmap_ready;
+
+}
+
+void* fixmap_map (enum fixmap_slot slot, void* phys) {
+
+	if (!_fixmap_ready || slot >= FIX_SLOTS) {
+		return NULL;
+	}
+
+	void* virt = (void*) FIXMAP_ADDR (slot);
+
+	_fixmap_ptes[slot] = pte_create (phys, PTE_PRESENT | PTE_WRITABLE);
+	invlpg (virt);
+
+	return virt;
+
+}
+
+void fixmap_unmap (enum fixmap_slot slot) {
+
+	if (!_fixmap_ready || slot >= FIX_SLOTS) {
+		return;
+	}
+
+	_fixmap_ptes[slot] = 0;
+	invlpg ((void*) FIXMAP_ADDR (slot));
+
+}
+
+bool vmm_switch_pagedir (pagedir_t* new_pagedir) {
+
+	pagedir_t* old  = vmm_get_current_pagedir ();
+	pagedir_t* kdir = vmm_get_kerneldir ();
+
+	if (!new_pagedir) {
+		return false;
+	}
+
+	if (_fixmap_ready) {
+		new_pagedir->table[ RECURSIVE_PDE ] = RECURSIVE_ENTRY (new_pagedir);
+	}
+
+	if (!_vmm_switch_pagedir (new_pagedir)) {
+		return false;
+	}
+
+	/* the old directory goes back to sharing the kernel's entry */
+	if (_fixmap_ready && old && old != new_pagedir && old != kdir) {
+		old->table[ RECURSIVE_PDE ] = kdir->table[ RECURSIVE_PDE ];
+	}
+
+	return true;
+
+}
@@ -0,0 +1,107 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <mm/frame.h>
+#include <mm/kmm.h>
+#include <mm/vmalloc.h>
+#include <utils.h>
+
+#define LOG_MOD_NAME 	"FRM"
+#define LOG_MOD_ENABLE  1
+#include <log.h>
+
+/* The vmm is linked so that every frame it releases goes through frame_put,
+	which lets shared user frames survive the teardown of one of the address
+	spaces mapping them. */
+
+/* Private variables */
+
+//! one entry per physical frame
+static frame_meta_t* 	_frame_table = NULL;
+static uint32_t 		_num_frames  = 0;
+
+/* Public functions of the interface */
+
+void frame_init (void) {
+
+	_num_frames  = kmm_get_total_frames ();
+	_frame_table = vmalloc (_num_frames * sizeof(frame_meta_t));
+
+	if (!_frame_table) {
+		LOG_ERROR ("cannot allocate metadata for %u frames\n", _num_frames);
+		_num_frames = 0;
+		return;
+	}
+
+	memset (_frame_table, 0, _num_frames * sizeof(frame_meta_t));
+
+	LOG_DEBUG ("frame metadata for %u frames at %p\n", _num_frames,
+				_frame_table);
+
+}
+
+frame_meta_t* frame_meta (void* phys) {
+
+	uint32_t frame = FRAME_NUMBER (phys);
+	return frame < _num_frames ? &_frame_table[frame] : NULL;
+
+}
+
+void frame_get (void* phys) {
+
+	frame_meta_t* meta = frame_meta (phys);
+	if (!meta) {
+		LOG_ERROR ("cannot share untracked frame %p\n", phys);
+		return;
+	}
+
+	if (!(meta->flags & FRAME_PINNED)) {
+		meta->refs++;
+	}
+
+}
+
+void frame_put (void* phys) {
+
+	frame_meta_t* meta = frame_meta (phys);
+
+	if (meta && (meta->flags & FRAME_PINNED)) {
+		return;
+	}
+
+	if (meta && meta->refs) {
+		meta->refs--;
+		return;
+	}
+
+	if (meta) {
+		meta->flags 	= 0;
+		meta->checksum 	= 0;
+	}
+
+	kmm_frame_free (phys);
+
+}
+
+void frame_pin (void* phys) {
+
+	frame_meta_t* meta = frame_meta (phys);
+	if (!meta) {
+		LOG_ERROR ("cannot pin untracked frame %p\n", phys);
+		return;
+	}
+
+	/* the extra reference keeps the frame looking shared to copy on write
+		and swap, which must never treat it as privately owned */
+	meta->flags |= FRAME_PINNED;
+	meta->refs 	 = 1;
+
+}
+
+uint32_t frame_refcount (void* phys) {
+
+	frame_meta_t* meta = frame_meta (phys);
+	return meta ? meta->refs + 1 : 1;
+
+}
@@ -0,0 +1,211 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#include <mm/highmem.h>
+#include <mm/kmm.h>
+#include <mem.h>
+#include <utils.h>
+
+#define LOG_MOD_NAME 	"HMM"
+#define LOG_MOD_ENABLE  1
+#include <log.h>
+
+/* The bootloader leaves the whole e820 map at MEM_MAP_LOC, the kmm keeps the
+	low words of it and this keeps the rest. A set bit in the bitmap is a
+	chunk in use, chunks that are not ram stay set for good. */
+
+/* Some helpful macros to help reduce verbosity */
+
+//! cpuid leaf 1 edx bit for physical address bits 32 to 35 in 4MB entries
+#define CPUID_EDX_PSE36 	(1 << 17)
+
+//! usable ram in the e820 map
+#define E820_TYPE_RAM 		1
+
+#define CHUNK_INDEX(phys) 	((uint32_t) (((phys) - HIGHMEM_START) / \
+								HIGHMEM_CHUNK_SIZE))
+#define CHUNK_ADDR(index) 	(HIGHMEM_START + \
+								(uint64_t) (index) * HIGHMEM_CHUNK_SIZE)
+
+#define EFLAGS_IF 			0x200
+
+/* Private variables */
+
+static uint32_t 		_highmem_bitmap[ HIGHMEM_MAX_CHUNKS / 32 ];
+static uint32_t 		_highmem_next = 0;	// where the search starts
+static highmem_stats_t 	_highmem_stats;
+
+/* Implementation private helper routines. */
+
+//! frees the whole chunks of the part of a range that lies above 4GB
+static void 	_highmem_add_range (uint64_t base, uint64_t length);
+
+/* Public functions of the interface */
+
+void highmem_init (void) {
+
+	for (uint32_t i = 0; i < HIGHMEM_MAX_CHUNKS / 32; i++) {
+		_highmem_bitmap[i] = 0xFFFFFFFF;
+	}
+
+	uint32_t eax, ebx, ecx, edx;
+	cpuid (1, &eax, &ebx, &ecx, &edx);
+
+	if (!pse_enabled () || !(edx & CPUID_EDX_PSE36)) {
+		LOG_DEBUG ("cpu cannot map memory above 4GB\n");
+		return;
+	}
+
+	uint32_t 	  count = *(uint32_t*) MEM_MAP_ENTRY_COUNT_LOC;
+	e820_entry_t* map 	= (e820_entry_t*) MEM_MAP_LOC;
+
+	for (uint32_t i = 0; i < count; i++) {
+
+		if (map[i].type != E820_TYPE_RAM) {
+			continue;
+		}
+
+		_highmem_add_range (((uint64_t) map[i].baseHigh << 32) | map[i].baseLow,
+							((uint64_t) map[i].lengthHigh << 32) |
+							map[i].lengthLow);
+	}
+
+	_highmem_stats.chunks_free = _highmem_stats.chunks_total;
+
+	if (_highmem_stats.chunks_total) {
+		LOG_DEBUG ("%u MB of memory above 4GB\n",
+				   _highmem_stats.chunks_total * (HIGHMEM_CHUNK_SIZE >> 20));
+	}
+
+}
+
+bool highmem_enabled (void) {
+
+	return _highmem_stats.chunks_free > 0;
+
+}
+
+uint64_t highmem_chunk_alloc (void) {
+
+	if (!_highmem_stats.chunks_free) {
+		return 0;
+	}
+
+	for (uint32_t n = 0; n < HIGHMEM_MAX_CHUNKS / 32; n++) {
+
+		uint32_t word = (_highmem_next / 32 + n) % (HIGHMEM_MAX_CHUNKS / 32);
+		if (_highmem_bitmap[word] == 0xFFFFFFFF) {
+			continue;
+		}
+
+		uint32_t bit = __builtin_ctz (~_highmem_bitmap[word]);
+		_highmem_bitmap[word] |= 1u << bit;
+
+		_highmem_next = word * 32 + bit;
+		_highmem_stats.chunks_free--;
+		_highmem_stats.allocs++;
+
+		return CHUNK_ADDR (_highmem_next);
+	}
+
+	return 0;
+
+}
+
+void highmem_chunk_free (uint64_t phys) {
+
+	if (phys < HIGHMEM_START || phys >= HIGHMEM_END ||
+		phys & (HIGHMEM_CHUNK_SIZE - 1)) {
+		LOG_ERROR ("freeing bad high memory chunk %x:%x\n",
+				   (uint32_t) (phys >> 32), (uint32_t) phys);
+		return;
+	}
+
+	uint32_t index = CHUNK_INDEX (phys);
+	uint32_t mask  = 1u << (index % 32);
+
+	if (!(_highmem_bitmap[index / 32] & mask)) {
+		LOG_ERROR ("high memory chunk %u freed twice\n", index);
+		return;
+	}
+
+	_highmem_bitmap[index / 32] &= ~mask;
+	_highmem_stats.chunks_free++;
+
+}
+
+pde_t highmem_make_pde (uint64_t phys, uint32_t flags) {
+
+	return ((uint32_t) phys & ~(PSE_PAGE_SIZE - 1)) |
+		   ((uint32_t) (phys >> 32) << PDE_PSE36_SHIFT) |
+		   (flags & (PDE_WRITABLE | PDE_USER)) | PDE_PRESENT | PDE_SIZE_4MB;
+
+}
+
+uint64_t highmem_pde_addr (pde_t pde) {
+
+	return ((uint64_t) ((pde & PDE_PSE36_MASK) >> PDE_PSE36_SHIFT) << 32) |
+		   (pde & ~(PSE_PAGE_SIZE - 1));
+
+}
+
+void* highmem_kmap (uint64_t phys, highmem_kmap_t* km) {
+
+	asm volatile ("pushfl; popl %0; cli" : "=r" (km->eflags) :: "memory");
+
+	pde_t* pde = &vmm_get_current_pagedir ()->table[ VMM_DIR_INDEX (HIGHMEM_WINDOW) ];
+	km->saved  = *pde;
+
+	*pde = highmem_make_pde (phys, PDE_WRITABLE);
+	invlpg ((void*) HIGHMEM_WINDOW);
+
+	return (void*) HIGHMEM_WINDOW;
+
+}
+
+void highmem_kunmap (highmem_kmap_t* km) {
+
+	pagedir_t* pdir = vmm_get_current_pagedir ();
+	pdir->table[ VMM_DIR_INDEX (HIGHMEM_WINDOW) ] = km->saved;
+	invlpg ((void*) HIGHMEM_WINDOW);
+
+	if (km->eflags & EFLAGS_IF) {
+		sti ();
+	}
+
+}
+
+const highmem_stats_t* highmem_get_stats (void) {
+
+	return &_highmem_stats;
+
+}
+
+/* Private helpers */
+
+void _highmem_add_range (uint64_t base, uint64_t length) {
+
+	uint64_t end = base + length;
+
+	if (base < HIGHMEM_START) {
+		base = HIGHMEM_START;
+	}
+	if (end > HIGHMEM_END) {
+		end = HIGHMEM_END;
+	}
+
+	/* only whole chunks can be mapped by one large entry */
+	base = (base + HIGHMEM_CHUNK_SIZE - 1) & ~(uint64_t) (HIGHMEM_CHUNK_SIZE - 1);
+
+	for (; base + HIGHMEM_CHUNK_SIZE <= end; base += HIGHMEM_CHUNK_SIZE) {
+
+		uint32_t index = CHUNK_INDEX (base);
+		uint32_t mask  = 1u << (index % 32);
+
+		if (_highmem_bitmap[index / 32] & mask) {
+			_highmem_bitmap[index / 32] &= ~mask;
+			_highmem_stats.chunks_total++;
+		}
+	}
+
+}
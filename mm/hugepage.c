@@ -0,0 +1,246 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <mm/hugepage.h>
+#include <mm/kmm.h>
+#include <mm/frame.h>
+#include <mm/shrinker.h>
+#include <mm/pgtable.h>
+#include <mm/fixmap.h>
+#include <mm/highmem.h>
+#include <mm/vma.h>
+#include <mem.h>
+#include <utils.h>
+
+#define LOG_MOD_NAME 	"HPG"
+#define LOG_MOD_ENABLE  1
+#include <log.h>
+
+/* A large user page is an ordinary block of 1024 frames mapped by one
+	directory entry. The frames carry no block state of their own, so after a
+	split each of them is unmapped and freed like any other 4KB page.
+
+	Memory above 4GB is used first. Page table entries cannot reach it, so a
+	large page up there is moved into a low block before it is split. */
+
+/* Some helpful macros to help reduce verbosity */
+
+//! pte flags that survive a split or a collapse
+#define HUGEPAGE_FLAGS 		(PTE_WRITABLE | PTE_USER)
+
+/* Private variables */
+
+static bool 				_hugepage_on = true;
+static hugepage_stats_t 	_hugepage_stats;
+
+/* Public functions of the interface */
+
+void hugepage_set_enabled (bool enabled) {
+
+	_hugepage_on = enabled;
+
+}
+
+bool hugepage_enabled (void) {
+
+	return _hugepage_on && pse_enabled ();
+
+}
+
+bool hugepage_map (pagedir_t* pdir, uintptr_t virt, uint32_t flags) {
+
+	if (!pdir || !hugepage_enabled () || PSE_PAGE_OFFSET (virt) ||
+		virt + PSE_PAGE_SIZE > PHYSMAP_BASE) {
+		return false;
+	}
+
+	pde_t* pde = &pdir->table[ VMM_DIR_INDEX (virt) ];
+	if (*pde) {
+		return false;
+	}
+
+	uint64_t high = highmem_chunk_alloc ();
+	if (high) {
+		highmem_kmap_t km;
+		memset (highmem_kmap (high, &km), 0, PSE_PAGE_SIZE);
+		highmem_kunmap (&km);
+
+		*pde = highmem_make_pde (high, flags);
+		_hugepage_stats.hits++;
+		return true;
+	}
+
+	void* block = kmm_block_alloc (HUGEPAGE_ORDER);
+	if (!block) {
+		_hugepage_stats.fallbacks++;
+		return false;
+	}
+
+	/* user memory must never leak what the frames held before */
+	memset (PHYS_TO_VIRT (block), 0, PSE_PAGE_SIZE);
+
+	*pde = (uintptr_t) block | (flags & HUGEPAGE_FLAGS) | PDE_PRESENT |
+		   PDE_SIZE_4MB;
+	_hugepage_stats.hits++;
+
+	return true;
+
+}
+
+bool hugepage_alloc_region (pagedir_t* pdir, void* virtual, size_t size,
+							uint32_t flags) {
+
+	uintptr_t start = (uintptr_t) virtual & ~(VMM_PAGE_SIZE - 1);
+	uintptr_t end 	= ALIGN_SIZE ((uintptr_t) virtual + size, VMM_PAGE_SIZE);
+
+	if (!hugepage_enabled () || end - start < PSE_PAGE_SIZE) {
+		return vmm_alloc_region (pdir, virtual, size, flags);
+	}
+
+	uintptr_t cursor = start;
+	while (cursor < end) {
+
+		if (!PSE_PAGE_OFFSET (cursor) && end - cursor >= PSE_PAGE_SIZE &&
+			hugepage_map (pdir, cursor, flags)) {
+			cursor += PSE_PAGE_SIZE;
+			continue;
+		}
+
+		/* everything up to the next 4MB boundary gets small pages */
+		uintptr_t next = ALIGN_SIZE (cursor + 1, PSE_PAGE_SIZE);
+		if (next > end || next < cursor) {
+			next = end;
+		}
+
+		if (!vmm_alloc_region (pdir, (void*) cursor, next - cursor, flags)) {
+			return false;
+		}
+		cursor = next;
+	}
+
+	return true;
+
+}
+
+int32_t hugepage_split (pagedir_t* pdir, uintptr_t virt) {
+
+	virt &= ~(PSE_PAGE_SIZE - 1);
+
+	/* the kernel linear map is never split */
+	if (!pdir || virt >= PHYSMAP_BASE ||
+		!PDE_IS_HUGE (pdir->table[ VMM_DIR_INDEX (virt) ])) {
+		return 0;
+	}
+
+	pde_t* pde = &pdir->table[ VMM_DIR_INDEX (virt) ];
+
+	if (hugepage_migrate_low (pdir, virt) != 0) {
+		LOG_ERROR ("no low block to split the large page at %x\n", virt);
+		return -1;
+	}
+
+	void* frame = reclaim_frame_alloc (0);
+	if (!frame) {
+		LOG_ERROR ("out of memory splitting the large page at %x\n", virt);
+		return -1;
+	}
+
+	uintptr_t 	 base  = PDE_PTABLE_ADDR (*pde);
+	uint32_t 	 flags = PDE_FLAGS (*pde) & HUGEPAGE_FLAGS;
+	pagetable_t* table = PHYS_TO_VIRT (frame);
+
+	for (uint32_t i = 0; i < VMM_PAGES_PER_TABLE; i++) {
+		table->table[i] = pte_create ((void*) (base + i * VMM_PAGE_SIZE),
+									  flags | PTE_PRESENT);
+	}
+
+	/* the protection now lives in the ptes */
+	*pde = pde_create (frame, PDE_PRESENT | PDE_WRITABLE | PDE_USER);
+	vma_charge_tables (pdir, 1);
+
+	/* the recursive window onto the entry changes from data to table */
+	if (pdir == vmm_get_current_pagedir ()) {
+		invlpg ((void*) virt);
+		invlpg (RECURSIVE_PT (virt));
+	}
+
+	_hugepage_stats.splits++;
+	return 0;
+
+}
+
+int32_t hugepage_migrate_low (pagedir_t* pdir, uintptr_t virt) {
+
+	pde_t* pde = &pdir->table[ VMM_DIR_INDEX (virt) ];
+	if (!PDE_IS_HIGH (*pde)) {
+		return 0;
+	}
+
+	void* block = kmm_block_alloc (HUGEPAGE_ORDER);
+	if (!block) {
+		return -1;
+	}
+
+	uint64_t 	   high = highmem_pde_addr (*pde);
+	highmem_kmap_t km;
+
+	memcpy (PHYS_TO_VIRT (block), highmem_kmap (high, &km), PSE_PAGE_SIZE);
+	highmem_kunmap (&km);
+
+	*pde = (uintptr_t) block | PDE_FLAGS (*pde);
+	highmem_chunk_free (high);
+
+	if (pdir == vmm_get_current_pagedir ()) {
+		invlpg ((void*) (virt & ~(PSE_PAGE_SIZE - 1)));
+	}
+
+	_hugepage_stats.migrations++;
+	return 0;
+
+}
+
+void hugepage_release (pagedir_t* pdir, uintptr_t virt) {
+
+	pde_t* pde = &pdir->table[ VMM_DIR_INDEX (virt) ];
+	if (!PDE_IS_HUGE (*pde)) {
+		return;
+	}
+
+	if (PDE_IS_HIGH (*pde)) {
+		highmem_chunk_free (highmem_pde_addr (*pde));
+		*pde = 0;
+		_hugepage_stats.releases++;
+		return;
+	}
+
+	uintptr_t base = PDE_PTABLE_ADDR (*pde);
+	*pde = 0;
+
+	for (uint32_t i = 0; i < VMM_PAGES_PER_TABLE; i++) {
+		frame_put ((void*) (base + i * VMM_PAGE_SIZE));
+	}
+
+	_hugepage_stats.releases++;
+
+}
+
+void hugepage_release_space (pagedir_t* pdir) {
+
+	if (!pdir) {
+		return;
+	}
+
+	for (uint32_t i = 0; i < VMM_DIR_INDEX (PHYSMAP_BASE); i++) {
+		if (PDE_IS_HUGE (pdir->table[i])) {
+			hugepage_release (pdir, i * PSE_PAGE_SIZE);
+		}
+	}
+
+}
+
+const hugepage_stats_t* hugepage_get_stats (void) {
+
+	return &_hugepage_stats;
+
+}
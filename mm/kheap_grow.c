@@ -0,0 +1,280 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <mm/kheap.h>
+#include <mm/kmm.h>
+#include <mm/shrinker.h>
+#include <mm/vmm.h>
+#include <mm/fault.h>
+#include <mm/pgtable.h>
+#include <mm/tlb.h>
+#include <mm/slab.h>
+#include <mem.h>
+#include <utils.h>
+
+#define LOG_MOD_NAME 	"HPG"
+#define LOG_MOD_ENABLE  1
+#include <log.h>
+
+/* The buddy allocator manages the whole [start, start + max_size) window from
+	the beginning, but only the first part of it is backed by frames. kheap_init
+	is linked against _kheap_alloc_region, which backs no more than
+	KERNEL_HEAP_SIZE of the kernel heap window. Touching
+	the rest faults, and the fault is resolved here by mapping the whole chunk
+	around the address. Buddy blocks are naturally aligned, so every block no
+	larger than a chunk (kernel stacks included) becomes fully present as soon
+	as kmalloc writes its header, and never faults halfway through use.
+
+	The prebuilt kheap_stats is renamed, the version here adds the backed
+	part of the window and the object caches, which hold most of the small
+	kernel objects. The trim walks the free lists the same way it does. */
+
+//! the statistics of the buddy allocator
+extern void 		_kheap_buddy_stats (heap_t* heap);
+
+//! vmm_alloc_region of the buddy allocator, see the makefile
+bool 				_kheap_alloc_region (pagedir_t* pdir, void* virtual,
+										 size_t size, uint32_t flags);
+
+/* Private data structures */
+
+/* The state the buddy allocator keeps in heap->state. A free block of size
+	1 << order starts with the link to the next free block of its order. */
+typedef struct _buddy_state {
+
+	uintptr_t 	base;				//! start of the managed window
+	uint32_t 	size;				//! bytes managed
+	uint32_t 	min_order;			//! order of the smallest block
+	uint32_t 	max_order;			//! order of the largest block
+	void* 		free_lists[32];		//! free blocks of each order
+
+} buddy_state_t;
+
+/* Private variables */
+
+//! the heap that grows on demand (only the kernel heap for now)
+static heap_t* 		_grow_heap 	 = NULL;
+
+//! number of frames currently backing the heap window
+static uint32_t 	_backed_pages = 0;
+
+//! frames backing the initial part of the window, never trimmed
+static uint32_t 	_initial_pages = 0;
+
+//! trims the heap under memory pressure
+static shrinker_t 	_kheap_shrinker;
+
+/* Implementation private helper routines. */
+
+//! page fault handler backing the heap window on first touch
+static int32_t 		_kheap_fault (uintptr_t addr, uint32_t error,
+								  interrupt_context_t* context);
+
+//! maps every missing page of the chunk at the given address
+static int32_t 		_kheap_map_chunk (uintptr_t chunk);
+
+//! releases the frames of the given range, returns the number released
+static uint32_t 	_kheap_unmap (uintptr_t start, size_t size);
+
+//! shrinker callbacks, the heap can give back what it grew beyond its start
+static uint32_t 	_kheap_shrink_count (void* priv);
+static uint32_t 	_kheap_shrink_scan (void* priv, uint32_t nr_to_scan);
+
+/* Public functions of the interface */
+
+void kheap_enable_growth (heap_t* heap, size_t initial_size) {
+
+	if (!heap || _grow_heap) {
+		LOG_ERROR ("heap growth can only be enabled once\n");
+		return;
+	}
+
+	size_t heap_size = heap->end - heap->start;
+	if (!IS_ALIGNED (heap->start, heap_size)) {
+		LOG_ERROR ("heap at %x is not aligned to its size\n", heap->start);
+		return;
+	}
+
+	initial_size = ALIGN_SIZE (initial_size, KHEAP_GROW_CHUNK);
+	if (initial_size > heap_size) {
+		initial_size = heap_size;
+	}
+
+	if (heap->start != KERNEL_HEAP_VIRT) {
+		LOG_ERROR ("only the kernel heap window can grow\n");
+		return;
+	}
+
+	/* the page tables must exist from the start so that every address space
+		created later shares them, and sees the chunks mapped at fault time */
+	pagedir_t* kdir = vmm_get_kerneldir ();
+	for (uintptr_t addr = heap->start; addr < heap->end; addr += PGTABLE_SPAN) {
+		vmm_create_pt (kdir, (void*) addr, PTE_PRESENT | PTE_WRITABLE);
+	}
+
+	/* kheap_init backed at most KERNEL_HEAP_SIZE, the rest of the initial
+		part is backed here */
+	for (uintptr_t chunk = heap->start; chunk < heap->start + initial_size;
+		 chunk += KHEAP_GROW_CHUNK) {
+		_kheap_map_chunk (chunk);
+	}
+
+	_grow_heap 	   = heap;
+	_initial_pages = initial_size / VMM_PAGE_SIZE;
+	vmm_fault_register (_kheap_fault, FAULT_KIND_KHEAP);
+
+	/* trimming walks the free lists, so it must never run from inside the
+		heap's own fault handler while a block is being split */
+	strncpy (_kheap_shrinker.name, "kheap", sizeof(_kheap_shrinker.name));
+	_kheap_shrinker.count = _kheap_shrink_count;
+	_kheap_shrinker.scan  = _kheap_shrink_scan;
+	_kheap_shrinker.flags = SHRINKER_USES_HEAP;
+	shrinker_register (&_kheap_shrinker);
+
+	LOG_DEBUG ("heap at %x grows on demand, %u of %u KB backed\n",
+				heap->start, initial_size / 1024, heap_size / 1024);
+
+}
+
+uint32_t kheap_trim (heap_t* heap) {
+
+	if (!heap || heap != _grow_heap) {
+		return 0;
+	}
+
+	buddy_state_t* 	buddy 	 = heap->state;
+	uint32_t 		released = 0;
+
+	uint32_t eflags;
+	asm volatile ("pushfl; popl %0; cli" : "=r" (eflags) :: "memory");
+
+	/* everything of a free block but the chunk holding its link can go */
+	for (uint32_t order = buddy->max_order;
+		 order >= buddy->min_order && (1u << order) >= 2 * KHEAP_GROW_CHUNK;
+		 order--) {
+
+		for (void** block = buddy->free_lists[order]; block; block = *block) {
+			released += _kheap_unmap ((uintptr_t) block + KHEAP_GROW_CHUNK,
+									  (1u << order) - KHEAP_GROW_CHUNK);
+		}
+	}
+
+	if (eflags & 0x200) {
+		sti ();
+	}
+
+	LOG_DEBUG ("trimmed %u frames from the heap\n", released);
+	return released;
+
+}
+
+void kheap_stats (heap_t* heap) {
+
+	_kheap_buddy_stats (heap);
+
+	if (heap && heap == _grow_heap) {
+		printk ("Backed     : %u of %u KB\n", kheap_backed_size (heap) / 1024,
+				(heap->end - heap->start) / 1024);
+	}
+
+	kmem_cache_stats ();
+
+}
+
+size_t kheap_backed_size (heap_t* heap) {
+
+	if (!heap || heap != _grow_heap) {
+		return heap ? heap->end - heap->start : 0;
+	}
+
+	return _backed_pages * VMM_PAGE_SIZE;
+
+}
+
+/* Private helpers */
+
+bool _kheap_alloc_region (pagedir_t* pdir, void* virtual, size_t size,
+						  uint32_t flags) {
+
+	if ((uintptr_t) virtual != KERNEL_HEAP_VIRT) {
+		return vmm_alloc_region (pdir, virtual, size, flags);
+	}
+
+	/* the rest of the kernel heap window is backed on demand */
+	if (size > KERNEL_HEAP_SIZE) {
+		size = KERNEL_HEAP_SIZE;
+	}
+
+	if (!vmm_alloc_region (pdir, virtual, size, flags)) {
+		return false;
+	}
+
+	_backed_pages = size / VMM_PAGE_SIZE;
+	return true;
+
+}
+
+int32_t _kheap_fault (uintptr_t addr, uint32_t error,
+					  interrupt_context_t* context) {
+
+	if (addr < _grow_heap->start || addr >= _grow_heap->end) {
+		return -1;
+	}
+
+	/* the heap is supervisor only, and is never mapped read-only */
+	if (error & (PF_ERR_PRESENT | PF_ERR_USER)) {
+		return -1;
+	}
+
+	return _kheap_map_chunk (addr & ~(KHEAP_GROW_CHUNK - 1));
+
+}
+
+int32_t _kheap_map_chunk (uintptr_t chunk) {
+
+	pagedir_t* kdir = vmm_get_kerneldir ();
+
+	for (uintptr_t page = chunk; page < chunk + KHEAP_GROW_CHUNK;
+		 page += VMM_PAGE_SIZE) {
+
+		pte_t* pte = pgtable_get_pte (kdir, (void*) page);
+		if (pte && PTE_IS_PRESENT (*pte)) {
+			continue;
+		}
+
+		void* frame = reclaim_frame_alloc (RECLAIM_NOHEAP);
+		if (!frame) {
+			LOG_ERROR ("out of frames growing the heap at %x\n", page);
+			return -1;
+		}
+
+		vmm_map_page (kdir, (void*) page, frame, KERNEL_PTE_FLAGS);
+		_backed_pages++;
+	}
+
+	return 0;
+
+}
+
+uint32_t _kheap_unmap (uintptr_t start, size_t size) {
+
+	uint32_t released = pgtable_unmap_range (vmm_get_kerneldir (), start, size);
+
+	_backed_pages -= released;
+	return released;
+
+}
+
+uint32_t _kheap_shrink_count (void* priv) {
+
+	return _backed_pages > _initial_pages ? _backed_pages - _initial_pages : 0;
+
+}
+
+uint32_t _kheap_shrink_scan (void* priv, uint32_t nr_to_scan) {
+
+	/* the trim cannot be bounded, it releases whatever is free */
+	return kheap_trim (_grow_heap);
+
+}
@@ -0,0 +1,139 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <mm/kmm.h>
+#include <mem.h>
+#include <utils.h>
+#include <kernel/bitmap.h>
+
+#define LOG_MOD_NAME 	"KMB"
+#define LOG_MOD_ENABLE  1
+#include <log.h>
+
+/* The kmm is prebuilt and only hands out single frames. Its bitmap and
+	counters are made global when it is linked, so that blocks of frames can
+	be carved out of the same bitmap here. A set bit is a used frame. */
+
+//! usable ram in the e820 map
+#define E820_TYPE_RAM 		1
+
+extern BITSET_WORD* 	_kmm_bitmap;
+extern uint32_t 		_kmm_max_blocks;
+extern uint32_t 		_kmm_used_blocks;
+
+extern uint32_t 		kernel_start;	// from linker script
+extern uint32_t 		kernel_end;
+
+/* Public functions of the interface */
+
+void* kmm_get_bitmap_start (void) {
+
+	return _kmm_bitmap;
+
+}
+
+uint32_t kmm_get_bitmap_size () {
+
+	return ALIGN_SIZE (_kmm_max_blocks, BITSET_WORD_SIZE) / _KMM_BLOCKS_PER_BYTE;
+
+}
+
+void kmm_limit (uint32_t max_frames) {
+
+	if (_kmm_max_blocks <= max_frames) {
+		return;
+	}
+
+	LOG_P ("using %u of %u MB of memory, the physmap cannot hold more\n",
+		   max_frames >> 8, _kmm_max_blocks >> 8);
+
+	_kmm_max_blocks = max_frames;
+
+	/* the kmm took only the low words of the e820 map, so a range above 4GB
+		freed whatever frames its low words name. the bitmap that is kept is
+		rebuilt from the ranges below 4GB, with the reservations of kmm_init */
+	memset (_kmm_bitmap, 0xFF, kmm_get_bitmap_size ());
+
+	uint32_t 	  count = *(uint32_t*) MEM_MAP_ENTRY_COUNT_LOC;
+	e820_entry_t* map 	= (e820_entry_t*) MEM_MAP_LOC;
+	uint64_t 	  limit = (uint64_t) max_frames * _KMM_BLOCK_SIZE;
+
+	for (uint32_t i = 0; i < count; i++) {
+
+		if (map[i].type != E820_TYPE_RAM || map[i].baseHigh ||
+			map[i].baseLow >= limit) {
+			continue;
+		}
+
+		uint64_t end = map[i].baseLow +
+					   (((uint64_t) map[i].lengthHigh << 32) | map[i].lengthLow);
+		if (end > limit) {
+			end = limit;
+		}
+
+		kmm_setup_memory_region (map[i].baseLow, end - map[i].baseLow, false);
+	}
+
+	kmm_setup_memory_region (0, IDENTITY_MAP_END, true);
+	kmm_setup_memory_region (KERNEL_LOAD_PHYS,
+							 (uintptr_t) &kernel_end - (uintptr_t) &kernel_start,
+							 true);
+	kmm_setup_memory_region ((uintptr_t) VIRT_TO_PHYS (_kmm_bitmap),
+							 kmm_get_bitmap_size (), true);
+
+	/* the region calls count every frame they touch, overlaps included */
+	_kmm_used_blocks = 0;
+	for (uint32_t i = 0; i < max_frames; i++) {
+		if (bitmap_test (_kmm_bitmap, i)) {
+			_kmm_used_blocks++;
+		}
+	}
+
+}
+
+void* kmm_block_alloc (uint32_t order) {
+
+	uint32_t count = 1 << order;
+	uint32_t limit = _kmm_max_blocks;
+
+	for (uint32_t first = 0; first + count <= limit; first += count) {
+
+		/* large blocks are checked a word at a time */
+		bool free = true;
+		if (count >= BITSET_WORD_SIZE) {
+			for (uint32_t w = 0; free && w < count / BITSET_WORD_SIZE; w++) {
+				free = _kmm_bitmap[ first / BITSET_WORD_SIZE + w ] == 0;
+			}
+		} else {
+			for (uint32_t i = 0; free && i < count; i++) {
+				free = !bitmap_test (_kmm_bitmap, first + i);
+			}
+		}
+
+		if (!free) {
+			continue;
+		}
+
+		for (uint32_t i = 0; i < count; i++) {
+			bitmap_set (_kmm_bitmap, first + i);
+		}
+		_kmm_used_blocks += count;
+
+		return (void*) (first * _KMM_BLOCK_SIZE);
+	}
+
+	LOG_DEBUG ("no free block of order %u\n", order);
+	return NULL;
+
+}
+
+void kmm_block_free (void* phys_addr, uint32_t order) {
+
+	uintptr_t base = (uintptr_t) phys_addr;
+
+	for (uint32_t i = 0; i < (1u << order); i++) {
+		kmm_frame_free ((void*) (base + i * _KMM_BLOCK_SIZE));
+	}
+
+}
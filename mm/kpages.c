@@ -0,0 +1,141 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <mm/kheap.h>
+#include <mm/kmm.h>
+#include <mm/shrinker.h>
+#include <mm/vmm.h>
+#include <mm/vmalloc.h>
+#include <mem.h>
+#include <utils.h>
+
+#define LOG_MOD_NAME 	"KPG"
+#define LOG_MOD_ENABLE  1
+#include <log.h>
+
+/* Whole page allocations skip the buddy heap entirely. A single page is just a
+	frame seen through the physmap, larger runs are stitched together in the
+	vmalloc range, so neither needs physically contiguous memory and neither
+	carries a header that would push a 4KB request into an 8KB block. */
+
+/* Some helpful macros to help reduce verbosity */
+
+#define IN_HEAP(p) \
+	( (uintptr_t)(p) >= KERNEL_HEAP_VIRT && \
+	  (uintptr_t)(p) < KERNEL_HEAP_VIRT + KERNEL_HEAP_MAX_SIZE )
+
+#define IN_VMALLOC(p) \
+	( (uintptr_t)(p) >= VMALLOC_START && (uintptr_t)(p) < VMALLOC_END )
+
+/* Implementation private helper routines. */
+
+//! size of a block returned by kmalloc_pages, 0 if ptr is not one
+static size_t 	_kpages_size (void* ptr);
+
+/* Public functions of the interface */
+
+void* kmalloc_pages (uint32_t count) {
+
+	if (count == 0) {
+		return NULL;
+	}
+
+	if (count > 1) {
+		return vmalloc (count * VMM_PAGE_SIZE);
+	}
+
+	void* frame = reclaim_frame_alloc (0);
+	return frame ? PHYS_TO_VIRT (frame) : NULL;
+
+}
+
+void kfree_pages (void* ptr) {
+
+	if (!ptr) {
+		return;
+	}
+
+	if (!IS_ALIGNED (ptr, VMM_PAGE_SIZE)) {
+		LOG_ERROR ("kfree_pages of unaligned pointer %p\n", ptr);
+		return;
+	}
+
+	if (IN_VMALLOC (ptr)) {
+		vfree (ptr);
+	} else {
+		kmm_frame_free (VIRT_TO_PHYS (ptr));
+	}
+
+}
+
+void* kvmalloc (size_t size) {
+
+	if (size >= KMALLOC_PAGES_THRESHOLD) {
+		return kmalloc_pages (ALIGN_SIZE (size, VMM_PAGE_SIZE) / VMM_PAGE_SIZE);
+	}
+
+	return malloc (size);
+
+}
+
+void kvfree (void* ptr) {
+
+	if (!ptr) {
+		return;
+	}
+
+	if (IN_HEAP (ptr)) {
+		free (ptr);
+	} else {
+		kfree_pages (ptr);
+	}
+
+}
+
+void* kvrealloc (void* ptr, size_t old_size, size_t new_size) {
+
+	if (!ptr) {
+		return kvmalloc (new_size);
+	}
+
+	if (new_size == 0) {
+		kvfree (ptr);
+		return NULL;
+	}
+
+	/* small to small stays inside the buddy heap */
+	if (IN_HEAP (ptr) && new_size < KMALLOC_PAGES_THRESHOLD) {
+		return realloc (ptr, new_size);
+	}
+
+	/* a page block that is already large enough is kept as is */
+	size_t have = IN_HEAP (ptr) ? 0 : _kpages_size (ptr);
+	if (have >= new_size && new_size >= KMALLOC_PAGES_THRESHOLD) {
+		return ptr;
+	}
+
+	void* new_ptr = kvmalloc (new_size);
+	if (!new_ptr) {
+		return NULL;
+	}
+
+	memcpy (new_ptr, ptr, old_size < new_size ? old_size : new_size);
+	kvfree (ptr);
+
+	return new_ptr;
+
+}
+
+/* Private helpers */
+
+size_t _kpages_size (void* ptr) {
+
+	if (IN_VMALLOC (ptr)) {
+		vm_region_t* region = vmalloc_find (ptr);
+		return region ? region->size : 0;
+	}
+
+	return VMM_PAGE_SIZE;
+
+}
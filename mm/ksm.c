@@ -0,0 +1,437 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <mm/ksm.h>
+#include <mm/vma.h>
+#include <mm/frame.h>
+#include <mm/slab.h>
+#include <mm/pgtable.h>
+#include <mm/zeropage.h>
+#include <kernel/rbtree.h>
+#include <interrupts.h>
+#include <mem.h>
+#include <utils.h>
+
+#define LOG_MOD_NAME 	"KSM"
+#define LOG_MOD_ENABLE  1
+#include <log.h>
+
+/* Two trees keyed by a checksum of the page contents drive the merging. The
+	stable tree holds the merged frames, which are read-only and hold a
+	reference of the tree so that they stay put while a mapping comes and
+	goes. The unstable tree holds pages seen during the current pass that
+	have no twin yet. Their contents may change under the tree, so an entry
+	is only trusted after checking it again, and the tree is thrown away at
+	the end of every pass.
+
+	A page is only considered once its checksum, kept in the frame metadata,
+	is the same as on the previous pass. Pages written all the time are never
+	merged only to be copied again by the next write. */
+
+/* Some helpful macros to help reduce verbosity */
+
+#define ITEM(n) 		RB_ENTRY (ksm_item_t, n, node)
+
+/* Private types */
+
+/* A merged frame in the stable tree, or a candidate page in the unstable
+	tree */
+typedef struct _ksm_item {
+
+	rb_node_t 		node;		//! node in one of the trees
+	uint32_t 		hash;		//! checksum of the contents
+	void* 			frame;		//! merged frame, stable tree only
+	pagedir_t* 		pdir;		//! address space of a candidate
+	uintptr_t 		addr;		//! address of a candidate
+
+} ksm_item_t;
+
+/* Private variables */
+
+static rb_tree_t 			_stable;
+static rb_tree_t 			_unstable;
+static kmem_cache_t* 		_item_cache = NULL;
+
+static bool 				_ksm_on = KSM_DEFAULT_ENABLED;
+static ksm_stats_t 			_ksm_stats;
+
+//! checksum of a page of zeroes
+static uint32_t 			_zero_hash;
+
+//! position of the scanner
+static pagedir_t* 			_hand_pdir = NULL;
+static uintptr_t 			_hand_addr = 0;
+
+//! ticks since the scanner last ran, and the timer isr it runs in front of
+static uint32_t 			_ticks = 0;
+static interrupt_service_t 	_timer_next = NULL;
+
+/* Implementation private helper routines. */
+
+//! checksum of the contents of a frame
+static uint32_t 	_ksm_checksum (const void* data);
+
+//! orders items by checksum, and items with the same one by address
+static int 			_ksm_cmp (const rb_node_t* a, const rb_node_t* b);
+static int 			_ksm_key_cmp (const void* key, const rb_node_t* node);
+
+//! tries to merge the page behind a pte, returns true if it was replaced
+static bool 		_ksm_merge_page (pagedir_t* pdir, pte_t* pte, uintptr_t addr);
+
+//! checks that a candidate still maps a private frame holding data, returns
+//! its pte or NULL if it changed
+static pte_t* 		_ksm_candidate_pte (ksm_item_t* item, void* data);
+
+//! makes the page behind a pte read-only, copy on write if it was writable
+static void 		_ksm_protect (pagedir_t* pdir, pte_t* pte, uintptr_t addr);
+
+//! maps frame in place of the page behind a pte, read-only
+static void 		_ksm_replace (pagedir_t* pdir, pte_t* pte, uintptr_t addr,
+								  void* frame);
+
+//! drops the unstable tree and the merged frames nobody maps anymore
+static void 		_ksm_end_pass (void);
+
+//! runs the scanner every KSM_SCAN_INTERVAL ticks
+static void 		_ksm_timer (interrupt_context_t* context);
+
+/* Public functions of the interface */
+
+void ksm_init (void) {
+
+	_item_cache = kmem_cache_create ("ksm_item", sizeof(ksm_item_t), 0, NULL);
+	rb_init (&_stable, NULL);
+	rb_init (&_unstable, NULL);
+
+	if (zero_page_frame ()) {
+		_zero_hash = _ksm_checksum (PHYS_TO_VIRT (zero_page_frame ()));
+	}
+
+	if (get_interrupt_handler (IRQ0_TIMER) != _ksm_timer) {
+		_timer_next = get_interrupt_handler (IRQ0_TIMER);
+		register_interrupt_handler (IRQ0_TIMER, _ksm_timer);
+	}
+
+}
+
+void ksm_set_enabled (bool enabled) {
+
+	_ksm_on = enabled;
+
+}
+
+bool ksm_enabled (void) {
+
+	return _ksm_on;
+
+}
+
+uint32_t ksm_scan (uint32_t nr) {
+
+	if (!_item_cache) {
+		return 0;
+	}
+
+	pagedir_t* 	kdir 	= vmm_get_kerneldir ();
+	vm_space_t* space 	= vma_get_space (_hand_pdir, false);
+	uintptr_t 	addr 	= _hand_addr;
+	uint32_t 	merged 	= 0;
+
+	/* the space the hand was in may be gone, start over from the first */
+	if (!space) {
+		space = vma_next_space (NULL);
+		addr  = 0;
+	}
+
+	while (space && nr) {
+
+		vm_area_t* area = (space->pdir == kdir) ? NULL
+												: vma_find_next (space, addr);
+
+		/* past the last area, move on to the next address space. the pass is
+			over after the last one. */
+		if (!area) {
+			space = vma_next_space (space);
+			addr  = 0;
+			if (!space) {
+				_ksm_end_pass ();
+			}
+			continue;
+		}
+
+		if (addr < area->start) {
+			addr = area->start;
+		}
+
+		if (area->flags & VMA_SHARED) {
+			addr = area->end;
+			continue;
+		}
+
+		/* large pages are never merged */
+		pde_t pde = space->pdir->table[ VMM_DIR_INDEX (addr) ];
+		if (!PDE_IS_PRESENT (pde) || PDE_IS_4MB (pde)) {
+			addr = ALIGN_SIZE (addr + 1, PGTABLE_SPAN);
+			continue;
+		}
+
+		pte_t* pte = pgtable_get_pte (space->pdir, (void*) addr);
+		if (pte && _ksm_merge_page (space->pdir, pte, addr)) {
+			merged++;
+		}
+
+		_ksm_stats.scanned++;
+		addr += VMM_PAGE_SIZE;
+		nr--;
+	}
+
+	_hand_pdir = space ? space->pdir : NULL;
+	_hand_addr = addr;
+
+	return merged;
+
+}
+
+const ksm_stats_t* ksm_get_stats (void) {
+
+	/* every mapping of a merged frame but the first saved a frame, the tree
+		holds one reference of its own */
+	_ksm_stats.pages_shared  = 0;
+	_ksm_stats.pages_sharing = 0;
+
+	for (rb_node_t* n = rb_first (&_stable); n; n = rb_next (n)) {
+
+		uint32_t refs = frame_refcount (ITEM (n)->frame);
+		if (refs > 1) {
+			_ksm_stats.pages_shared++;
+			_ksm_stats.pages_sharing += refs - 2;
+		}
+	}
+
+	return &_ksm_stats;
+
+}
+
+void ksm_stats (void) {
+
+	const ksm_stats_t* stats = ksm_get_stats ();
+
+	printk ("ksm: %s, %u frames shared by %u more pages, %u zero pages\n",
+			_ksm_on ? "on" : "off", stats->pages_shared, stats->pages_sharing,
+			stats->zero_merges);
+	printk ("ksm: merges %u, scanned %u, full scans %u\n", stats->merges,
+			stats->scanned, stats->full_scans);
+
+}
+
+/* Private helpers */
+
+uint32_t _ksm_checksum (const void* data) {
+
+	/* fnv-1a over words, good enough to tell pages apart before comparing
+		them byte for byte */
+	const uint32_t* words = data;
+	uint32_t 		hash  = 2166136261u;
+
+	for (uint32_t i = 0; i < VMM_PAGE_SIZE / sizeof(uint32_t); i++) {
+		hash = (hash ^ words[i]) * 16777619u;
+	}
+
+	return hash;
+
+}
+
+int _ksm_cmp (const rb_node_t* a, const rb_node_t* b) {
+
+	uint32_t ha = ITEM (a)->hash;
+	uint32_t hb = ITEM (b)->hash;
+
+	if (ha != hb) {
+		return (ha > hb) - (ha < hb);
+	}
+
+	return (a > b) - (a < b);
+
+}
+
+int _ksm_key_cmp (const void* key, const rb_node_t* node) {
+
+	uint32_t hk = *(const uint32_t*) key;
+	uint32_t hn = ITEM (node)->hash;
+
+	return (hk > hn) - (hk < hn);
+
+}
+
+bool _ksm_merge_page (pagedir_t* pdir, pte_t* pte, uintptr_t addr) {
+
+	if (!PTE_IS_PRESENT (*pte) || !(*pte & PTE_USER)) {
+		return false;
+	}
+
+	/* merged frames, the zero page and anything shared is left alone */
+	void* 		  frame = (void*) PTE_FRAME_ADDR (*pte);
+	frame_meta_t* meta 	= frame_meta (frame);
+	if (!meta || frame_refcount (frame) > 1) {
+		return false;
+	}
+
+	void* 	 data = PHYS_TO_VIRT (frame);
+	uint32_t hash = _ksm_checksum (data);
+
+	if (meta->checksum != hash) {
+		meta->checksum = hash;
+		return false;
+	}
+
+	if (hash == _zero_hash && zero_page_frame () &&
+		memcmp (data, PHYS_TO_VIRT (zero_page_frame ()), VMM_PAGE_SIZE) == 0) {
+		_ksm_replace (pdir, pte, addr, zero_page_frame ());
+		_ksm_stats.zero_merges++;
+		return true;
+	}
+
+	rb_node_t* node = rb_find (&_stable, &hash, _ksm_key_cmp);
+	if (node) {
+
+		/* a different page with the same checksum is not merged */
+		if (memcmp (data, PHYS_TO_VIRT (ITEM (node)->frame), VMM_PAGE_SIZE)) {
+			return false;
+		}
+
+		_ksm_replace (pdir, pte, addr, ITEM (node)->frame);
+		_ksm_stats.merges++;
+		return true;
+	}
+
+	node = rb_find (&_unstable, &hash, _ksm_key_cmp);
+	if (!node) {
+
+		ksm_item_t* item = kmem_cache_alloc (_item_cache);
+		if (item) {
+			item->hash 	= hash;
+			item->frame = NULL;
+			item->pdir 	= pdir;
+			item->addr 	= addr;
+			rb_insert (&_unstable, &item->node, _ksm_cmp);
+		}
+		return false;
+	}
+
+	ksm_item_t* item  = ITEM (node);
+	pte_t* 		other = _ksm_candidate_pte (item, data);
+
+	/* the candidate went away or changed, this page takes its place */
+	if (!other || PTE_FRAME_ADDR (*other) == (uintptr_t) frame) {
+		item->pdir = pdir;
+		item->addr = addr;
+		return false;
+	}
+
+	/* the candidate's frame becomes the merged frame, held by the tree */
+	void* merged = (void*) PTE_FRAME_ADDR (*other);
+
+	rb_remove (&_unstable, &item->node);
+	_ksm_protect (item->pdir, other, item->addr);
+
+	frame_get (merged);
+	frame_meta (merged)->flags |= FRAME_KSM;
+
+	item->frame = merged;
+	rb_insert (&_stable, &item->node, _ksm_cmp);
+
+	_ksm_replace (pdir, pte, addr, merged);
+	_ksm_stats.merges++;
+
+	return true;
+
+}
+
+pte_t* _ksm_candidate_pte (ksm_item_t* item, void* data) {
+
+	/* the directory of a destroyed address space must not be touched */
+	if (!vma_get_space (item->pdir, false)) {
+		return NULL;
+	}
+
+	pte_t* pte = pgtable_get_pte (item->pdir, (void*) item->addr);
+	if (!pte || !PTE_IS_PRESENT (*pte) || !(*pte & PTE_USER)) {
+		return NULL;
+	}
+
+	void* frame = (void*) PTE_FRAME_ADDR (*pte);
+	if (frame_refcount (frame) > 1 ||
+		memcmp (PHYS_TO_VIRT (frame), data, VMM_PAGE_SIZE) != 0) {
+		return NULL;
+	}
+
+	return pte;
+
+}
+
+void _ksm_protect (pagedir_t* pdir, pte_t* pte, uintptr_t addr) {
+
+	if (*pte & PTE_WRITABLE) {
+		*pte = (*pte & ~PTE_WRITABLE) | PTE_COW;
+	}
+
+	if (pdir == vmm_get_current_pagedir ()) {
+		invlpg ((void*) addr);
+	}
+
+}
+
+void _ksm_replace (pagedir_t* pdir, pte_t* pte, uintptr_t addr, void* frame) {
+
+	void* 	 old   = (void*) PTE_FRAME_ADDR (*pte);
+	uint32_t flags = PTE_FLAGS (*pte) & (PTE_WRITABLE | PTE_USER);
+
+	frame_get (frame);
+	*pte = pte_create (frame, flags | PTE_PRESENT);
+	_ksm_protect (pdir, pte, addr);
+
+	frame_put (old);
+
+}
+
+void _ksm_end_pass (void) {
+
+	while (!rb_is_empty (&_unstable)) {
+		rb_node_t* node = _unstable.root;
+		rb_remove (&_unstable, node);
+		kmem_cache_free (_item_cache, ITEM (node));
+	}
+
+	/* a merged frame only the tree still holds goes back to the kmm */
+	rb_node_t* node = rb_first (&_stable);
+	while (node) {
+
+		rb_node_t*  next = rb_next (node);
+		ksm_item_t* item = ITEM (node);
+
+		if (frame_refcount (item->frame) == 1) {
+			frame_put (item->frame);
+			rb_remove (&_stable, node);
+			kmem_cache_free (_item_cache, item);
+		}
+
+		node = next;
+	}
+
+	_ksm_stats.full_scans++;
+
+}
+
+void _ksm_timer (interrupt_context_t* context) {
+
+	/* page tables are only rearranged when the timer interrupted user mode,
+		no kernel path can be halfway through changing them then */
+	if (_ksm_on && (context->cs & 3) == 3 && ++_ticks >= KSM_SCAN_INTERVAL) {
+		_ticks = 0;
+		ksm_scan (KSM_SCAN_PAGES);
+	}
+
+	_timer_next (context);
+
+}
@@ -0,0 +1,376 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <mm/kstack.h>
+#include <mm/fault.h>
+#include <mm/pgtable.h>
+#include <mm/shrinker.h>
+#include <mm/tlb.h>
+#include <init/gdt.h>
+#include <init/idt.h>
+#include <proc/tss.h>
+#include <utils.h>
+
+#define LOG_MOD_NAME 	"KST"
+#define LOG_MOD_ENABLE  1
+#include <log.h>
+
+/* A stack ends where its slot ends, so the pages between the start of the
+	slot and the stack are its guard. Stacks on a free list stay mapped and
+	link through their lowest word, a slot whose pages the shrinker took back
+	is empty and gets mapped again for whatever size is asked for next.
+
+	A thread that runs off the end of its stack faults on the guard while
+	pushing, and the cpu cannot push the frame of that page fault on the same
+	stack either, which makes it a double fault. The double fault goes
+	through a task gate to a task with a stack of its own, so it can still be
+	reported: the switch saved the state of the thread in the kernel TSS, and
+	cr2 holds the address that hit the guard. There is nothing to go back to,
+	the task stops the machine. The page fault handler only sees an access
+	that jumps past the end of the stack while the stack pointer is still
+	inside it. */
+
+/* Some helpful macros to help reduce verbosity */
+
+#define SLOT_INDEX(addr) 	(((uintptr_t) (addr) - KSTACK_AREA_START) / \
+								KSTACK_SLOT_SIZE)
+#define SLOT_END(index) 	(KSTACK_AREA_START + ((index) + 1) * KSTACK_SLOT_SIZE)
+
+//! lowest address of the stack in a slot
+#define SLOT_STACK(index, pages) \
+							(SLOT_END (index) - (pages) * VMM_PAGE_SIZE)
+
+//! raised when the cpu cannot deliver a fault
+#define DOUBLE_FAULT_INT 	8
+
+//! stack of the double fault task, enough to print the report
+#define DF_STACK_SIZE 		4096
+
+//! eflags of the double fault task, interrupts off and the reserved bit set
+#define DF_EFLAGS 			0x2
+
+/* Private variables */
+
+//! mapped pages of every slot, 0 for an empty slot
+static uint8_t 			_slot_pages[ KSTACK_MAX_SLOTS ];
+
+//! true for slots whose stack sits on a free list
+static bool 			_slot_cached[ KSTACK_MAX_SLOTS ];
+
+//! free lists by size in pages, linked through the stacks
+static uintptr_t 		_free_lists[ KSTACK_MAX_PAGES + 1 ];
+
+//! slots above this one were never used
+static uint32_t 		_next_slot = 0;
+
+static bool 			_kstack_ready = false;
+static kstack_stats_t 	_kstack_stats;
+static shrinker_t 		_kstack_shrinker;
+
+//! the double fault task
+static tss_t 			_df_tss;
+static uint8_t 			_df_stack[ DF_STACK_SIZE ] __attribute__((aligned(16)));
+
+/* Implementation private helper routines. */
+
+//! finds a slot without pages, -1 if the range is full
+static int32_t 		_kstack_empty_slot (void);
+
+//! maps the stack pages of a slot, returns false if frames ran out
+static bool 		_kstack_map (uint32_t slot, uint32_t pages);
+
+//! true if the address lies in the guard pages of a slot
+static bool 		_kstack_is_guard (uintptr_t addr);
+
+//! names the stack whose guard page was hit, never resolves the fault
+static int32_t 		_kstack_fault (uintptr_t addr, uint32_t error,
+								   interrupt_context_t* context);
+
+//! points the double fault at a task with its own stack
+static void 		_kstack_df_install (void);
+
+//! entry of the double fault task, reports the fault and stops
+static void 		_kstack_double_fault (void);
+
+//! shrinker callbacks, release the pages of cached stacks
+static uint32_t 	_kstack_shrink_count (void* priv);
+static uint32_t 	_kstack_shrink_scan (void* priv, uint32_t nr_to_scan);
+
+/* Public functions of the interface */
+
+void kstack_init (void) {
+
+	/* like vmalloc, every address space shares the tables of the range */
+	pagedir_t* kdir = vmm_get_kerneldir ();
+	for (uintptr_t addr = KSTACK_AREA_START; addr < KSTACK_AREA_END;
+		 addr += PGTABLE_SPAN) {
+		vmm_create_pt (kdir, (void*) addr, PTE_PRESENT | PTE_WRITABLE);
+	}
+
+	vmm_fault_register (_kstack_fault, FAULT_KIND_OTHER);
+	_kstack_df_install ();
+
+	strncpy (_kstack_shrinker.name, "kstack", sizeof(_kstack_shrinker.name));
+	_kstack_shrinker.count = _kstack_shrink_count;
+	_kstack_shrinker.scan  = _kstack_shrink_scan;
+	shrinker_register (&_kstack_shrinker);
+
+	_kstack_ready = true;
+
+}
+
+void* kstack_alloc (size_t size) {
+
+	uint32_t pages = ALIGN_SIZE (size, VMM_PAGE_SIZE) / VMM_PAGE_SIZE;
+
+	if (!_kstack_ready || pages == 0 || pages > KSTACK_MAX_PAGES) {
+		return NULL;
+	}
+
+	uintptr_t stack = _free_lists[pages];
+	if (stack) {
+		_free_lists[pages] = *(uintptr_t*) stack;
+		_slot_cached[ SLOT_INDEX (stack) ] = false;
+
+		_kstack_stats.cached--;
+		_kstack_stats.cache_hits++;
+	}
+	else {
+		int32_t slot = _kstack_empty_slot ();
+		if (slot < 0) {
+			LOG_ERROR ("no free slot for a kernel stack\n");
+			return NULL;
+		}
+
+		if (!_kstack_map (slot, pages)) {
+			return NULL;
+		}
+		stack = SLOT_STACK (slot, pages);
+	}
+
+	_kstack_stats.allocs++;
+	_kstack_stats.in_use++;
+
+	return (void*) stack;
+
+}
+
+void kstack_free (void* stack) {
+
+	if (!stack) {
+		return;
+	}
+
+	uint32_t slot  = SLOT_INDEX (stack);
+	uint32_t pages = kstack_owns (stack) ? _slot_pages[slot] : 0;
+
+	if (!pages || (uintptr_t) stack != SLOT_STACK (slot, pages) ||
+		_slot_cached[slot]) {
+		LOG_ERROR ("freeing %p which is not a kernel stack in use\n", stack);
+		return;
+	}
+
+	/* the exiting thread may still be running on it, the next owner only
+		starts using it after a switch */
+	*(uintptr_t*) stack = _free_lists[pages];
+	_free_lists[pages] 	= (uintptr_t) stack;
+	_slot_cached[slot] 	= true;
+
+	_kstack_stats.frees++;
+	_kstack_stats.in_use--;
+	_kstack_stats.cached++;
+
+}
+
+bool kstack_owns (const void* addr) {
+
+	return (uintptr_t) addr >= KSTACK_AREA_START &&
+		   (uintptr_t) addr < KSTACK_AREA_END;
+
+}
+
+const kstack_stats_t* kstack_get_stats (void) {
+
+	return &_kstack_stats;
+
+}
+
+void kstack_stats (void) {
+
+	const kstack_stats_t* s = &_kstack_stats;
+
+	printk ("kstack: %u in use, %u cached, %u allocs (%u from cache), "
+			"%u frees\n", s->in_use, s->cached, s->allocs, s->cache_hits,
+			s->frees);
+	printk ("kstack: %u pages reclaimed, %u guard page faults\n",
+			s->reclaimed, s->guard_hits);
+
+}
+
+/* Private helpers */
+
+int32_t _kstack_empty_slot (void) {
+
+	if (_next_slot < KSTACK_MAX_SLOTS) {
+		return _next_slot++;
+	}
+
+	/* all slots were used once, look for one the shrinker emptied */
+	for (uint32_t i = 0; i < KSTACK_MAX_SLOTS; i++) {
+		if (!_slot_pages[i]) {
+			return i;
+		}
+	}
+
+	return -1;
+
+}
+
+bool _kstack_map (uint32_t slot, uint32_t pages) {
+
+	pagedir_t* kdir  = vmm_get_kerneldir ();
+	uintptr_t  stack = SLOT_STACK (slot, pages);
+
+	for (uint32_t i = 0; i < pages; i++) {
+
+		void* frame = reclaim_frame_alloc (0);
+		if (!frame) {
+			LOG_ERROR ("out of frames for a kernel stack\n");
+			pgtable_unmap_range (kdir, stack, i * VMM_PAGE_SIZE);
+			return false;
+		}
+
+		vmm_map_page (kdir, (void*) (stack + i * VMM_PAGE_SIZE), frame,
+					  KERNEL_PTE_FLAGS);
+	}
+
+	_slot_pages[slot] = pages;
+	return true;
+
+}
+
+bool _kstack_is_guard (uintptr_t addr) {
+
+	if (!kstack_owns ((void*) addr)) {
+		return false;
+	}
+
+	uint32_t slot = SLOT_INDEX (addr);
+	return addr < SLOT_STACK (slot, _slot_pages[slot]);
+
+}
+
+int32_t _kstack_fault (uintptr_t addr, uint32_t error,
+					   interrupt_context_t* context) {
+
+	if (_kstack_is_guard (addr)) {
+		_kstack_stats.guard_hits++;
+		LOG_ERROR ("kernel stack overflow, %x hit the guard of slot %u "
+				   "(eip %x)\n", addr, SLOT_INDEX (addr), context->eip);
+	}
+
+	return -1;
+
+}
+
+void _kstack_df_install (void) {
+
+	memset (&_df_tss, 0, sizeof(tss_t));
+
+	/* the task runs in the kernel space of the moment the stacks were set
+		up, which every address space shares */
+	_df_tss.eip 		= (uint32_t) _kstack_double_fault;
+	_df_tss.esp 		= (uint32_t) &_df_stack[ DF_STACK_SIZE ];
+	_df_tss.eflags 		= DF_EFLAGS;
+	_df_tss.cr3 		= read_cr3 ();
+	_df_tss.cs 			= GDT_KERNEL_CODE_SEL;
+	_df_tss.ss 			= GDT_KERNEL_DATA_SEL;
+	_df_tss.ds 			= _df_tss.es = _df_tss.fs = _df_tss.gs = GDT_KERNEL_DATA_SEL;
+	_df_tss.iomap_base 	= sizeof(tss_t);
+
+	idt_entry_t* idt 	= (idt_entry_t*) get_idt_ptr ()->base;
+	idt_entry_t* gate 	= &idt[ DOUBLE_FAULT_INT ];
+
+	gate->offset_low 	 = 0;
+	gate->offset_high 	 = 0;
+	gate->zero 			 = 0;
+	gate->selector 		 = gdt_set_task_tss (&_df_tss);
+	gate->gate_type_attr = IDT_ATTR_PRESENT | IDT_ATTR_DPL0 | IDT_GATE_TYPE_TASK;
+
+}
+
+void _kstack_double_fault (void) {
+
+	/* the switch stored the faulting thread in the kernel TSS */
+	tss_t* 	  tss  = tss_get_global ();
+	uintptr_t addr = read_cr2 ();
+
+	uintptr_t hit  = _kstack_is_guard (addr) ? addr : tss->esp;
+
+	if (_kstack_is_guard (hit)) {
+		_kstack_stats.guard_hits++;
+		LOG_ERROR ("kernel stack overflow, %x hit the guard of slot %u "
+				   "(eip %x, esp %x)\n", hit, SLOT_INDEX (hit), tss->eip,
+				   tss->esp);
+	}
+	else {
+		LOG_ERROR ("double fault at eip %x, esp %x, cr2 %x\n", tss->eip,
+				   tss->esp, addr);
+	}
+
+	while (1) {
+		asm volatile ("cli; hlt");
+	}
+
+}
+
+uint32_t _kstack_shrink_count (void* priv) {
+
+	uint32_t pages = 0;
+
+	for (uint32_t n = 1; n <= KSTACK_MAX_PAGES; n++) {
+		for (uintptr_t s = _free_lists[n]; s; s = *(uintptr_t*) s) {
+			pages += n;
+		}
+	}
+
+	return pages;
+
+}
+
+uint32_t _kstack_shrink_scan (void* priv, uint32_t nr_to_scan) {
+
+	pagedir_t* kdir 	= vmm_get_kerneldir ();
+	uintptr_t  esp 		= (uintptr_t) &kdir;
+	uint32_t   released = 0;
+
+	for (uint32_t n = 1; n <= KSTACK_MAX_PAGES && released < nr_to_scan; n++) {
+
+		uintptr_t* link = &_free_lists[n];
+		while (*link && released < nr_to_scan) {
+
+			uintptr_t stack = *link;
+
+			/* a thread that freed its own stack runs on it until it is
+				switched out */
+			if (esp >= stack && esp < stack + n * VMM_PAGE_SIZE) {
+				link = (uintptr_t*) stack;
+				continue;
+			}
+
+			*link = *(uintptr_t*) stack;
+
+			uint32_t slot = SLOT_INDEX (stack);
+			_slot_pages[slot]  = 0;
+			_slot_cached[slot] = false;
+			_kstack_stats.cached--;
+
+			released += pgtable_unmap_range (kdir, stack, n * VMM_PAGE_SIZE);
+		}
+	}
+
+	_kstack_stats.reclaimed += released;
+	return released;
+
+}
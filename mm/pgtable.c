@@ -0,0 +1,251 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#include <mm/pgtable.h>
+#include <mm/frame.h>
+#include <mm/tlb.h>
+#include <mm/hugepage.h>
+#include <mm/fixmap.h>
+#include <mm/swap.h>
+#include <mm/zeropage.h>
+#include <mm/vma.h>
+#include <mem.h>
+#include <utils.h>
+
+/* The prebuilt vmm keeps its vmm_create_pt as a weak symbol, so the version
+	here serves vmm_map_page as well. It counts every table it adds to the
+	user half of an address space, the tables of the kernel half are shared
+	by all of them. */
+
+//! the original vmm_create_pt of the vmm object
+extern void 	_vmm_create_pt_prebuilt (pagedir_t* pdir, void* virtual,
+										 uint32_t flags);
+
+/* Implementation private helper routines. */
+
+//! clears the pte of a page and drops its frame, without touching the tlb.
+//! returns true for a present page, a dropped swap entry is counted in swapped
+static bool 	_pgtable_clear (pagedir_t* pdir, void* virtual,
+								uint32_t* swapped);
+
+/* Public functions of the interface */
+
+void vmm_create_pt (pagedir_t* pdir, void* virtual, uint32_t flags) {
+
+	pde_t* pde 	 = &pdir->table[ VMM_DIR_INDEX (virtual) ];
+	bool   fresh = !PDE_IS_PRESENT (*pde);
+
+	_vmm_create_pt_prebuilt (pdir, virtual, flags);
+
+	if (fresh && PDE_IS_PRESENT (*pde) && (uintptr_t) virtual < PHYSMAP_BASE &&
+		pdir != vmm_get_kerneldir ()) {
+		vma_charge_tables (pdir, 1);
+	}
+
+}
+
+pagetable_t* pgtable_get_table (pagedir_t* pdir, void* virtual) {
+
+	if (!pdir) {
+		return NULL;
+	}
+
+	/* the tables of the current address space sit at fixed addresses */
+	if (fixmap_recursive_ready () && pdir == vmm_get_current_pagedir ()) {
+
+		pde_t pde = RECURSIVE_PD->table[ VMM_DIR_INDEX (virtual) ];
+		if (!PDE_IS_PRESENT (pde) || PDE_IS_4MB (pde)) {
+			return NULL;
+		}
+
+		return RECURSIVE_PT (virtual);
+	}
+
+	pde_t pde = pdir->table[ VMM_DIR_INDEX (virtual) ];
+	if (!PDE_IS_PRESENT (pde) || PDE_IS_4MB (pde)) {
+		return NULL;
+	}
+
+	/* other page tables are reached through the physmap like every other
+		frame */
+	return (pagetable_t*) PHYS_TO_VIRT (PDE_PTABLE_ADDR (pde));
+
+}
+
+pte_t* pgtable_get_pte (pagedir_t* pdir, void* virtual) {
+
+	pagetable_t* table = pgtable_get_table (pdir, virtual);
+	if (!table) {
+		return NULL;
+	}
+
+	return &table->table[ VMM_TABLE_INDEX (virtual) ];
+
+}
+
+bool pgtable_unmap_page (pagedir_t* pdir, void* virtual) {
+
+	/* a single page of a large page takes a table of its own */
+	if (hugepage_split (pdir, (uintptr_t) virtual) != 0) {
+		return false;
+	}
+
+	uint32_t swapped = 0;
+	bool 	 cleared = _pgtable_clear (pdir, virtual, &swapped);
+
+	if ((uintptr_t) virtual < PHYSMAP_BASE) {
+		vma_charge (pdir, -(int32_t) cleared, -(int32_t) swapped);
+	}
+
+	if (!cleared) {
+		return false;
+	}
+
+	invlpg (virtual);
+	return true;
+
+}
+
+uint32_t pgtable_unmap_range (pagedir_t* pdir, uintptr_t start, size_t size) {
+
+	tlb_batch_t batch;
+	uint32_t 	unmapped = 0;
+	uint32_t 	swapped  = 0;
+
+	tlb_batch_init (&batch);
+
+	uintptr_t page = start;
+	while (page < start + size) {
+
+		/* large pages go away whole if the range covers them, otherwise they
+			are split and unmapped page by page */
+		if (PDE_IS_HUGE (pdir->table[ VMM_DIR_INDEX (page) ]) &&
+			page < PHYSMAP_BASE) {
+
+			if (!PSE_PAGE_OFFSET (page) && start + size - page >= PSE_PAGE_SIZE) {
+				hugepage_release (pdir, page);
+				tlb_batch_add (&batch, page);
+				unmapped += VMM_PAGES_PER_TABLE;
+				page 	 += PSE_PAGE_SIZE;
+				continue;
+			}
+
+			if (hugepage_split (pdir, page) != 0) {
+				page = ALIGN_SIZE (page + 1, PSE_PAGE_SIZE);
+				continue;
+			}
+		}
+
+		if (_pgtable_clear (pdir, (void*) page, &swapped)) {
+			tlb_batch_add (&batch, page);
+			unmapped++;
+		}
+		page += VMM_PAGE_SIZE;
+	}
+
+	/* stale user entries of another address space are dropped by the cr3
+		load that switches to it, only the live ones need invalidating */
+	if (pdir == vmm_get_current_pagedir () || start >= PHYSMAP_BASE) {
+		tlb_batch_flush (&batch);
+	}
+
+	if (start < PHYSMAP_BASE) {
+		vma_charge (pdir, -(int32_t) unmapped, -(int32_t) swapped);
+	}
+
+	return unmapped;
+
+}
+
+uint32_t pgtable_protect_range (pagedir_t* pdir, uintptr_t start, size_t size,
+								uint32_t flags) {
+
+	tlb_batch_t batch;
+	uint32_t 	changed = 0;
+
+	flags &= PTE_WRITABLE | PTE_USER;
+	tlb_batch_init (&batch);
+
+	uintptr_t page = start;
+	while (page < start + size) {
+
+		pde_t* pde = &pdir->table[ VMM_DIR_INDEX (page) ];
+
+		/* a large page keeps one protection, so only a whole one can change
+			without being split */
+		if (PDE_IS_HUGE (*pde) && page < PHYSMAP_BASE) {
+
+			if (!PSE_PAGE_OFFSET (page) && start + size - page >= PSE_PAGE_SIZE) {
+				*pde = (*pde & ~(PDE_WRITABLE | PDE_USER)) | flags;
+				tlb_batch_add (&batch, page);
+				changed += VMM_PAGES_PER_TABLE;
+				page 	+= PSE_PAGE_SIZE;
+				continue;
+			}
+
+			if (hugepage_split (pdir, page) != 0) {
+				page = ALIGN_SIZE (page + 1, PSE_PAGE_SIZE);
+				continue;
+			}
+		}
+
+		pte_t* pte = pgtable_get_pte (pdir, (void*) page);
+		if (pte && PTE_IS_PRESENT (*pte)) {
+
+			pte_t new_pte = (*pte & ~(PTE_WRITABLE | PTE_USER)) | flags;
+
+			/* the zero page is only ever written through a copy */
+			if ((new_pte & PTE_WRITABLE) &&
+				zero_page_is ((void*) PTE_FRAME_ADDR (new_pte))) {
+				new_pte |= PTE_COW;
+			}
+
+			/* shared pages become writable through their cow fault */
+			if (new_pte & PTE_COW) {
+				new_pte &= ~PTE_WRITABLE;
+			}
+
+			if (new_pte != *pte) {
+				*pte = new_pte;
+				tlb_batch_add (&batch, page);
+				changed++;
+			}
+		}
+		else if (pte && PTE_IS_SWAP (*pte)) {
+			/* the page gets the new protection when it is read back */
+			*pte = (*pte & ~(PTE_WRITABLE | PTE_USER)) | flags;
+			changed++;
+		}
+		page += VMM_PAGE_SIZE;
+	}
+
+	if (pdir == vmm_get_current_pagedir () || start >= PHYSMAP_BASE) {
+		tlb_batch_flush (&batch);
+	}
+
+	return changed;
+
+}
+
+/* Private helpers */
+
+bool _pgtable_clear (pagedir_t* pdir, void* virtual, uint32_t* swapped) {
+
+	pte_t* pte = pgtable_get_pte (pdir, virtual);
+	if (pte && PTE_IS_SWAP (*pte)) {
+		swap_free_entry (*pte);
+		*pte = 0;
+		(*swapped)++;
+		return false;
+	}
+
+	if (!pte || !PTE_IS_PRESENT (*pte)) {
+		return false;
+	}
+
+	frame_put ((void*) PTE_FRAME_ADDR (*pte));
+	*pte = 0;
+
+	return true;
+
+}
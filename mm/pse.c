@@ -0,0 +1,158 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#include <mm/pse.h>
+#include <mm/highmem.h>
+#include <mm/hugepage.h>
+#include <mm/pgtable.h>
+#include <mm/frame.h>
+#include <mm/kmm.h>
+#include <mm/tlb.h>
+#include <mem.h>
+#include <utils.h>
+
+#define LOG_MOD_NAME 	"PSE"
+#define LOG_MOD_ENABLE  1
+#include <log.h>
+
+/* The vmm is linked with its own vmm_get_phys_frame renamed out of the way
+	to _vmm_get_phys_frame_pt, the version here handles large entries and
+	uses the page table walkers for the rest. vmm_get_phys_addr also returns
+	the frames of large pages above 4GB, which vmm_get_phys_frame first
+	moves below since its pointer cannot hold them. */
+
+/* Some helpful macros to help reduce verbosity */
+
+//! cpuid leaf 1 edx bit for 4MB pages
+#define CPUID_EDX_PSE 		(1 << 3)
+
+/* Private variables */
+
+static bool 		_pse_enabled = false;
+static pse_stats_t 	_pse_stats;
+
+/* Public functions of the interface */
+
+void pse_init (void) {
+
+	uint32_t eax, ebx, ecx, edx;
+	cpuid (1, &eax, &ebx, &ecx, &edx);
+
+	if (!(edx & CPUID_EDX_PSE)) {
+		LOG_DEBUG ("cpu has no 4MB pages\n");
+		return;
+	}
+
+	write_cr4 (read_cr4 () | CR4_PSE);
+	_pse_enabled = true;
+
+	/* the vmm maps all of memory linearly, only the tail of it can end in a
+		partially filled table which stays as it is */
+	pagedir_t* kdir = vmm_get_kerneldir ();
+	uintptr_t  end  = PHYSMAP_BASE + kmm_get_total_frames () * VMM_PAGE_SIZE;
+
+	if (end > PHYSMAP_BASE + PHYSMAP_MAX_SIZE) {
+		end = PHYSMAP_BASE + PHYSMAP_MAX_SIZE;
+	}
+
+	for (uintptr_t virt = PHYSMAP_BASE; virt < end; virt += PSE_PAGE_SIZE) {
+		pse_collapse_linear (kdir, virt);
+	}
+
+	/* both translations point at the same frames, so running on the old
+		ones until here is harmless */
+	tlb_flush_all ();
+
+	LOG_DEBUG ("physmap uses %u large pages\n", _pse_stats.kernel_pdes);
+
+}
+
+bool pse_enabled (void) {
+
+	return _pse_enabled;
+
+}
+
+bool pse_collapse_linear (pagedir_t* pdir, uintptr_t virt) {
+
+	if (!_pse_enabled || PSE_PAGE_OFFSET (virt)) {
+		return false;
+	}
+
+	pagetable_t* table = pgtable_get_table (pdir, (void*) virt);
+	if (!table) {
+		return false;
+	}
+
+	uintptr_t base  = PTE_FRAME_ADDR (table->table[0]);
+	uint32_t  flags = PTE_FLAGS (table->table[0]) & (PTE_WRITABLE | PTE_USER);
+
+	if (PSE_PAGE_OFFSET (base)) {
+		return false;
+	}
+
+	for (uint32_t i = 0; i < VMM_PAGES_PER_TABLE; i++) {
+
+		pte_t pte = table->table[i];
+		if (!PTE_IS_PRESENT (pte) ||
+			PTE_FRAME_ADDR (pte) != base + i * VMM_PAGE_SIZE ||
+			(PTE_FLAGS (pte) & (PTE_WRITABLE | PTE_USER)) != flags) {
+			return false;
+		}
+	}
+
+	pde_t* pde = &pdir->table[ VMM_DIR_INDEX (virt) ];
+	*pde = base | flags | PDE_PRESENT | PDE_SIZE_4MB;
+
+	frame_put ((void*) VIRT_TO_PHYS (table));
+
+	if (virt >= PHYSMAP_BASE) {
+		_pse_stats.kernel_pdes++;
+	}
+	_pse_stats.tables_freed++;
+
+	return true;
+
+}
+
+void* vmm_get_phys_frame (pagedir_t* pdir, void* virtual) {
+
+	if (!pdir || !virtual) {
+		return NULL;
+	}
+
+	if (hugepage_migrate_low (pdir, (uintptr_t) virtual) != 0) {
+		return NULL;
+	}
+
+	return (void*) (uintptr_t) vmm_get_phys_addr (pdir, virtual);
+
+}
+
+uint64_t vmm_get_phys_addr (pagedir_t* pdir, void* virtual) {
+
+	if (!pdir || !virtual) {
+		return 0;
+	}
+
+	pde_t pde = pdir->table[ VMM_DIR_INDEX (virtual) ];
+	if (PDE_IS_PRESENT (pde) && PDE_IS_4MB (pde)) {
+		return highmem_pde_addr (pde) +
+			   (PSE_PAGE_OFFSET (virtual) & ~VMM_PAGE_OFFSET_MASK);
+	}
+
+	/* the current space is walked through its recursive mapping */
+	pte_t* pte = pgtable_get_pte (pdir, virtual);
+	if (!pte || !PTE_IS_PRESENT (*pte)) {
+		return 0;
+	}
+
+	return PTE_FRAME_ADDR (*pte);
+
+}
+
+const pse_stats_t* pse_get_stats (void) {
+
+	return &_pse_stats;
+
+}
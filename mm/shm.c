@@ -0,0 +1,387 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <mm/shm.h>
+#include <mm/vma.h>
+#include <mm/frame.h>
+#include <mm/pgtable.h>
+#include <mm/shrinker.h>
+#include <mm/kheap.h>
+#include <init/syscall.h>
+#include <interrupts.h>
+#include <mem.h>
+#include <utils.h>
+
+#define LOG_MOD_NAME 	"SHM"
+#define LOG_MOD_ENABLE  1
+#include <log.h>
+
+/* An attachment is an area of the address space flagged VMA_SHARED whose
+	backing points at the segment. The areas are copied on fork and dropped
+	on exit like any other, so the attachment counts follow them through
+	shm_clone_space and shm_release_space. The swap scanner and the copy on
+	write code leave shared areas alone. */
+
+/* Some helpful macros to help reduce verbosity */
+
+#define SEG_PAGES(seg) 		((seg)->size / VMM_PAGE_SIZE)
+
+/* Private variables */
+
+static shm_segment_t 		_segments[ SHM_MAX_SEGMENTS ];
+static shm_stats_t 			_shm_stats;
+
+//! the syscall isr that was installed before ours
+static interrupt_service_t 	_syscall_next = NULL;
+
+/* Implementation private helper routines. */
+
+//! returns the segment backing an area, NULL if it is not an attachment
+static shm_segment_t* 	_shm_area_segment (vm_area_t* area);
+
+//! finds a free range for size bytes in the shm window
+static uintptr_t 		_shm_find_range (vm_space_t* space, size_t size);
+
+//! turns the copy on write pages of a cloned attachment back into writable
+//! shared pages
+static void 			_shm_share_pages (pagedir_t* pdir, vm_area_t* area);
+
+//! drops an attachment, freeing the segment with the last one
+static void 			_shm_put (shm_segment_t* seg);
+
+//! gives the frames of a segment back and empties its slot
+static void 			_shm_free (shm_segment_t* seg);
+
+//! serves the shm syscalls and passes every other one on
+static void 			_shm_syscall (interrupt_context_t* context);
+
+/* Public functions of the interface */
+
+void shm_init (void) {
+
+	if (get_interrupt_handler (ISR128_SYSCALL) != _shm_syscall) {
+		_syscall_next = get_interrupt_handler (ISR128_SYSCALL);
+		register_interrupt_handler (ISR128_SYSCALL, _shm_syscall);
+	}
+
+}
+
+int32_t shm_create (pagedir_t* pdir, uint32_t key, size_t size) {
+
+	if (size == 0 || size > SHM_MAX_SIZE) {
+		return -1;
+	}
+
+	size = ALIGN_SIZE (size, VMM_PAGE_SIZE);
+
+	int32_t  id    = -1;
+	uint32_t owned = 0;
+	for (int32_t i = 0; i < SHM_MAX_SEGMENTS; i++) {
+
+		shm_segment_t* seg = &_segments[i];
+
+		/* an existing segment is handed out if it is large enough */
+		if (seg->used && !seg->removed && key != SHM_KEY_PRIVATE &&
+			seg->key == key) {
+			return (size <= seg->size) ? i : -1;
+		}
+
+		if (seg->used && pdir && seg->owner == pdir) {
+			owned++;
+		}
+
+		if (!seg->used && id < 0) {
+			id = i;
+		}
+	}
+
+	if (owned >= SHM_MAX_PER_SPACE) {
+		return -1;
+	}
+
+	if (id < 0) {
+		LOG_ERROR ("out of shared memory segments\n");
+		return -1;
+	}
+
+	shm_segment_t* seg = &_segments[id];
+	seg->frames = malloc ((size / VMM_PAGE_SIZE) * sizeof(void*));
+	if (!seg->frames) {
+		return -1;
+	}
+
+	for (uint32_t i = 0; i < size / VMM_PAGE_SIZE; i++) {
+
+		seg->frames[i] = reclaim_frame_alloc (0);
+		if (!seg->frames[i]) {
+			LOG_ERROR ("out of memory creating a segment of %x bytes\n", size);
+			while (i--) {
+				frame_put (seg->frames[i]);
+			}
+			free (seg->frames);
+			return -1;
+		}
+
+		memset (PHYS_TO_VIRT (seg->frames[i]), 0, VMM_PAGE_SIZE);
+	}
+
+	seg->used 	 = true;
+	seg->removed = false;
+	seg->key 	 = key;
+	seg->owner 	 = pdir;
+	seg->size 	 = size;
+	seg->nattch  = 0;
+
+	_shm_stats.segments++;
+	_shm_stats.pages += size / VMM_PAGE_SIZE;
+
+	return id;
+
+}
+
+int32_t shm_remove (pagedir_t* pdir, int32_t id) {
+
+	if (id < 0 || id >= SHM_MAX_SEGMENTS || !_segments[id].used ||
+		_segments[id].removed) {
+		return -1;
+	}
+
+	shm_segment_t* seg = &_segments[id];
+	if (pdir && seg->owner && seg->owner != pdir) {
+		return -1;
+	}
+
+	seg->removed = true;
+	if (seg->nattch == 0) {
+		_shm_free (seg);
+	}
+
+	return 0;
+
+}
+
+void* shm_attach (pagedir_t* pdir, int32_t id, void* addr) {
+
+	if (!pdir || pdir == vmm_get_kerneldir () || id < 0 ||
+		id >= SHM_MAX_SEGMENTS || !_segments[id].used ||
+		_segments[id].removed) {
+		return NULL;
+	}
+
+	shm_segment_t* seg 	 = &_segments[id];
+	vm_space_t*    space = vma_get_space (pdir, true);
+	uintptr_t 	   start = (uintptr_t) addr;
+
+	if (!space) {
+		return NULL;
+	}
+
+	if (!start) {
+		start = _shm_find_range (space, seg->size);
+	}
+
+	if (!start || !IS_ALIGNED (start, VMM_PAGE_SIZE) ||
+		start + seg->size < start || start + seg->size > PHYSMAP_BASE) {
+		return NULL;
+	}
+
+	if (!vma_insert (space, start, seg->size, SHM_PAGE_FLAGS,
+					 VMA_MMAP | VMA_SHARED, seg, 0)) {
+		return NULL;
+	}
+
+	/* every attachment maps the segment's own frames */
+	for (uint32_t i = 0; i < SEG_PAGES (seg); i++) {
+		frame_get (seg->frames[i]);
+		vmm_map_page (pdir, (void*) (start + i * VMM_PAGE_SIZE), seg->frames[i],
+					  SHM_PAGE_FLAGS);
+	}
+
+	vma_charge (pdir, SEG_PAGES (seg), 0);
+	seg->nattch++;
+	_shm_stats.attaches++;
+
+	return (void*) start;
+
+}
+
+int32_t shm_detach (pagedir_t* pdir, void* addr) {
+
+	vm_space_t* 	space = vma_get_space (pdir, false);
+	vm_area_t* 		area  = vma_find (space, (uintptr_t) addr);
+	shm_segment_t* 	seg   = _shm_area_segment (area);
+
+	if (!seg || area->start != (uintptr_t) addr) {
+		return -1;
+	}
+
+	pgtable_unmap_range (pdir, area->start, area->end - area->start);
+	vma_remove (space, area);
+	_shm_put (seg);
+
+	return 0;
+
+}
+
+void shm_clone_space (pagedir_t* src, pagedir_t* dst) {
+
+	vm_space_t* space = vma_get_space (dst, false);
+	if (!space) {
+		return;
+	}
+
+	for (vm_area_t* area = vma_find_next (space, 0); area;
+		 area = vma_find_next (space, area->end)) {
+
+		shm_segment_t* seg = _shm_area_segment (area);
+		if (!seg) {
+			continue;
+		}
+
+		/* the clone shared the pages copy on write, make them plain shared
+			pages again on both sides */
+		_shm_share_pages (src, area);
+		_shm_share_pages (dst, area);
+
+		seg->nattch++;
+		_shm_stats.attaches++;
+	}
+
+}
+
+void shm_release_space (pagedir_t* pdir) {
+
+	vm_space_t* space = vma_get_space (pdir, false);
+
+	/* the mappings themselves go away with the page tables */
+	for (vm_area_t* area = space ? vma_find_next (space, 0) : NULL; area;
+		 area = vma_find_next (space, area->end)) {
+
+		shm_segment_t* seg = _shm_area_segment (area);
+		if (seg) {
+			area->backing = NULL;
+			_shm_put (seg);
+		}
+	}
+
+	/* the segments it created outlive it only while they are attached */
+	for (int32_t i = 0; pdir && i < SHM_MAX_SEGMENTS; i++) {
+
+		shm_segment_t* seg = &_segments[i];
+		if (!seg->used || seg->owner != pdir) {
+			continue;
+		}
+
+		if (seg->nattch == 0) {
+			_shm_free (seg);
+		}
+		else {
+			seg->owner = NULL;
+		}
+	}
+
+}
+
+const shm_stats_t* shm_get_stats (void) {
+
+	return &_shm_stats;
+
+}
+
+/* Private helpers */
+
+shm_segment_t* _shm_area_segment (vm_area_t* area) {
+
+	if (!area || !(area->flags & VMA_SHARED)) {
+		return NULL;
+	}
+
+	shm_segment_t* seg = area->backing;
+	if (seg < _segments || seg >= _segments + SHM_MAX_SEGMENTS || !seg->used) {
+		return NULL;
+	}
+
+	return seg;
+
+}
+
+uintptr_t _shm_find_range (vm_space_t* space, size_t size) {
+
+	uintptr_t start = USER_SHM_BASE;
+
+	while (start + size <= USER_SHM_END) {
+
+		vm_area_t* next = vma_find_next (space, start);
+		if (!next || next->start >= start + size) {
+			return start;
+		}
+
+		start = next->end;
+	}
+
+	return 0;
+
+}
+
+void _shm_share_pages (pagedir_t* pdir, vm_area_t* area) {
+
+	for (uintptr_t page = area->start; page < area->end; page += VMM_PAGE_SIZE) {
+
+		pte_t* pte = pgtable_get_pte (pdir, (void*) page);
+		if (pte && PTE_IS_PRESENT (*pte)) {
+			*pte = (*pte & ~PTE_COW) | PTE_WRITABLE;
+		}
+	}
+
+}
+
+void _shm_put (shm_segment_t* seg) {
+
+	_shm_stats.detaches++;
+
+	if (--seg->nattch == 0) {
+		_shm_free (seg);
+	}
+
+}
+
+void _shm_free (shm_segment_t* seg) {
+
+	/* each attachment drops its own frame references when its pages are
+		unmapped, this is the reference of the segment itself */
+	for (uint32_t i = 0; i < SEG_PAGES (seg); i++) {
+		frame_put (seg->frames[i]);
+	}
+
+	_shm_stats.segments--;
+	_shm_stats.pages -= SEG_PAGES (seg);
+
+	free (seg->frames);
+	memset (seg, 0, sizeof(shm_segment_t));
+
+}
+
+void _shm_syscall (interrupt_context_t* context) {
+
+	pagedir_t* pdir = vmm_get_current_pagedir ();
+
+	/* shmget(key, size), shmat(id, addr), shmdt(addr) and shmrm(id) */
+	if (context->eax == SYSCALL_SHMGET) {
+		context->eax = shm_create (pdir, context->ebx, context->ecx);
+	}
+	else if (context->eax == SYSCALL_SHMAT) {
+		void* addr 	 = shm_attach (pdir, context->ebx, (void*) context->ecx);
+		context->eax = addr ? (uint32_t) addr : (uint32_t) -1;
+	}
+	else if (context->eax == SYSCALL_SHMDT) {
+		context->eax = shm_detach (pdir, (void*) context->ebx);
+	}
+	else if (context->eax == SYSCALL_SHMRM) {
+		context->eax = shm_remove (pdir, context->ebx);
+	}
+	else {
+		_syscall_next (context);
+	}
+
+}
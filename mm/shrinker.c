@@ -0,0 +1,218 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <mm/shrinker.h>
+#include <mm/kmm.h>
+#include <utils.h>
+
+#define LOG_MOD_NAME 	"SHR"
+#define LOG_MOD_ENABLE  1
+#include <log.h>
+
+/* The physical memory manager ships as a prebuilt object, so reclaim cannot
+	be wired into kmm_frame_alloc itself. Instead every allocator that takes
+	frames for a cache (slab, vmalloc, whole pages, heap growth) goes through
+	reclaim_frame_alloc, which checks the watermark before asking the kmm and
+	runs the shrinkers again if the kmm comes back empty handed. */
+
+/* Some helpful macros to help reduce verbosity */
+
+#define FREE_FRAMES() 	(kmm_get_total_frames () - kmm_get_used_frames ())
+
+/* Private variables */
+
+//! registered shrinkers, run in registration order
+static list_t 			_shrinkers;
+
+static uint32_t 		_low_wmark 	= SHRINKER_LOW_WATERMARK;
+static uint32_t 		_high_wmark = SHRINKER_HIGH_WATERMARK;
+
+static reclaim_stats_t 	_stats;
+
+//! set while the shrinkers are running. a shrinker may itself need a frame,
+//! and that allocation must not recurse into reclaim.
+static bool 			_in_reclaim = false;
+
+/* Implementation private helper routines. */
+
+//! true if the shrinker may run under the given reclaim flags
+static bool 	_shrinker_allowed (shrinker_t* shrinker, uint32_t flags);
+
+/* Public functions of the interface */
+
+int32_t shrinker_register (shrinker_t* shrinker) {
+
+	if (!shrinker || !shrinker->count || !shrinker->scan) {
+		LOG_ERROR ("invalid shrinker specified for register\n");
+		return -1;
+	}
+
+	shrinker->name[SHRINKER_NAME_LEN - 1] = '\0';
+	shrinker->calls 	= 0;
+	shrinker->reclaimed = 0;
+	shrinker->link.next = NULL;
+	shrinker->link.prev = NULL;
+
+	list_append (&_shrinkers, &shrinker->link);
+	return 0;
+
+}
+
+void shrinker_unregister (shrinker_t* shrinker) {
+
+	if (!shrinker) {
+		return;
+	}
+
+	list_remove (&_shrinkers, &shrinker->link);
+
+}
+
+int32_t shrinker_set_watermarks (uint32_t low, uint32_t high) {
+
+	if (high < low) {
+		LOG_ERROR ("high watermark %u below low watermark %u\n", high, low);
+		return -1;
+	}
+
+	_low_wmark 	= low;
+	_high_wmark = high;
+
+	return 0;
+
+}
+
+void shrinker_get_watermarks (uint32_t* low, uint32_t* high) {
+
+	if (low) {
+		*low = _low_wmark;
+	}
+
+	if (high) {
+		*high = _high_wmark;
+	}
+
+}
+
+uint32_t shrink_memory (uint32_t nr_pages, uint32_t flags) {
+
+	if (_in_reclaim || nr_pages == 0) {
+		return 0;
+	}
+
+	_in_reclaim = true;
+
+	uint32_t released = 0;
+	for (list_element_t* e = list_head (&_shrinkers);
+		 e && released < nr_pages; e = list_next (e)) {
+
+		shrinker_t* shrinker = LIST_ENTRY (shrinker_t, e, link);
+		if (!_shrinker_allowed (shrinker, flags)) {
+			continue;
+		}
+
+		uint32_t freeable = shrinker->count (shrinker->priv);
+		if (freeable == 0) {
+			continue;
+		}
+
+		uint32_t want = nr_pages - released;
+		uint32_t got  = shrinker->scan (shrinker->priv,
+										freeable < want ? freeable : want);
+
+		shrinker->calls++;
+		shrinker->reclaimed += got;
+		released 			+= got;
+	}
+
+	_stats.pages_reclaimed += released;
+	_in_reclaim = false;
+
+	if (released) {
+		LOG_DEBUG ("reclaimed %u of %u requested pages\n", released, nr_pages);
+	}
+
+	return released;
+
+}
+
+void* reclaim_frame_alloc (uint32_t flags) {
+
+	if (flags & RECLAIM_NORECLAIM) {
+		return kmm_frame_alloc ();
+	}
+
+	/* background style reclaim, bring free memory back up to the high
+		watermark before it runs out completely */
+	uint32_t avail = FREE_FRAMES ();
+	if (avail < _low_wmark && !_in_reclaim) {
+		_stats.low_wmark_hits++;
+		shrink_memory (_high_wmark - avail, flags);
+	}
+
+	void* frame = kmm_frame_alloc ();
+	if (frame || _in_reclaim) {
+		return frame;
+	}
+
+	/* direct reclaim, the last chance before the allocation fails */
+	_stats.direct_reclaims++;
+	if (shrink_memory (_high_wmark ? _high_wmark : 1, flags)) {
+		frame = kmm_frame_alloc ();
+	}
+
+	if (frame) {
+		_stats.direct_rescues++;
+	} else {
+		_stats.alloc_failures++;
+	}
+
+	return frame;
+
+}
+
+void* kmm_frame_alloc_reclaim (void) {
+
+	return reclaim_frame_alloc (RECLAIM_NOHEAP);
+
+}
+
+const reclaim_stats_t* reclaim_get_stats (void) {
+
+	return &_stats;
+
+}
+
+void shrinker_stats (void) {
+
+	printk ("free %u frames, watermarks low %u high %u\n", FREE_FRAMES (),
+			_low_wmark, _high_wmark);
+	printk ("low hits %u, direct %u (rescued %u, failed %u), reclaimed %u\n",
+			_stats.low_wmark_hits, _stats.direct_reclaims,
+			_stats.direct_rescues, _stats.alloc_failures,
+			_stats.pages_reclaimed);
+
+	printk ("%-16s %8s %6s %9s\n", "shrinker", "freeable", "calls",
+			"reclaimed");
+
+	for (list_element_t* e = list_head (&_shrinkers); e; e = list_next (e)) {
+		shrinker_t* shrinker = LIST_ENTRY (shrinker_t, e, link);
+		printk ("%-16s %8u %6u %9u\n", shrinker->name,
+				shrinker->count (shrinker->priv), shrinker->calls,
+				shrinker->reclaimed);
+	}
+
+}
+
+/* Private helpers */
+
+bool _shrinker_allowed (shrinker_t* shrinker, uint32_t flags) {
+
+	if ((flags & RECLAIM_NOHEAP) && (shrinker->flags & SHRINKER_USES_HEAP)) {
+		return false;
+	}
+
+	return true;
+
+}
@@ -0,0 +1,429 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <mm/slab.h>
+#include <mm/kmm.h>
+#include <mm/shrinker.h>
+#include <mem.h>
+#include <utils.h>
+
+#define LOG_MOD_NAME 	"SLB"
+#define LOG_MOD_ENABLE  1
+#include <log.h>
+
+/* Some helpful macros to help reduce verbosity */
+
+//! the slab header always lives at the start of the page holding the object
+#define OBJ_TO_SLAB(obj) \
+	( (kmem_slab_t*) ((uintptr_t)(obj) & ~(KMEM_SLAB_SIZE - 1)) )
+
+//! frame number of a slab page, slabs are always in the physmap
+#define SLAB_FRAME(slab) \
+	( (uint32_t) ((uintptr_t) VIRT_TO_PHYS (slab) / KMEM_SLAB_SIZE) )
+
+//! address of the i-th object slot in a slab
+#define SLAB_OBJ(cache, slab, i) \
+	( (void*) ((uintptr_t)(slab) + (cache)->first_offset + (i) * (cache)->slot_size) )
+
+/* Private variables */
+
+//! the cache from which all other cache descriptors are allocated. it is set
+//! up by hand during init since it cannot allocate its own descriptor.
+static kmem_cache_t 	_cache_cache;
+
+//! list of every cache in the system, used for stats and reclaim
+static list_t 			_cache_list;
+
+//! set once kmem_cache_init has run
+static bool 			_slab_ready = false;
+
+//! gives the free slabs of every cache back under memory pressure
+static shrinker_t 		_slab_shrinker;
+
+//! one bit for every frame of the physmap, set while the frame is a slab
+static uint32_t 		_slab_frames[ PHYSMAP_MAX_SIZE / KMEM_SLAB_SIZE / 32 ];
+
+/* Implementation private helper routines. */
+
+//! fills in a cache descriptor, returns false if the object cannot fit a slab
+static bool 		_kmem_cache_setup (kmem_cache_t* cache, const char* name,
+									   size_t size, size_t align,
+									   kmem_ctor_t ctor);
+
+//! gets a new page from the kmm and carves it into objects
+static kmem_slab_t* _kmem_slab_grow (kmem_cache_t* cache);
+
+//! gives the page of a completely free slab back to the kmm
+static void 		_kmem_slab_release (kmem_cache_t* cache, kmem_slab_t* slab);
+
+//! shrinker callbacks, count and release free slabs across all caches
+static uint32_t 	_kmem_shrink_count (void* priv);
+static uint32_t 	_kmem_shrink_scan (void* priv, uint32_t nr_to_scan);
+
+/* Public functions of the interface */
+
+void kmem_cache_init (void) {
+
+	list_init (&_cache_list);
+
+	_kmem_cache_setup (&_cache_cache, "kmem_cache", sizeof(kmem_cache_t),
+					   0, NULL);
+	list_append (&_cache_list, &_cache_cache.cache_link);
+
+	_slab_ready = true;
+
+	strncpy (_slab_shrinker.name, "slab", sizeof(_slab_shrinker.name));
+	_slab_shrinker.count = _kmem_shrink_count;
+	_slab_shrinker.scan  = _kmem_shrink_scan;
+	shrinker_register (&_slab_shrinker);
+
+	LOG_DEBUG ("slab allocator initialized, %u caches per slab\n",
+				_cache_cache.objs_per_slab);
+
+}
+
+kmem_cache_t* kmem_cache_create (const char* name, size_t size, size_t align,
+								 kmem_ctor_t ctor) {
+
+	if (!_slab_ready) {
+		LOG_ERROR ("cache %s created before the slab allocator init\n", name);
+		return NULL;
+	}
+
+	kmem_cache_t* cache = kmem_cache_alloc (&_cache_cache);
+	if (!cache) {
+		LOG_ERROR ("failed to allocate descriptor for cache %s\n", name);
+		return NULL;
+	}
+
+	if (!_kmem_cache_setup (cache, name, size, align, ctor)) {
+		LOG_ERROR ("object size %u (align %u) too large for cache %s\n",
+					size, align, name);
+		kmem_cache_free (&_cache_cache, cache);
+		return NULL;
+	}
+
+	list_append (&_cache_list, &cache->cache_link);
+
+	LOG_DEBUG ("created cache %s: size=%u, slot=%u, objs/slab=%u\n", name,
+				size, cache->slot_size, cache->objs_per_slab);
+
+	return cache;
+
+}
+
+int32_t kmem_cache_destroy (kmem_cache_t* cache) {
+
+	if (!cache || cache == &_cache_cache) {
+		LOG_ERROR ("invalid cache specified for destroy\n");
+		return -1;
+	}
+
+	if (cache->num_active) {
+		LOG_ERROR ("cache %s still has %u objects in use\n", cache->name,
+					cache->num_active);
+		return -1;
+	}
+
+	/* no active objects means all the slabs are on the free list */
+	kmem_cache_shrink (cache);
+
+	list_remove (&_cache_list, &cache->cache_link);
+	kmem_cache_free (&_cache_cache, cache);
+
+	return 0;
+
+}
+
+void* kmem_cache_alloc (kmem_cache_t* cache) {
+
+	if (!cache) {
+		return NULL;
+	}
+
+	/* prefer partially used slabs to keep the number of slabs low, fall back to
+		a free slab and only then ask for a new page */
+	kmem_slab_t* slab = NULL;
+	list_t* 	 from = NULL;
+
+	if (!list_is_empty (&cache->slabs_partial)) {
+		from = &cache->slabs_partial;
+	}
+	else if (!list_is_empty (&cache->slabs_free)) {
+		from = &cache->slabs_free;
+	}
+	else if (_kmem_slab_grow (cache)) {
+		from = &cache->slabs_free;
+	}
+	else {
+		LOG_ERROR ("out of memory growing cache %s\n", cache->name);
+		return NULL;
+	}
+
+	slab = LIST_ENTRY (kmem_slab_t, list_head (from), link);
+
+	/* pop the first free object */
+	void* obj 		= slab->free_list;
+	slab->free_list = *(void**) obj;
+	slab->in_use++;
+
+	/* move the slab to the list matching its new state */
+	list_t* to = (slab->in_use == cache->objs_per_slab) ? &cache->slabs_full
+														: &cache->slabs_partial;
+	if (to != from) {
+		list_remove (from, &slab->link);
+		list_append (to, &slab->link);
+	}
+
+	cache->num_active++;
+	cache->total_allocs++;
+
+	/* the link word overwrote the first word of a constructed object */
+	if (cache->ctor) {
+		cache->ctor (obj);
+	}
+
+	return obj;
+
+}
+
+void kmem_cache_free (kmem_cache_t* cache, void* obj) {
+
+	if (!cache || !obj) {
+		return;
+	}
+
+	kmem_slab_t* slab = OBJ_TO_SLAB (obj);
+	uintptr_t 	 offs = (uintptr_t) obj - (uintptr_t) slab;
+
+	if (slab->magic != KMEM_SLAB_MAGIC || slab->cache != cache) {
+		LOG_ERROR ("object %p does not belong to cache %s\n", obj, cache->name);
+		return;
+	}
+
+	if (offs < cache->first_offset ||
+		(offs - cache->first_offset) % cache->slot_size != 0 ||
+		(offs - cache->first_offset) / cache->slot_size >= cache->objs_per_slab) {
+		LOG_ERROR ("invalid object %p freed to cache %s\n", obj, cache->name);
+		return;
+	}
+
+	if (slab->in_use == 0) {
+		LOG_ERROR ("double free of object %p in cache %s\n", obj, cache->name);
+		return;
+	}
+
+	list_t* from = (slab->in_use == cache->objs_per_slab) ? &cache->slabs_full
+														  : &cache->slabs_partial;
+
+	*(void**) obj 	= slab->free_list;
+	slab->free_list = obj;
+	slab->in_use--;
+
+	list_t* to = (slab->in_use == 0) ? &cache->slabs_free
+									 : &cache->slabs_partial;
+	if (to != from) {
+		list_remove (from, &slab->link);
+		list_append (to, &slab->link);
+	}
+
+	cache->num_active--;
+	cache->total_frees++;
+
+	/* keep a small number of free slabs around to absorb alloc/free bursts,
+		anything beyond that goes back to the physical memory manager */
+	if (list_size (&cache->slabs_free) > KMEM_FREE_SLABS_MAX) {
+		_kmem_slab_release (cache, slab);
+	}
+
+}
+
+kmem_cache_t* kmem_cache_of (const void* obj) {
+
+	/* slabs are physmap pages, anything outside of it is no object */
+	uintptr_t addr = (uintptr_t) obj;
+	if (addr < PHYSMAP_BASE || addr - PHYSMAP_BASE >= PHYSMAP_MAX_SIZE) {
+		return NULL;
+	}
+
+	kmem_slab_t* slab  = OBJ_TO_SLAB (obj);
+	uint32_t 	 frame = SLAB_FRAME (slab);
+
+	if (!(_slab_frames[frame / 32] & (1u << (frame % 32)))) {
+		return NULL;
+	}
+
+	return slab->cache;
+
+}
+
+uint32_t kmem_cache_shrink (kmem_cache_t* cache) {
+
+	if (!cache) {
+		return 0;
+	}
+
+	uint32_t released = 0;
+	while (!list_is_empty (&cache->slabs_free)) {
+		kmem_slab_t* slab = LIST_ENTRY (kmem_slab_t,
+										list_head (&cache->slabs_free), link);
+		_kmem_slab_release (cache, slab);
+		released++;
+	}
+
+	return released;
+
+}
+
+uint32_t kmem_cache_reap (void) {
+
+	uint32_t released = 0;
+
+	for (list_element_t* e = list_head (&_cache_list); e; e = list_next (e)) {
+		released += kmem_cache_shrink (LIST_ENTRY (kmem_cache_t, e, cache_link));
+	}
+
+	return released;
+
+}
+
+void kmem_cache_stats (void) {
+
+	printk ("%-16s %6s %6s %8s %6s %5s\n", "cache", "size", "active",
+			"total", "slabs", "util");
+
+	for (list_element_t* e = list_head (&_cache_list); e; e = list_next (e)) {
+
+		kmem_cache_t* cache = LIST_ENTRY (kmem_cache_t, e, cache_link);
+		uint32_t total 		= cache->num_slabs * cache->objs_per_slab;
+		uint32_t util 		= total ? (cache->num_active * 100) / total : 0;
+
+		printk ("%-16s %6u %6u %8u %6u %4u%%\n", cache->name, cache->obj_size,
+				cache->num_active, total, cache->num_slabs, util);
+	}
+
+}
+
+/* Private helpers */
+
+bool _kmem_cache_setup (kmem_cache_t* cache, const char* name, size_t size,
+						size_t align, kmem_ctor_t ctor) {
+
+	if (align < KMEM_MIN_ALIGN) {
+		align = KMEM_MIN_ALIGN;
+	}
+
+	/* alignment must be a power of two for the ALIGN macros to hold */
+	if (size == 0 || (align & (align - 1)) != 0) {
+		return false;
+	}
+
+	memset (cache, 0, sizeof(kmem_cache_t));
+	strncpy (cache->name, name ? name : "anon", sizeof(cache->name));
+	cache->name[sizeof(cache->name) - 1] = '\0';
+
+	cache->obj_size 	= size;
+	cache->slot_size 	= ALIGN_SIZE (size, align);
+	cache->first_offset = ALIGN_SIZE (sizeof(kmem_slab_t), align);
+	cache->ctor 		= ctor;
+
+	if (cache->first_offset >= KMEM_SLAB_SIZE) {
+		return false;
+	}
+
+	cache->objs_per_slab = (KMEM_SLAB_SIZE - cache->first_offset) /
+							cache->slot_size;
+	if (cache->objs_per_slab == 0) {
+		return false;
+	}
+
+	list_init (&cache->slabs_full);
+	list_init (&cache->slabs_partial);
+	list_init (&cache->slabs_free);
+
+	return true;
+
+}
+
+kmem_slab_t* _kmem_slab_grow (kmem_cache_t* cache) {
+
+	void* frame = reclaim_frame_alloc (0);
+	if (!frame) {
+		return NULL;
+	}
+
+	/* all physical memory is reachable through the physmap, so the slab page
+		needs no mapping of its own and is visible in every address space */
+	kmem_slab_t* slab = PHYS_TO_VIRT (frame);
+
+	slab->link.next = NULL;
+	slab->link.prev = NULL;
+	slab->cache 	= cache;
+	slab->in_use 	= 0;
+	slab->magic 	= KMEM_SLAB_MAGIC;
+
+	/* chain the objects in address order so that allocations walk the page
+		sequentially */
+	slab->free_list = NULL;
+	for (uint32_t i = cache->objs_per_slab; i > 0; i--) {
+		void* obj 		= SLAB_OBJ (cache, slab, i - 1);
+		*(void**) obj 	= slab->free_list;
+		slab->free_list = obj;
+	}
+
+	list_append (&cache->slabs_free, &slab->link);
+	cache->num_slabs++;
+
+	uint32_t n = SLAB_FRAME (slab);
+	_slab_frames[n / 32] |= 1u << (n % 32);
+
+	return slab;
+
+}
+
+void _kmem_slab_release (kmem_cache_t* cache, kmem_slab_t* slab) {
+
+	list_remove (&cache->slabs_free, &slab->link);
+	slab->magic = 0;
+
+	uint32_t n = SLAB_FRAME (slab);
+	_slab_frames[n / 32] &= ~(1u << (n % 32));
+
+	kmm_frame_free (VIRT_TO_PHYS (slab));
+
+	cache->num_slabs--;
+	cache->slabs_reclaimed++;
+
+}
+
+uint32_t _kmem_shrink_count (void* priv) {
+
+	uint32_t freeable = 0;
+
+	for (list_element_t* e = list_head (&_cache_list); e; e = list_next (e)) {
+		freeable += list_size (&LIST_ENTRY (kmem_cache_t, e, cache_link)->slabs_free);
+	}
+
+	return freeable;
+
+}
+
+uint32_t _kmem_shrink_scan (void* priv, uint32_t nr_to_scan) {
+
+	uint32_t released = 0;
+
+	for (list_element_t* e = list_head (&_cache_list);
+		 e && released < nr_to_scan; e = list_next (e)) {
+
+		kmem_cache_t* cache = LIST_ENTRY (kmem_cache_t, e, cache_link);
+		while (released < nr_to_scan && !list_is_empty (&cache->slabs_free)) {
+			_kmem_slab_release (cache, LIST_ENTRY (kmem_slab_t,
+								list_head (&cache->slabs_free), link));
+			released++;
+		}
+	}
+
+	return released;
+
+}
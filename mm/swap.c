@@ -0,0 +1,464 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <mm/swap.h>
+#include <mm/vma.h>
+#include <mm/frame.h>
+#include <mm/fault.h>
+#include <mm/pgtable.h>
+#include <mm/shrinker.h>
+#include <mm/kheap.h>
+#include <driver/block.h>
+#include <mem.h>
+#include <utils.h>
+
+#define LOG_MOD_NAME 	"SWP"
+#define LOG_MOD_ENABLE  1
+#include <log.h>
+
+/* The swap area is an array of page sized slots, each with a count of the
+	swap entries pointing at it. A slot is freed as soon as its page is read
+	back, so a page lives either in memory or in swap, never in both.
+
+	The clock hand is kept as an address space and an address, and moves
+	through the areas of each space in address order. A page whose accessed
+	bit is set has the bit cleared and is passed over, so only pages left
+	untouched for a whole sweep are written out. Shared pages are skipped,
+	their other mappings would have to be found and updated as well. */
+
+/* Private variables */
+
+static block_device_t* 	_swap_dev = NULL;
+
+//! references on each slot, 0 for a free slot
+static uint16_t* 		_swap_map = NULL;
+
+//! blocks of the swap device per page
+static uint32_t 		_swap_blocks_per_page = 0;
+
+//! slot the next allocation starts searching from
+static uint32_t 		_swap_next_slot = 0;
+
+static uint32_t 		_swappiness = SWAP_DEFAULT_SWAPPINESS;
+static swap_stats_t 	_swap_stats;
+
+//! position of the clock hand
+static pagedir_t* 		_hand_pdir = NULL;
+static uintptr_t 		_hand_addr = 0;
+
+//! evicts user pages when the other caches have nothing left to give back
+static shrinker_t 		_swap_shrinker;
+
+/* Implementation private helper routines. */
+
+//! finds a free slot and takes a reference on it, -1 if the area is full
+static int32_t 	_swap_alloc_slot (void);
+
+//! drops a reference on a slot
+static void 	_swap_put_slot (uint32_t slot);
+
+//! reads or writes the page of a slot through the block device
+static int32_t 	_swap_io (uint32_t slot, void* page, bool write);
+
+//! looks at the page behind a pte, returns true if it was written out
+static bool 	_swap_evict (pagedir_t* pdir, pte_t* pte, uintptr_t addr);
+
+//! page fault handler for pages that were written out
+static int32_t 	_swap_fault (uintptr_t addr, uint32_t error,
+							 interrupt_context_t* context);
+
+//! shrinker callbacks, count the free slots and evict user pages
+static uint32_t _swap_shrink_count (void* priv);
+static uint32_t _swap_shrink_scan (void* priv, uint32_t nr_to_scan);
+
+/* Public functions of the interface */
+
+void swap_init (void) {
+
+	vmm_fault_register (_swap_fault, FAULT_KIND_SWAP);
+
+	/* registered last, the caches are cheaper to shrink than a disk write */
+	strncpy (_swap_shrinker.name, "swap", sizeof(_swap_shrinker.name));
+	_swap_shrinker.count = _swap_shrink_count;
+	_swap_shrinker.scan  = _swap_shrink_scan;
+	shrinker_register (&_swap_shrinker);
+
+}
+
+int32_t swap_on (const char* dev_name) {
+
+	if (_swap_dev) {
+		LOG_ERROR ("swap is already on %s\n", _swap_dev->name);
+		return -1;
+	}
+
+	block_device_t* dev = blkdev_get_by_name (dev_name);
+	if (!dev || !dev->block_size || VMM_PAGE_SIZE % dev->block_size) {
+		LOG_ERROR ("%s cannot hold a swap area\n", dev_name);
+		return -1;
+	}
+
+	uint32_t per_page = VMM_PAGE_SIZE / dev->block_size;
+	uint32_t slots 	  = dev->num_blocks / per_page;
+
+	/* slot numbers have to fit the frame bits of a pte */
+	if (slots > (PTE_FRAME_MASK >> 12)) {
+		slots = PTE_FRAME_MASK >> 12;
+	}
+
+	if (slots == 0) {
+		LOG_ERROR ("%s is too small for a swap area\n", dev_name);
+		return -1;
+	}
+
+	_swap_map = malloc (slots * sizeof(uint16_t));
+	if (!_swap_map) {
+		LOG_ERROR ("no memory for the map of %u swap slots\n", slots);
+		return -1;
+	}
+
+	memset (_swap_map, 0, slots * sizeof(uint16_t));
+
+	_swap_blocks_per_page = per_page;
+	_swap_stats.slots 	  = slots;
+	_swap_dev 			  = dev;
+
+	LOG_P ("swap on %s, %u slots (%u KB)\n", dev_name, slots,
+			slots * (VMM_PAGE_SIZE / 1024));
+
+	return 0;
+
+}
+
+bool swap_enabled (void) {
+
+	return _swap_dev != NULL;
+
+}
+
+uint32_t swap_out (uint32_t nr) {
+
+	if (!_swap_dev || nr == 0) {
+		return 0;
+	}
+
+	pagedir_t* 	kdir 	= vmm_get_kerneldir ();
+	vm_space_t* space 	= vma_get_space (_hand_pdir, false);
+	uintptr_t 	addr 	= _hand_addr;
+	uint32_t 	evicted = 0;
+	uint32_t 	budget 	= SWAP_SCAN_MAX;
+
+	/* the space the hand was in may be gone, start over from the first */
+	if (!space) {
+		space = vma_next_space (NULL);
+		addr  = 0;
+	}
+
+	while (space && budget && evicted < nr &&
+		   _swap_stats.used < _swap_stats.slots) {
+
+		vm_area_t* area = (space->pdir == kdir) ? NULL
+												: vma_find_next (space, addr);
+
+		/* past the last area, move on to the next address space */
+		if (!area) {
+			space = vma_next_space (space);
+			if (!space) {
+				space = vma_next_space (NULL);
+			}
+			addr = 0;
+			budget--;
+			continue;
+		}
+
+		if (addr < area->start) {
+			addr = area->start;
+		}
+
+		if (area->flags & VMA_SHARED) {
+			addr = area->end;
+			continue;
+		}
+
+		/* large pages and holes in the page tables are skipped a table at a
+			time */
+		pde_t pde = space->pdir->table[ VMM_DIR_INDEX (addr) ];
+		if (!PDE_IS_PRESENT (pde) || PDE_IS_4MB (pde)) {
+			addr = ALIGN_SIZE (addr + 1, PGTABLE_SPAN);
+			budget--;
+			continue;
+		}
+
+		pte_t* pte = pgtable_get_pte (space->pdir, (void*) addr);
+		if (pte && _swap_evict (space->pdir, pte, addr)) {
+			evicted++;
+		}
+
+		_swap_stats.scanned++;
+		addr += VMM_PAGE_SIZE;
+		budget--;
+	}
+
+	_hand_pdir = space ? space->pdir : NULL;
+	_hand_addr = addr;
+
+	return evicted;
+
+}
+
+int32_t swap_set_swappiness (uint32_t swappiness) {
+
+	if (swappiness > SWAP_MAX_SWAPPINESS) {
+		return -1;
+	}
+
+	_swappiness = swappiness;
+	return 0;
+
+}
+
+uint32_t swap_get_swappiness (void) {
+
+	return _swappiness;
+
+}
+
+void swap_dup_entry (pte_t pte) {
+
+	if (!PTE_IS_SWAP (pte) || SWAP_SLOT (pte) >= _swap_stats.slots) {
+		return;
+	}
+
+	_swap_map[ SWAP_SLOT (pte) ]++;
+
+}
+
+void swap_free_entry (pte_t pte) {
+
+	if (!PTE_IS_SWAP (pte) || SWAP_SLOT (pte) >= _swap_stats.slots) {
+		return;
+	}
+
+	_swap_put_slot (SWAP_SLOT (pte));
+
+}
+
+void swap_release_space (pagedir_t* pdir) {
+
+	pagedir_t* kdir = vmm_get_kerneldir ();
+
+	if (!_swap_dev || !pdir || pdir == kdir) {
+		return;
+	}
+
+	for (uint32_t i = 0; i < VMM_DIR_INDEX (PHYSMAP_BASE); i++) {
+
+		pde_t pde = pdir->table[i];
+		if (!PDE_IS_PRESENT (pde) || PDE_IS_4MB (pde) || pde == kdir->table[i]) {
+			continue;
+		}
+
+		pagetable_t* table = pgtable_get_table (pdir, (void*) (i * PGTABLE_SPAN));
+		for (uint32_t j = 0; j < VMM_PAGES_PER_TABLE; j++) {
+			if (PTE_IS_SWAP (table->table[j])) {
+				swap_free_entry (table->table[j]);
+				table->table[j] = 0;
+			}
+		}
+	}
+
+}
+
+const swap_stats_t* swap_get_stats (void) {
+
+	return &_swap_stats;
+
+}
+
+void swap_stats (void) {
+
+	printk ("swap: %s, %u of %u slots used, swappiness %u\n",
+			_swap_dev ? _swap_dev->name : "off", _swap_stats.used,
+			_swap_stats.slots, _swappiness);
+	printk ("swap: ins %u, outs %u, scanned %u, failures %u\n",
+			_swap_stats.swap_ins, _swap_stats.swap_outs, _swap_stats.scanned,
+			_swap_stats.failures);
+
+}
+
+/* Private helpers */
+
+int32_t _swap_alloc_slot (void) {
+
+	for (uint32_t i = 0; i < _swap_stats.slots; i++) {
+
+		uint32_t slot = (_swap_next_slot + i) % _swap_stats.slots;
+		if (_swap_map[slot] == 0) {
+			_swap_map[slot] = 1;
+			_swap_next_slot = slot + 1;
+			_swap_stats.used++;
+			return slot;
+		}
+	}
+
+	return -1;
+
+}
+
+void _swap_put_slot (uint32_t slot) {
+
+	if (_swap_map[slot] == 0) {
+		LOG_ERROR ("swap slot %u freed twice\n", slot);
+		return;
+	}
+
+	if (--_swap_map[slot] == 0) {
+		_swap_stats.used--;
+	}
+
+}
+
+int32_t _swap_io (uint32_t slot, void* page, bool write) {
+
+	block_lba_t lba = slot * _swap_blocks_per_page;
+
+	for (uint32_t i = 0; i < _swap_blocks_per_page; i++) {
+
+		uint8_t* block = (uint8_t*) page + i * _swap_dev->block_size;
+		int32_t  ret   = write ? blkwrite (_swap_dev, lba + i, block)
+							   : blkread (_swap_dev, lba + i, block);
+		if (ret < 0) {
+			return -1;
+		}
+	}
+
+	return 0;
+
+}
+
+bool _swap_evict (pagedir_t* pdir, pte_t* pte, uintptr_t addr) {
+
+	bool current = (pdir == vmm_get_current_pagedir ());
+
+	if (!PTE_IS_PRESENT (*pte)) {
+		return false;
+	}
+
+	/* second chance for pages used since the hand last came by */
+	if (*pte & PTE_ACCESSED) {
+		*pte &= ~PTE_ACCESSED;
+		if (current) {
+			invlpg ((void*) addr);
+		}
+		return false;
+	}
+
+	void* frame = (void*) PTE_FRAME_ADDR (*pte);
+	if ((*pte & PTE_COW) || frame_refcount (frame) > 1) {
+		return false;
+	}
+
+	int32_t slot = _swap_alloc_slot ();
+	if (slot < 0) {
+		return false;
+	}
+
+	/* the write may be preempted, a page touched while it is on the way to
+		disk keeps its frame and the copy is thrown away */
+	*pte &= ~PTE_DIRTY;
+	if (current) {
+		invlpg ((void*) addr);
+	}
+
+	if (_swap_io (slot, PHYS_TO_VIRT (frame), true) != 0) {
+		LOG_ERROR ("write of swap slot %u failed\n", slot);
+		_swap_put_slot (slot);
+		_swap_stats.failures++;
+		return false;
+	}
+
+	if (*pte & (PTE_ACCESSED | PTE_DIRTY)) {
+		_swap_put_slot (slot);
+		return false;
+	}
+
+	*pte = SWAP_ENTRY ((uint32_t) slot, PTE_FLAGS (*pte));
+	if (current) {
+		invlpg ((void*) addr);
+	}
+
+	frame_put (frame);
+	vma_charge (pdir, -1, 1);
+	_swap_stats.swap_outs++;
+
+	return true;
+
+}
+
+int32_t _swap_fault (uintptr_t addr, uint32_t error,
+					 interrupt_context_t* context) {
+
+	if ((error & PF_ERR_PRESENT) || addr >= PHYSMAP_BASE || !_swap_dev) {
+		return -1;
+	}
+
+	pte_t* pte = pgtable_get_pte (vmm_get_current_pagedir (), (void*) addr);
+	if (!pte || !PTE_IS_SWAP (*pte)) {
+		return -1;
+	}
+
+	pte_t 	 entry = *pte;
+	uint32_t slot  = SWAP_SLOT (entry);
+
+	void* frame = reclaim_frame_alloc (0);
+	if (!frame) {
+		LOG_ERROR ("out of memory reading page %x from swap\n", addr);
+		return -1;
+	}
+
+	if (_swap_io (slot, PHYS_TO_VIRT (frame), false) != 0) {
+		LOG_ERROR ("read of swap slot %u failed\n", slot);
+		frame_put (frame);
+		_swap_stats.failures++;
+		return -1;
+	}
+
+	/* reclaim or a preempting fault may have brought the page in already,
+		the access is simply restarted against whatever is there now */
+	if (*pte != entry) {
+		frame_put (frame);
+		return 0;
+	}
+
+	*pte = pte_create (frame, (entry & (PTE_WRITABLE | PTE_USER)) | PTE_PRESENT);
+	_swap_put_slot (slot);
+	vma_charge (vmm_get_current_pagedir (), 1, -1);
+	_swap_stats.swap_ins++;
+
+	return 0;
+
+}
+
+uint32_t _swap_shrink_count (void* priv) {
+
+	if (!_swap_dev || _swappiness == 0) {
+		return 0;
+	}
+
+	return _swap_stats.slots - _swap_stats.used;
+
+}
+
+uint32_t _swap_shrink_scan (void* priv, uint32_t nr_to_scan) {
+
+	/* swappiness scales how hard user pages are pushed out, a request is
+		never rounded down to nothing */
+	uint32_t nr = (nr_to_scan * _swappiness) / SWAP_MAX_SWAPPINESS;
+	if (nr == 0) {
+		nr = 1;
+	}
+
+	return swap_out (nr);
+
+}
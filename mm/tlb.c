@@ -0,0 +1,152 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#include <mm/tlb.h>
+#include <mm/vmm.h>
+#include <mm/pgtable.h>
+#include <mm/fixmap.h>
+#include <mem.h>
+#include <utils.h>
+
+#define LOG_MOD_NAME 	"TLB"
+#define LOG_MOD_ENABLE  1
+#include <log.h>
+
+/* Some helpful macros to help reduce verbosity */
+
+//! cpuid leaf 1 edx bit for global pages
+#define CPUID_EDX_PGE 		(1 << 13)
+
+//! first page directory entry of the kernel half
+#define KERNEL_FIRST_PDE 	VMM_DIR_INDEX (PHYSMAP_BASE)
+
+/* Private variables */
+
+static bool 		_global_enabled = false;
+static tlb_stats_t 	_tlb_stats;
+
+/* Public functions of the interface */
+
+void tlb_init (void) {
+
+	uint32_t eax, ebx, ecx, edx;
+	cpuid (1, &eax, &ebx, &ecx, &edx);
+
+	if (!(edx & CPUID_EDX_PGE)) {
+		LOG_DEBUG ("cpu has no global pages\n");
+		return;
+	}
+
+	/* the kernel half is shared by every address space, so its translations
+		stay valid across a switch */
+	pagedir_t* kdir  = vmm_get_kerneldir ();
+	uint32_t   count = 0;
+
+	for (uint32_t i = KERNEL_FIRST_PDE; i < RECURSIVE_PDE; i++) {
+
+		/* large pages carry the global bit in the directory entry */
+		if (PDE_IS_PRESENT (kdir->table[i]) && PDE_IS_4MB (kdir->table[i])) {
+			kdir->table[i] |= PDE_GLOBAL;
+			count += VMM_PAGES_PER_TABLE;
+			continue;
+		}
+
+		pagetable_t* table = pgtable_get_table (kdir,
+												(void*) (i * PGTABLE_SPAN));
+		if (!table) {
+			continue;
+		}
+
+		for (uint32_t j = 0; j < VMM_PAGES_PER_TABLE; j++) {
+			if (PTE_IS_PRESENT (table->table[j])) {
+				table->table[j] |= PTE_GLOBAL;
+				count++;
+			}
+		}
+	}
+
+	write_cr4 (read_cr4 () | CR4_PGE);
+	_global_enabled = true;
+
+	LOG_DEBUG ("%u kernel pages marked global\n", count);
+
+}
+
+bool tlb_global_enabled (void) {
+
+	return _global_enabled;
+
+}
+
+void tlb_batch_init (tlb_batch_t* batch) {
+
+	batch->count  = 0;
+	batch->full   = false;
+	batch->global = false;
+
+}
+
+void tlb_batch_add (tlb_batch_t* batch, uintptr_t virt) {
+
+	if (virt >= PHYSMAP_BASE) {
+		batch->global = true;
+	}
+
+	if (batch->full) {
+		return;
+	}
+
+	if (batch->count == TLB_FLUSH_THRESHOLD) {
+		batch->full = true;
+		return;
+	}
+
+	batch->pages[batch->count++] = virt;
+
+}
+
+void tlb_batch_flush (tlb_batch_t* batch) {
+
+	if (batch->full) {
+		/* reloading cr3 keeps global entries, which kernel pages are */
+		if (batch->global && _global_enabled) {
+			tlb_flush_all ();
+		} else {
+			flush_tlb ();
+			_tlb_stats.full_flushes++;
+		}
+	} else {
+		for (uint32_t i = 0; i < batch->count; i++) {
+			invlpg ((void*) batch->pages[i]);
+		}
+		_tlb_stats.pages += batch->count;
+	}
+
+	if (batch->count || batch->full) {
+		_tlb_stats.batches++;
+	}
+
+	tlb_batch_init (batch);
+
+}
+
+void tlb_flush_all (void) {
+
+	/* toggling PGE drops every entry, global or not */
+	uint32_t cr4 = read_cr4 ();
+	if (cr4 & CR4_PGE) {
+		write_cr4 (cr4 & ~CR4_PGE);
+		write_cr4 (cr4);
+	} else {
+		flush_tlb ();
+	}
+
+	_tlb_stats.global_flushes++;
+
+}
+
+const tlb_stats_t* tlb_get_stats (void) {
+
+	return &_tlb_stats;
+
+}
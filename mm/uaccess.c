@@ -0,0 +1,336 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <mm/uaccess.h>
+#include <mm/fault.h>
+#include <init/syscall.h>
+#include <interrupts.h>
+#include <utils.h>
+
+#define LOG_MOD_NAME 	"UAC"
+#define LOG_MOD_ENABLE  1
+#include <log.h>
+
+/* The copies are plain string instructions. Every instruction that touches
+	user memory gets an exception table entry, and the fixup handler sits at
+	the end of the fault chain, so demand paging, copy on write and swap still
+	get to resolve the fault first and the copy simply restarts. Only a fault
+	that nobody wants lands in the table, and the copy then continues at its
+	fixup with the count of what is left.
+
+	read and write keep their original handler, which touches the buffer
+	without a table entry. The buffer is checked and handed to it a chunk at
+	a time in a kernel bounce buffer, so a bad pointer fails the call rather
+	than faulting in the handler.
+
+	CR0.WP is set, so writes to copy on write pages fault into the copy on
+	write handler and writes to read-only pages fail. */
+
+//! exception table, gathered by the linker script
+extern exception_entry_t 	kextable_start[];
+extern exception_entry_t 	kextable_end[];
+
+/* Private variables */
+
+static uaccess_stats_t 		_uaccess_stats;
+
+//! the syscall isr that was installed before ours
+static interrupt_service_t 	_syscall_next = NULL;
+
+/* Implementation private helper routines. */
+
+//! copies size bytes, returns the number of bytes that were not copied
+static size_t 	_uaccess_copy (void* dst, const void* src, size_t size);
+
+//! continues kernel faults on user memory at their fixup
+static int32_t 	_uaccess_fault (uintptr_t addr, uint32_t error,
+								interrupt_context_t* context);
+
+//! runs the original write on the user buffer copied to the kernel a chunk
+//! at a time
+static int32_t 	_uaccess_write (interrupt_context_t* context);
+
+//! runs the original read on a kernel chunk at a time and copies the result
+//! to the user buffer
+static int32_t 	_uaccess_read (interrupt_context_t* context);
+
+//! calls the original handler with buf and count in place of the user's
+static void 	_uaccess_forward (interrupt_context_t* context, void* buf,
+								  size_t count);
+
+//! checks the buffers of read and write, hands them to the original handler
+//! through a bounce buffer and passes the rest on
+static void 	_uaccess_syscall (interrupt_context_t* context);
+
+/* Public functions of the interface */
+
+void uaccess_init (void) {
+
+	vmm_fault_register (_uaccess_fault, FAULT_KIND_FIXUP);
+
+	if (get_interrupt_handler (ISR128_SYSCALL) != _uaccess_syscall) {
+		_syscall_next = get_interrupt_handler (ISR128_SYSCALL);
+		register_interrupt_handler (ISR128_SYSCALL, _uaccess_syscall);
+	}
+
+}
+
+bool uaccess_range_ok (const void* addr, size_t size) {
+
+	uintptr_t start = (uintptr_t) addr;
+
+	return start >= USER_SPACE_START && start + size >= start &&
+		   start + size <= USER_SPACE_END;
+
+}
+
+int32_t copy_from_user (void* dst, const void* src, size_t size) {
+
+	if (!uaccess_range_ok (src, size)) {
+		_uaccess_stats.rejected++;
+		return -1;
+	}
+
+	_uaccess_stats.copies_from++;
+
+	size_t left = _uaccess_copy (dst, src, size);
+	_uaccess_stats.bytes += size - left;
+
+	return left ? -1 : 0;
+
+}
+
+int32_t copy_to_user (void* dst, const void* src, size_t size) {
+
+	if (!uaccess_range_ok (dst, size)) {
+		_uaccess_stats.rejected++;
+		return -1;
+	}
+
+	_uaccess_stats.copies_to++;
+
+	size_t left = _uaccess_copy (dst, src, size);
+
+	_uaccess_stats.bytes += size - left;
+
+	return left ? -1 : 0;
+
+}
+
+int32_t strncpy_from_user (char* dst, const char* src, size_t size) {
+
+	uintptr_t start = (uintptr_t) src;
+
+	if (start < USER_SPACE_START || start >= USER_SPACE_END) {
+		_uaccess_stats.rejected++;
+		return -1;
+	}
+
+	/* the string may end anywhere, so only the start is checked and the
+		copy is kept from running into the kernel */
+	if (size > USER_SPACE_END - start) {
+		size = USER_SPACE_END - start;
+	}
+
+	_uaccess_stats.copies_from++;
+
+	size_t 	left  = size;
+	int32_t fault = 0;
+	void* 	d0;
+	void* 	d1;
+
+	/* copies until the terminator, which is copied too, or size bytes */
+	asm volatile (
+		"	testl %0, %0\n"
+		"	jz 3f\n"
+		"1:	lodsb\n"
+		"	stosb\n"
+		"	testb %%al, %%al\n"
+		"	jz 3f\n"
+		"	decl %0\n"
+		"	jnz 1b\n"
+		"	jmp 3f\n"
+		"2:	movl $-1, %1\n"
+		"3:\n"
+		"	.pushsection __ex_table, \"a\"\n"
+		"	.long 1b, 2b\n"
+		"	.popsection\n"
+		: "+c" (left), "+r" (fault), "=&D" (d0), "=&S" (d1)
+		: "2" (dst), "3" (src)
+		: "eax", "memory");
+
+	if (fault) {
+		return -1;
+	}
+
+	_uaccess_stats.bytes += size - left;
+
+	return size - left;
+
+}
+
+uintptr_t uaccess_search_fixup (uintptr_t eip) {
+
+	for (exception_entry_t* entry = kextable_start; entry < kextable_end;
+		 entry++) {
+		if (entry->insn == eip) {
+			return entry->fixup;
+		}
+	}
+
+	return 0;
+
+}
+
+const uaccess_stats_t* uaccess_get_stats (void) {
+
+	return &_uaccess_stats;
+
+}
+
+/* Private helpers */
+
+size_t _uaccess_copy (void* dst, const void* src, size_t size) {
+
+	size_t left;
+	void*  d0;
+	void*  d1;
+
+	/* a fault in the dword copy leaves ecx dwords and the tail to go, a
+		fault in the byte copy leaves ecx bytes */
+	asm volatile (
+		"1:	rep movsl\n"
+		"	movl %5, %0\n"
+		"2:	rep movsb\n"
+		"	jmp 4f\n"
+		"3:	leal (%5, %0, 4), %0\n"
+		"4:\n"
+		"	.pushsection __ex_table, \"a\"\n"
+		"	.long 1b, 3b\n"
+		"	.long 2b, 4b\n"
+		"	.popsection\n"
+		: "=&c" (left), "=&D" (d0), "=&S" (d1)
+		: "0" (size >> 2), "1" (dst), "r" (size & 3), "2" (src)
+		: "memory");
+
+	return left;
+
+}
+
+int32_t _uaccess_fault (uintptr_t addr, uint32_t error,
+						interrupt_context_t* context) {
+
+	if (error & PF_ERR_USER) {
+		return -1;
+	}
+
+	uintptr_t fixup = uaccess_search_fixup (context->eip);
+	if (!fixup) {
+		return -1;
+	}
+
+	_uaccess_stats.fixups++;
+	context->eip = fixup;
+
+	return 0;
+
+}
+
+int32_t _uaccess_write (interrupt_context_t* context) {
+
+	const char* buf   = (const char*) context->ebx;
+	size_t 		count = context->ecx;
+	char 		chunk[ UACCESS_CHUNK_SIZE ];
+
+	for (size_t done = 0; done < count; ) {
+
+		size_t n = count - done;
+		if (n > sizeof(chunk)) {
+			n = sizeof(chunk);
+		}
+
+		if (copy_from_user (chunk, buf + done, n) != 0) {
+			return -1;
+		}
+
+		_uaccess_forward (context, chunk, n);
+		done += n;
+	}
+
+	return count;
+
+}
+
+int32_t _uaccess_read (interrupt_context_t* context) {
+
+	char* 	buf   = (char*) context->ebx;
+	size_t 	count = context->ecx;
+	char 	chunk[ UACCESS_CHUNK_SIZE ];
+
+	/* the terminal stops at a newline, which it stores as the terminator */
+	for (size_t done = 0; done < count; ) {
+
+		size_t n = count - done;
+		if (n > sizeof(chunk)) {
+			n = sizeof(chunk);
+		}
+
+		memset (chunk, 0, n);
+		_uaccess_forward (context, chunk, n);
+
+		size_t len = 0;
+		while (len < n && chunk[len]) {
+			len++;
+		}
+
+		if (copy_to_user (buf + done, chunk, len < n ? len + 1 : n) != 0) {
+			return -1;
+		}
+
+		done += len;
+		if (len < n) {
+			return done;
+		}
+	}
+
+	return count;
+
+}
+
+void _uaccess_forward (interrupt_context_t* context, void* buf, size_t count) {
+
+	uint32_t ebx = context->ebx;
+	uint32_t ecx = context->ecx;
+
+	context->ebx = (uint32_t) buf;
+	context->ecx = count;
+	_syscall_next (context);
+
+	context->ebx = ebx;
+	context->ecx = ecx;
+
+}
+
+void _uaccess_syscall (interrupt_context_t* context) {
+
+	if (context->eax != SYSCALL_READ && context->eax != SYSCALL_WRITE) {
+		_syscall_next (context);
+		return;
+	}
+
+	/* read(buf, count) and write(buf, count), the original handler only ever
+		sees kernel memory */
+	uint32_t nr = context->eax;
+
+	if (!uaccess_range_ok ((void*) context->ebx, context->ecx)) {
+		_uaccess_stats.rejected++;
+		context->eax = (uint32_t) -1;
+		return;
+	}
+
+	int32_t ret = (nr == SYSCALL_READ) ? _uaccess_read (context) :
+										 _uaccess_write (context);
+	context->eax = ret;
+
+}
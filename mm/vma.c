@@ -0,0 +1,406 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <mm/vma.h>
+#include <mm/slab.h>
+#include <mm/hugepage.h>
+#include <mm/swap.h>
+#include <mm/shm.h>
+#include <mm/pgtable.h>
+#include <mem.h>
+#include <utils.h>
+
+#define LOG_MOD_NAME 	"VMS"
+#define LOG_MOD_ENABLE  1
+#include <log.h>
+
+/* Some helpful macros to help reduce verbosity */
+
+#define AREA(n) 		RB_ENTRY (vm_area_t, n, node)
+
+#define IN_STACK(addr) \
+	( (addr) >= USER_STACK_LIMIT && (addr) < USER_STACK_TOP + USER_STACK_SIZE )
+
+/* Private variables */
+
+//! every address space that has areas
+static list_t 			_spaces;
+
+//! space found by the previous lookup, usually the current one
+static vm_space_t* 		_last_space = NULL;
+
+//! caches for the descriptors
+static kmem_cache_t* 	_space_cache = NULL;
+static kmem_cache_t* 	_area_cache  = NULL;
+
+/* Implementation private helper routines. */
+
+//! orders areas by start address
+static int 			_vma_cmp (const rb_node_t* a, const rb_node_t* b);
+
+//! inserts the parts of [start, end) no area covers yet
+static void 		_vma_insert_uncovered (vm_space_t* space, uintptr_t start,
+										   uintptr_t end, uint32_t prot,
+										   uint32_t flags);
+
+//! counts the present pages of [start, end)
+static uint32_t 	_vma_count_present (pagedir_t* pdir, uintptr_t start,
+										uintptr_t end);
+
+/* Public functions of the interface */
+
+void vma_init (void) {
+
+	_space_cache = kmem_cache_create ("vm_space", sizeof(vm_space_t), 0, NULL);
+	_area_cache  = kmem_cache_create ("vm_area", sizeof(vm_area_t), 0, NULL);
+
+}
+
+vm_space_t* vma_get_space (pagedir_t* pdir, bool create) {
+
+	if (!pdir) {
+		return NULL;
+	}
+
+	if (_last_space && _last_space->pdir == pdir) {
+		return _last_space;
+	}
+
+	for (list_element_t* e = list_head (&_spaces); e; e = list_next (e)) {
+		vm_space_t* space = LIST_ENTRY (vm_space_t, e, link);
+		if (space->pdir == pdir) {
+			_last_space = space;
+			return space;
+		}
+	}
+
+	if (!create || !_space_cache) {
+		return NULL;
+	}
+
+	vm_space_t* space = kmem_cache_alloc (_space_cache);
+	if (!space) {
+		return NULL;
+	}
+
+	space->pdir 	= pdir;
+	space->last_hit = NULL;
+	memset (&space->faults, 0, sizeof(fault_counts_t));
+	memset (&space->usage, 0, sizeof(vm_usage_t));
+	space->usage.kobjects = sizeof(vm_space_t);
+	rb_init (&space->areas, NULL);
+	list_append (&_spaces, &space->link);
+
+	_last_space = space;
+	return space;
+
+}
+
+vm_space_t* vma_next_space (vm_space_t* space) {
+
+	list_element_t* e = space ? list_next (&space->link) : list_head (&_spaces);
+	return e ? LIST_ENTRY (vm_space_t, e, link) : NULL;
+
+}
+
+vm_area_t* vma_find (vm_space_t* space, uintptr_t addr) {
+
+	if (!space) {
+		return NULL;
+	}
+
+	/* faults tend to hit the same area over and over */
+	vm_area_t* hit = space->last_hit;
+	if (hit && addr >= hit->start && addr < hit->end) {
+		return hit;
+	}
+
+	hit = vma_find_next (space, addr);
+	if (!hit || addr < hit->start) {
+		return NULL;
+	}
+
+	space->last_hit = hit;
+	return hit;
+
+}
+
+vm_area_t* vma_find_next (vm_space_t* space, uintptr_t addr) {
+
+	if (!space) {
+		return NULL;
+	}
+
+	/* areas never overlap, so ordering by start also orders them by end */
+	vm_area_t* found = NULL;
+	rb_node_t* node  = space->areas.root;
+
+	while (node) {
+		if (AREA (node)->end > addr) {
+			found = AREA (node);
+			node  = node->left;
+		} else {
+			node  = node->right;
+		}
+	}
+
+	return found;
+
+}
+
+vm_area_t* vma_insert (vm_space_t* space, uintptr_t start, size_t size,
+					   uint32_t prot, uint32_t flags, void* backing,
+					   uint32_t offset) {
+
+	if (!space || !_area_cache || size == 0 ||
+		!IS_ALIGNED (start, VMM_PAGE_SIZE) || !IS_ALIGNED (size, VMM_PAGE_SIZE) ||
+		start + size < start) {
+		return NULL;
+	}
+
+	vm_area_t* next = vma_find_next (space, start);
+	if (next && next->start < start + size) {
+		return NULL;
+	}
+
+	vm_area_t* area = kmem_cache_alloc (_area_cache);
+	if (!area) {
+		return NULL;
+	}
+
+	area->start   = start;
+	area->end 	  = start + size;
+	area->prot 	  = prot;
+	area->flags   = flags;
+	area->backing = backing;
+	area->offset  = offset;
+	rb_insert (&space->areas, &area->node, _vma_cmp);
+
+	space->usage.kobjects += sizeof(vm_area_t);
+	return area;
+
+}
+
+void vma_remove (vm_space_t* space, vm_area_t* area) {
+
+	if (!space || !area) {
+		return;
+	}
+
+	if (space->last_hit == area) {
+		space->last_hit = NULL;
+	}
+
+	rb_remove (&space->areas, &area->node);
+	kmem_cache_free (_area_cache, area);
+
+	space->usage.kobjects -= sizeof(vm_area_t);
+
+}
+
+int32_t vma_clone_space (pagedir_t* src, pagedir_t* dst) {
+
+	vm_space_t* from = vma_get_space (src, false);
+	if (!from) {
+		return 0;
+	}
+
+	vm_space_t* to = vma_get_space (dst, true);
+	if (!to) {
+		return -1;
+	}
+
+	for (rb_node_t* n = rb_first (&from->areas); n; n = rb_next (n)) {
+		vm_area_t* area = AREA (n);
+		if (!vma_insert (to, area->start, area->end - area->start, area->prot,
+						 area->flags, area->backing, area->offset)) {
+			return -1;
+		}
+	}
+
+	/* the clone maps every page the source maps */
+	to->usage.rss 	  = from->usage.rss;
+	to->usage.swapped = from->usage.swapped;
+
+	return 0;
+
+}
+
+void vma_destroy_space (pagedir_t* pdir) {
+
+	vm_space_t* space = vma_get_space (pdir, false);
+	if (!space) {
+		return;
+	}
+
+	while (!rb_is_empty (&space->areas)) {
+		vma_remove (space, AREA (space->areas.root));
+	}
+
+	list_remove (&_spaces, &space->link);
+	if (_last_space == space) {
+		_last_space = NULL;
+	}
+
+	kmem_cache_free (_space_cache, space);
+
+}
+
+void vmm_destroy_space (pagedir_t* pdir) {
+
+	/* the pages of the areas go away with the page tables, the vmm only
+		understands the ones behind page tables */
+	shm_release_space (pdir);
+	vma_destroy_space (pdir);
+	hugepage_release_space (pdir);
+	swap_release_space (pdir);
+	vmm_destroy_pagedir (pdir);
+
+}
+
+bool vma_alloc_region (pagedir_t* pdir, void* virtual, size_t size,
+					   uint32_t flags) {
+
+	uintptr_t start = (uintptr_t) virtual & ~(VMM_PAGE_SIZE - 1);
+	uintptr_t end 	= ALIGN_SIZE ((uintptr_t) virtual + size, VMM_PAGE_SIZE);
+
+	/* segments may share a boundary page that is already mapped */
+	uint32_t mapped = 0;
+	if (start < PHYSMAP_BASE) {
+		mapped = _vma_count_present (pdir, start, end);
+	}
+
+	/* the space comes first, so the page tables of the mapping are counted */
+	vm_space_t* space = vma_get_space (pdir, true);
+
+	if (!hugepage_alloc_region (pdir, virtual, size, flags)) {
+		return false;
+	}
+
+	if (!space || start >= PHYSMAP_BASE) {
+		return true;
+	}
+
+	space->usage.rss += (end - start) / VMM_PAGE_SIZE - mapped;
+
+	/* the stack owns its whole window, the rest of it is grown on demand */
+	if (IN_STACK (start)) {
+		_vma_insert_uncovered (space, USER_STACK_LIMIT,
+							   USER_STACK_TOP + USER_STACK_SIZE, flags,
+							   VMA_STACK | VMA_DEMAND | VMA_GROWSDOWN);
+	} else {
+		_vma_insert_uncovered (space, start, end, flags,
+							   (flags & PTE_WRITABLE) ? VMA_DATA : VMA_CODE);
+	}
+
+	return true;
+
+}
+
+void vma_charge (pagedir_t* pdir, int32_t rss, int32_t swapped) {
+
+	vm_space_t* space = vma_get_space (pdir, false);
+	if (!space) {
+		return;
+	}
+
+	space->usage.rss 	 += rss;
+	space->usage.swapped += swapped;
+
+}
+
+void vma_charge_tables (pagedir_t* pdir, int32_t tables) {
+
+	vm_space_t* space = vma_get_space (pdir, false);
+	if (space) {
+		space->usage.pgtables += tables;
+	}
+
+}
+
+const vm_usage_t* vma_get_usage (pagedir_t* pdir) {
+
+	vm_space_t* space = vma_get_space (pdir, false);
+	return space ? &space->usage : NULL;
+
+}
+
+void vma_dump (pagedir_t* pdir) {
+
+	static const char* kinds[] = { "code", "data", "heap", "stack", "mmap" };
+
+	vm_space_t* space = vma_get_space (pdir, false);
+	if (!space) {
+		printk ("no areas\n");
+		return;
+	}
+
+	for (rb_node_t* n = rb_first (&space->areas); n; n = rb_next (n)) {
+
+		vm_area_t*  area = AREA (n);
+		const char* kind = "?";
+		for (uint32_t i = 0; i < sizeof(kinds) / sizeof(kinds[0]); i++) {
+			if (area->flags & (1 << i)) {
+				kind = kinds[i];
+			}
+		}
+
+		printk ("%x-%x %c%c %-5s%s\n", area->start, area->end,
+				(area->prot & PTE_USER) ? 'u' : '-',
+				(area->prot & PTE_WRITABLE) ? 'w' : '-', kind,
+				(area->flags & VMA_DEMAND) ? " demand" : "");
+	}
+
+}
+
+/* Private helpers */
+
+int _vma_cmp (const rb_node_t* a, const rb_node_t* b) {
+
+	uintptr_t sa = AREA (a)->start;
+	uintptr_t sb = AREA (b)->start;
+
+	return (sa > sb) - (sa < sb);
+
+}
+
+void _vma_insert_uncovered (vm_space_t* space, uintptr_t start, uintptr_t end,
+							uint32_t prot, uint32_t flags) {
+
+	/* segments of an executable may share their boundary pages, each page
+		belongs to whichever area claimed it first */
+	while (start < end) {
+
+		vm_area_t* next = vma_find_next (space, start);
+
+		if (next && next->start <= start) {
+			start = next->end;
+			continue;
+		}
+
+		uintptr_t stop = (next && next->start < end) ? next->start : end;
+		if (!vma_insert (space, start, stop - start, prot, flags, NULL, 0)) {
+			LOG_ERROR ("cannot record area %x-%x\n", start, stop);
+			return;
+		}
+
+		start = stop;
+	}
+
+}
+
+uint32_t _vma_count_present (pagedir_t* pdir, uintptr_t start, uintptr_t end) {
+
+	uint32_t present = 0;
+
+	for (uintptr_t page = start; page < end; page += VMM_PAGE_SIZE) {
+		pte_t* pte = pgtable_get_pte (pdir, (void*) page);
+		if (pte && PTE_IS_PRESENT (*pte)) {
+			present++;
+		}
+	}
+
+	return present;
+
+}
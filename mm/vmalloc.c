@@ -0,0 +1,212 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#include <mm/vmalloc.h>
+#include <mm/slab.h>
+#include <mm/kmm.h>
+#include <mm/shrinker.h>
+#include <mm/vmm.h>
+#include <mm/pgtable.h>
+#include <mm/tlb.h>
+#include <mem.h>
+#include <utils.h>
+
+#define LOG_MOD_NAME 	"VMA"
+#define LOG_MOD_ENABLE  1
+#include <log.h>
+
+/* Some helpful macros to help reduce verbosity */
+
+#define REGION(n) 		RB_ENTRY (vm_region_t, n, node)
+
+//! end of a region including its guard page
+#define REGION_END(r) 	((r)->start + (r)->size + VMALLOC_GUARD_SIZE)
+
+/* Private variables */
+
+//! all regions currently handed out
+static rb_tree_t 		_regions;
+
+//! cache for the region descriptors
+static kmem_cache_t* 	_region_cache = NULL;
+
+//! number of pages currently mapped in the range
+static uint32_t 		_mapped_pages = 0;
+
+/* Implementation private helper routines. */
+
+//! interval tree augmentation, recomputes max_end of a node
+static void 		_vmalloc_augment (rb_node_t* node);
+
+//! orders regions by start address
+static int 			_vmalloc_cmp (const rb_node_t* a, const rb_node_t* b);
+
+//! finds the lowest free gap of the range that can hold size bytes
+static uintptr_t 	_vmalloc_find_gap (size_t size);
+
+//! unmaps and frees the first size bytes of the range at start
+static void 		_vmalloc_unmap (uintptr_t start, size_t size);
+
+/* Public functions of the interface */
+
+void vmalloc_init (void) {
+
+	rb_init (&_regions, _vmalloc_augment);
+	_region_cache = kmem_cache_create ("vm_region", sizeof(vm_region_t),
+									   0, NULL);
+
+	/* create all page tables of the range up front, address spaces cloned from
+		the kernel directory then share them and see every later mapping */
+	pagedir_t* kdir = vmm_get_kerneldir ();
+	for (uintptr_t addr = VMALLOC_START; addr < VMALLOC_END;
+		 addr += PGTABLE_SPAN) {
+		vmm_create_pt (kdir, (void*) addr, PTE_PRESENT | PTE_WRITABLE);
+	}
+
+}
+
+void* vmalloc (size_t size) {
+
+	if (size == 0 || !_region_cache) {
+		return NULL;
+	}
+
+	size = ALIGN_SIZE (size, VMM_PAGE_SIZE);
+
+	uintptr_t start = _vmalloc_find_gap (size);
+	if (!start) {
+		LOG_ERROR ("no room for %u bytes in the vmalloc range\n", size);
+		return NULL;
+	}
+
+	vm_region_t* region = kmem_cache_alloc (_region_cache);
+	if (!region) {
+		return NULL;
+	}
+
+	pagedir_t* kdir = vmm_get_kerneldir ();
+	for (size_t offs = 0; offs < size; offs += VMM_PAGE_SIZE) {
+
+		void* frame = reclaim_frame_alloc (0);
+		if (!frame) {
+			LOG_ERROR ("out of frames mapping %u bytes\n", size);
+			_vmalloc_unmap (start, offs);
+			kmem_cache_free (_region_cache, region);
+			return NULL;
+		}
+
+		vmm_map_page (kdir, (void*) (start + offs), frame, KERNEL_PTE_FLAGS);
+		_mapped_pages++;
+	}
+
+	region->start = start;
+	region->size  = size;
+	rb_insert (&_regions, &region->node, _vmalloc_cmp);
+
+	return (void*) start;
+
+}
+
+void vfree (void* addr) {
+
+	if (!addr) {
+		return;
+	}
+
+	vm_region_t* region = vmalloc_find (addr);
+	if (!region || region->start != (uintptr_t) addr) {
+		LOG_ERROR ("vfree of %p which was not returned by vmalloc\n", addr);
+		return;
+	}
+
+	_vmalloc_unmap (region->start, region->size);
+	rb_remove (&_regions, &region->node);
+	kmem_cache_free (_region_cache, region);
+
+}
+
+vm_region_t* vmalloc_find (void* addr) {
+
+	uintptr_t  a 	= (uintptr_t) addr;
+	rb_node_t* node = _regions.root;
+
+	/* regions never overlap, so if the left subtree reaches past the address
+		any region containing it must be there, otherwise it is to the right */
+	while (node) {
+
+		vm_region_t* r = REGION (node);
+		if (a >= r->start && a < r->start + r->size) {
+			return r;
+		}
+
+		if (node->left && REGION (node->left)->max_end > a) {
+			node = node->left;
+		} else if (a >= r->start) {
+			node = node->right;
+		} else {
+			break;
+		}
+	}
+
+	return NULL;
+
+}
+
+void vmalloc_stats (void) {
+
+	printk ("vmalloc: %u regions, %u pages mapped, range %x-%x\n",
+			rb_size (&_regions), _mapped_pages, VMALLOC_START, VMALLOC_END);
+
+}
+
+/* Private helpers */
+
+void _vmalloc_augment (rb_node_t* node) {
+
+	vm_region_t* r 	 = REGION (node);
+	uintptr_t 	 max = REGION_END (r);
+
+	if (node->left && REGION (node->left)->max_end > max) {
+		max = REGION (node->left)->max_end;
+	}
+	if (node->right && REGION (node->right)->max_end > max) {
+		max = REGION (node->right)->max_end;
+	}
+
+	r->max_end = max;
+
+}
+
+int _vmalloc_cmp (const rb_node_t* a, const rb_node_t* b) {
+
+	uintptr_t sa = REGION (a)->start;
+	uintptr_t sb = REGION (b)->start;
+
+	return (sa < sb) ? -1 : (sa > sb);
+
+}
+
+uintptr_t _vmalloc_find_gap (size_t size) {
+
+	size_t 	  need 	 = size + VMALLOC_GUARD_SIZE;
+	uintptr_t cursor = VMALLOC_START;
+
+	/* walk the regions in address order, the first hole large enough wins */
+	for (rb_node_t* n = rb_first (&_regions); n; n = rb_next (n)) {
+
+		vm_region_t* r = REGION (n);
+		if (r->start - cursor >= need) {
+			return cursor;
+		}
+		cursor = REGION_END (r);
+	}
+
+	return (VMALLOC_END - cursor >= need) ? cursor : 0;
+
+}
+
+void _vmalloc_unmap (uintptr_t start, size_t size) {
+
+	_mapped_pages -= pgtable_unmap_range (vmm_get_kerneldir (), start, size);
+
+}
@@ -0,0 +1,116 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <mm/zeropage.h>
+#include <mm/cow.h>
+#include <mm/frame.h>
+#include <mm/kmm.h>
+#include <mm/pgtable.h>
+#include <mem.h>
+#include <utils.h>
+
+#define LOG_MOD_NAME 	"ZPG"
+#define LOG_MOD_ENABLE  1
+#include <log.h>
+
+/* The zero page is mapped copy on write wherever the area is writable, the
+	first write from either mode faults and gets a frame of its own. The elf
+	loader zeroes .bss through zero_page_fill, which maps whole pages to it
+	and writes the partial ones through cow_load_fill like the rest of the
+	segment. */
+
+/* Private variables */
+
+static void* 				_zero_frame = NULL;
+static zero_page_stats_t 	_zero_stats;
+
+/* Public functions of the interface */
+
+void zero_page_init (void) {
+
+	_zero_frame = kmm_frame_alloc ();
+	if (!_zero_frame) {
+		LOG_ERROR ("no frame for the zero page\n");
+		return;
+	}
+
+	memset (PHYS_TO_VIRT (_zero_frame), 0, VMM_PAGE_SIZE);
+	frame_pin (_zero_frame);
+
+}
+
+void* zero_page_frame (void) {
+
+	return _zero_frame;
+
+}
+
+bool zero_page_is (void* phys) {
+
+	return _zero_frame && phys == _zero_frame;
+
+}
+
+bool zero_page_map (pagedir_t* pdir, uintptr_t virt, uint32_t flags) {
+
+	if (!_zero_frame || !pdir || virt >= PHYSMAP_BASE) {
+		return false;
+	}
+
+	uint32_t pte_flags = PTE_PRESENT | (flags & PTE_USER);
+	if (flags & PTE_WRITABLE) {
+		pte_flags |= PTE_COW;
+	}
+
+	vmm_map_page (pdir, (void*) (virt & ~(VMM_PAGE_SIZE - 1)), _zero_frame,
+				  pte_flags);
+	return true;
+
+}
+
+void* zero_page_fill (void* dst, int c, size_t n) {
+
+	uintptr_t start = (uintptr_t) dst;
+	uintptr_t end 	= start + n;
+	uintptr_t first = ALIGN_SIZE (start, VMM_PAGE_SIZE);
+	uintptr_t last 	= end & ~(VMM_PAGE_SIZE - 1);
+
+	if (c != 0 || !_zero_frame || end < start || end > PHYSMAP_BASE ||
+		first >= last) {
+		return cow_load_fill (dst, c, n);
+	}
+
+	pagedir_t* pdir = vmm_get_current_pagedir ();
+
+	/* the partial pages at either end hold data of their own */
+	cow_load_fill (dst, 0, first - start);
+	cow_load_fill ((void*) last, 0, end - last);
+
+	for (uintptr_t page = first; page < last; page += VMM_PAGE_SIZE) {
+
+		pte_t* pte 	 = pgtable_get_pte (pdir, (void*) page);
+		void*  frame = pte ? (void*) PTE_FRAME_ADDR (*pte) : NULL;
+
+		/* large pages and shared frames are zeroed in place */
+		if (!pte || !PTE_IS_PRESENT (*pte) || (*pte & PTE_COW) ||
+			frame_refcount (frame) > 1) {
+			cow_load_fill ((void*) page, 0, VMM_PAGE_SIZE);
+			continue;
+		}
+
+		zero_page_map (pdir, page, PTE_FLAGS (*pte));
+		invlpg ((void*) page);
+		frame_put (frame);
+		_zero_stats.bss_pages++;
+	}
+
+	return dst;
+
+}
+
+const zero_page_stats_t* zero_page_get_stats (void) {
+
+	return &_zero_stats;
+
+}
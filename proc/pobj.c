@@ -0,0 +1,154 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <proc/pobj.h>
+#include <proc/process.h>
+#include <proc/sched.h>
+#include <proc/procmem.h>
+#include <mm/kstack.h>
+#include <mm/slab.h>
+#include <mm/kheap.h>
+
+/* The process code allocates nothing but processes, threads and thread
+	stacks. Processes and threads are only a few dozen bytes, in the buddy
+	heap each would take a block of twice its size, so they come from caches
+	of their own. Which of them a malloc asks for is told by its call site:
+	the makefile marks the return address of each call that allocates a
+	process, a thread or a stack. A free goes wherever the slab and stack
+	records say the memory belongs.
+
+	Every thread is allocated with the scheduler bytes behind it, cleared,
+	so the scheduler state is never on the thread's stack.
+
+	Each object is charged to its process as it is handed out. A process is
+	charged for itself here, a thread and its stack by the thread_create
+	below, which replaces the weak original, and are given back by the
+	thread_destroy of sched.c. */
+
+//! the original thread_create of the process object
+extern thread_t* 	_thread_create_prebuilt (process_t* process, void* entry,
+											 void* arg);
+
+//! return addresses of the calls to malloc in the process object, see the
+//! makefile
+extern const uint8_t 	_pobj_site_fork[];		//! process of process_fork
+extern const uint8_t 	_pobj_site_spawn[];		//! process of process_spawn
+extern const uint8_t 	_pobj_site_init[];		//! kernel process
+extern const uint8_t 	_pobj_site_thread[];	//! thread of thread_create
+extern const uint8_t 	_pobj_site_kstack[];	//! stack of a thread
+
+/* Some helpful macros to help reduce verbosity */
+
+#define THREAD_OBJ_SIZE 	(sizeof(thread_t) + SCHED_DATA_SIZE)
+
+/* Private variables */
+
+static kmem_cache_t* 	_process_cache = NULL;
+static kmem_cache_t* 	_thread_cache  = NULL;
+
+/* Implementation private helper routines. */
+
+//! clears a thread and its scheduler bytes
+static void 		_pobj_thread_ctor (void* obj);
+
+/* Public functions of the interface */
+
+void pobj_init (void) {
+
+	_process_cache = kmem_cache_create ("process", sizeof(process_t), 0, NULL);
+	_thread_cache  = kmem_cache_create ("thread", THREAD_OBJ_SIZE, 0,
+										_pobj_thread_ctor);
+
+}
+
+process_t* pobj_process_alloc (void) {
+
+	process_t* process = kmem_cache_alloc (_process_cache);
+
+	procmem_charge (process, 0, sizeof(process_t));
+	return process;
+
+}
+
+thread_t* pobj_thread_alloc (void) {
+
+	return kmem_cache_alloc (_thread_cache);
+
+}
+
+void* pobj_malloc (size_t size) {
+
+	const uint8_t* site = __builtin_return_address (0);
+
+	if (site == _pobj_site_fork || site == _pobj_site_spawn ||
+		site == _pobj_site_init) {
+		return pobj_process_alloc ();
+	}
+
+	if (site == _pobj_site_thread) {
+		return pobj_thread_alloc ();
+	}
+
+	if (site == _pobj_site_kstack) {
+		return kstack_alloc (size);
+	}
+
+	return malloc (size);
+
+}
+
+void pobj_free (void* ptr) {
+
+	kmem_cache_t* cache = kmem_cache_of (ptr);
+
+	/* a process takes its charges along */
+	if (cache == _process_cache) {
+		procmem_release (ptr);
+	}
+
+	if (cache && (cache == _process_cache || cache == _thread_cache)) {
+		kmem_cache_free (cache, ptr);
+	}
+	else if (kstack_owns (ptr)) {
+		kstack_free (ptr);
+	}
+	else {
+		free (ptr);
+	}
+
+}
+
+thread_t* thread_create (process_t* process, void* entry, void* arg) {
+
+	thread_t* thread = _thread_create_prebuilt (process, entry, arg);
+
+	pobj_charge_thread (thread, true);
+	return thread;
+
+}
+
+void pobj_charge_thread (thread_t* thread, bool charge) {
+
+	if (!thread || !thread->parent) {
+		return;
+	}
+
+	int32_t kstack = thread->kstack_size;
+	int32_t kheap  = THREAD_OBJ_SIZE;
+
+	if (charge) {
+		procmem_charge (thread->parent, kstack, kheap);
+	} else {
+		procmem_charge (thread->parent, -kstack, -kheap);
+	}
+
+}
+
+/* Private helpers */
+
+void _pobj_thread_ctor (void* obj) {
+
+	memset (obj, 0, THREAD_OBJ_SIZE);
+
+}
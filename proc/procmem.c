@@ -0,0 +1,221 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <proc/procmem.h>
+#include <mm/vma.h>
+#include <mm/slab.h>
+#include <mm/uaccess.h>
+#include <init/syscall.h>
+#include <interrupts.h>
+#include <mem.h>
+#include <utils.h>
+
+#define LOG_MOD_NAME 	"PMEM"
+#define LOG_MOD_ENABLE  1
+#include <log.h>
+
+/* Everything is charged as it is allocated and read back as it is. The page
+	counts and the page tables are kept by the memory manager in the address
+	space of the process. process_t is laid out by the prebuilt process
+	object, so the kernel stacks and objects of a process are charged to a
+	record of its own, which pobj.c fills in as the process code allocates
+	and frees them. */
+
+//! list of every process, kept by the prebuilt process object
+extern list_t 	_all_processes;
+
+/* Private data structures */
+
+typedef struct _proc_charge {
+
+	list_element_t 	link;
+	process_t* 		process;
+	uint32_t 		kstack;		//! bytes of kernel stack
+	uint32_t 		kheap;		//! bytes of process and thread objects
+
+} proc_charge_t;
+
+/* Private variables */
+
+static list_t 				_charges;
+static kmem_cache_t* 		_charge_cache = NULL;
+
+//! the syscall isr that was installed before ours
+static interrupt_service_t 	_syscall_next = NULL;
+
+/* Implementation private helper routines. */
+
+//! returns the record of a process, making one if asked to
+static proc_charge_t* 	_procmem_charge_of (process_t* process, bool create);
+
+//! serves procmem(index, buf) and passes every other syscall on
+static void 		_procmem_syscall (interrupt_context_t* context);
+
+/* Public functions of the interface */
+
+void procmem_init (void) {
+
+	list_init (&_charges);
+	_charge_cache = kmem_cache_create ("procmem", sizeof(proc_charge_t), 0,
+									   NULL);
+
+	if (get_interrupt_handler (ISR128_SYSCALL) != _procmem_syscall) {
+		_syscall_next = get_interrupt_handler (ISR128_SYSCALL);
+		register_interrupt_handler (ISR128_SYSCALL, _procmem_syscall);
+	}
+
+}
+
+int32_t procmem_get (process_t* process, proc_mem_t* mem) {
+
+	if (!process || !mem) {
+		return -1;
+	}
+
+	memset (mem, 0, sizeof(proc_mem_t));
+	mem->pid = process->pid;
+	strncpy (mem->name, process->name, PROCESS_NAME_MAX_LEN - 1);
+
+	/* a thread that ends may give its charge back from the tick */
+	uint32_t eflags;
+	asm volatile ("pushfl; popl %0; cli" : "=r" (eflags) :: "memory");
+
+	proc_charge_t* charge = _procmem_charge_of (process, false);
+	if (charge) {
+		mem->kstack = charge->kstack;
+		mem->kheap 	= charge->kheap;
+	}
+
+	if (eflags & 0x200) {
+		sti ();
+	}
+
+	/* the kernel process runs in the kernel directory */
+	if (!process->pagedir || process->pagedir == vmm_get_kerneldir ()) {
+		return 0;
+	}
+
+	const vm_usage_t* usage = vma_get_usage (process->pagedir);
+	if (usage) {
+		mem->rss 	 = usage->rss;
+		mem->swapped = usage->swapped;
+		mem->kheap 	+= usage->kobjects;
+	}
+
+	/* the directory itself and the tables of its user half */
+	mem->pgtables = 1 + (usage ? usage->pgtables : 0);
+
+	return 0;
+
+}
+
+int32_t procmem_get_nth (uint32_t index, proc_mem_t* mem) {
+
+	list_element_t* e = list_head (&_all_processes);
+	while (e && index--) {
+		e = list_next (e);
+	}
+
+	if (!e) {
+		return -1;
+	}
+
+	return procmem_get (LIST_ENTRY (process_t, e, list_all), mem);
+
+}
+
+void procmem_charge (process_t* process, int32_t kstack, int32_t kheap) {
+
+	uint32_t eflags;
+	asm volatile ("pushfl; popl %0; cli" : "=r" (eflags) :: "memory");
+
+	proc_charge_t* charge = _procmem_charge_of (process, kstack > 0 || kheap > 0);
+	if (charge) {
+		charge->kstack += kstack;
+		charge->kheap  += kheap;
+
+		/* a process that was not allocated here is done with its last thread */
+		if (!charge->kstack && !charge->kheap) {
+			list_remove (&_charges, &charge->link);
+			kmem_cache_free (_charge_cache, charge);
+		}
+	}
+
+	if (eflags & 0x200) {
+		sti ();
+	}
+
+}
+
+void procmem_release (process_t* process) {
+
+	proc_charge_t* charge = _procmem_charge_of (process, false);
+	if (charge) {
+		procmem_charge (process, -(int32_t) charge->kstack,
+						-(int32_t) charge->kheap);
+	}
+
+}
+
+void procmem_ps (void) {
+
+	proc_mem_t mem;
+
+	printk ("  PID NAME               RSS   SWAP  PGTBL  KSTACK   KHEAP\n");
+	for (uint32_t i = 0; procmem_get_nth (i, &mem) == 0; i++) {
+		printk ("%5u %-16s %5uK %5uK %5uK %6uK %6uB\n", mem.pid, mem.name,
+				mem.rss * (VMM_PAGE_SIZE / 1024),
+				mem.swapped * (VMM_PAGE_SIZE / 1024),
+				mem.pgtables * (VMM_PAGE_SIZE / 1024), mem.kstack / 1024,
+				mem.kheap);
+	}
+
+}
+
+/* Private helpers */
+
+proc_charge_t* _procmem_charge_of (process_t* process, bool create) {
+
+	if (!process || !_charge_cache) {
+		return NULL;
+	}
+
+	for (list_element_t* e = list_head (&_charges); e; e = list_next (e)) {
+		proc_charge_t* charge = LIST_ENTRY (proc_charge_t, e, link);
+		if (charge->process == process) {
+			return charge;
+		}
+	}
+
+	proc_charge_t* charge = create ? kmem_cache_alloc (_charge_cache) : NULL;
+	if (charge) {
+		charge->process = process;
+		charge->kstack 	= 0;
+		charge->kheap 	= 0;
+		list_append (&_charges, &charge->link);
+	}
+
+	return charge;
+
+}
+
+void _procmem_syscall (interrupt_context_t* context) {
+
+	if (context->eax != SYSCALL_PROCMEM) {
+		_syscall_next (context);
+		return;
+	}
+
+	proc_mem_t mem;
+
+	/* procmem(index, buf) */
+	if (procmem_get_nth (context->ebx, &mem) != 0 ||
+		copy_to_user ((void*) context->ecx, &mem, sizeof(proc_mem_t)) != 0) {
+		context->eax = (uint32_t) -1;
+		return;
+	}
+
+	context->eax = 0;
+
+}
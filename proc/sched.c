@@ -0,0 +1,386 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <proc/sched.h>
+#include <proc/pobj.h>
+#include <proc/tss.h>
+#include <mm/vmm.h>
+#include <init/syscall.h>
+#include <interrupts.h>
+#include <utils.h>
+
+#define LOG_MOD_NAME 	"SCHED"
+#define LOG_MOD_ENABLE  1
+#include <log.h>
+
+/* The prebuilt process object keeps its scheduler_post and scheduler_tick as
+	weak symbols, so the versions here replace them for every caller, its own
+	included, and the queues inside it are never used. It exports the current
+	process and thread, which the tick switches. Its thread_destroy is weak
+	as well, the one here takes the thread off the ready queues and gives its
+	reservation and its memory charge back before the original frees the
+	thread.
+
+	Threads have no room for scheduler state, so every thread object is
+	allocated with the scheduler bytes right behind it (see pobj.c). They
+	are cleared with the object, which leaves them without an owner class. A thread whose bytes belong to
+	the deadline class is queued there, every other thread in the selected
+	class. The deadline class is asked first for the next thread. */
+
+extern process_t* 	_current_process;
+extern thread_t* 	_current_thread;
+
+//! the original thread_destroy of the process object
+extern int32_t 		_thread_destroy_prebuilt (thread_t* thread);
+
+/* Some helpful macros to help reduce verbosity */
+
+//! the scheduler bytes of a thread
+#define SCHED_THREAD(t) 	((sched_thread_t*) ((t) + 1))
+
+//! true for a thread with a deadline reservation
+#define SCHED_IS_DL(t) 		(SCHED_THREAD (t)->owner == &sched_dl_class)
+
+/* Private data structures */
+
+typedef struct _sched_thread {
+
+	const sched_class_t* 	owner;		//! class the data belongs to
+	uint32_t 				queued;		//! on the queues of its class
+	uint8_t 				data[ SCHED_DATA_SIZE - sizeof(void*) -
+								  sizeof(uint32_t) ];
+
+} sched_thread_t;
+
+/* Private variables */
+
+static const sched_class_t* 	_sched_classes[] = {
+	&sched_prio_class,
+	&sched_fair_class,
+	&sched_mlfq_class
+};
+
+static const sched_class_t* 	_sched_class = &sched_prio_class;
+static uint64_t 				_sched_clock = 0;
+
+//! the syscall isr that was installed before ours
+static interrupt_service_t 		_syscall_next = NULL;
+
+//! shared with the deadline class, which counts its misses and throttles
+sched_stats_t 					_sched_stats;
+
+/* Implementation private helper routines. */
+
+//! class that queues a thread
+static const sched_class_t* 	_sched_class_of (thread_t* thread);
+
+//! serves sched_deadline(runtime, period, deadline) and sched_yield() and
+//! passes every other syscall on
+static void 	_sched_syscall (interrupt_context_t* context);
+
+/* Public functions of the interface */
+
+void sched_init (void) {
+
+	if (sched_set_class (SCHED_DEFAULT_CLASS) != 0) {
+		LOG_ERROR ("no scheduling class %s, using %s\n", SCHED_DEFAULT_CLASS,
+				   _sched_class->name);
+		_sched_class->init ();
+	}
+
+	sched_dl_class.init ();
+
+	if (get_interrupt_handler (ISR128_SYSCALL) != _sched_syscall) {
+		_syscall_next = get_interrupt_handler (ISR128_SYSCALL);
+		register_interrupt_handler (ISR128_SYSCALL, _sched_syscall);
+	}
+
+}
+
+int32_t sched_set_class (const char* name) {
+
+	const sched_class_t* class = NULL;
+
+	for (uint32_t i = 0; i < sizeof(_sched_classes) / sizeof(_sched_classes[0]);
+		 i++) {
+		if (strcmp (_sched_classes[i]->name, name) == 0) {
+			class = _sched_classes[i];
+		}
+	}
+
+	if (!class) {
+		return -1;
+	}
+
+	uint32_t eflags;
+	asm volatile ("pushfl; popl %0; cli" : "=r" (eflags) :: "memory");
+
+	const sched_class_t* old = _sched_class;
+
+	if (class != old) {
+		class->init ();
+
+		thread_t* thread;
+		while ((thread = old->pick_next ()) != NULL) {
+			class->enqueue (thread);
+		}
+
+		_sched_class = class;
+	}
+	else if (_sched_stats.nr_running == 0) {
+		class->init ();
+	}
+
+	if (eflags & 0x200) {
+		sti ();
+	}
+
+	return 0;
+
+}
+
+const char* sched_get_class (void) {
+
+	return _sched_class->name;
+
+}
+
+void scheduler_post (thread_t* thread) {
+
+	if (!thread || !thread->parent) {
+		return;
+	}
+
+	_sched_class_of (thread)->enqueue (thread);
+	SCHED_THREAD (thread)->queued = true;
+
+	if (++_sched_stats.nr_running > _sched_stats.max_running) {
+		_sched_stats.max_running = _sched_stats.nr_running;
+	}
+
+}
+
+void sched_dequeue (thread_t* thread) {
+
+	if (!sched_is_queued (thread)) {
+		return;
+	}
+
+	_sched_class_of (thread)->dequeue (thread);
+	SCHED_THREAD (thread)->queued = false;
+	_sched_stats.nr_running--;
+
+}
+
+bool sched_is_queued (thread_t* thread) {
+
+	return thread && thread->parent && SCHED_THREAD (thread)->queued;
+
+}
+
+void sched_wake (thread_t* thread) {
+
+	uint32_t eflags;
+	asm volatile ("pushfl; popl %0; cli" : "=r" (eflags) :: "memory");
+
+	if (thread && thread->state == STATE_BLOCKED) {
+		thread->state = STATE_READY;
+		scheduler_post (thread);
+	}
+
+	if (eflags & 0x200) {
+		sti ();
+	}
+
+}
+
+void scheduler_tick (interrupt_context_t* context) {
+
+	_sched_clock += SCHED_TICK_US;
+
+	if (!_current_process || !_current_thread) {
+		return;
+	}
+
+	_sched_stats.ticks++;
+	_current_thread->trap_frame = context;
+
+	sched_dl_class.clock (_sched_clock);
+	if (_sched_class->clock) {
+		_sched_class->clock (_sched_clock);
+	}
+
+	/* a thread that blocked or ended is switched out whatever the classes
+		say. the deadline class charges its own threads, and for any other
+		thread says whether one of its threads is waiting. */
+	if (_current_thread->state == STATE_RUNNING) {
+
+		bool resched = sched_dl_class.tick (_current_thread);
+		if (!SCHED_IS_DL (_current_thread)) {
+			resched |= _sched_class->tick (_current_thread);
+		}
+
+		if (!resched) {
+			return;
+		}
+	}
+
+	thread_t* next = sched_dl_class.pick_next ();
+	if (!next) {
+		next = _sched_class->pick_next ();
+	}
+
+	/* a running thread got here only if its class wants it switched out. a
+		deadline thread that was throttled or yielded still waits for its
+		next period with nothing else to run, it goes on from the idle loop
+		once the clock refills it and it is picked again. */
+	if (!next) {
+		if (_current_thread->state == STATE_RUNNING &&
+			SCHED_IS_DL (_current_thread)) {
+			_current_thread->state = STATE_READY;
+			scheduler_post (_current_thread);
+		}
+		_sched_stats.idle_ticks++;
+		return;
+	}
+
+	SCHED_THREAD (next)->queued = false;
+	_sched_stats.nr_running--;
+
+	if (_current_thread->state == STATE_RUNNING) {
+		_current_thread->state = STATE_READY;
+		scheduler_post (_current_thread);
+	}
+
+	if (_current_thread->state == STATE_TERMINATED) {
+		thread_destroy (_current_thread);
+	}
+
+	if (next != _current_thread) {
+		_sched_stats.switches++;
+	}
+
+	next->state = STATE_RUNNING;
+
+	process_t* proc = next->parent;
+	if (proc && proc->pagedir != _current_process->pagedir) {
+		vmm_switch_pagedir (proc->pagedir);
+	}
+
+	tss_update_esp0 ((uint32_t) next->esp0_start + next->kstack_size);
+
+	_current_process = proc;
+	_current_thread  = next;
+
+	/* continue wherever the next thread was interrupted */
+	asm volatile (
+		"movl %0, %%esp\n"
+		"popl %%ds\n"
+		"popa\n"
+		"addl $8, %%esp\n"
+		"iret\n"
+		:: "r" (next->trap_frame) : "memory");
+
+}
+
+int32_t thread_destroy (thread_t* thread) {
+
+	/* a thread of a process that exits may still be queued, and one with a
+		reservation holds on to its bandwidth */
+	if (thread && thread->parent) {
+
+		uint32_t eflags;
+		asm volatile ("pushfl; popl %0; cli" : "=r" (eflags) :: "memory");
+
+		sched_dequeue (thread);
+		sched_set_deadline (thread, 0, 0, 0);
+		pobj_charge_thread (thread, false);
+
+		if (eflags & 0x200) {
+			sti ();
+		}
+	}
+
+	return _thread_destroy_prebuilt (thread);
+
+}
+
+uint32_t sched_nr_running (void) {
+
+	return _sched_stats.nr_running;
+
+}
+
+uint64_t sched_clock (void) {
+
+	return _sched_clock;
+
+}
+
+void* sched_thread_data (thread_t* thread, const sched_class_t* class) {
+
+	sched_thread_t* st = SCHED_THREAD (thread);
+
+	if (st->owner != class) {
+		memset (st->data, 0, sizeof(st->data));
+		st->owner = class;
+	}
+
+	return st->data;
+
+}
+
+const sched_class_t* sched_thread_owner (thread_t* thread) {
+
+	return SCHED_THREAD (thread)->owner;
+
+}
+
+const sched_stats_t* sched_get_stats (void) {
+
+	return &_sched_stats;
+
+}
+
+void sched_stats (void) {
+
+	const sched_stats_t* s = &_sched_stats;
+
+	printk ("sched: class %s, %u ready (at most %u)\n", _sched_class->name,
+			s->nr_running, s->max_running);
+	printk ("sched: %u ticks, %u switches, %u idle\n", s->ticks, s->switches,
+			s->idle_ticks);
+
+	if (_sched_class->stats) {
+		_sched_class->stats ();
+	}
+
+	sched_dl_class.stats ();
+
+}
+
+/* Private helpers */
+
+const sched_class_t* _sched_class_of (thread_t* thread) {
+
+	return SCHED_IS_DL (thread) ? &sched_dl_class : _sched_class;
+
+}
+
+void _sched_syscall (interrupt_context_t* context) {
+
+	/* sched_deadline(runtime, period, deadline) for the calling thread */
+	if (context->eax == SYSCALL_SCHED_DEADLINE) {
+		context->eax = sched_set_deadline (get_current_thread (), context->ebx,
+										   context->ecx, context->edx);
+	}
+	else if (context->eax == SYSCALL_SCHED_YIELD) {
+		sched_dl_yield ();
+		context->eax = 0;
+	}
+	else {
+		_syscall_next (context);
+	}
+
+}
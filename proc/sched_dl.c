@@ -0,0 +1,377 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <proc/sched.h>
+#include <kernel/rbtree.h>
+#include <utils.h>
+
+/* Earliest deadline first over reservations. A thread reserves a runtime in
+	every period, due a deadline after the period starts, and a thread is
+	only admitted while the reservations add up to no more than the limit, so
+	EDF can meet every deadline and the other classes keep the rest.
+
+	The ready threads are in a tree ordered by absolute deadline. The running
+	thread is charged its runtime tick by tick, and once it is used up the
+	thread is throttled: it waits in a second tree, ordered by the start of
+	its next period, until the clock reaches it and the runtime is refilled.
+	A thread that wakes up late enough that its remaining runtime would not
+	fit before its old deadline at the reserved rate gets a fresh period, so
+	sleeping cannot be used to take more than the reservation (the constant
+	bandwidth server rule).
+
+	A deadline is missed when it passes while the thread still has runtime
+	left, each period counts at most once. */
+
+/* Some helpful macros to help reduce verbosity */
+
+#define ENTITY(n) 			RB_ENTRY (dl_entity_t, n, node)
+
+//! bandwidth of a reservation
+#define DL_BW(runtime, period) \
+							(((runtime) << SCHED_DL_BW_SHIFT) / (period))
+
+/* Private data structures */
+
+typedef struct _dl_entity {
+
+	rb_node_t 	node;			//! node in the ready or the throttled tree
+	thread_t* 	thread;
+	uint32_t 	runtime;		//! the reservation
+	uint32_t 	period;
+	uint32_t 	deadline;
+	uint64_t 	abs_deadline;	//! deadline of the current period
+	uint64_t 	replenish_at;	//! start of the next period while throttled
+	int32_t 	remaining;		//! runtime left in the current period
+	uint32_t 	misses;			//! deadlines missed
+	bool 		throttled;		//! waiting for the next period
+	bool 		yielded;		//! gave up the rest of the period
+	bool 		missed;			//! this period was counted as missed
+
+} dl_entity_t;
+
+//! the core statistics, the misses and throttles are counted here
+extern sched_stats_t 	_sched_stats;
+
+/* Private variables */
+
+static rb_tree_t 		_dl_ready;
+static rb_tree_t 		_dl_throttled;
+static uint32_t 		_dl_total_bw = 0;
+
+/* Implementation private helper routines. */
+
+static void 		_dl_init (void);
+static void 		_dl_enqueue (thread_t* thread);
+static void 		_dl_dequeue (thread_t* thread);
+static thread_t* 	_dl_pick_next (void);
+static bool 		_dl_tick (thread_t* curr);
+static void 		_dl_clock (uint64_t now);
+static void 		_dl_stats (void);
+
+//! the entity of a thread that is in the class, NULL for any other thread
+static dl_entity_t* _dl_entity (thread_t* thread);
+
+//! orders the ready tree by deadline and the throttled tree by period start
+static int 			_dl_cmp_deadline (const rb_node_t* a, const rb_node_t* b);
+static int 			_dl_cmp_replenish (const rb_node_t* a, const rb_node_t* b);
+
+//! starts a new period with the full runtime
+static void 		_dl_replenish (dl_entity_t* se, uint64_t start);
+
+//! counts a miss if the deadline passed with runtime left
+static void 		_dl_check_miss (dl_entity_t* se, uint64_t now);
+
+/* Public functions of the interface */
+
+const sched_class_t sched_dl_class = {
+	.name 		= "dl",
+	.init 		= _dl_init,
+	.enqueue 	= _dl_enqueue,
+	.dequeue 	= _dl_dequeue,
+	.pick_next 	= _dl_pick_next,
+	.tick 		= _dl_tick,
+	.clock 		= _dl_clock,
+	.stats 		= _dl_stats
+};
+
+int32_t sched_set_deadline (thread_t* thread, uint32_t runtime,
+							uint32_t period, uint32_t deadline) {
+
+	if (!thread || !thread->parent) {
+		return -1;
+	}
+
+	if (deadline == 0) {
+		deadline = period;
+	}
+
+	if (runtime && (period > SCHED_DL_PERIOD_MAX || runtime > deadline ||
+					deadline > period)) {
+		return -1;
+	}
+
+	uint32_t eflags;
+	asm volatile ("pushfl; popl %0; cli" : "=r" (eflags) :: "memory");
+
+	dl_entity_t* se 	= _dl_entity (thread);
+	uint32_t 	 old_bw = se ? DL_BW (se->runtime, se->period) : 0;
+	uint32_t 	 new_bw = runtime ? DL_BW (runtime, period) : 0;
+
+	if (_dl_total_bw - old_bw + new_bw > SCHED_DL_BW_LIMIT) {
+		if (eflags & 0x200) {
+			sti ();
+		}
+		return -1;
+	}
+
+	_dl_total_bw = _dl_total_bw - old_bw + new_bw;
+
+	/* a queued thread moves to the class that now owns it */
+	bool queued = sched_is_queued (thread);
+	sched_dequeue (thread);
+
+	if (runtime) {
+		if (!se) {
+			se = sched_thread_data (thread, &sched_dl_class);
+			se->thread = thread;
+		}
+
+		se->runtime  = runtime;
+		se->period 	 = period;
+		se->deadline = deadline;
+
+		se->throttled = false;
+		se->yielded   = false;
+		_dl_replenish (se, sched_clock ());
+	}
+	else if (se) {
+		sched_thread_data (thread, NULL);
+	}
+
+	if (queued) {
+		scheduler_post (thread);
+	}
+
+	if (eflags & 0x200) {
+		sti ();
+	}
+
+	return 0;
+
+}
+
+int32_t sched_get_deadline (thread_t* thread, sched_dl_attr_t* attr) {
+
+	dl_entity_t* se = thread ? _dl_entity (thread) : NULL;
+
+	if (!se || !attr) {
+		return -1;
+	}
+
+	attr->runtime  = se->runtime;
+	attr->period   = se->period;
+	attr->deadline = se->deadline;
+	attr->misses   = se->misses;
+
+	return 0;
+
+}
+
+void sched_dl_yield (void) {
+
+	thread_t* self = get_current_thread ();
+
+	uint32_t eflags;
+	asm volatile ("pushfl; popl %0; cli" : "=r" (eflags) :: "memory");
+
+	dl_entity_t* se = self ? _dl_entity (self) : NULL;
+	if (se) {
+
+		/* the next tick throttles the thread, which goes on from here when
+			its next period starts */
+		se->yielded = true;
+		while (se->yielded) {
+			asm volatile ("sti; hlt; cli" ::: "memory");
+		}
+	}
+
+	if (eflags & 0x200) {
+		sti ();
+	}
+
+}
+
+uint32_t sched_dl_bandwidth (void) {
+
+	return _dl_total_bw;
+
+}
+
+/* Private helpers */
+
+void _dl_init (void) {
+
+	rb_init (&_dl_ready, NULL);
+	rb_init (&_dl_throttled, NULL);
+
+}
+
+void _dl_enqueue (thread_t* thread) {
+
+	dl_entity_t* se  = _dl_entity (thread);
+	uint64_t 	 now = sched_clock ();
+
+	if (se->throttled) {
+		rb_insert (&_dl_throttled, &se->node, _dl_cmp_replenish);
+		return;
+	}
+
+	/* the runtime left must fit before the deadline at the reserved rate,
+		otherwise the thread starts over in a new period */
+	if (se->remaining <= 0 || now >= se->abs_deadline ||
+		(uint64_t) se->remaining * se->period >
+		(se->abs_deadline - now) * se->runtime) {
+		_dl_replenish (se, now);
+	}
+
+	rb_insert (&_dl_ready, &se->node, _dl_cmp_deadline);
+
+}
+
+void _dl_dequeue (thread_t* thread) {
+
+	dl_entity_t* se = _dl_entity (thread);
+
+	rb_remove (se->throttled ? &_dl_throttled : &_dl_ready, &se->node);
+
+}
+
+thread_t* _dl_pick_next (void) {
+
+	rb_node_t* first = rb_first (&_dl_ready);
+	if (!first) {
+		return NULL;
+	}
+
+	rb_remove (&_dl_ready, first);
+	return ENTITY (first)->thread;
+
+}
+
+bool _dl_tick (thread_t* curr) {
+
+	dl_entity_t* se 	= _dl_entity (curr);
+	rb_node_t* 	 first 	= rb_first (&_dl_ready);
+
+	/* a thread of another class gives way to any ready deadline thread */
+	if (!se) {
+		return first != NULL;
+	}
+
+	se->remaining -= SCHED_TICK_US;
+	_dl_check_miss (se, sched_clock ());
+
+	if (se->remaining <= 0 || se->yielded) {
+
+		if (!se->yielded) {
+			_sched_stats.dl_throttles++;
+		}
+
+		/* the next period starts a period after the current one, or right
+			away if the thread overran that as well */
+		uint64_t next = se->abs_deadline - se->deadline + se->period;
+		if (next < sched_clock ()) {
+			next = sched_clock ();
+		}
+
+		se->replenish_at = next;
+		se->throttled 	 = true;
+		return true;
+	}
+
+	return first && ENTITY (first)->abs_deadline < se->abs_deadline;
+
+}
+
+void _dl_clock (uint64_t now) {
+
+	rb_node_t* node;
+
+	/* refill the throttled threads whose next period has started */
+	while ((node = rb_first (&_dl_throttled)) != NULL &&
+		   ENTITY (node)->replenish_at <= now) {
+
+		dl_entity_t* se = ENTITY (node);
+
+		rb_remove (&_dl_throttled, node);
+		se->throttled = false;
+		se->yielded   = false;
+
+		_dl_replenish (se, se->replenish_at);
+		rb_insert (&_dl_ready, &se->node, _dl_cmp_deadline);
+	}
+
+	/* the ready threads are in deadline order, stop at the first that can
+		still make it */
+	for (node = rb_first (&_dl_ready); node; node = rb_next (node)) {
+
+		dl_entity_t* se = ENTITY (node);
+		if (se->abs_deadline >= now) {
+			break;
+		}
+		_dl_check_miss (se, now);
+	}
+
+}
+
+void _dl_stats (void) {
+
+	printk ("sched: %u deadline threads ready, %u throttled, %u/%u of the cpu "
+			"reserved\n", rb_size (&_dl_ready), rb_size (&_dl_throttled),
+			_dl_total_bw, 1 << SCHED_DL_BW_SHIFT);
+	printk ("sched: %u deadline misses, %u throttles\n", _sched_stats.dl_misses,
+			_sched_stats.dl_throttles);
+
+}
+
+dl_entity_t* _dl_entity (thread_t* thread) {
+
+	/* asking with another owner would hand the bytes over */
+	if (sched_thread_owner (thread) != &sched_dl_class) {
+		return NULL;
+	}
+
+	return sched_thread_data (thread, &sched_dl_class);
+
+}
+
+int _dl_cmp_deadline (const rb_node_t* a, const rb_node_t* b) {
+
+	return ENTITY (a)->abs_deadline < ENTITY (b)->abs_deadline ? -1 : 1;
+
+}
+
+int _dl_cmp_replenish (const rb_node_t* a, const rb_node_t* b) {
+
+	return ENTITY (a)->replenish_at < ENTITY (b)->replenish_at ? -1 : 1;
+
+}
+
+void _dl_replenish (dl_entity_t* se, uint64_t start) {
+
+	se->abs_deadline = start + se->deadline;
+	se->remaining 	 = se->runtime;
+	se->missed 		 = false;
+
+}
+
+void _dl_check_miss (dl_entity_t* se, uint64_t now) {
+
+	if (!se->missed && se->remaining > 0 && now > se->abs_deadline) {
+		se->missed = true;
+		se->misses++;
+		_sched_stats.dl_misses++;
+	}
+
+}
@@ -0,0 +1,183 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <proc/sched.h>
+#include <kernel/rbtree.h>
+
+/* Fair sharing by weighted virtual runtime. Every thread carries the time it
+	has run, scaled down by its weight, and the ready threads are kept in a
+	tree ordered by it, so the one that got the least of its share is always
+	the leftmost node. The running thread keeps the cpu until it has used its
+	slice of the target latency, which is split between the ready threads by
+	weight.
+
+	A thread that was not ready for a while is put back no further than half
+	a latency behind the others, so it runs soon after waking but cannot make
+	up for all the time it slept. */
+
+/* Some helpful macros to help reduce verbosity */
+
+#define ENTITY(n) 			RB_ENTRY (fair_entity_t, n, node)
+
+/* Private data structures */
+
+typedef struct _fair_entity {
+
+	rb_node_t 	node;			//! node in the timeline while ready
+	uint64_t 	vruntime;		//! weighted run time in microseconds
+	uint32_t 	weight;			//! share of the cpu, from the priority
+	uint32_t 	slice_used;		//! microseconds run since it was picked
+	thread_t* 	thread;
+
+} fair_entity_t;
+
+/* Private variables */
+
+//! weights by priority, every step is worth about 25% of cpu time
+static const uint32_t 	_fair_weights[ PROCESS_NUM_PRIORITIES ] = {
+	335, 419, 524, 655, 819, SCHED_WEIGHT_DEFAULT, 1280, 1600, 2000, 2500, 3125
+};
+
+static rb_tree_t 		_timeline;
+static uint64_t 		_min_vruntime 	= 0;
+static uint32_t 		_total_weight 	= 0;
+
+/* Implementation private helper routines. */
+
+static void 		_fair_init (void);
+static void 		_fair_enqueue (thread_t* thread);
+static void 		_fair_dequeue (thread_t* thread);
+static thread_t* 	_fair_pick_next (void);
+static bool 		_fair_tick (thread_t* curr);
+static void 		_fair_stats (void);
+
+//! returns the entity of a thread, sets it up the first time it is seen
+static fair_entity_t* 	_fair_entity (thread_t* thread);
+
+//! orders the timeline, equal run times go behind so they take turns
+static int 			_fair_cmp (const rb_node_t* a, const rb_node_t* b);
+
+/* Public functions of the interface */
+
+const sched_class_t sched_fair_class = {
+	.name 		= "fair",
+	.init 		= _fair_init,
+	.enqueue 	= _fair_enqueue,
+	.dequeue 	= _fair_dequeue,
+	.pick_next 	= _fair_pick_next,
+	.tick 		= _fair_tick,
+	.stats 		= _fair_stats
+};
+
+/* Private helpers */
+
+void _fair_init (void) {
+
+	rb_init (&_timeline, NULL);
+	_min_vruntime = 0;
+	_total_weight = 0;
+
+}
+
+void _fair_enqueue (thread_t* thread) {
+
+	fair_entity_t* se 	 = _fair_entity (thread);
+	uint64_t 	   floor = _min_vruntime > SCHED_LATENCY_US / 2 ?
+						   _min_vruntime - SCHED_LATENCY_US / 2 : 0;
+
+	if (se->vruntime < floor) {
+		se->vruntime = floor;
+	}
+
+	rb_insert (&_timeline, &se->node, _fair_cmp);
+	_total_weight += se->weight;
+
+}
+
+void _fair_dequeue (thread_t* thread) {
+
+	fair_entity_t* se = _fair_entity (thread);
+
+	rb_remove (&_timeline, &se->node);
+	_total_weight -= se->weight;
+
+}
+
+thread_t* _fair_pick_next (void) {
+
+	rb_node_t* first = rb_first (&_timeline);
+	if (!first) {
+		return NULL;
+	}
+
+	fair_entity_t* se = ENTITY (first);
+
+	rb_remove (&_timeline, first);
+	_total_weight -= se->weight;
+
+	if (se->vruntime > _min_vruntime) {
+		_min_vruntime = se->vruntime;
+	}
+
+	se->slice_used = 0;
+	return se->thread;
+
+}
+
+bool _fair_tick (thread_t* curr) {
+
+	fair_entity_t* se = _fair_entity (curr);
+
+	se->vruntime   += SCHED_TICK_US * SCHED_WEIGHT_DEFAULT / se->weight;
+	se->slice_used += SCHED_TICK_US;
+
+	if (rb_is_empty (&_timeline)) {
+		return false;
+	}
+
+	/* the running thread is off the timeline, count it in */
+	uint32_t slice = SCHED_LATENCY_US * se->weight / (_total_weight + se->weight);
+	if (slice < SCHED_MIN_GRANULARITY_US) {
+		slice = SCHED_MIN_GRANULARITY_US;
+	}
+
+	return se->slice_used >= slice;
+
+}
+
+void _fair_stats (void) {
+
+	printk ("sched: %u on the timeline, weight %u, min vruntime %u us\n",
+			rb_size (&_timeline), _total_weight, (uint32_t) _min_vruntime);
+
+}
+
+fair_entity_t* _fair_entity (thread_t* thread) {
+
+	fair_entity_t* se = sched_thread_data (thread, &sched_fair_class);
+
+	if (!se->thread) {
+		int32_t prio = thread->parent->priority;
+
+		if (prio < PROCESS_PRI_MIN) {
+			prio = PROCESS_PRI_MIN;
+		}
+		if (prio > PROCESS_PRI_MAX) {
+			prio = PROCESS_PRI_MAX;
+		}
+
+		se->thread 	 = thread;
+		se->weight 	 = _fair_weights[prio];
+		se->vruntime = _min_vruntime;
+	}
+
+	return se;
+
+}
+
+int _fair_cmp (const rb_node_t* a, const rb_node_t* b) {
+
+	return ENTITY (a)->vruntime < ENTITY (b)->vruntime ? -1 : 1;
+
+}
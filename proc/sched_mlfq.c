@@ -0,0 +1,208 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <proc/sched.h>
+
+/* Multi level feedback queue. Threads start at the top level and the highest
+	level with a ready thread runs round robin. A thread that runs for the
+	whole time slice of its level moves one level down, where the slice is
+	twice as long. The run time adds up across the times the thread is picked,
+	so blocking just before the slice ends does not keep a thread up, but one
+	that mostly waits for input never uses a slice up and stays on top. A
+	thread that becomes ready on a higher level than the running one takes
+	the cpu at the next tick.
+
+	Once a second every thread goes back to the top level, so the threads
+	that were moved down cannot starve. The second is counted on the clock
+	of every tick, whoever runs or if nobody does. The boost only bumps an epoch, and a
+	thread whose epoch is behind is put back to the top the next time the
+	class looks at it. The ready threads are moved to the top queue at once,
+	which keeps their queue in line with their level. */
+
+/* Private data structures */
+
+typedef struct _mlfq_entity {
+
+	uint32_t 	level;			//! current level, 0 is the top
+	uint32_t 	used;			//! ticks run on the current level
+	uint32_t 	epoch;			//! boost the level was last checked against
+	bool 		seen;			//! set up for this class
+
+} mlfq_entity_t;
+
+/* Private variables */
+
+static list_t 				_mlfq_queues[ SCHED_MLFQ_LEVELS ];
+static uint32_t 			_mlfq_epoch = 0;
+static uint32_t 			_mlfq_ticks = 0;
+static sched_mlfq_stats_t 	_mlfq_stats;
+
+/* Implementation private helper routines. */
+
+static void 		_mlfq_init (void);
+static void 		_mlfq_enqueue (thread_t* thread);
+static void 		_mlfq_dequeue (thread_t* thread);
+static thread_t* 	_mlfq_pick_next (void);
+static bool 		_mlfq_tick (thread_t* curr);
+static void 		_mlfq_clock (uint64_t now);
+static void 		_mlfq_stats_print (void);
+
+//! returns the entity of a thread, with its level brought up to the last boost
+static mlfq_entity_t* 	_mlfq_entity (thread_t* thread);
+
+//! highest level with a ready thread, SCHED_MLFQ_LEVELS if there is none
+static uint32_t 	_mlfq_top_level (void);
+
+//! moves every ready thread to the top queue
+static void 		_mlfq_boost (void);
+
+/* Public functions of the interface */
+
+const sched_class_t sched_mlfq_class = {
+	.name 		= "mlfq",
+	.init 		= _mlfq_init,
+	.enqueue 	= _mlfq_enqueue,
+	.dequeue 	= _mlfq_dequeue,
+	.pick_next 	= _mlfq_pick_next,
+	.tick 		= _mlfq_tick,
+	.clock 		= _mlfq_clock,
+	.stats 		= _mlfq_stats_print
+};
+
+uint32_t sched_mlfq_level (thread_t* thread) {
+
+	return _mlfq_entity (thread)->level;
+
+}
+
+const sched_mlfq_stats_t* sched_mlfq_get_stats (void) {
+
+	return &_mlfq_stats;
+
+}
+
+/* Private helpers */
+
+void _mlfq_init (void) {
+
+	for (uint32_t i = 0; i < SCHED_MLFQ_LEVELS; i++) {
+		list_init (&_mlfq_queues[i]);
+	}
+
+	_mlfq_ticks = 0;
+
+}
+
+void _mlfq_enqueue (thread_t* thread) {
+
+	mlfq_entity_t* se = _mlfq_entity (thread);
+
+	list_append (&_mlfq_queues[se->level], &thread->list_all);
+
+}
+
+void _mlfq_dequeue (thread_t* thread) {
+
+	mlfq_entity_t* se = _mlfq_entity (thread);
+
+	list_remove (&_mlfq_queues[se->level], &thread->list_all);
+
+}
+
+thread_t* _mlfq_pick_next (void) {
+
+	uint32_t level = _mlfq_top_level ();
+	if (level == SCHED_MLFQ_LEVELS) {
+		return NULL;
+	}
+
+	list_element_t* entry = list_remove_head (&_mlfq_queues[level]);
+	return LIST_ENTRY (thread_t, entry, list_all);
+
+}
+
+bool _mlfq_tick (thread_t* curr) {
+
+	mlfq_entity_t* se = _mlfq_entity (curr);
+
+	if (++se->used >= SCHED_MLFQ_SLICE (se->level)) {
+		if (se->level < SCHED_MLFQ_LEVELS - 1) {
+			se->level++;
+			_mlfq_stats.demotions++;
+		}
+		se->used = 0;
+		return _mlfq_top_level () != SCHED_MLFQ_LEVELS;
+	}
+
+	if (_mlfq_top_level () < se->level) {
+		_mlfq_stats.preemptions++;
+		return true;
+	}
+
+	return false;
+
+}
+
+void _mlfq_clock (uint64_t now) {
+
+	if (++_mlfq_ticks % SCHED_MLFQ_BOOST_TICKS == 0) {
+		_mlfq_boost ();
+	}
+
+}
+
+void _mlfq_stats_print (void) {
+
+	printk ("sched: ready by level");
+	for (uint32_t i = 0; i < SCHED_MLFQ_LEVELS; i++) {
+		printk (" %u", list_size (&_mlfq_queues[i]));
+	}
+	printk ("\n");
+
+	printk ("sched: %u demotions, %u preemptions, %u boosts\n",
+			_mlfq_stats.demotions, _mlfq_stats.preemptions, _mlfq_stats.boosts);
+
+}
+
+mlfq_entity_t* _mlfq_entity (thread_t* thread) {
+
+	mlfq_entity_t* se = sched_thread_data (thread, &sched_mlfq_class);
+
+	if (!se->seen || se->epoch != _mlfq_epoch) {
+		se->seen  = true;
+		se->epoch = _mlfq_epoch;
+		se->level = 0;
+		se->used  = 0;
+	}
+
+	return se;
+
+}
+
+uint32_t _mlfq_top_level (void) {
+
+	uint32_t level = 0;
+
+	while (level < SCHED_MLFQ_LEVELS && list_is_empty (&_mlfq_queues[level])) {
+		level++;
+	}
+
+	return level;
+
+}
+
+void _mlfq_boost (void) {
+
+	for (uint32_t i = 1; i < SCHED_MLFQ_LEVELS; i++) {
+
+		list_element_t* entry;
+		while ((entry = list_remove_head (&_mlfq_queues[i])) != NULL) {
+			list_append (&_mlfq_queues[0], entry);
+		}
+	}
+
+	_mlfq_epoch++;
+	_mlfq_stats.boosts++;
+
+}
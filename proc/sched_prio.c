@@ -0,0 +1,125 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <proc/sched.h>
+
+/* Fixed priority round robin. There is one queue per priority and a bitmap
+	with a bit for every queue that holds a thread, so the highest priority
+	ready thread is found with a single bsf and posting or picking a thread
+	never walks the queues, however many threads there are. */
+
+/* Private variables */
+
+static list_t 		_ready_queues[ PROCESS_NUM_PRIORITIES ];
+static uint32_t 	_ready_bitmap = 0;
+
+/* Implementation private helper routines. */
+
+static void 		_prio_init (void);
+static void 		_prio_enqueue (thread_t* thread);
+static void 		_prio_dequeue (thread_t* thread);
+static thread_t* 	_prio_pick_next (void);
+static bool 		_prio_tick (thread_t* curr);
+static void 		_prio_stats (void);
+
+//! clamps the priority of the thread's process to the queue range
+static int32_t 		_prio_of (thread_t* thread);
+
+/* Public functions of the interface */
+
+const sched_class_t sched_prio_class = {
+	.name 		= "prio",
+	.init 		= _prio_init,
+	.enqueue 	= _prio_enqueue,
+	.dequeue 	= _prio_dequeue,
+	.pick_next 	= _prio_pick_next,
+	.tick 		= _prio_tick,
+	.stats 		= _prio_stats
+};
+
+uint32_t sched_ready_bitmap (void) {
+
+	return _ready_bitmap;
+
+}
+
+/* Private helpers */
+
+void _prio_init (void) {
+
+	for (int32_t i = 0; i < PROCESS_NUM_PRIORITIES; i++) {
+		list_init (&_ready_queues[i]);
+	}
+
+	_ready_bitmap = 0;
+
+}
+
+void _prio_enqueue (thread_t* thread) {
+
+	int32_t prio = _prio_of (thread);
+
+	list_append (&_ready_queues[prio], &thread->list_all);
+	_ready_bitmap |= SCHED_PRIO_BIT (prio);
+
+}
+
+void _prio_dequeue (thread_t* thread) {
+
+	int32_t prio = _prio_of (thread);
+
+	list_remove (&_ready_queues[prio], &thread->list_all);
+	if (list_is_empty (&_ready_queues[prio])) {
+		_ready_bitmap &= ~SCHED_PRIO_BIT (prio);
+	}
+
+}
+
+thread_t* _prio_pick_next (void) {
+
+	if (!_ready_bitmap) {
+		return NULL;
+	}
+
+	uint32_t bit;
+	asm ("bsfl %1, %0" : "=r" (bit) : "rm" (_ready_bitmap));
+
+	int32_t 		prio  = PROCESS_PRI_MAX - bit;
+	list_element_t* entry = list_remove_head (&_ready_queues[prio]);
+
+	if (list_is_empty (&_ready_queues[prio])) {
+		_ready_bitmap &= ~SCHED_PRIO_BIT (prio);
+	}
+
+	return LIST_ENTRY (thread_t, entry, list_all);
+
+}
+
+bool _prio_tick (thread_t* curr) {
+
+	/* every tick goes to the next ready thread */
+	return true;
+
+}
+
+void _prio_stats (void) {
+
+	printk ("sched: ready priorities %x\n", _ready_bitmap);
+
+}
+
+int32_t _prio_of (thread_t* thread) {
+
+	int32_t prio = thread->parent->priority;
+
+	if (prio < PROCESS_PRI_MIN) {
+		prio = PROCESS_PRI_MIN;
+	}
+	if (prio > PROCESS_PRI_MAX) {
+		prio = PROCESS_PRI_MAX;
+	}
+
+	return prio;
+
+}
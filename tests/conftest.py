@@ -18,11 +18,31 @@ def pytest_configure(config):
     config.addinivalue_line("markers", "sys: System call tests")
     config.addinivalue_line("markers", "kmm: kernel physical memory manager tests")
     config.addinivalue_line("markers", "kheap: kernel heap allocator tests")
+    config.addinivalue_line("markers", "slab: slab object cache tests")
+    config.addinivalue_line("markers", "vmalloc: vmalloc allocator tests")
+    config.addinivalue_line("markers", "shrinker: memory pressure reclaim tests")
+    config.addinivalue_line("markers", "cow: copy on write fork tests")
+    config.addinivalue_line("markers", "demand: demand paging tests")
+    config.addinivalue_line("markers", "vma: address space area tests")
+    config.addinivalue_line("markers", "tlb: global page and tlb flush tests")
+    config.addinivalue_line("markers", "pse: 4MB page tests")
+    config.addinivalue_line("markers", "hugepage: 4MB user page tests")
+    config.addinivalue_line("markers", "fixmap: recursive mapping and fixmap tests")
+    config.addinivalue_line("markers", "swap: swap and page reclaim tests")
+    config.addinivalue_line("markers", "shm: shared memory segment tests")
+    config.addinivalue_line("markers", "zeropage: shared zero page tests")
+    config.addinivalue_line("markers", "ksm: same page merging tests")
+    config.addinivalue_line("markers", "uaccess: fault safe user copy tests")
+    config.addinivalue_line("markers", "pgfault: page fault profiling tests")
+    config.addinivalue_line("markers", "highmem: memory above 4GB tests")
+    config.addinivalue_line("markers", "kstack: kernel stack cache tests")
+    config.addinivalue_line("markers", "sched: scheduler ready queue tests")
     config.addinivalue_line("markers", "vmm: virtual memory manager tests")
     config.addinivalue_line("markers", "timer: PIT timer tests")
     config.addinivalue_line("markers", "tss: Task State Segment tests")
     config.addinivalue_line("markers", "elf: ELF loading tests")
     config.addinivalue_line("markers", "proc: process management tests")
+    config.addinivalue_line("markers", "procmem: process memory accounting tests")
     config.addinivalue_line("markers", "hfs: filesystem tests")
 
 # CONFIGURE YOUR TEST SUITES HERE
@@ -36,11 +56,31 @@ ENABLED_SUITES = [
     "sys",
     "kmm",
     "kheap",
+    "slab",
+    "vmalloc",
+    "shrinker",
+    "cow",
+    "demand",
+    "vma",
+    "tlb",
+    "pse",
+    "hugepage",
+    "fixmap",
+    "swap",
+    "shm",
+    "zeropage",
+    "ksm",
+    "uaccess",
+    "pgfault",
+    "highmem",
+    "kstack",
     "vmm",
     "timer",
     "tss",
     "elf",
     "proc",
+    "procmem",
+    "sched",
     "hfs"
 ]
 
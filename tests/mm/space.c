@@ -0,0 +1,14 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#include <mm/vmm.h>
+#include "space.h"
+
+pagedir_t *test_make_space(void) {
+    pagedir_t *kdir = vmm_get_kerneldir();
+    pagedir_t *pdir = vmm_create_address_space();
+    if (!pdir) return NULL;
+
+    for (int i = 0; i < VMM_PAGES_PER_DIR; i++) pdir->table[i] = kdir->table[i];
+    return pdir;
+}
@@ -0,0 +1,10 @@
+#ifndef _MM_TEST_SPACE_H
+#define _MM_TEST_SPACE_H
+
+#include <mm/vmm.h>
+
+/* a fresh user address space that shares the kernel's page tables, the way
+   a process gets one. destroy it with vmm_destroy_space. */
+extern pagedir_t *test_make_space(void);
+
+#endif // _MM_TEST_SPACE_H
@@ -0,0 +1,177 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <mm/cow.h>
+#include <mm/frame.h>
+#include <mm/kmm.h>
+#include <mm/vmm.h>
+#include <mm/pgtable.h>
+#include <mem.h>
+#include <utils.h>
+#include <testmain.h>
+#include "space.h"
+
+#define COW_TEST_ADDR   0x40000000
+#define COW_USER_FLAGS  (PTE_PRESENT | PTE_WRITABLE | PTE_USER)
+
+/* builds an address space with npages of user memory, each page filled
+    with its index */
+static pagedir_t *make_filled_space(uint32_t npages) {
+    pagedir_t *pdir = test_make_space();
+    if (!pdir) return NULL;
+
+    if (!vmm_alloc_region(pdir, (void *)COW_TEST_ADDR, npages * VMM_PAGE_SIZE,
+                          COW_USER_FLAGS)) {
+        vmm_destroy_pagedir(pdir);
+        return NULL;
+    }
+
+    for (uint32_t i = 0; i < npages; i++) {
+        void *phys = vmm_get_phys_frame(pdir, (void *)(COW_TEST_ADDR + i * VMM_PAGE_SIZE));
+        memset(PHYS_TO_VIRT(phys), (int)i, VMM_PAGE_SIZE);
+    }
+
+    return pdir;
+}
+
+/* clones pdir from inside it, like fork does from the parent */
+static pagedir_t *clone_from(pagedir_t *pdir, pagedir_t *(*clone)(void)) {
+    pagedir_t *saved = vmm_get_current_pagedir();
+    vmm_switch_pagedir(pdir);
+    pagedir_t *child = clone();
+    vmm_switch_pagedir(saved);
+    return child;
+}
+
+// ---------------- Clone shares frames read-only ----------------
+void test_cow_clone_shares() {
+    uint32_t used = kmm_get_used_frames();
+
+    pagedir_t *parent = make_filled_space(1);
+    ASSERT_NOT_NULL(parent, "address space setup failed");
+
+    pagedir_t *child = clone_from(parent, vmm_clone_pagedir_cow);
+    ASSERT_NOT_NULL(child, "cow clone failed");
+
+    pte_t *ppte = pgtable_get_pte(parent, (void *)COW_TEST_ADDR);
+    pte_t *cpte = pgtable_get_pte(child, (void *)COW_TEST_ADDR);
+    ASSERT_TRUE(ppte && cpte, "pte missing after clone");
+
+    void *frame = (void *)PTE_FRAME_ADDR(*ppte);
+    ASSERT_EQ(PTE_FRAME_ADDR(*cpte), (uintptr_t)frame, "frame not shared");
+    ASSERT_FALSE(*ppte & PTE_WRITABLE, "parent still writable");
+    ASSERT_TRUE((*ppte & PTE_COW) && (*cpte & PTE_COW), "cow bit missing");
+    ASSERT_EQ(frame_refcount(frame), 2, "shared frame not referenced twice");
+
+    /* tearing down the child must leave the parent's data alone */
+    vmm_destroy_pagedir(child);
+    ASSERT_EQ(frame_refcount(frame), 1, "reference not dropped");
+    ASSERT_EQ(*(uint8_t *)PHYS_TO_VIRT(frame), 0, "parent data lost");
+
+    vmm_destroy_pagedir(parent);
+    ASSERT_EQ(kmm_get_used_frames(), used, "frames leaked");
+    PASS();
+}
+
+// ---------------- First write copies the page ----------------
+void test_cow_write_fault() {
+    pagedir_t *parent = make_filled_space(2);
+    ASSERT_NOT_NULL(parent, "address space setup failed");
+
+    pagedir_t *child = clone_from(parent, vmm_clone_pagedir_cow);
+    ASSERT_NOT_NULL(child, "cow clone failed");
+
+    uint32_t copies = cow_get_stats()->copies;
+    uint32_t reuses = cow_get_stats()->reuses;
+
+    /* CR0.WP is set, a supervisor write faults like a user one */
+    pagedir_t *saved = vmm_get_current_pagedir();
+    vmm_switch_pagedir(child);
+    *(volatile uint8_t *)COW_TEST_ADDR = 0xAB;
+    vmm_switch_pagedir(saved);
+
+    pte_t *ppte = pgtable_get_pte(parent, (void *)COW_TEST_ADDR);
+    pte_t *cpte = pgtable_get_pte(child, (void *)COW_TEST_ADDR);
+
+    bool copied  = cow_get_stats()->copies == copies + 1;
+    bool split   = PTE_FRAME_ADDR(*ppte) != PTE_FRAME_ADDR(*cpte);
+    bool private = (*cpte & PTE_WRITABLE) && !(*cpte & PTE_COW);
+    bool intact  = *(uint8_t *)PHYS_TO_VIRT(PTE_FRAME_ADDR(*ppte)) == 0 &&
+                   *(uint8_t *)PHYS_TO_VIRT(PTE_FRAME_ADDR(*cpte)) == 0xAB;
+
+    /* the parent is now the only user of its frame, breaking it is free */
+    vmm_switch_pagedir(parent);
+    cow_break_range((void *)COW_TEST_ADDR, VMM_PAGE_SIZE);
+    vmm_switch_pagedir(saved);
+    bool reused = cow_get_stats()->reuses == reuses + 1;
+
+    vmm_destroy_pagedir(child);
+    vmm_destroy_pagedir(parent);
+
+    ASSERT_TRUE(copied && split && private, "write did not copy the page");
+    ASSERT_TRUE(intact, "page contents wrong after copy");
+    ASSERT_TRUE(reused, "sole owner was copied instead of reused");
+    PASS();
+}
+
+// ---------------- The loader writes read-only pages ----------------
+void test_cow_load_readonly() {
+    pagedir_t *pdir = test_make_space();
+    ASSERT_NOT_NULL(pdir, "address space setup failed");
+
+    bool mapped = vmm_alloc_region(pdir, (void *)COW_TEST_ADDR, VMM_PAGE_SIZE,
+                                   PTE_PRESENT | PTE_USER);
+
+    const char text[] = "read only segment";
+    pagedir_t *saved = vmm_get_current_pagedir();
+    vmm_switch_pagedir(pdir);
+    if (mapped) {
+        cow_load_copy((void *)(COW_TEST_ADDR + 16), text, sizeof(text));
+        cow_load_fill((void *)COW_TEST_ADDR, 0x5A, 16);
+    }
+    vmm_switch_pagedir(saved);
+
+    pte_t *pte  = mapped ? pgtable_get_pte(pdir, (void *)COW_TEST_ADDR) : NULL;
+    uint8_t *pg = pte ? PHYS_TO_VIRT(PTE_FRAME_ADDR(*pte)) : NULL;
+    bool loaded = pg && pg[0] == 0x5A && pg[15] == 0x5A &&
+                  memcmp(pg + 16, text, sizeof(text)) == 0;
+    bool ro     = pte && !(*pte & PTE_WRITABLE);
+
+    vmm_destroy_pagedir(pdir);
+
+    ASSERT_TRUE(mapped, "region setup failed");
+    ASSERT_TRUE(loaded, "segment contents wrong");
+    ASSERT_TRUE(ro, "page left writable");
+    PASS();
+}
+
+// ---------------- Fork latency, deep copy against copy on write ----------------
+void test_cow_fork_benchmark() {
+    const uint32_t npages = 64;
+
+    pagedir_t *parent = make_filled_space(npages);
+    ASSERT_NOT_NULL(parent, "address space setup failed");
+
+    uint64_t t0 = rdtsc();
+    pagedir_t *deep = clone_from(parent, vmm_clone_pagedir);
+    uint64_t t1 = rdtsc();
+    pagedir_t *cow = clone_from(parent, vmm_clone_pagedir_cow);
+    uint64_t t2 = rdtsc();
+
+    bool ok = deep && cow;
+    if (deep) vmm_destroy_pagedir(deep);
+    if (cow) vmm_destroy_pagedir(cow);
+    vmm_destroy_pagedir(parent);
+    ASSERT_TRUE(ok, "clone failed");
+
+    uint32_t deep_cycles = (uint32_t)(t1 - t0);
+    uint32_t cow_cycles  = (uint32_t)(t2 - t1);
+
+    printk("fork of %u pages: copy %u cycles, cow %u cycles\n", npages,
+           deep_cycles, cow_cycles);
+    ASSERT_TRUE(cow_cycles < deep_cycles, "cow clone slower than copying");
+    PASS();
+}
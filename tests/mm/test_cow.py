@@ -0,0 +1,27 @@
+import pytest
+
+pytestmark = pytest.mark.cow
+
+
+def assert_passed(result: str):
+    """Helper: ensure PASSED and not FAILED."""
+    assert "FAILED" not in result, f"Copy on write failed: {result}"
+    assert "PASSED" in result, f"Unexpected output: {result}"
+
+
+def test_clone_shares(runner):
+    assert_passed(runner.send_serial("cow_clone_shares"))
+
+
+def test_write_fault(runner):
+    assert_passed(runner.send_serial("cow_write_fault"))
+
+
+def test_load_readonly(runner):
+    assert_passed(runner.send_serial("cow_load_readonly"))
+
+
+def test_fork_benchmark(runner):
+    result = runner.send_serial("cow_fork_benchmark")
+    print(result)
+    assert_passed(result)
@@ -0,0 +1,161 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <mm/demand.h>
+#include <mm/vma.h>
+#include <mm/kmm.h>
+#include <mm/vmm.h>
+#include <mm/pgtable.h>
+#include <mem.h>
+#include <testmain.h>
+#include "space.h"
+
+#define DEMAND_TEST_ADDR    0x40000000
+#define DEMAND_TEST_PAGES   16
+#define DEMAND_USER_FLAGS   (PTE_PRESENT | PTE_WRITABLE | PTE_USER)
+
+static bool page_present(pagedir_t *pdir, uintptr_t addr) {
+    pte_t *pte = pgtable_get_pte(pdir, (void *)addr);
+    return pte && PTE_IS_PRESENT(*pte);
+}
+
+// ---------------- Reserved pages are backed on first touch ----------------
+void test_demand_reserve_lazy() {
+    uint32_t used = kmm_get_used_frames();
+
+    pagedir_t *pdir = test_make_space();
+    ASSERT_NOT_NULL(pdir, "address space setup failed");
+
+    bool reserved = vmm_reserve_region(pdir, (void *)DEMAND_TEST_ADDR,
+                                       DEMAND_TEST_PAGES * VMM_PAGE_SIZE,
+                                       DEMAND_USER_FLAGS);
+    uint32_t after_reserve = kmm_get_used_frames();
+
+    pagedir_t *saved = vmm_get_current_pagedir();
+    vmm_switch_pagedir(pdir);
+    volatile uint32_t *first = (uint32_t *)DEMAND_TEST_ADDR;
+    volatile uint32_t *last  = (uint32_t *)(DEMAND_TEST_ADDR +
+                                (DEMAND_TEST_PAGES - 1) * VMM_PAGE_SIZE);
+    bool zeroed = reserved && *first == 0;
+    if (reserved) *last = 0x12345678;
+    vmm_switch_pagedir(saved);
+
+    uint32_t touched = 0;
+    for (uint32_t i = 0; i < DEMAND_TEST_PAGES; i++) {
+        if (page_present(pdir, DEMAND_TEST_ADDR + i * VMM_PAGE_SIZE)) touched++;
+    }
+
+    bool released = vmm_unreserve_region(pdir, (void *)DEMAND_TEST_ADDR,
+                                         DEMAND_TEST_PAGES * VMM_PAGE_SIZE);
+    bool unmapped = !page_present(pdir, DEMAND_TEST_ADDR);
+    vmm_destroy_space(pdir);
+
+    ASSERT_TRUE(reserved, "reservation failed");
+    /* at most the page directory and slabs for the space and area */
+    ASSERT_TRUE(after_reserve - used <= 3, "reservation consumed frames");
+    ASSERT_TRUE(zeroed, "demand page not zeroed");
+    ASSERT_EQ(touched, 2, "untouched pages were backed");
+    ASSERT_TRUE(released && unmapped, "unreserve left pages mapped");
+    PASS();
+}
+
+// ---------------- The user stack grows down to its limit ----------------
+void test_demand_stack_growth() {
+    pagedir_t *pdir = test_make_space();
+    ASSERT_NOT_NULL(pdir, "address space setup failed");
+
+    /* set up the initial stack page the way process_spawn does */
+    bool stack = vma_alloc_region(pdir, (void *)USER_STACK_TOP, USER_STACK_SIZE,
+                                  DEMAND_USER_FLAGS);
+
+    uint32_t grown = demand_get_stats()->stack_pages;
+    uintptr_t deep = USER_STACK_LIMIT;
+
+    if (!stack) {
+        vmm_destroy_space(pdir);
+        send_msg("FAILED: stack setup failed");
+        return;
+    }
+
+    pagedir_t *saved = vmm_get_current_pagedir();
+    vmm_switch_pagedir(pdir);
+    *(volatile uint32_t *)(USER_STACK_TOP - VMM_PAGE_SIZE) = 1;
+    *(volatile uint32_t *)deep = 2;
+    vmm_switch_pagedir(saved);
+
+    bool ok = page_present(pdir, USER_STACK_TOP - VMM_PAGE_SIZE) &&
+              page_present(pdir, deep) &&
+              !page_present(pdir, deep + VMM_PAGE_SIZE);
+    vmm_destroy_space(pdir);
+
+    ASSERT_TRUE(ok, "stack pages not populated individually");
+    ASSERT_EQ(demand_get_stats()->stack_pages, grown + 2, "growth not counted");
+    PASS();
+}
+
+// ---------------- Invalid reservations are refused ----------------
+void test_demand_reserve_invalid() {
+    pagedir_t *pdir = test_make_space();
+    ASSERT_NOT_NULL(pdir, "address space setup failed");
+
+    bool first   = vmm_reserve_region(pdir, (void *)DEMAND_TEST_ADDR,
+                                      4 * VMM_PAGE_SIZE, DEMAND_USER_FLAGS);
+    bool overlap = vmm_reserve_region(pdir, (void *)(DEMAND_TEST_ADDR + VMM_PAGE_SIZE),
+                                      4 * VMM_PAGE_SIZE, DEMAND_USER_FLAGS);
+    bool guard   = vmm_reserve_region(pdir, (void *)(USER_STACK_LIMIT - VMM_PAGE_SIZE),
+                                      VMM_PAGE_SIZE, DEMAND_USER_FLAGS);
+    bool kernel  = vmm_reserve_region(pdir, (void *)PHYSMAP_BASE,
+                                      VMM_PAGE_SIZE, DEMAND_USER_FLAGS);
+    bool partial = vmm_unreserve_region(pdir, (void *)DEMAND_TEST_ADDR,
+                                        VMM_PAGE_SIZE);
+    vmm_destroy_space(pdir);
+
+    ASSERT_TRUE(first, "valid reservation failed");
+    ASSERT_FALSE(overlap, "overlapping reservation accepted");
+    ASSERT_FALSE(guard, "reservation in the stack guard gap accepted");
+    ASSERT_FALSE(kernel, "reservation in kernel space accepted");
+    ASSERT_FALSE(partial, "partial unreserve accepted");
+    PASS();
+}
+
+// ---------------- mmap places reservations in its window ----------------
+void test_demand_mmap() {
+    pagedir_t *pdir = test_make_space();
+    ASSERT_NOT_NULL(pdir, "address space setup failed");
+
+    uint32_t reserved = demand_get_stats()->reserved_pages;
+
+    uint8_t *a = vmm_mmap(pdir, NULL, 3 * VMM_PAGE_SIZE, MMAP_PROT_READ | MMAP_PROT_WRITE);
+    uint8_t *b = vmm_mmap(pdir, NULL, VMM_PAGE_SIZE, MMAP_PROT_READ);
+    uint8_t *c = vmm_mmap(pdir, (void *)DEMAND_TEST_ADDR, VMM_PAGE_SIZE, MMAP_PROT_WRITE);
+    bool placed = a == (uint8_t *)USER_MMAP_BASE && b == a + 3 * VMM_PAGE_SIZE &&
+                  c == (uint8_t *)DEMAND_TEST_ADDR;
+
+    /* nothing is backed until it is touched */
+    bool lazy = placed && !page_present(pdir, (uintptr_t)a) &&
+                demand_get_stats()->reserved_pages == reserved + 5;
+
+    vm_space_t *space = vma_get_space(pdir, false);
+    vm_area_t *ra = vma_find(space, (uintptr_t)a);
+    vm_area_t *rb = vma_find(space, (uintptr_t)b);
+    bool prot = ra && rb && (ra->prot & PTE_WRITABLE) && !(rb->prot & PTE_WRITABLE);
+
+    bool refused = vmm_mmap(pdir, (void *)DEMAND_TEST_ADDR, VMM_PAGE_SIZE, MMAP_PROT_READ) == NULL &&
+                   vmm_mmap(vmm_get_kerneldir(), NULL, VMM_PAGE_SIZE, MMAP_PROT_READ) == NULL &&
+                   vmm_mmap(pdir, NULL, 0, MMAP_PROT_READ) == NULL;
+
+    /* a released range is handed out again */
+    bool released = vmm_unreserve_region(pdir, a, 3 * VMM_PAGE_SIZE) &&
+                    vmm_mmap(pdir, NULL, VMM_PAGE_SIZE, MMAP_PROT_READ) == a;
+
+    vmm_destroy_space(pdir);
+
+    ASSERT_TRUE(placed, "reservations placed at the wrong addresses");
+    ASSERT_TRUE(lazy, "reservation backed before it was touched");
+    ASSERT_TRUE(prot, "reservation protection not applied");
+    ASSERT_TRUE(refused, "invalid mmap accepted");
+    ASSERT_TRUE(released, "released range not reused");
+    PASS();
+}
@@ -0,0 +1,25 @@
+import pytest
+
+pytestmark = pytest.mark.demand
+
+
+def assert_passed(result: str):
+    """Helper: ensure PASSED and not FAILED."""
+    assert "FAILED" not in result, f"Demand paging failed: {result}"
+    assert "PASSED" in result, f"Unexpected output: {result}"
+
+
+def test_reserve_lazy(runner):
+    assert_passed(runner.send_serial("demand_reserve_lazy"))
+
+
+def test_stack_growth(runner):
+    assert_passed(runner.send_serial("demand_stack_growth"))
+
+
+def test_reserve_invalid(runner):
+    assert_passed(runner.send_serial("demand_reserve_invalid"))
+
+
+def test_mmap(runner):
+    assert_passed(runner.send_serial("demand_mmap"))
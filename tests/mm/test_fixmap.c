@@ -0,0 +1,88 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <mm/fixmap.h>
+#include <mm/vma.h>
+#include <mm/vmm.h>
+#include <mm/kmm.h>
+#include <mm/vmalloc.h>
+#include <mm/pgtable.h>
+#include <mem.h>
+#include <utils.h>
+#include <testmain.h>
+
+#define FIX_TEST_ADDR   0x40000000
+#define FIX_USER_FLAGS  (PTE_PRESENT | PTE_WRITABLE | PTE_USER)
+
+void test_fixmap_recursive() {
+    ASSERT_TRUE(fixmap_recursive_ready(), "recursive mapping not set up");
+
+    pagedir_t *kdir = vmm_get_kerneldir();
+    pagedir_t *saved = vmm_get_current_pagedir();
+
+    /* kernel tables are walked through the window while the kernel runs */
+    void *buf = vmalloc(VMM_PAGE_SIZE);
+    ASSERT_NOT_NULL(buf, "vmalloc failed");
+    pte_t *pte = pgtable_get_pte(saved, buf);
+    bool window = pte == &RECURSIVE_PT(buf)->table[VMM_TABLE_INDEX(buf)] &&
+                  PTE_FRAME_ADDR(*pte) == (uintptr_t)vmm_get_phys_frame(saved, buf);
+    vfree(buf);
+    ASSERT_TRUE(window, "kernel pte not reached through the window");
+
+    /* a user space sees its own directory through the window */
+    pagedir_t *pdir = vmm_create_address_space();
+    ASSERT_NOT_NULL(pdir, "address space setup failed");
+    for (int i = 0; i < VMM_PAGES_PER_DIR; i++) pdir->table[i] = kdir->table[i];
+
+    if (!vma_alloc_region(pdir, (void *)FIX_TEST_ADDR, VMM_PAGE_SIZE, FIX_USER_FLAGS)) {
+        vmm_destroy_space(pdir);
+        FAIL();
+        return;
+    }
+
+    pagetable_t *table = PHYS_TO_VIRT(PDE_PTABLE_ADDR(pdir->table[VMM_DIR_INDEX(FIX_TEST_ADDR)]));
+    uintptr_t frame = PTE_FRAME_ADDR(table->table[VMM_TABLE_INDEX(FIX_TEST_ADDR)]);
+
+    vmm_switch_pagedir(pdir);
+    bool self   = RECURSIVE_PD->table[VMM_DIR_INDEX(FIX_TEST_ADDR)] ==
+                  pdir->table[VMM_DIR_INDEX(FIX_TEST_ADDR)];
+    bool lookup = (uintptr_t)vmm_get_phys_frame(pdir, (void *)FIX_TEST_ADDR) == frame;
+    vmm_switch_pagedir(saved);
+
+    /* away from the cpu the directory shares the kernel's entry again */
+    bool shared = pdir->table[RECURSIVE_PDE] == kdir->table[RECURSIVE_PDE];
+    vmm_destroy_space(pdir);
+
+    ASSERT_TRUE(self, "window does not show the current directory");
+    ASSERT_TRUE(lookup, "lookup through the window failed");
+    ASSERT_TRUE(shared, "recursive entry left behind after switching away");
+    PASS();
+}
+
+void test_fixmap_slots() {
+    void *frame = kmm_frame_alloc();
+    ASSERT_NOT_NULL(frame, "frame allocation failed");
+
+    uint32_t *phys_view = PHYS_TO_VIRT(frame);
+    phys_view[0] = 0;
+
+    uint32_t *fix_view = fixmap_map(FIX_PAGE_DST, frame);
+    bool addr = fix_view == (uint32_t *)FIXMAP_ADDR(FIX_PAGE_DST);
+    if (fix_view) fix_view[0] = 0xF1F1F1F1;
+    bool seen = phys_view[0] == 0xF1F1F1F1;
+
+    fixmap_unmap(FIX_PAGE_DST);
+    pte_t *pte = pgtable_get_pte(vmm_get_kerneldir(), (void *)FIXMAP_ADDR(FIX_PAGE_DST));
+    bool gone = pte && !PTE_IS_PRESENT(*pte);
+
+    kmm_frame_free(frame);
+
+    ASSERT_TRUE(addr, "slot mapped at the wrong address");
+    ASSERT_TRUE(seen, "write through the slot not visible");
+    ASSERT_TRUE(gone, "slot still mapped");
+    ASSERT_NULL(fixmap_map(FIX_SLOTS, frame), "invalid slot mapped");
+    PASS();
+}
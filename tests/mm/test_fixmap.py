@@ -0,0 +1,17 @@
+import pytest
+
+pytestmark = pytest.mark.fixmap
+
+
+def assert_passed(result: str):
+    """Helper: ensure PASSED and not FAILED."""
+    assert "FAILED" not in result, f"Fixmap test failed: {result}"
+    assert "PASSED" in result, f"Unexpected output: {result}"
+
+
+def test_recursive(runner):
+    assert_passed(runner.send_serial("fixmap_recursive"))
+
+
+def test_slots(runner):
+    assert_passed(runner.send_serial("fixmap_slots"))
@@ -0,0 +1,139 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <mm/highmem.h>
+#include <mm/hugepage.h>
+#include <mm/pgtable.h>
+#include <mm/vma.h>
+#include <mm/vmm.h>
+#include <mem.h>
+#include <utils.h>
+#include <testmain.h>
+#include "space.h"
+
+#define HIGH_TEST_ADDR    0x40000000
+#define HIGH_TEST_PHYS    0x123400000ULL
+#define HIGH_USER_FLAGS   (PTE_PRESENT | PTE_WRITABLE | PTE_USER)
+
+// ------------ Directory entries carry the address bits above 4GB ------------
+void test_highmem_pde() {
+    pde_t pde = highmem_make_pde(HIGH_TEST_PHYS, PDE_WRITABLE | PDE_USER);
+
+    ASSERT_TRUE(PDE_IS_HIGH(pde), "entry not recognised as high");
+    ASSERT_TRUE(PDE_IS_USER(pde) && PDE_IS_WRITABLE(pde), "flags lost");
+    ASSERT_TRUE(highmem_pde_addr(pde) == HIGH_TEST_PHYS, "address did not survive");
+
+    pde_t low = highmem_make_pde(PSE_PAGE_SIZE, PDE_USER);
+    ASSERT_TRUE(PDE_IS_HUGE(low) && !PDE_IS_HIGH(low), "low entry taken as high");
+    ASSERT_EQ(highmem_pde_addr(low), PSE_PAGE_SIZE, "low address changed");
+    PASS();
+}
+
+// ------------ Maps of the window nest ------------
+void test_highmem_kmap_nest() {
+    if (!pse_enabled()) {
+        SKIP("no large pages");
+        return;
+    }
+
+    /* any large page can go through the window, the two below 4GB are
+        reachable through the physmap as well */
+    const uint32_t *outer_phys = PHYS_TO_VIRT(0);
+    const uint32_t *inner_phys = PHYS_TO_VIRT(PSE_PAGE_SIZE);
+    const uint32_t  last       = PSE_PAGE_SIZE / sizeof(uint32_t) - 1;
+
+    highmem_kmap_t outer, inner;
+    sti();
+
+    uint32_t *window = highmem_kmap(0, &outer);
+    bool first = window[last] == outer_phys[last];
+
+    window = highmem_kmap(PSE_PAGE_SIZE, &inner);
+    bool nested = window[last] == inner_phys[last];
+    highmem_kunmap(&inner);
+
+    uint32_t eflags;
+    asm volatile ("pushfl; popl %0" : "=r" (eflags));
+    bool still_off = !(eflags & 0x200);
+    bool restored  = window[last] == outer_phys[last];
+    highmem_kunmap(&outer);
+
+    asm volatile ("pushfl; popl %0" : "=r" (eflags));
+    pde_t pde = vmm_get_current_pagedir()->table[VMM_DIR_INDEX(HIGHMEM_WINDOW)];
+
+    ASSERT_TRUE(first && nested, "window shows the wrong chunk");
+    ASSERT_TRUE(still_off, "inner unmap enabled interrupts");
+    ASSERT_TRUE(restored, "inner unmap dropped the outer map");
+    ASSERT_TRUE(eflags & 0x200, "interrupts not restored");
+    ASSERT_EQ(pde, 0, "window left mapped");
+    PASS();
+}
+
+// ------------ Chunks are handed out and reached through the window ------------
+void test_highmem_chunk() {
+    if (!highmem_enabled()) {
+        SKIP("no memory above 4GB, run with QEMU_MEM=6G");
+        return;
+    }
+
+    uint32_t free_before = highmem_get_stats()->chunks_free;
+
+    uint64_t chunk = highmem_chunk_alloc();
+    ASSERT_TRUE(chunk >= HIGHMEM_START, "chunk below 4GB");
+    ASSERT_EQ(highmem_get_stats()->chunks_free, free_before - 1, "chunk not taken");
+
+    highmem_kmap_t km;
+    uint32_t *window = highmem_kmap(chunk, &km);
+    window[0] = 0xCAFEBABE;
+    window[PSE_PAGE_SIZE / sizeof(uint32_t) - 1] = 0xDEADBEEF;
+    highmem_kunmap(&km);
+
+    window = highmem_kmap(chunk, &km);
+    bool kept = window[0] == 0xCAFEBABE &&
+                window[PSE_PAGE_SIZE / sizeof(uint32_t) - 1] == 0xDEADBEEF;
+    highmem_kunmap(&km);
+
+    highmem_chunk_free(chunk);
+
+    ASSERT_TRUE(kept, "chunk contents lost");
+    ASSERT_EQ(highmem_get_stats()->chunks_free, free_before, "chunk not returned");
+    PASS();
+}
+
+// ------------ Large user pages above 4GB move down to be split ------------
+void test_highmem_hugepage() {
+    if (!highmem_enabled() || !hugepage_enabled()) {
+        SKIP("no memory above 4GB or no large pages, run with QEMU_MEM=6G");
+        return;
+    }
+
+    pagedir_t *pdir = test_make_space();
+    ASSERT_NOT_NULL(pdir, "address space setup failed");
+
+    uint32_t free_before = highmem_get_stats()->chunks_free;
+    uint32_t migrations  = hugepage_get_stats()->migrations;
+
+    bool mapped = hugepage_map(pdir, HIGH_TEST_ADDR, HIGH_USER_FLAGS);
+    bool high   = mapped && PDE_IS_HIGH(pdir->table[VMM_DIR_INDEX(HIGH_TEST_ADDR)]);
+
+    /* the lookup sees the frame where it is */
+    uint64_t phys = vmm_get_phys_addr(pdir, (void *)(HIGH_TEST_ADDR + VMM_PAGE_SIZE));
+    bool found    = high && phys >= HIGHMEM_START &&
+                    phys == highmem_pde_addr(pdir->table[VMM_DIR_INDEX(HIGH_TEST_ADDR)]) +
+                            VMM_PAGE_SIZE;
+
+    /* a partial unmap needs page tables, which cannot reach the chunk */
+    bool split  = high && pgtable_unmap_page(pdir, (void *)(HIGH_TEST_ADDR + VMM_PAGE_SIZE));
+    bool moved  = split && hugepage_get_stats()->migrations == migrations + 1 &&
+                  vmm_get_phys_frame(pdir, (void *)HIGH_TEST_ADDR) != NULL;
+    bool freed  = highmem_get_stats()->chunks_free == free_before;
+
+    vmm_destroy_space(pdir);
+
+    ASSERT_TRUE(high, "large page not taken from above 4GB");
+    ASSERT_TRUE(found, "lookup missed the frame above 4GB");
+    ASSERT_TRUE(moved, "large page not moved below 4GB");
+    ASSERT_TRUE(freed, "chunk not returned after the move");
+    PASS();
+}
@@ -0,0 +1,27 @@
+import pytest
+
+pytestmark = pytest.mark.highmem
+
+
+def assert_passed(result: str):
+    """Helper: ensure PASSED and not FAILED, skip what the machine lacks."""
+    if "SKIPPED" in result:
+        pytest.skip(result)
+    assert "FAILED" not in result, f"High memory test failed: {result}"
+    assert "PASSED" in result, f"Unexpected output: {result}"
+
+
+def test_pde(runner):
+    assert_passed(runner.send_serial("highmem_pde"))
+
+
+def test_kmap_nest(runner):
+    assert_passed(runner.send_serial("highmem_kmap_nest"))
+
+
+def test_chunk(runner):
+    assert_passed(runner.send_serial("highmem_chunk"))
+
+
+def test_hugepage(runner):
+    assert_passed(runner.send_serial("highmem_hugepage"))
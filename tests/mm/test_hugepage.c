@@ -0,0 +1,150 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <mm/hugepage.h>
+#include <mm/highmem.h>
+#include <mm/vma.h>
+#include <mm/vmm.h>
+#include <mm/kmm.h>
+#include <mm/pgtable.h>
+#include <mem.h>
+#include <utils.h>
+#include <testmain.h>
+#include "space.h"
+
+#define HUGE_TEST_ADDR   0x40000000
+#define HUGE_USER_FLAGS  (PTE_PRESENT | PTE_WRITABLE | PTE_USER)
+#define HUGE_MAX_BLOCKS  64
+
+/* an address space sharing the kernel tables, with no user memory */
+static bool is_huge(pagedir_t *pdir, uintptr_t virt) {
+    return PDE_IS_HUGE(pdir->table[VMM_DIR_INDEX(virt)]);
+}
+
+void test_hugepage_alloc() {
+    if (!hugepage_enabled()) {
+        PASS();
+        return;
+    }
+
+    pagedir_t *pdir = test_make_space();
+    ASSERT_NOT_NULL(pdir, "address space setup failed");
+
+    /* two aligned large pieces followed by a small tail */
+    hugepage_stats_t before = *hugepage_get_stats();
+    size_t size = 2 * PSE_PAGE_SIZE + 2 * VMM_PAGE_SIZE;
+    bool ok = vma_alloc_region(pdir, (void *)HUGE_TEST_ADDR, size, HUGE_USER_FLAGS);
+    if (!ok) vmm_destroy_space(pdir);
+    ASSERT_TRUE(ok, "region allocation failed");
+
+    uint32_t hits = hugepage_get_stats()->hits - before.hits;
+    bool huge  = is_huge(pdir, HUGE_TEST_ADDR) && is_huge(pdir, HUGE_TEST_ADDR + PSE_PAGE_SIZE);
+    bool small = !is_huge(pdir, HUGE_TEST_ADDR + 2 * PSE_PAGE_SIZE) &&
+                 vmm_get_phys_frame(pdir, (void *)(HUGE_TEST_ADDR + 2 * PSE_PAGE_SIZE + VMM_PAGE_SIZE));
+
+    /* frames inside a large page are contiguous and zeroed */
+    uintptr_t base = PDE_PTABLE_ADDR(pdir->table[VMM_DIR_INDEX(HUGE_TEST_ADDR)]);
+    bool linear = vmm_get_phys_frame(pdir, (void *)(HUGE_TEST_ADDR + 0x5123)) ==
+                  (void *)(base + 0x5000);
+    uint8_t *data = PHYS_TO_VIRT(base);
+    bool zeroed = data[0] == 0 && data[PSE_PAGE_SIZE - 1] == 0;
+
+    uint32_t used = kmm_get_used_frames();
+    vmm_destroy_space(pdir);
+    bool freed = used - kmm_get_used_frames() >= 2 * VMM_PAGES_PER_TABLE;
+
+    /* no contiguous memory left is a fallback, not an error */
+    if (hits == 0) {
+        ASSERT_TRUE(hugepage_get_stats()->fallbacks > before.fallbacks, "fallback not counted");
+        PASS();
+        return;
+    }
+
+    ASSERT_TRUE(hits == 2 && huge, "aligned pieces not backed by large pages");
+    ASSERT_TRUE(small, "tail not backed by small pages");
+    ASSERT_TRUE(linear, "wrong frame inside a large page");
+    ASSERT_TRUE(zeroed, "large page not zeroed");
+    ASSERT_TRUE(freed, "large page frames not freed");
+    PASS();
+}
+
+void test_hugepage_split() {
+    if (!hugepage_enabled()) {
+        PASS();
+        return;
+    }
+
+    pagedir_t *pdir = test_make_space();
+    ASSERT_NOT_NULL(pdir, "address space setup failed");
+
+    uintptr_t a = HUGE_TEST_ADDR, b = HUGE_TEST_ADDR + PSE_PAGE_SIZE;
+    if (!hugepage_map(pdir, a, HUGE_USER_FLAGS) || !hugepage_map(pdir, b, HUGE_USER_FLAGS)) {
+        vmm_destroy_space(pdir);
+        PASS();
+        return;
+    }
+
+    bool      high   = PDE_IS_HIGH(pdir->table[VMM_DIR_INDEX(a)]);
+    uintptr_t base   = PDE_PTABLE_ADDR(pdir->table[VMM_DIR_INDEX(a)]);
+    uint32_t  splits = hugepage_get_stats()->splits;
+
+    /* unmapping one page splits the large page around it */
+    bool unmapped = pgtable_unmap_page(pdir, (void *)(a + 0x5000));
+    if (high) {
+        /* it was moved below 4GB on the way */
+        base = (uintptr_t)vmm_get_phys_frame(pdir, (void *)a);
+    }
+    bool split    = !is_huge(pdir, a) && hugepage_get_stats()->splits == splits + 1;
+    bool hole     = vmm_get_phys_frame(pdir, (void *)(a + 0x5000)) == NULL;
+    bool kept     = vmm_get_phys_frame(pdir, (void *)(a + 0x6000)) == (void *)(base + 0x6000);
+
+    /* a whole large page changes protection in place, part of one splits */
+    pgtable_protect_range(pdir, b, PSE_PAGE_SIZE, PTE_USER);
+    bool whole = is_huge(pdir, b) && !PDE_IS_WRITABLE(pdir->table[VMM_DIR_INDEX(b)]);
+
+    pgtable_protect_range(pdir, b, VMM_PAGE_SIZE, PTE_USER | PTE_WRITABLE);
+    pte_t *first = pgtable_get_pte(pdir, (void *)b);
+    pte_t *next  = pgtable_get_pte(pdir, (void *)(b + VMM_PAGE_SIZE));
+    bool partial = !is_huge(pdir, b) && first && next &&
+                   PTE_IS_WRITABLE(*first) && !PTE_IS_WRITABLE(*next);
+
+    vmm_destroy_space(pdir);
+
+    ASSERT_TRUE(unmapped && split, "partial unmap did not split");
+    ASSERT_TRUE(hole, "unmapped page still mapped");
+    ASSERT_TRUE(kept, "split moved the other pages");
+    ASSERT_TRUE(whole, "whole large page not protected in place");
+    ASSERT_TRUE(partial, "partial protection did not split");
+    PASS();
+}
+
+void test_hugepage_fallback() {
+    if (!hugepage_enabled()) {
+        PASS();
+        return;
+    }
+
+    /* take every free block so that the next large page has to fall back */
+    void *blocks[HUGE_MAX_BLOCKS];
+    uint32_t n = 0;
+    while (n < HUGE_MAX_BLOCKS && (blocks[n] = kmm_block_alloc(HUGEPAGE_ORDER))) n++;
+
+    pagedir_t *pdir = test_make_space();
+    uint32_t fallbacks = hugepage_get_stats()->fallbacks;
+    bool ok = pdir && vma_alloc_region(pdir, (void *)HUGE_TEST_ADDR, PSE_PAGE_SIZE,
+                                       HUGE_USER_FLAGS);
+    bool small = ok && !is_huge(pdir, HUGE_TEST_ADDR) &&
+                 vmm_get_phys_frame(pdir, (void *)HUGE_TEST_ADDR);
+    bool counted = hugepage_get_stats()->fallbacks == fallbacks + 1;
+
+    if (pdir) vmm_destroy_space(pdir);
+    for (uint32_t i = 0; i < n; i++) kmm_block_free(blocks[i], HUGEPAGE_ORDER);
+
+    ASSERT_TRUE(n < HUGE_MAX_BLOCKS, "memory larger than the test expects");
+    ASSERT_TRUE(ok && small, "fallback to small pages failed");
+    ASSERT_TRUE(counted, "fallback not counted");
+    PASS();
+}
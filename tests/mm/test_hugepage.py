@@ -0,0 +1,21 @@
+import pytest
+
+pytestmark = pytest.mark.hugepage
+
+
+def assert_passed(result: str):
+    """Helper: ensure PASSED and not FAILED."""
+    assert "FAILED" not in result, f"Large user page test failed: {result}"
+    assert "PASSED" in result, f"Unexpected output: {result}"
+
+
+def test_alloc(runner):
+    assert_passed(runner.send_serial("hugepage_alloc"))
+
+
+def test_split(runner):
+    assert_passed(runner.send_serial("hugepage_split"))
+
+
+def test_fallback(runner):
+    assert_passed(runner.send_serial("hugepage_fallback"))
@@ -1,4 +1,6 @@
 #include <mm/kheap.h>
+#include <mm/kmm.h>
+#include <mem.h>
 #include <utils.h>
 #include <stdio.h>
 #include <string.h>
@@ -315,3 +317,91 @@ void test_kheap_buddy_multilevel(void) {
     if (merged) kfree(heap, merged);
     
 }
+
+/* -------------------------------------------------------------------------- */
+/* On-demand growth beyond the initially backed size                         */
+/* -------------------------------------------------------------------------- */
+void test_kheap_grow_on_demand(void) {
+
+    heap_t *heap = get_kernel_heap();
+    size_t backed = kheap_backed_size(heap);
+
+    /* larger than the initial backing, must be faulted in page by page */
+    size_t size = KERNEL_HEAP_SIZE + KERNEL_HEAP_SIZE / 2;
+    uint8_t *buf = kmalloc(heap, size);
+    if (!buf) { send_msg("FAILED: large allocation failed"); return; }
+
+    for (size_t i = 0; i < size; i += 4096) buf[i] = (uint8_t)(i >> 12);
+    for (size_t i = 0; i < size; i += 4096) {
+        if (buf[i] != (uint8_t)(i >> 12)) {
+            kfree(heap, buf);
+            send_msg("FAILED: grown heap lost data");
+            return;
+        }
+    }
+
+    bool grew = kheap_backed_size(heap) > backed;
+    kfree(heap, buf);
+
+    size_t before_trim = kheap_backed_size(heap);
+    uint32_t released  = kheap_trim(heap);
+    bool trimmed = released > 0 && kheap_backed_size(heap) < before_trim;
+
+    send_msg(grew && trimmed ? "PASSED" : "FAILED: heap did not grow/trim");
+}
+
+/* -------------------------------------------------------------------------- */
+/* Whole page allocations bypass the buddy heap                              */
+/* -------------------------------------------------------------------------- */
+void test_kheap_pages(void) {
+
+    /* warm up the vmalloc region cache so its slab is not counted below */
+    kfree_pages(kmalloc_pages(2));
+    uint32_t used = kmm_get_used_frames();
+
+    uint8_t *one   = kmalloc_pages(1);
+    uint8_t *three = kmalloc_pages(3);
+    if (!one || !three) { send_msg("FAILED: page allocation failed"); return; }
+
+    bool aligned = IS_ALIGNED(one, 4096) && IS_ALIGNED(three, 4096);
+
+    /* no header: exactly one frame for one page, three for three pages */
+    bool exact = kmm_get_used_frames() - used == 4;
+
+    memset(one, 0x5A, 4096);
+    memset(three, 0xA5, 3 * 4096);
+    bool intact = one[4095] == 0x5A && three[3 * 4096 - 1] == 0xA5;
+
+    kfree_pages(one);
+    kfree_pages(three);
+    bool released = kmm_get_used_frames() == used;
+
+    send_msg(aligned && exact && intact && released
+             ? "PASSED" : "FAILED: page allocation not headerless");
+}
+
+/* -------------------------------------------------------------------------- */
+/* kvrealloc moves a block from the heap to whole pages and back             */
+/* -------------------------------------------------------------------------- */
+void test_kheap_kvrealloc(void) {
+
+    uint8_t *buf = kvmalloc(100);
+    if (!buf) { send_msg("FAILED: small allocation failed"); return; }
+    for (int i = 0; i < 100; i++) buf[i] = (uint8_t)i;
+
+    /* crossing the threshold must land on a page aligned block */
+    uint8_t *big = kvrealloc(buf, 100, 2 * 4096);
+    if (!big) { kvfree(buf); send_msg("FAILED: grow failed"); return; }
+    bool moved = IS_ALIGNED(big, 4096);
+
+    bool kept = true;
+    for (int i = 0; i < 100; i++) if (big[i] != (uint8_t)i) kept = false;
+    big[2 * 4096 - 1] = 0xEE;
+
+    uint8_t *small = kvrealloc(big, 2 * 4096, 50);
+    if (!small) { kvfree(big); send_msg("FAILED: shrink failed"); return; }
+    for (int i = 0; i < 50; i++) if (small[i] != (uint8_t)i) kept = false;
+    kvfree(small);
+
+    send_msg(moved && kept ? "PASSED" : "FAILED: kvrealloc lost data");
+}
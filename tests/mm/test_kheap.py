@@ -88,3 +88,15 @@ def test_kheap_buddy_symmetry(runner):
 # def test_kheap_buddy_multilevel(runner):
 #     result = runner.send_serial("kheap_buddy_multilevel")
 #     assert_passed(result)
+
+def test_kheap_grow_on_demand(runner):
+    result = runner.send_serial("kheap_grow_on_demand")
+    assert_passed(result)
+
+def test_kheap_pages(runner):
+    result = runner.send_serial("kheap_pages")
+    assert_passed(result)
+
+def test_kheap_kvrealloc(runner):
+    result = runner.send_serial("kheap_kvrealloc")
+    assert_passed(result)
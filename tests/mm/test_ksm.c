@@ -0,0 +1,121 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <mm/ksm.h>
+#include <mm/zeropage.h>
+#include <mm/vma.h>
+#include <mm/vmm.h>
+#include <mm/kmm.h>
+#include <mm/frame.h>
+#include <mm/pgtable.h>
+#include <mem.h>
+#include <testmain.h>
+#include "space.h"
+
+#define KSM_TEST_ADDR    0x40000000
+#define KSM_TEST_PAGES   4
+#define KSM_USER_FLAGS   (PTE_PRESENT | PTE_WRITABLE | PTE_USER)
+#define KSM_MAX_PASSES   8
+#define KSM_SCAN_BUDGET  4096
+
+/* maps the test pages, page i holds the pattern fill + i */
+static pagedir_t *make_filled_space(uint8_t fill) {
+    pagedir_t *pdir = test_make_space();
+    if (!pdir) return NULL;
+
+    if (!vma_alloc_region(pdir, (void *)KSM_TEST_ADDR,
+                          KSM_TEST_PAGES * VMM_PAGE_SIZE, KSM_USER_FLAGS)) {
+        vmm_destroy_space(pdir);
+        return NULL;
+    }
+
+    for (uint32_t i = 0; i < KSM_TEST_PAGES; i++) {
+        void *frame = vmm_get_phys_frame(pdir, (void *)(KSM_TEST_ADDR + i * VMM_PAGE_SIZE));
+        memset(PHYS_TO_VIRT(frame), fill ? fill + i : 0, VMM_PAGE_SIZE);
+    }
+    return pdir;
+}
+
+static void *frame_of(pagedir_t *pdir, uint32_t page) {
+    return vmm_get_phys_frame(pdir, (void *)(KSM_TEST_ADDR + page * VMM_PAGE_SIZE));
+}
+
+/* runs whole passes until the scanner stops finding anything to merge */
+static void scan_passes(void) {
+    for (int pass = 0; pass < KSM_MAX_PASSES; pass++) {
+        uint32_t full = ksm_get_stats()->full_scans;
+        while (ksm_get_stats()->full_scans == full) {
+            ksm_scan(KSM_SCAN_BUDGET);
+        }
+    }
+}
+
+// ------------ Identical pages of two spaces share a frame ------------
+void test_ksm_merge() {
+    pagedir_t *a = make_filled_space(0x10);
+    pagedir_t *b = make_filled_space(0x10);
+    ASSERT_TRUE(a && b, "address space setup failed");
+
+    uint32_t merges = ksm_get_stats()->merges;
+    uint32_t used   = kmm_get_used_frames();
+    scan_passes();
+
+    bool shared = true;
+    for (uint32_t i = 0; i < KSM_TEST_PAGES; i++) {
+        if (frame_of(a, i) != frame_of(b, i)) shared = false;
+    }
+    bool distinct = frame_of(a, 0) != frame_of(a, 1);
+    bool counted  = ksm_get_stats()->merges - merges >= KSM_TEST_PAGES;
+    bool saved    = used - kmm_get_used_frames() >= KSM_TEST_PAGES;
+
+    pte_t *pte = pgtable_get_pte(a, (void *)KSM_TEST_ADDR);
+    bool cow   = pte && (*pte & PTE_COW) && !PTE_IS_WRITABLE(*pte);
+
+    /* the merged frame stays readable through either space */
+    uint8_t *data = PHYS_TO_VIRT(frame_of(b, 2));
+    bool intact = data[0] == 0x12 && data[VMM_PAGE_SIZE - 1] == 0x12;
+
+    vmm_destroy_space(a);
+    vmm_destroy_space(b);
+
+    /* with both spaces gone the next pass frees the merged frames */
+    uint32_t before = kmm_get_used_frames();
+    scan_passes();
+    bool released = before - kmm_get_used_frames() >= KSM_TEST_PAGES ||
+                    ksm_get_stats()->pages_shared == 0;
+
+    ASSERT_TRUE(shared && distinct, "identical pages not merged");
+    ASSERT_TRUE(counted && saved, "merges not accounted");
+    ASSERT_TRUE(cow, "merged page left writable");
+    ASSERT_TRUE(intact, "merged page contents changed");
+    ASSERT_TRUE(released, "unused merged frames kept");
+    PASS();
+}
+
+// ------------ Zero filled pages map the zero page ------------
+void test_ksm_zero() {
+    if (!zero_page_frame()) {
+        PASS();
+        return;
+    }
+
+    pagedir_t *pdir = make_filled_space(0);
+    ASSERT_NOT_NULL(pdir, "address space setup failed");
+
+    uint32_t zeros = ksm_get_stats()->zero_merges;
+    scan_passes();
+
+    bool mapped = true;
+    for (uint32_t i = 0; i < KSM_TEST_PAGES; i++) {
+        if (!zero_page_is(frame_of(pdir, i))) mapped = false;
+    }
+    bool counted = ksm_get_stats()->zero_merges - zeros >= KSM_TEST_PAGES;
+
+    vmm_destroy_space(pdir);
+
+    ASSERT_TRUE(mapped, "zero pages not merged into the zero page");
+    ASSERT_TRUE(counted, "zero merges not counted");
+    PASS();
+}
@@ -0,0 +1,17 @@
+import pytest
+
+pytestmark = pytest.mark.ksm
+
+
+def assert_passed(result: str):
+    """Helper: ensure PASSED and not FAILED."""
+    assert "FAILED" not in result, f"Same page merging test failed: {result}"
+    assert "PASSED" in result, f"Unexpected output: {result}"
+
+
+def test_merge(runner):
+    assert_passed(runner.send_serial("ksm_merge"))
+
+
+def test_zero(runner):
+    assert_passed(runner.send_serial("ksm_zero"))
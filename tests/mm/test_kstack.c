@@ -0,0 +1,119 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <mm/kstack.h>
+#include <mm/kheap.h>
+#include <mm/pgtable.h>
+#include <mm/slab.h>
+#include <mm/vmm.h>
+#include <init/gdt.h>
+#include <init/idt.h>
+#include <proc/process.h>
+#include <mem.h>
+#include <testmain.h>
+
+static bool is_mapped(uintptr_t addr) {
+    pte_t *pte = pgtable_get_pte(vmm_get_kerneldir(), (void *)addr);
+    return pte && PTE_IS_PRESENT(*pte);
+}
+
+// ------------ Stacks sit above unmapped guard pages ------------
+void test_kstack_guard() {
+    uint8_t *small = kstack_alloc(VMM_PAGE_SIZE);
+    uint8_t *large = kstack_alloc(KSTACK_MAX_PAGES * VMM_PAGE_SIZE);
+    ASSERT_NOT_NULL(small, "small stack allocation failed");
+    ASSERT_NOT_NULL(large, "large stack allocation failed");
+
+    bool owned   = kstack_owns(small) && kstack_owns(large);
+    bool mapped  = is_mapped((uintptr_t)small) &&
+                   is_mapped((uintptr_t)large + (KSTACK_MAX_PAGES - 1) * VMM_PAGE_SIZE);
+    bool guarded = !is_mapped((uintptr_t)small - VMM_PAGE_SIZE) &&
+                   !is_mapped((uintptr_t)large - VMM_PAGE_SIZE);
+
+    /* the whole stack is usable */
+    small[0] = 1;
+    small[VMM_PAGE_SIZE - 1] = 2;
+
+    kstack_free(small);
+    kstack_free(large);
+
+    ASSERT_TRUE(owned, "stacks outside the stack range");
+    ASSERT_TRUE(mapped, "stack pages not mapped");
+    ASSERT_TRUE(guarded, "guard page mapped");
+    ASSERT_NULL(kstack_alloc((KSTACK_MAX_PAGES + 1) * VMM_PAGE_SIZE), "oversized stack handed out");
+    PASS();
+}
+
+// ------------ Freed stacks are reused by size ------------
+void test_kstack_recycle() {
+    void *a = kstack_alloc(VMM_PAGE_SIZE);
+    void *b = kstack_alloc(2 * VMM_PAGE_SIZE);
+    ASSERT_TRUE(a && b, "stack allocation failed");
+
+    kstack_free(a);
+    kstack_free(b);
+
+    uint32_t hits   = kstack_get_stats()->cache_hits;
+    uint32_t cached = kstack_get_stats()->cached;
+
+    void *again_b = kstack_alloc(2 * VMM_PAGE_SIZE);
+    void *again_a = kstack_alloc(VMM_PAGE_SIZE);
+
+    bool reused = again_a == a && again_b == b;
+    bool counted = kstack_get_stats()->cache_hits == hits + 2 &&
+                   kstack_get_stats()->cached == cached - 2;
+
+    kstack_free(again_a);
+    kstack_free(again_b);
+
+    ASSERT_TRUE(reused, "freed stacks not reused by size");
+    ASSERT_TRUE(counted, "cache hits not counted");
+    PASS();
+}
+
+// ------------ Threads get their stacks from the cache ------------
+// and the thread itself from the thread cache
+void test_kstack_thread() {
+    process_t *proc = malloc(sizeof(process_t));
+    ASSERT_NOT_NULL(proc, "malloc failed for process");
+
+    uint32_t in_use = kstack_get_stats()->in_use;
+
+    process_create(proc, "stacks", PROCESS_PRI_DEFAULT);
+    thread_t *main = _get_main_thread(proc);
+    bool cached = main && kstack_owns(main->esp0_start) &&
+                  kstack_get_stats()->in_use == in_use + 1;
+    kmem_cache_t *cache = kmem_cache_of(main);
+    uint32_t active = cache ? cache->num_active : 0;
+
+    process_destroy(proc);
+    free(proc);
+
+    ASSERT_TRUE(cached, "thread stack not from the stack cache");
+    ASSERT_EQ(kstack_get_stats()->in_use, in_use, "thread stack not returned");
+    ASSERT_TRUE(cache && strcmp(cache->name, "thread") == 0,
+                "thread not from the thread cache");
+    ASSERT_EQ(cache->num_active, active - 1, "thread not freed to its cache");
+    PASS();
+}
+
+// ------------ Double faults switch to a task with its own stack ------------
+void test_kstack_df_gate() {
+    idt_entry_t *gate = &((idt_entry_t *)get_idt_ptr()->base)[8];
+
+    ASSERT_TRUE(gate->gate_type_attr & IDT_ATTR_PRESENT, "double fault gate missing");
+    ASSERT_EQ(gate->gate_type_attr & 0x0F, IDT_GATE_TYPE_TASK, "double fault not a task gate");
+
+    gdt_entry_t *desc = &((gdt_entry_t *)get_gdt_ptr()->base)[gate->selector >> 3];
+    tss_t *tss = (tss_t *)(desc->base_low | (desc->base_middle << 16) |
+                           (desc->base_high << 24));
+
+    ASSERT_EQ(desc->access & 0x0F, GDT_ACCESS_TSS32, "gate not pointing at a free TSS");
+    ASSERT_TRUE(tss != tss_get_global(), "double fault on the kernel TSS");
+    ASSERT_TRUE(tss->eip && tss->esp, "task has no entry or stack");
+    ASSERT_TRUE(!kstack_owns((void *)tss->esp), "task stack is a thread stack");
+    ASSERT_EQ(tss->cs, GDT_KERNEL_CODE_SEL, "task not in the kernel");
+    PASS();
+}
@@ -0,0 +1,25 @@
+import pytest
+
+pytestmark = pytest.mark.kstack
+
+
+def assert_passed(result: str):
+    """Helper: ensure PASSED and not FAILED."""
+    assert "FAILED" not in result, f"Kernel stack test failed: {result}"
+    assert "PASSED" in result, f"Unexpected output: {result}"
+
+
+def test_guard(runner):
+    assert_passed(runner.send_serial("kstack_guard"))
+
+
+def test_recycle(runner):
+    assert_passed(runner.send_serial("kstack_recycle"))
+
+
+def test_thread(runner):
+    assert_passed(runner.send_serial("kstack_thread"))
+
+
+def test_df_gate(runner):
+    assert_passed(runner.send_serial("kstack_df_gate"))
@@ -0,0 +1,101 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <mm/fault.h>
+#include <mm/demand.h>
+#include <mm/uaccess.h>
+#include <mm/vma.h>
+#include <mm/vmm.h>
+#include <mem.h>
+#include <testmain.h>
+#include "space.h"
+
+#define PGFAULT_TEST_ADDR    0x40000000
+#define PGFAULT_TEST_HOLE    0x48000000
+#define PGFAULT_TEST_PAGES   4
+#define PGFAULT_USER_FLAGS   (PTE_PRESENT | PTE_WRITABLE | PTE_USER)
+
+// ------------ Faults are counted by cause and by resolver ------------
+void test_pgfault_counts() {
+    pagedir_t *pdir = test_make_space();
+    ASSERT_NOT_NULL(pdir, "address space setup failed");
+
+    bool none     = vmm_fault_get_counts(pdir) == NULL;
+    bool reserved = vmm_reserve_region(pdir, (void *)PGFAULT_TEST_ADDR,
+                                       PGFAULT_TEST_PAGES * VMM_PAGE_SIZE,
+                                       PGFAULT_USER_FLAGS);
+    if (!reserved) vmm_destroy_space(pdir);
+    ASSERT_TRUE(reserved, "reservation failed");
+
+    fault_counts_t before = *vmm_fault_get_counts(NULL);
+    uint32_t value = 0;
+
+    /* a read and a write populate two pages, a copy to the hole is fixed up */
+    pagedir_t *saved = vmm_get_current_pagedir();
+    vmm_switch_pagedir(pdir);
+    volatile uint32_t *mem = (uint32_t *)PGFAULT_TEST_ADDR;
+    value = mem[0];
+    mem[VMM_PAGE_SIZE / 4] = 0x1234;
+    bool fixed = copy_to_user((void *)PGFAULT_TEST_HOLE, &value, 4) == -1;
+    vmm_switch_pagedir(saved);
+
+    const fault_counts_t *space  = vmm_fault_get_counts(pdir);
+    const fault_counts_t *global = vmm_fault_get_counts(NULL);
+
+    bool local = space && space->total == 3 && space->not_present == 3 &&
+                 space->protection == 0 && space->kernel == 3 &&
+                 space->user == 0 && space->writes == 2 &&
+                 space->kinds[FAULT_KIND_DEMAND] == 2 &&
+                 space->kinds[FAULT_KIND_FIXUP] == 1;
+    bool all = global->total - before.total >= 3 &&
+               global->kinds[FAULT_KIND_DEMAND] - before.kinds[FAULT_KIND_DEMAND] >= 2 &&
+               global->kinds[FAULT_KIND_FIXUP] - before.kinds[FAULT_KIND_FIXUP] >= 1;
+
+    vmm_destroy_space(pdir);
+
+    ASSERT_TRUE(none, "counts for a page directory without a space");
+    ASSERT_TRUE(fixed, "copy to a hole not caught");
+    ASSERT_TRUE(local, "per space counts wrong");
+    ASSERT_TRUE(all, "global counts wrong");
+    PASS();
+}
+
+// ------------ The trace records the faulting address and resolver ------------
+void test_pgfault_trace() {
+    pagedir_t *pdir = test_make_space();
+    ASSERT_NOT_NULL(pdir, "address space setup failed");
+
+    bool reserved = vmm_reserve_region(pdir, (void *)PGFAULT_TEST_ADDR,
+                                       VMM_PAGE_SIZE, PGFAULT_USER_FLAGS);
+    if (!reserved) vmm_destroy_space(pdir);
+    ASSERT_TRUE(reserved, "reservation failed");
+
+    uint32_t value = 0;
+
+    vmm_fault_trace(true);
+    pagedir_t *saved = vmm_get_current_pagedir();
+    vmm_switch_pagedir(pdir);
+    value = *(volatile uint32_t *)(PGFAULT_TEST_ADDR + 8);
+    copy_from_user(&value, (void *)PGFAULT_TEST_HOLE, 4);
+    vmm_switch_pagedir(saved);
+    vmm_fault_trace(false);
+
+    fault_trace_entry_t entries[ 4 ];
+    uint32_t count = vmm_fault_trace_read(entries, 4);
+
+    vmm_destroy_space(pdir);
+
+    ASSERT_EQ(count, 2, "wrong number of traced faults");
+    ASSERT_TRUE(entries[0].addr == PGFAULT_TEST_ADDR + 8 &&
+                entries[0].kind == FAULT_KIND_DEMAND, "demand fault not traced");
+    ASSERT_TRUE(entries[1].addr == PGFAULT_TEST_HOLE &&
+                entries[1].kind == FAULT_KIND_FIXUP, "fixed up fault not traced");
+    ASSERT_TRUE(entries[0].eip >= PHYSMAP_BASE && entries[1].eip >= PHYSMAP_BASE,
+                "faulting instruction not recorded");
+    ASSERT_TRUE(uaccess_search_fixup(entries[1].eip) != 0, "eip is not the copy");
+
+    vmm_fault_trace_dump();
+    PASS();
+}
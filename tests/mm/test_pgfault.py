@@ -0,0 +1,19 @@
+import pytest
+
+pytestmark = pytest.mark.pgfault
+
+
+def assert_passed(result: str):
+    """Helper: ensure PASSED and not FAILED."""
+    assert "FAILED" not in result, f"Page fault profiling test failed: {result}"
+    assert "PASSED" in result, f"Unexpected output: {result}"
+
+
+def test_counts(runner):
+    assert_passed(runner.send_serial("pgfault_counts"))
+
+
+def test_trace(runner):
+    result = runner.send_serial("pgfault_trace")
+    assert_passed(result)
+    assert "page fault trace" in result, f"Trace not dumped: {result}"
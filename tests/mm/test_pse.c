@@ -0,0 +1,67 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <mm/pse.h>
+#include <mm/vmm.h>
+#include <mm/kmm.h>
+#include <mm/pgtable.h>
+#include <mem.h>
+#include <utils.h>
+#include <testmain.h>
+
+#define PSE_BENCH_ROUNDS  100
+#define PSE_BENCH_PAGES   256
+
+void test_pse_physmap() {
+    if (!pse_enabled()) {
+        PASS();
+        return;
+    }
+
+    ASSERT_TRUE(read_cr4() & CR4_PSE, "CR4.PSE not set");
+    ASSERT_TRUE(pse_get_stats()->kernel_pdes > 0, "physmap not collapsed");
+
+    /* the first 4MB of memory always exist and are mapped linearly */
+    pagedir_t *kdir = vmm_get_kerneldir();
+    pde_t pde = kdir->table[VMM_DIR_INDEX(PHYSMAP_BASE)];
+    ASSERT_TRUE(PDE_IS_PRESENT(pde) && PDE_IS_4MB(pde), "physmap not a large page");
+    ASSERT_NULL(pgtable_get_pte(kdir, (void *)PHYSMAP_BASE), "walker followed a large entry");
+
+    ASSERT_EQ(vmm_get_phys_frame(kdir, (void *)(PHYSMAP_BASE + 0x123456)),
+              (void *)0x123000, "wrong frame inside a large page");
+    ASSERT_EQ(vmm_get_phys_frame(kdir, (void *)(PHYSMAP_BASE + 0x100000)),
+              (void *)0x100000, "wrong frame for the kernel image");
+
+    /* the kernel image runs from the large page */
+    ASSERT_EQ(vmm_get_phys_frame(kdir, (void *)test_pse_physmap),
+              (void *)((uintptr_t)VIRT_TO_PHYS(test_pse_physmap) & ~VMM_PAGE_OFFSET_MASK),
+              "kernel text not in the linear map");
+    PASS();
+}
+
+void test_pse_benchmark() {
+    /* one read per page over the first megabytes of the physmap, with a cold
+        tlb each round */
+    uint32_t pages = kmm_get_total_frames();
+    if (pages > PSE_BENCH_PAGES) pages = PSE_BENCH_PAGES;
+
+    volatile uint8_t *base = (volatile uint8_t *)PHYSMAP_BASE;
+    uint32_t sum = 0;
+
+    uint64_t t0 = rdtsc();
+    for (uint32_t r = 0; r < PSE_BENCH_ROUNDS; r++) {
+        flush_tlb();
+        for (uint32_t p = 0; p < pages; p++) sum += base[p * VMM_PAGE_SIZE];
+    }
+    uint64_t t1 = rdtsc();
+    (void)sum;
+
+    uint32_t cycles = (uint32_t)(t1 - t0);
+
+    printk("physmap walk of %u pages (%s): %u cycles/round\n", pages,
+           pse_enabled() ? "4MB" : "4KB",
+           cycles / PSE_BENCH_ROUNDS);
+    PASS();
+}
@@ -0,0 +1,17 @@
+import pytest
+
+pytestmark = pytest.mark.pse
+
+
+def assert_passed(result: str):
+    """Helper: ensure PASSED and not FAILED."""
+    assert "FAILED" not in result, f"Large page test failed: {result}"
+    assert "PASSED" in result, f"Unexpected output: {result}"
+
+
+def test_physmap(runner):
+    assert_passed(runner.send_serial("pse_physmap"))
+
+
+def test_benchmark(runner):
+    assert_passed(runner.send_serial("pse_benchmark"))
@@ -0,0 +1,170 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <mm/shm.h>
+#include <mm/vma.h>
+#include <mm/vmm.h>
+#include <mm/kmm.h>
+#include <mm/frame.h>
+#include <mm/pgtable.h>
+#include <mem.h>
+#include <testmain.h>
+#include "space.h"
+
+#define SHM_TEST_KEY     0x5348
+#define SHM_TEST_PAGES   4
+#define SHM_TEST_ADDR    0x48000000
+
+// ------------ Two spaces see the same frames ------------
+void test_shm_attach() {
+    pagedir_t *a = test_make_space();
+    pagedir_t *b = test_make_space();
+    ASSERT_TRUE(a && b, "address space setup failed");
+
+    int32_t id = shm_create(NULL, SHM_TEST_KEY, SHM_TEST_PAGES * VMM_PAGE_SIZE);
+    bool found = id >= 0 && shm_create(NULL, SHM_TEST_KEY, VMM_PAGE_SIZE) == id;
+
+    uint8_t *in_a = shm_attach(a, id, NULL);
+    uint8_t *in_b = shm_attach(b, id, (void *)SHM_TEST_ADDR);
+    bool placed = in_a == (uint8_t *)USER_SHM_BASE && in_b == (uint8_t *)SHM_TEST_ADDR;
+
+    /* a write through one attachment is read through the other */
+    bool same = true;
+    for (uint32_t i = 0; placed && i < SHM_TEST_PAGES; i++) {
+        void *fa = vmm_get_phys_frame(a, in_a + i * VMM_PAGE_SIZE);
+        void *fb = vmm_get_phys_frame(b, in_b + i * VMM_PAGE_SIZE);
+        if (!fa || fa != fb || frame_refcount(fa) != 3) same = false;
+    }
+
+    bool seen = false;
+    if (placed) {
+        pagedir_t *saved = vmm_get_current_pagedir();
+        vmm_switch_pagedir(a);
+        ((volatile uint32_t *)in_a)[10] = 0xC0FFEE;
+        vmm_switch_pagedir(b);
+        seen = ((volatile uint32_t *)in_b)[10] == 0xC0FFEE;
+        vmm_switch_pagedir(saved);
+    }
+
+    vmm_destroy_space(a);
+    vmm_destroy_space(b);
+
+    ASSERT_TRUE(found, "segment not found by its key");
+    ASSERT_TRUE(placed, "segment attached at the wrong address");
+    ASSERT_TRUE(same, "attachments map different frames");
+    ASSERT_TRUE(seen, "write not visible through the other attachment");
+    PASS();
+}
+
+// ------------ The last detach frees the segment ------------
+void test_shm_detach() {
+    pagedir_t *a = test_make_space();
+    pagedir_t *b = test_make_space();
+    ASSERT_TRUE(a && b, "address space setup failed");
+
+    uint32_t used     = kmm_get_used_frames();
+    uint32_t segments = shm_get_stats()->segments;
+
+    int32_t id = shm_create(NULL, SHM_KEY_PRIVATE, SHM_TEST_PAGES * VMM_PAGE_SIZE);
+    void *in_a = shm_attach(a, id, NULL);
+    void *in_b = shm_attach(b, id, NULL);
+    bool attached = in_a && in_b;
+
+    bool bad    = shm_detach(a, (uint8_t *)in_a + VMM_PAGE_SIZE) != 0;
+    bool first  = shm_detach(a, in_a) == 0 && vmm_get_phys_frame(a, in_a) == NULL;
+    bool alive  = shm_get_stats()->segments == segments + 1;
+    bool second = shm_detach(b, in_b) == 0;
+    bool gone   = shm_get_stats()->segments == segments;
+
+    vmm_destroy_space(a);
+    vmm_destroy_space(b);
+
+    /* only the page tables of the spaces may still be around */
+    bool freed = kmm_get_used_frames() <= used + 2;
+
+    ASSERT_TRUE(id >= 0 && attached, "segment setup failed");
+    ASSERT_TRUE(bad, "detach inside an attachment accepted");
+    ASSERT_TRUE(first && alive, "segment freed with attachments left");
+    ASSERT_TRUE(second && gone, "segment kept after the last detach");
+    ASSERT_TRUE(freed, "segment frames leaked");
+    PASS();
+}
+
+// ------------ A removed segment goes with its last attachment ------------
+void test_shm_remove() {
+    pagedir_t *a = test_make_space();
+    pagedir_t *b = test_make_space();
+    ASSERT_TRUE(a && b, "address space setup failed");
+
+    uint32_t segments = shm_get_stats()->segments;
+
+    /* nothing attached, so it is freed right away */
+    int32_t idle = shm_create(a, SHM_TEST_KEY + 1, VMM_PAGE_SIZE);
+    bool idle_gone = idle >= 0 && shm_remove(a, idle) == 0 &&
+                     shm_get_stats()->segments == segments;
+
+    int32_t id = shm_create(a, SHM_TEST_KEY + 1, VMM_PAGE_SIZE);
+    void *in_b = shm_attach(b, id, NULL);
+
+    bool denied  = shm_remove(b, id) != 0;
+    bool removed = shm_remove(a, id) == 0 && shm_get_stats()->segments == segments + 1;
+
+    /* the key is free for a new segment, the old one cannot be attached */
+    int32_t fresh = shm_create(NULL, SHM_TEST_KEY + 1, VMM_PAGE_SIZE);
+    bool hidden = fresh >= 0 && fresh != id && shm_attach(a, id, NULL) == NULL;
+    shm_remove(NULL, fresh);
+
+    bool gone = shm_detach(b, in_b) == 0 && shm_get_stats()->segments == segments;
+
+    vmm_destroy_space(a);
+    vmm_destroy_space(b);
+
+    ASSERT_TRUE(idle_gone, "unattached segment kept after remove");
+    ASSERT_TRUE(id >= 0 && in_b, "segment setup failed");
+    ASSERT_TRUE(denied, "segment removed by a space that did not create it");
+    ASSERT_TRUE(removed, "attached segment freed on remove");
+    ASSERT_TRUE(hidden, "removed segment still found");
+    ASSERT_TRUE(gone, "removed segment kept after the last detach");
+    PASS();
+}
+
+// ------------ A space creates few segments and takes them along ------------
+void test_shm_owner() {
+    pagedir_t *a = test_make_space();
+    pagedir_t *b = test_make_space();
+    ASSERT_TRUE(a && b, "address space setup failed");
+
+    uint32_t used     = kmm_get_used_frames();
+    uint32_t segments = shm_get_stats()->segments;
+
+    int32_t ids[SHM_MAX_PER_SPACE];
+    bool created = true;
+    for (int i = 0; i < SHM_MAX_PER_SPACE; i++) {
+        ids[i] = shm_create(a, SHM_KEY_PRIVATE, VMM_PAGE_SIZE);
+        if (ids[i] < 0) created = false;
+    }
+
+    bool limited = shm_create(a, SHM_KEY_PRIVATE, VMM_PAGE_SIZE) < 0;
+    bool others  = shm_create(b, SHM_KEY_PRIVATE, VMM_PAGE_SIZE) >= 0;
+
+    /* the attached one outlives its creator */
+    void *in_b = created ? shm_attach(b, ids[0], NULL) : NULL;
+
+    vmm_destroy_space(a);
+    bool released = shm_get_stats()->segments == segments + 2;
+    bool alive    = in_b && vmm_get_phys_frame(b, in_b) != NULL;
+
+    vmm_destroy_space(b);
+    bool gone  = shm_get_stats()->segments == segments;
+    bool freed = kmm_get_used_frames() <= used + 2;
+
+    ASSERT_TRUE(created, "segment setup failed");
+    ASSERT_TRUE(limited, "segment created past the per space limit");
+    ASSERT_TRUE(others, "limit of one space applied to another");
+    ASSERT_TRUE(released && alive, "segments of an exited creator mishandled");
+    ASSERT_TRUE(gone, "segments kept after their spaces went away");
+    ASSERT_TRUE(freed, "segment frames leaked");
+    PASS();
+}
@@ -0,0 +1,25 @@
+import pytest
+
+pytestmark = pytest.mark.shm
+
+
+def assert_passed(result: str):
+    """Helper: ensure PASSED and not FAILED."""
+    assert "FAILED" not in result, f"Shared memory test failed: {result}"
+    assert "PASSED" in result, f"Unexpected output: {result}"
+
+
+def test_attach(runner):
+    assert_passed(runner.send_serial("shm_attach"))
+
+
+def test_detach(runner):
+    assert_passed(runner.send_serial("shm_detach"))
+
+
+def test_remove(runner):
+    assert_passed(runner.send_serial("shm_remove"))
+
+
+def test_owner(runner):
+    assert_passed(runner.send_serial("shm_owner"))
@@ -0,0 +1,139 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <mm/shrinker.h>
+#include <mm/slab.h>
+#include <mm/kmm.h>
+#include <mm/vma.h>
+#include <mm/vmm.h>
+#include <testmain.h>
+
+/* a fake cache that holds on to a few frames and gives them up on request */
+#define FAKE_FRAMES 8
+
+static void    *fake_held[FAKE_FRAMES];
+static uint32_t fake_count = 0;
+
+static uint32_t fake_shrink_count(void *priv) {
+    (void)priv;
+    return fake_count;
+}
+
+static uint32_t fake_shrink_scan(void *priv, uint32_t nr) {
+    (void)priv;
+    uint32_t released = 0;
+    while (released < nr && fake_count > 0) {
+        kmm_frame_free(fake_held[--fake_count]);
+        released++;
+    }
+    return released;
+}
+
+static void fake_fill(void) {
+    while (fake_count < FAKE_FRAMES) {
+        fake_held[fake_count++] = kmm_frame_alloc();
+    }
+}
+
+static shrinker_t fake_shrinker = {
+    .name  = "test_fake",
+    .count = fake_shrink_count,
+    .scan  = fake_shrink_scan,
+};
+
+// ---------------- Watermark triggered reclaim ----------------
+void test_shrinker_low_watermark() {
+    uint32_t low, high;
+    shrinker_get_watermarks(&low, &high);
+
+    fake_fill();
+    ASSERT_EQ(shrinker_register(&fake_shrinker), 0, "register failed");
+
+    /* pretend every frame is needed, any allocation is now under pressure */
+    uint32_t total = kmm_get_total_frames();
+    shrinker_set_watermarks(total, total);
+
+    uint32_t hits = reclaim_get_stats()->low_wmark_hits;
+    void *frame = reclaim_frame_alloc(0);
+
+    shrinker_set_watermarks(low, high);
+    shrinker_unregister(&fake_shrinker);
+
+    ASSERT_NOT_NULL(frame, "allocation failed");
+    kmm_frame_free(frame);
+
+    ASSERT_EQ(reclaim_get_stats()->low_wmark_hits, hits + 1, "watermark not hit");
+    ASSERT_EQ(fake_count, 0, "shrinker did not release its frames");
+    ASSERT_TRUE(fake_shrinker.reclaimed == FAKE_FRAMES, "reclaim not accounted");
+    PASS();
+}
+
+// ---------------- The vmm's frames go through reclaim ----------------
+void test_shrinker_vmm() {
+    uint32_t low, high;
+    shrinker_get_watermarks(&low, &high);
+
+    fake_fill();
+    ASSERT_EQ(shrinker_register(&fake_shrinker), 0, "register failed");
+
+    uint32_t total = kmm_get_total_frames();
+    shrinker_set_watermarks(total, total);
+
+    uint32_t hits = reclaim_get_stats()->low_wmark_hits;
+    pagedir_t *pdir = vmm_create_address_space();
+
+    shrinker_set_watermarks(low, high);
+    shrinker_unregister(&fake_shrinker);
+
+    ASSERT_NOT_NULL(pdir, "address space creation failed");
+    vmm_destroy_space(pdir);
+
+    ASSERT_TRUE(reclaim_get_stats()->low_wmark_hits > hits,
+                "vmm frame allocation bypassed reclaim");
+    ASSERT_EQ(fake_count, 0, "shrinker did not run for the vmm");
+    PASS();
+}
+
+// ---------------- Heap shrinkers are skipped when asked ----------------
+void test_shrinker_noheap() {
+    fake_fill();
+    fake_shrinker.flags = SHRINKER_USES_HEAP;
+    ASSERT_EQ(shrinker_register(&fake_shrinker), 0, "register failed");
+
+    uint32_t skipped = shrink_memory(FAKE_FRAMES, RECLAIM_NOHEAP);
+    uint32_t kept    = fake_count;
+    shrink_memory(FAKE_FRAMES, 0);
+
+    shrinker_unregister(&fake_shrinker);
+    fake_shrinker.flags = 0;
+
+    ASSERT_TRUE(kept == FAKE_FRAMES, "heap shrinker ran under RECLAIM_NOHEAP");
+    ASSERT_EQ(fake_count, 0, "heap shrinker did not run without the flag");
+    (void)skipped;
+    PASS();
+}
+
+// ---------------- Slab caches are reclaimable ----------------
+void test_shrinker_slab() {
+    kmem_cache_t *c = kmem_cache_create("t_shrink", 512, 0, NULL);
+    ASSERT_NOT_NULL(c, "cache creation failed");
+
+    /* spread objects over several slabs, then free them all */
+    void *objs[32];
+    for (int i = 0; i < 32; i++) objs[i] = kmem_cache_alloc(c);
+    for (int i = 0; i < 32; i++) kmem_cache_free(c, objs[i]);
+
+    ASSERT_TRUE(c->num_slabs > 0, "no free slab kept around");
+
+    uint32_t used = kmm_get_used_frames();
+    uint32_t got  = shrink_memory(kmm_get_total_frames(), RECLAIM_NOHEAP);
+
+    ASSERT_TRUE(got > 0, "no pages reclaimed");
+    ASSERT_EQ(c->num_slabs, 0, "cache still holds free slabs");
+    ASSERT_TRUE(kmm_get_used_frames() < used, "frames not returned");
+
+    ASSERT_EQ(kmem_cache_destroy(c), 0, "destroy failed");
+    PASS();
+}
@@ -0,0 +1,25 @@
+import pytest
+
+pytestmark = pytest.mark.shrinker
+
+
+def assert_passed(result: str):
+    """Helper: ensure PASSED and not FAILED."""
+    assert "FAILED" not in result, f"Shrinker failed: {result}"
+    assert "PASSED" in result, f"Unexpected output: {result}"
+
+
+def test_low_watermark(runner):
+    assert_passed(runner.send_serial("shrinker_low_watermark"))
+
+
+def test_noheap(runner):
+    assert_passed(runner.send_serial("shrinker_noheap"))
+
+
+def test_slab(runner):
+    assert_passed(runner.send_serial("shrinker_slab"))
+
+
+def test_vmm(runner):
+    assert_passed(runner.send_serial("shrinker_vmm"))
@@ -0,0 +1,208 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <mm/slab.h>
+#include <mm/kmm.h>
+#include <mm/kheap.h>
+#include <mem.h>
+#include <testmain.h>
+
+/* object type used by the tests, odd sized on purpose */
+struct slab_test_obj {
+    uint32_t    magic;
+    uint8_t     payload[21];
+};
+
+#define TEST_OBJ_MAGIC  0xC0FFEE11
+
+static uint32_t ctor_calls = 0;
+
+static void test_obj_ctor(void *obj) {
+    struct slab_test_obj *o = obj;
+    o->magic = TEST_OBJ_MAGIC;
+    memset(o->payload, 0, sizeof(o->payload));
+    ctor_calls++;
+}
+
+// ---------------- Creation ----------------
+void test_slab_create_destroy() {
+    kmem_cache_t *c = kmem_cache_create("t_create", 40, 0, NULL);
+    ASSERT_NOT_NULL(c, "cache creation failed");
+    ASSERT_TRUE(c->slot_size >= 40, "slot smaller than object");
+    ASSERT_TRUE(c->objs_per_slab > 0, "no objects per slab");
+    ASSERT_EQ(kmem_cache_destroy(c), 0, "destroy of empty cache failed");
+    PASS();
+}
+
+void test_slab_create_too_large() {
+    kmem_cache_t *c = kmem_cache_create("t_large", KMEM_SLAB_SIZE, 0, NULL);
+    ASSERT_NULL(c, "object larger than a slab accepted");
+    PASS();
+}
+
+// ---------------- Allocation ----------------
+void test_slab_alloc_free_reuse() {
+    kmem_cache_t *c = kmem_cache_create("t_reuse", 64, 0, NULL);
+    ASSERT_NOT_NULL(c, "cache creation failed");
+
+    void *a = kmem_cache_alloc(c);
+    ASSERT_NOT_NULL(a, "alloc failed");
+    kmem_cache_free(c, a);
+    void *b = kmem_cache_alloc(c);
+    ASSERT_TRUE(a == b, "freed object not reused first");
+
+    kmem_cache_free(c, b);
+    ASSERT_EQ(c->num_active, 0, "active count not zero");
+    ASSERT_EQ(kmem_cache_destroy(c), 0, "destroy failed");
+    PASS();
+}
+
+void test_slab_alignment() {
+    kmem_cache_t *c = kmem_cache_create("t_align", 24, 64, NULL);
+    ASSERT_NOT_NULL(c, "cache creation failed");
+
+    void *objs[8];
+    for (int i = 0; i < 8; i++) {
+        objs[i] = kmem_cache_alloc(c);
+        ASSERT_NOT_NULL(objs[i], "alloc failed");
+        ASSERT_TRUE(((uintptr_t)objs[i] & 63) == 0, "object misaligned");
+    }
+    for (int i = 0; i < 8; i++) kmem_cache_free(c, objs[i]);
+
+    ASSERT_EQ(kmem_cache_destroy(c), 0, "destroy failed");
+    PASS();
+}
+
+void test_slab_ctor() {
+    kmem_cache_t *c = kmem_cache_create("t_ctor", sizeof(struct slab_test_obj),
+                                        0, test_obj_ctor);
+    ASSERT_NOT_NULL(c, "cache creation failed");
+
+    ctor_calls = 0;
+    struct slab_test_obj *o = kmem_cache_alloc(c);
+    ASSERT_NOT_NULL(o, "alloc failed");
+    ASSERT_EQ(o->magic, TEST_OBJ_MAGIC, "object not constructed");
+    ASSERT_EQ(ctor_calls, 1, "ctor not called exactly once");
+
+    kmem_cache_free(c, o);
+    o = kmem_cache_alloc(c);
+    ASSERT_EQ(o->magic, TEST_OBJ_MAGIC, "reused object not constructed");
+
+    kmem_cache_free(c, o);
+    ASSERT_EQ(kmem_cache_destroy(c), 0, "destroy failed");
+    PASS();
+}
+
+// ---------------- Slab management ----------------
+void test_slab_multi_slab() {
+    kmem_cache_t *c = kmem_cache_create("t_multi", 128, 0, NULL);
+    ASSERT_NOT_NULL(c, "cache creation failed");
+
+    uint32_t n = c->objs_per_slab * 3;
+    static void *objs[256];
+    ASSERT_TRUE(n <= 256, "test array too small");
+
+    for (uint32_t i = 0; i < n; i++) {
+        objs[i] = kmem_cache_alloc(c);
+        ASSERT_NOT_NULL(objs[i], "alloc failed");
+        memset(objs[i], (int)i, 128);
+    }
+    ASSERT_EQ(c->num_slabs, 3, "unexpected slab count");
+    ASSERT_EQ(list_size(&c->slabs_full), 3, "slabs not on full list");
+
+    /* no two objects may overlap */
+    for (uint32_t i = 0; i < n; i++) {
+        uint8_t *p = objs[i];
+        ASSERT_TRUE(p[0] == (uint8_t)i && p[127] == (uint8_t)i,
+                    "object contents clobbered");
+    }
+
+    for (uint32_t i = 0; i < n; i++) kmem_cache_free(c, objs[i]);
+    ASSERT_EQ(c->num_active, 0, "active count not zero");
+    ASSERT_TRUE(c->num_slabs <= KMEM_FREE_SLABS_MAX, "free slabs not reclaimed");
+
+    ASSERT_EQ(kmem_cache_destroy(c), 0, "destroy failed");
+    PASS();
+}
+
+void test_slab_shrink_returns_frames() {
+    kmem_cache_t *c = kmem_cache_create("t_shrink", 256, 0, NULL);
+    ASSERT_NOT_NULL(c, "cache creation failed");
+
+    uint32_t used_before = kmm_get_used_frames();
+    void *o = kmem_cache_alloc(c);
+    ASSERT_NOT_NULL(o, "alloc failed");
+    ASSERT_EQ(kmm_get_used_frames(), used_before + 1, "slab frame not taken");
+
+    kmem_cache_free(c, o);
+    ASSERT_EQ(kmem_cache_shrink(c), 1, "shrink released wrong count");
+    ASSERT_EQ(kmm_get_used_frames(), used_before, "slab frame not returned");
+
+    ASSERT_EQ(kmem_cache_destroy(c), 0, "destroy failed");
+    PASS();
+}
+
+void test_slab_destroy_busy() {
+    kmem_cache_t *c = kmem_cache_create("t_busy", 32, 0, NULL);
+    ASSERT_NOT_NULL(c, "cache creation failed");
+
+    void *o = kmem_cache_alloc(c);
+    ASSERT_TRUE(kmem_cache_destroy(c) != 0, "destroyed cache with live objects");
+
+    kmem_cache_free(c, o);
+    ASSERT_EQ(kmem_cache_destroy(c), 0, "destroy failed");
+    PASS();
+}
+
+void test_slab_invalid_free() {
+    kmem_cache_t *a = kmem_cache_create("t_inv_a", 32, 0, NULL);
+    kmem_cache_t *b = kmem_cache_create("t_inv_b", 32, 0, NULL);
+    ASSERT_TRUE(a && b, "cache creation failed");
+
+    void *o = kmem_cache_alloc(a);
+    kmem_cache_free(b, o);              /* wrong cache, must be ignored */
+    ASSERT_EQ(a->num_active, 1, "foreign free changed owner cache");
+    ASSERT_EQ(b->num_active, 0, "foreign free accepted");
+
+    kmem_cache_free(a, (uint8_t *)o + 1);   /* not an object boundary */
+    ASSERT_EQ(a->num_active, 1, "misaligned free accepted");
+
+    kmem_cache_free(a, o);
+    kmem_cache_free(a, o);              /* double free on empty slab */
+    ASSERT_EQ(a->num_active, 0, "double free corrupted counts");
+
+    ASSERT_EQ(kmem_cache_destroy(a), 0, "destroy failed");
+    ASSERT_EQ(kmem_cache_destroy(b), 0, "destroy failed");
+    PASS();
+}
+
+void test_slab_cache_of() {
+    kmem_cache_t *c = kmem_cache_create("t_owner", 24, 0, NULL);
+    ASSERT_NOT_NULL(c, "cache creation failed");
+
+    void *o = kmem_cache_alloc(c);
+    void *h = malloc(24);
+    ASSERT_TRUE(o && h, "allocation failed");
+
+    ASSERT_TRUE(kmem_cache_of(o) == c, "object not owned by its cache");
+    ASSERT_NULL(kmem_cache_of(h), "heap block owned by a cache");
+    ASSERT_NULL(kmem_cache_of(&ctor_calls), "kernel data owned by a cache");
+
+    /* a page that only looks like a slab is not one */
+    void *frame = kmm_frame_alloc();
+    ASSERT_NOT_NULL(frame, "frame allocation failed");
+    kmem_slab_t *fake = PHYS_TO_VIRT(frame);
+    fake->cache = c;
+    fake->magic = KMEM_SLAB_MAGIC;
+    bool forged = kmem_cache_of((uint8_t *)fake + 64) != NULL;
+    kmm_frame_free(frame);
+    ASSERT_FALSE(forged, "forged slab header owned by a cache");
+
+    free(h);
+    kmem_cache_free(c, o);
+    ASSERT_EQ(kmem_cache_destroy(c), 0, "destroy failed");
+    ASSERT_NULL(kmem_cache_of(o), "released slab still owned");
+    PASS();
+}
@@ -0,0 +1,49 @@
+import pytest
+
+pytestmark = pytest.mark.slab
+
+
+def assert_passed(result: str):
+    """Helper: ensure PASSED and not FAILED."""
+    assert "FAILED" not in result, f"Slab allocator failed: {result}"
+    assert "PASSED" in result, f"Unexpected output: {result}"
+
+
+def test_create_destroy(runner):
+    assert_passed(runner.send_serial("slab_create_destroy"))
+
+
+def test_create_too_large(runner):
+    assert_passed(runner.send_serial("slab_create_too_large"))
+
+
+def test_alloc_free_reuse(runner):
+    assert_passed(runner.send_serial("slab_alloc_free_reuse"))
+
+
+def test_alignment(runner):
+    assert_passed(runner.send_serial("slab_alignment"))
+
+
+def test_ctor(runner):
+    assert_passed(runner.send_serial("slab_ctor"))
+
+
+def test_multi_slab(runner):
+    assert_passed(runner.send_serial("slab_multi_slab"))
+
+
+def test_shrink_returns_frames(runner):
+    assert_passed(runner.send_serial("slab_shrink"))
+
+
+def test_destroy_busy(runner):
+    assert_passed(runner.send_serial("slab_destroy_busy"))
+
+
+def test_invalid_free(runner):
+    assert_passed(runner.send_serial("slab_invalid_free"))
+
+
+def test_cache_of(runner):
+    assert_passed(runner.send_serial("slab_cache_of"))
@@ -0,0 +1,137 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <mm/swap.h>
+#include <mm/vma.h>
+#include <mm/vmm.h>
+#include <mm/pgtable.h>
+#include <mem.h>
+#include <testmain.h>
+#include "space.h"
+
+#define SWAP_TEST_ADDR    0x40000000
+#define SWAP_TEST_PAGES   4
+#define SWAP_USER_FLAGS   (PTE_PRESENT | PTE_WRITABLE | PTE_USER)
+#define SWAP_MAX_SWEEPS   16
+
+static bool page_swapped(pagedir_t *pdir, uintptr_t addr) {
+    pte_t *pte = pgtable_get_pte(pdir, (void *)addr);
+    return pte && PTE_IS_SWAP(*pte);
+}
+
+/* maps the test pages and fills each with its index through the physmap */
+static pagedir_t *make_filled_space(void) {
+    pagedir_t *pdir = test_make_space();
+    if (!pdir) return NULL;
+
+    if (!vma_alloc_region(pdir, (void *)SWAP_TEST_ADDR,
+                          SWAP_TEST_PAGES * VMM_PAGE_SIZE, SWAP_USER_FLAGS)) {
+        vmm_destroy_space(pdir);
+        return NULL;
+    }
+
+    for (uint32_t i = 0; i < SWAP_TEST_PAGES; i++) {
+        void *frame = vmm_get_phys_frame(pdir, (void *)(SWAP_TEST_ADDR + i * VMM_PAGE_SIZE));
+        memset(PHYS_TO_VIRT(frame), 0xA0 + i, VMM_PAGE_SIZE);
+    }
+    return pdir;
+}
+
+/* sweeps the clock hand until every test page is out, other spaces may be
+   holding some of the hand's attention */
+static bool swap_out_all(pagedir_t *pdir) {
+    for (int sweep = 0; sweep < SWAP_MAX_SWEEPS; sweep++) {
+        uint32_t out = 0;
+        for (uint32_t i = 0; i < SWAP_TEST_PAGES; i++) {
+            if (page_swapped(pdir, SWAP_TEST_ADDR + i * VMM_PAGE_SIZE)) out++;
+        }
+        if (out == SWAP_TEST_PAGES) return true;
+        swap_out(SWAP_TEST_PAGES);
+    }
+    return false;
+}
+
+// ------------ Evicted pages come back with their contents ------------
+void test_swap_roundtrip() {
+    if (!swap_enabled()) {
+        PASS();
+        return;
+    }
+
+    pagedir_t *pdir = make_filled_space();
+    ASSERT_NOT_NULL(pdir, "address space setup failed");
+
+    swap_stats_t before = *swap_get_stats();
+    bool out = swap_out_all(pdir);
+    bool counted = swap_get_stats()->swap_outs - before.swap_outs >= SWAP_TEST_PAGES;
+
+    /* touching the pages faults them back in */
+    bool intact = true;
+    pagedir_t *saved = vmm_get_current_pagedir();
+    vmm_switch_pagedir(pdir);
+    for (uint32_t i = 0; out && i < SWAP_TEST_PAGES; i++) {
+        volatile uint8_t *page = (uint8_t *)(SWAP_TEST_ADDR + i * VMM_PAGE_SIZE);
+        if (page[0] != 0xA0 + i || page[VMM_PAGE_SIZE - 1] != 0xA0 + i) intact = false;
+    }
+    vmm_switch_pagedir(saved);
+
+    uint32_t ins = swap_get_stats()->swap_ins - before.swap_ins;
+    pte_t *pte = pgtable_get_pte(pdir, (void *)SWAP_TEST_ADDR);
+    bool writable = pte && PTE_IS_PRESENT(*pte) && PTE_IS_WRITABLE(*pte);
+
+    vmm_destroy_space(pdir);
+
+    ASSERT_TRUE(out, "pages not written out");
+    ASSERT_TRUE(counted, "swap outs not counted");
+    ASSERT_TRUE(intact, "page contents lost in swap");
+    ASSERT_TRUE(ins >= SWAP_TEST_PAGES, "swap ins not counted");
+    ASSERT_TRUE(writable, "page lost its protection in swap");
+    PASS();
+}
+
+// ------------ Destroying a space gives its slots back ------------
+void test_swap_release() {
+    if (!swap_enabled()) {
+        PASS();
+        return;
+    }
+
+    uint32_t used = swap_get_stats()->used;
+
+    pagedir_t *pdir = make_filled_space();
+    ASSERT_NOT_NULL(pdir, "address space setup failed");
+
+    bool out = swap_out_all(pdir);
+    uint32_t held = 0;
+    for (uint32_t i = 0; i < SWAP_TEST_PAGES; i++) {
+        if (page_swapped(pdir, SWAP_TEST_ADDR + i * VMM_PAGE_SIZE)) held++;
+    }
+
+    /* slots of other spaces evicted meanwhile stay used */
+    uint32_t during = swap_get_stats()->used;
+    vmm_destroy_space(pdir);
+    uint32_t after = swap_get_stats()->used;
+
+    ASSERT_TRUE(out && held == SWAP_TEST_PAGES, "pages not written out");
+    ASSERT_TRUE(during >= used + SWAP_TEST_PAGES, "slots not taken");
+    ASSERT_TRUE(during - after == SWAP_TEST_PAGES, "slots not released");
+    PASS();
+}
+
+// ------------ Swappiness stays within its range ------------
+void test_swap_swappiness() {
+    uint32_t saved = swap_get_swappiness();
+
+    bool low  = swap_set_swappiness(0) == 0 && swap_get_swappiness() == 0;
+    bool high = swap_set_swappiness(SWAP_MAX_SWAPPINESS) == 0;
+    bool over = swap_set_swappiness(SWAP_MAX_SWAPPINESS + 1) != 0 &&
+                swap_get_swappiness() == SWAP_MAX_SWAPPINESS;
+
+    swap_set_swappiness(saved);
+
+    ASSERT_TRUE(low && high, "valid swappiness rejected");
+    ASSERT_TRUE(over, "out of range swappiness accepted");
+    PASS();
+}
@@ -0,0 +1,21 @@
+import pytest
+
+pytestmark = pytest.mark.swap
+
+
+def assert_passed(result: str):
+    """Helper: ensure PASSED and not FAILED."""
+    assert "FAILED" not in result, f"Swap test failed: {result}"
+    assert "PASSED" in result, f"Unexpected output: {result}"
+
+
+def test_roundtrip(runner):
+    assert_passed(runner.send_serial("swap_roundtrip"))
+
+
+def test_release(runner):
+    assert_passed(runner.send_serial("swap_release"))
+
+
+def test_swappiness(runner):
+    assert_passed(runner.send_serial("swap_swappiness"))
@@ -0,0 +1,132 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <mm/tlb.h>
+#include <mm/vmm.h>
+#include <mm/vmalloc.h>
+#include <mm/pgtable.h>
+#include <mem.h>
+#include <utils.h>
+#include <testmain.h>
+
+#define TLB_BENCH_SWITCHES  1000
+#define TLB_BENCH_PAGES     16
+
+/* true if every page of a kernel buffer is mapped global */
+static bool all_global(void *buf, uint32_t npages) {
+    pagedir_t *kdir = vmm_get_kerneldir();
+    for (uint32_t i = 0; i < npages; i++) {
+        pte_t *pte = pgtable_get_pte(kdir, (uint8_t *)buf + i * VMM_PAGE_SIZE);
+        if (!pte || !PTE_IS_PRESENT(*pte) || !(*pte & PTE_GLOBAL)) return false;
+    }
+    return true;
+}
+
+/* switches back and forth between two address spaces, reading one word of
+    each kernel page after every switch */
+static uint32_t bench_switches(pagedir_t *a, pagedir_t *b, volatile uint32_t *buf) {
+    uint32_t sum = 0;
+    uint64_t t0  = rdtsc();
+    for (uint32_t i = 0; i < TLB_BENCH_SWITCHES; i++) {
+        vmm_switch_pagedir((i & 1) ? a : b);
+        for (uint32_t p = 0; p < TLB_BENCH_PAGES; p++)
+            sum += buf[p * (VMM_PAGE_SIZE / sizeof(uint32_t))];
+    }
+    uint64_t t1 = rdtsc();
+    (void)sum;
+    return (uint32_t)(t1 - t0);
+}
+
+void test_tlb_global() {
+    uint32_t eax, ebx, ecx, edx;
+    cpuid(1, &eax, &ebx, &ecx, &edx);
+
+    if (!(edx & (1 << 13))) {
+        ASSERT_FALSE(tlb_global_enabled(), "global pages enabled without cpu support");
+        PASS();
+        return;
+    }
+
+    ASSERT_TRUE(tlb_global_enabled(), "global pages not enabled");
+    ASSERT_TRUE(read_cr4() & CR4_PGE, "CR4.PGE not set");
+
+    void *buf = vmalloc(4 * VMM_PAGE_SIZE);
+    ASSERT_NOT_NULL(buf, "vmalloc failed");
+    bool ok = all_global(buf, 4);
+    vfree(buf);
+
+    ASSERT_TRUE(ok, "vmalloc pages not mapped global");
+    PASS();
+}
+
+void test_tlb_batch() {
+    tlb_stats_t before = *tlb_get_stats();
+    tlb_batch_t batch;
+
+    /* small batches invalidate page by page */
+    tlb_batch_init(&batch);
+    for (uint32_t i = 0; i < 4; i++)
+        tlb_batch_add(&batch, VMALLOC_START + i * VMM_PAGE_SIZE);
+    ASSERT_TRUE(batch.count == 4 && !batch.full, "small batch miscounted");
+    tlb_batch_flush(&batch);
+
+    const tlb_stats_t *after = tlb_get_stats();
+    ASSERT_TRUE(after->pages == before.pages + 4, "pages not invalidated one by one");
+    ASSERT_TRUE(batch.count == 0, "batch not emptied by flush");
+
+    /* large batches of kernel pages drop everything, global entries too */
+    tlb_batch_init(&batch);
+    for (uint32_t i = 0; i <= TLB_FLUSH_THRESHOLD; i++)
+        tlb_batch_add(&batch, VMALLOC_START + i * VMM_PAGE_SIZE);
+    ASSERT_TRUE(batch.full, "threshold not detected");
+    tlb_batch_flush(&batch);
+
+    if (tlb_global_enabled())
+        ASSERT_TRUE(after->global_flushes == before.global_flushes + 1, "no global flush");
+    else
+        ASSERT_TRUE(after->full_flushes == before.full_flushes + 1, "no full flush");
+
+    /* unmapping a large vmalloc buffer goes through one batch */
+    uint32_t batches = after->batches;
+    void *buf = vmalloc((TLB_FLUSH_THRESHOLD * 2) * VMM_PAGE_SIZE);
+    ASSERT_NOT_NULL(buf, "vmalloc failed");
+    vfree(buf);
+    ASSERT_TRUE(after->batches == batches + 1, "vfree did not batch the unmap");
+
+    PASS();
+}
+
+void test_tlb_switch_benchmark() {
+    pagedir_t *kdir = vmm_get_kerneldir();
+    pagedir_t *pdir = vmm_create_address_space();
+    ASSERT_NOT_NULL(pdir, "address space setup failed");
+
+    for (int i = 0; i < VMM_PAGES_PER_DIR; i++) pdir->table[i] = kdir->table[i];
+
+    uint32_t *buf = vmalloc(TLB_BENCH_PAGES * VMM_PAGE_SIZE);
+    if (!buf) {
+        vmm_destroy_pagedir(pdir);
+        FAIL();
+        return;
+    }
+    memset(buf, 0, TLB_BENCH_PAGES * VMM_PAGE_SIZE);
+
+    uint32_t cr4    = read_cr4();
+    uint32_t global = bench_switches(kdir, pdir, buf);
+
+    write_cr4(cr4 & ~CR4_PGE);
+    uint32_t local  = bench_switches(kdir, pdir, buf);
+    write_cr4(cr4);
+
+    vmm_switch_pagedir(kdir);
+    vfree(buf);
+    vmm_destroy_pagedir(pdir);
+
+    /* emulators do not always model the tlb, so only report the numbers */
+    printk("%u switches: global %u cycles, non-global %u cycles\n",
+           TLB_BENCH_SWITCHES, global, local);
+    PASS();
+}
@@ -0,0 +1,21 @@
+import pytest
+
+pytestmark = pytest.mark.tlb
+
+
+def assert_passed(result: str):
+    """Helper: ensure PASSED and not FAILED."""
+    assert "FAILED" not in result, f"TLB test failed: {result}"
+    assert "PASSED" in result, f"Unexpected output: {result}"
+
+
+def test_global(runner):
+    assert_passed(runner.send_serial("tlb_global"))
+
+
+def test_batch(runner):
+    assert_passed(runner.send_serial("tlb_batch"))
+
+
+def test_switch_benchmark(runner):
+    assert_passed(runner.send_serial("tlb_switch_benchmark"))
@@ -0,0 +1,129 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <mm/uaccess.h>
+#include <mm/zeropage.h>
+#include <mm/vma.h>
+#include <mm/vmm.h>
+#include <mm/pgtable.h>
+#include <mem.h>
+#include <testmain.h>
+#include "space.h"
+
+#define UACCESS_TEST_ADDR    0x40000000
+#define UACCESS_TEST_PAGES   2
+#define UACCESS_USER_FLAGS   (PTE_PRESENT | PTE_WRITABLE | PTE_USER)
+#define UACCESS_RO_FLAGS     (PTE_PRESENT | PTE_USER)
+
+// ------------ Copies in and out of mapped user memory ------------
+void test_uaccess_copy() {
+    pagedir_t *pdir = test_make_space();
+    ASSERT_NOT_NULL(pdir, "address space setup failed");
+
+    bool ok = vma_alloc_region(pdir, (void *)UACCESS_TEST_ADDR,
+                               UACCESS_TEST_PAGES * VMM_PAGE_SIZE, UACCESS_USER_FLAGS);
+    if (!ok) vmm_destroy_space(pdir);
+    ASSERT_TRUE(ok, "region allocation failed");
+
+    uint8_t out[ 301 ];
+    uint8_t in[ 301 ];
+    char    str[ 16 ];
+    for (uint32_t i = 0; i < sizeof(out); i++) out[i] = (uint8_t)(i * 7);
+    memset(in, 0, sizeof(in));
+
+    /* an odd length at an odd address exercises both the dword and byte part */
+    uint8_t *user = (uint8_t *)(UACCESS_TEST_ADDR + VMM_PAGE_SIZE - 150);
+
+    pagedir_t *saved = vmm_get_current_pagedir();
+    vmm_switch_pagedir(pdir);
+    bool to   = copy_to_user(user, out, sizeof(out)) == 0;
+    bool from = copy_from_user(in, user, sizeof(in)) == 0;
+    memcpy((void *)UACCESS_TEST_ADDR, "leanix", 7);
+    int32_t len   = strncpy_from_user(str, (const char *)UACCESS_TEST_ADDR, sizeof(str));
+    int32_t trunc = strncpy_from_user(str + 8, (const char *)UACCESS_TEST_ADDR, 3);
+    vmm_switch_pagedir(saved);
+
+    vmm_destroy_space(pdir);
+
+    ASSERT_TRUE(to && from, "copy of mapped memory failed");
+    ASSERT_TRUE(memcmp(in, out, sizeof(in)) == 0, "copied bytes differ");
+    ASSERT_TRUE(len == 6 && strcmp(str, "leanix") == 0, "string copy wrong");
+    ASSERT_TRUE(trunc == 3 && memcmp(str + 8, "lea", 3) == 0, "string not truncated");
+    PASS();
+}
+
+// ------------ Bad pointers fail without taking the kernel down ------------
+void test_uaccess_fault() {
+    pagedir_t *pdir = test_make_space();
+    ASSERT_NOT_NULL(pdir, "address space setup failed");
+
+    /* one writable page followed by a hole, and a read-only page */
+    bool ok = vma_alloc_region(pdir, (void *)UACCESS_TEST_ADDR, VMM_PAGE_SIZE,
+                               UACCESS_USER_FLAGS) &&
+              vma_alloc_region(pdir, (void *)(UACCESS_TEST_ADDR + 4 * VMM_PAGE_SIZE),
+                               VMM_PAGE_SIZE, UACCESS_RO_FLAGS);
+    if (!ok) vmm_destroy_space(pdir);
+    ASSERT_TRUE(ok, "region allocation failed");
+
+    uint8_t  buf[ 64 ];
+    uint32_t fixups   = uaccess_get_stats()->fixups;
+    uint32_t rejected = uaccess_get_stats()->rejected;
+    uint8_t *edge     = (uint8_t *)(UACCESS_TEST_ADDR + VMM_PAGE_SIZE - 8);
+
+    pagedir_t *saved = vmm_get_current_pagedir();
+    vmm_switch_pagedir(pdir);
+    memset(edge, 'x', 8);
+    bool hole    = copy_from_user(buf, edge, sizeof(buf)) == -1;
+    bool partial = buf[0] == 'x' && buf[7] == 'x';
+    bool string  = strncpy_from_user((char *)buf, (const char *)edge, sizeof(buf)) == -1;
+    bool ro      = copy_to_user((void *)(UACCESS_TEST_ADDR + 4 * VMM_PAGE_SIZE),
+                                buf, 4) == -1;
+    bool unmapped = copy_to_user((void *)(UACCESS_TEST_ADDR + 2 * VMM_PAGE_SIZE),
+                                 buf, 4) == -1;
+    vmm_switch_pagedir(saved);
+
+    bool kernel = copy_from_user(buf, (void *)KERNEL_HEAP_VIRT, 4) == -1 &&
+                  copy_to_user((void *)(PHYSMAP_BASE - 2), buf, 4) == -1 &&
+                  strncpy_from_user((char *)buf, NULL, 4) == -1;
+
+    bool caught  = uaccess_get_stats()->fixups - fixups == 4;
+    bool checked = uaccess_get_stats()->rejected - rejected == 3;
+
+    vmm_destroy_space(pdir);
+
+    ASSERT_TRUE(hole && partial, "copy across a hole not stopped");
+    ASSERT_TRUE(string, "string copy across a hole not stopped");
+    ASSERT_TRUE(ro, "copy to a read-only page succeeded");
+    ASSERT_TRUE(unmapped, "copy to an unmapped page succeeded");
+    ASSERT_TRUE(kernel && checked, "kernel pointers accepted");
+    ASSERT_TRUE(caught, "faults not recovered through the table");
+    PASS();
+}
+
+// ------------ Copies to shared pages break the sharing ------------
+void test_uaccess_cow() {
+    ASSERT_NOT_NULL(zero_page_frame(), "no zero page");
+
+    pagedir_t *pdir = test_make_space();
+    ASSERT_NOT_NULL(pdir, "address space setup failed");
+
+    bool mapped = zero_page_map(pdir, UACCESS_TEST_ADDR, UACCESS_USER_FLAGS);
+
+    pagedir_t *saved = vmm_get_current_pagedir();
+    vmm_switch_pagedir(pdir);
+    bool copied = mapped && copy_to_user((void *)UACCESS_TEST_ADDR, "abcd", 4) == 0;
+    vmm_switch_pagedir(saved);
+
+    void *frame   = vmm_get_phys_frame(pdir, (void *)UACCESS_TEST_ADDR);
+    bool private  = frame && !zero_page_is(frame);
+    bool intact   = ((uint8_t *)PHYS_TO_VIRT(zero_page_frame()))[0] == 0;
+
+    vmm_destroy_space(pdir);
+
+    ASSERT_TRUE(copied, "copy to a copy on write page failed");
+    ASSERT_TRUE(private, "copy did not break the sharing");
+    ASSERT_TRUE(intact, "zero page was written");
+    PASS();
+}
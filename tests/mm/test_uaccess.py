@@ -0,0 +1,21 @@
+import pytest
+
+pytestmark = pytest.mark.uaccess
+
+
+def assert_passed(result: str):
+    """Helper: ensure PASSED and not FAILED."""
+    assert "FAILED" not in result, f"User copy test failed: {result}"
+    assert "PASSED" in result, f"Unexpected output: {result}"
+
+
+def test_copy(runner):
+    assert_passed(runner.send_serial("uaccess_copy"))
+
+
+def test_fault(runner):
+    assert_passed(runner.send_serial("uaccess_fault"))
+
+
+def test_cow(runner):
+    assert_passed(runner.send_serial("uaccess_cow"))
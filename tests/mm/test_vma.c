@@ -0,0 +1,145 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <mm/vma.h>
+#include <mm/vmm.h>
+#include <mem.h>
+#include <testmain.h>
+#include "space.h"
+
+#define VMA_TEST_BASE   0x10000000
+#define VMA_TEST_FLAGS  (PTE_PRESENT | PTE_USER)
+#define PG              VMM_PAGE_SIZE
+
+// ---------------- Insert, lookup and removal ----------------
+void test_vma_insert_find() {
+    pagedir_t *pdir = test_make_space();
+    ASSERT_NOT_NULL(pdir, "address space setup failed");
+
+    vm_space_t *space = vma_get_space(pdir, true);
+    ASSERT_NOT_NULL(space, "space creation failed");
+    ASSERT_TRUE(vma_get_space(pdir, false) == space, "space not found again");
+
+    vm_area_t *a = vma_insert(space, VMA_TEST_BASE, 4 * PG, VMA_TEST_FLAGS,
+                              VMA_CODE, NULL, 0);
+    vm_area_t *b = vma_insert(space, VMA_TEST_BASE + 8 * PG, 2 * PG,
+                              VMA_TEST_FLAGS | PTE_WRITABLE, VMA_DATA, NULL, 0);
+    vm_area_t *c = vma_insert(space, VMA_TEST_BASE + 3 * PG, 2 * PG,
+                              VMA_TEST_FLAGS, VMA_DATA, NULL, 0);
+    vm_area_t *d = vma_insert(space, VMA_TEST_BASE + 1, PG, VMA_TEST_FLAGS,
+                              VMA_DATA, NULL, 0);
+
+    bool found = vma_find(space, VMA_TEST_BASE) == a &&
+                 vma_find(space, VMA_TEST_BASE + 4 * PG - 1) == a &&
+                 vma_find(space, VMA_TEST_BASE + 9 * PG) == b &&
+                 vma_find(space, VMA_TEST_BASE + 4 * PG) == NULL &&
+                 vma_find(space, VMA_TEST_BASE + 10 * PG) == NULL &&
+                 vma_find_next(space, VMA_TEST_BASE + 5 * PG) == b;
+
+    vma_remove(space, a);
+    bool removed = vma_find(space, VMA_TEST_BASE) == NULL &&
+                   vma_find(space, VMA_TEST_BASE + 8 * PG) == b;
+
+    vmm_destroy_space(pdir);
+    bool dropped = vma_get_space(pdir, false) == NULL;
+
+    ASSERT_TRUE(a && b, "insert failed");
+    ASSERT_TRUE(!c && !d, "overlapping or unaligned area accepted");
+    ASSERT_TRUE(found, "lookup returned the wrong area");
+    ASSERT_TRUE(removed, "removal broke the tree");
+    ASSERT_TRUE(dropped, "space outlived its page directory");
+    PASS();
+}
+
+// ---------------- Lookups stay correct with many areas ----------------
+void test_vma_many() {
+    pagedir_t *pdir = test_make_space();
+    ASSERT_NOT_NULL(pdir, "address space setup failed");
+    vm_space_t *space = vma_get_space(pdir, true);
+
+    /* insert in a scrambled order, one page areas with one page gaps */
+    const uint32_t n = 256;
+    bool inserted = true;
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t k = (i * 97) % n;
+        if (!vma_insert(space, VMA_TEST_BASE + 2 * k * PG, PG, VMA_TEST_FLAGS,
+                        VMA_MMAP, NULL, k)) {
+            inserted = false;
+        }
+    }
+
+    bool found = true;
+    for (uint32_t k = 0; k < n; k++) {
+        vm_area_t *area = vma_find(space, VMA_TEST_BASE + 2 * k * PG + 16);
+        if (!area || area->offset != k) found = false;
+        if (vma_find(space, VMA_TEST_BASE + (2 * k + 1) * PG)) found = false;
+    }
+
+    size_t size = rb_size(&space->areas);
+    vmm_destroy_space(pdir);
+
+    ASSERT_TRUE(inserted, "insert failed");
+    ASSERT_EQ(size, n, "wrong number of areas");
+    ASSERT_TRUE(found, "lookup returned the wrong area");
+    PASS();
+}
+
+// ---------------- Loader and stack regions are recorded ----------------
+void test_vma_alloc_region() {
+    pagedir_t *pdir = test_make_space();
+    ASSERT_NOT_NULL(pdir, "address space setup failed");
+
+    /* a text and a data segment sharing their boundary page */
+    bool ok = vma_alloc_region(pdir, (void *)VMA_TEST_BASE, 2 * PG + 100,
+                               VMA_TEST_FLAGS) &&
+              vma_alloc_region(pdir, (void *)(VMA_TEST_BASE + 2 * PG + 200), 2 * PG,
+                               VMA_TEST_FLAGS | PTE_WRITABLE) &&
+              vma_alloc_region(pdir, (void *)USER_STACK_TOP, USER_STACK_SIZE,
+                               VMA_TEST_FLAGS | PTE_WRITABLE);
+
+    vm_space_t *space = vma_get_space(pdir, false);
+    vm_area_t *text  = vma_find(space, VMA_TEST_BASE + 2 * PG);
+    vm_area_t *data  = vma_find(space, VMA_TEST_BASE + 3 * PG);
+    vm_area_t *stack = vma_find(space, USER_STACK_LIMIT);
+
+    bool kinds = text && (text->flags & VMA_CODE) &&
+                 data && (data->flags & VMA_DATA) && data->start == text->end &&
+                 stack && (stack->flags & VMA_STACK) &&
+                 (stack->flags & VMA_GROWSDOWN) &&
+                 stack->end == USER_STACK_TOP + USER_STACK_SIZE;
+
+    vmm_destroy_space(pdir);
+
+    ASSERT_TRUE(ok, "region allocation failed");
+    ASSERT_TRUE(kinds, "areas not recorded with their kind");
+    PASS();
+}
+
+// ---------------- Areas are carried through a clone ----------------
+void test_vma_clone() {
+    pagedir_t *parent = test_make_space();
+    pagedir_t *child  = test_make_space();
+    ASSERT_TRUE(parent && child, "address space setup failed");
+
+    vm_space_t *space = vma_get_space(parent, true);
+    vma_insert(space, VMA_TEST_BASE, 4 * PG, VMA_TEST_FLAGS, VMA_CODE, NULL, 0);
+    vma_insert(space, VMA_TEST_BASE + 16 * PG, PG, VMA_TEST_FLAGS, VMA_HEAP,
+               NULL, 0);
+
+    int32_t rc = vma_clone_space(parent, child);
+    vm_space_t *copy = vma_get_space(child, false);
+    vm_area_t *heap = vma_find(copy, VMA_TEST_BASE + 16 * PG);
+
+    bool same = copy && copy != space && rb_size(&copy->areas) == 2 &&
+                heap && (heap->flags & VMA_HEAP) &&
+                heap != vma_find(space, VMA_TEST_BASE + 16 * PG);
+
+    vmm_destroy_space(child);
+    vmm_destroy_space(parent);
+
+    ASSERT_EQ(rc, 0, "clone failed");
+    ASSERT_TRUE(same, "areas not copied");
+    PASS();
+}
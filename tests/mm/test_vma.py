@@ -0,0 +1,25 @@
+import pytest
+
+pytestmark = pytest.mark.vma
+
+
+def assert_passed(result: str):
+    """Helper: ensure PASSED and not FAILED."""
+    assert "FAILED" not in result, f"VMA tree failed: {result}"
+    assert "PASSED" in result, f"Unexpected output: {result}"
+
+
+def test_insert_find(runner):
+    assert_passed(runner.send_serial("vma_insert_find"))
+
+
+def test_many(runner):
+    assert_passed(runner.send_serial("vma_many"))
+
+
+def test_alloc_region(runner):
+    assert_passed(runner.send_serial("vma_alloc_region"))
+
+
+def test_clone(runner):
+    assert_passed(runner.send_serial("vma_clone"))
@@ -0,0 +1,87 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <mm/vmalloc.h>
+#include <mm/kmm.h>
+#include <mem.h>
+#include <testmain.h>
+
+// ---------------- Allocation ----------------
+void test_vmalloc_basic() {
+    uint8_t *buf = vmalloc(3 * 4096 + 1);
+    ASSERT_NOT_NULL(buf, "vmalloc failed");
+    ASSERT_TRUE(((uintptr_t)buf & 0xFFF) == 0, "buffer not page aligned");
+    ASSERT_TRUE((uintptr_t)buf >= VMALLOC_START &&
+                (uintptr_t)buf < VMALLOC_END, "buffer outside vmalloc range");
+
+    /* every page must be mapped and writable */
+    memset(buf, 0xA5, 4 * 4096);
+    ASSERT_TRUE(buf[0] == 0xA5 && buf[4 * 4096 - 1] == 0xA5, "data lost");
+
+    vfree(buf);
+    PASS();
+}
+
+void test_vmalloc_find() {
+    uint8_t *buf = vmalloc(2 * 4096);
+    ASSERT_NOT_NULL(buf, "vmalloc failed");
+
+    vm_region_t *r = vmalloc_find(buf + 4096 + 17);
+    ASSERT_NOT_NULL(r, "region not found from inner address");
+    ASSERT_EQ(r->start, (uintptr_t)buf, "wrong region found");
+    ASSERT_EQ(r->size, 2 * 4096, "wrong region size");
+    ASSERT_NULL(vmalloc_find(buf + 2 * 4096), "guard page reported as mapped");
+
+    vfree(buf);
+    ASSERT_NULL(vmalloc_find(buf), "freed region still tracked");
+    PASS();
+}
+
+void test_vmalloc_no_overlap() {
+    uint8_t *a = vmalloc(4096);
+    uint8_t *b = vmalloc(5 * 4096);
+    uint8_t *c = vmalloc(4096);
+    ASSERT_TRUE(a && b && c, "vmalloc failed");
+
+    memset(a, 1, 4096);
+    memset(b, 2, 5 * 4096);
+    memset(c, 3, 4096);
+    ASSERT_TRUE(a[4095] == 1 && b[0] == 2 && b[5 * 4096 - 1] == 2 && c[0] == 3,
+                "regions overlap");
+
+    /* the hole left by b must be reused by an allocation that fits */
+    vfree(b);
+    uint8_t *d = vmalloc(2 * 4096);
+    ASSERT_TRUE(d == b, "freed hole not reused");
+
+    vfree(a); vfree(c); vfree(d);
+    PASS();
+}
+
+void test_vmalloc_frees_frames() {
+    /* warm up the region descriptor cache so it does not skew the count */
+    vfree(vmalloc(4096));
+    uint32_t used = kmm_get_used_frames();
+
+    void *buf = vmalloc(16 * 4096);
+    ASSERT_NOT_NULL(buf, "vmalloc failed");
+    ASSERT_TRUE(kmm_get_used_frames() >= used + 16, "frames not allocated");
+
+    vfree(buf);
+    ASSERT_EQ(kmm_get_used_frames(), used, "frames not released");
+    PASS();
+}
+
+void test_vmalloc_invalid_free() {
+    uint8_t *buf = vmalloc(2 * 4096);
+    ASSERT_NOT_NULL(buf, "vmalloc failed");
+
+    vfree(buf + 4096);          /* not the start of the region, ignored */
+    ASSERT_NOT_NULL(vmalloc_find(buf), "interior vfree released region");
+    vfree(NULL);
+
+    vfree(buf);
+    PASS();
+}
@@ -0,0 +1,29 @@
+import pytest
+
+pytestmark = pytest.mark.vmalloc
+
+
+def assert_passed(result: str):
+    """Helper: ensure PASSED and not FAILED."""
+    assert "FAILED" not in result, f"vmalloc failed: {result}"
+    assert "PASSED" in result, f"Unexpected output: {result}"
+
+
+def test_vmalloc_basic(runner):
+    assert_passed(runner.send_serial("vmalloc_basic"))
+
+
+def test_vmalloc_find(runner):
+    assert_passed(runner.send_serial("vmalloc_find"))
+
+
+def test_vmalloc_no_overlap(runner):
+    assert_passed(runner.send_serial("vmalloc_no_overlap"))
+
+
+def test_vmalloc_frees_frames(runner):
+    assert_passed(runner.send_serial("vmalloc_frees_frames"))
+
+
+def test_vmalloc_invalid_free(runner):
+    assert_passed(runner.send_serial("vmalloc_invalid_free"))
@@ -0,0 +1,110 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <mm/zeropage.h>
+#include <mm/cow.h>
+#include <mm/vma.h>
+#include <mm/vmm.h>
+#include <mm/kmm.h>
+#include <mm/frame.h>
+#include <mm/pgtable.h>
+#include <mem.h>
+#include <testmain.h>
+#include "space.h"
+
+#define ZERO_TEST_ADDR    0x40000000
+#define ZERO_TEST_PAGES   4
+#define ZERO_USER_FLAGS   (PTE_PRESENT | PTE_WRITABLE | PTE_USER)
+
+static bool maps_zero(pagedir_t *pdir, uintptr_t addr) {
+    pte_t *pte = pgtable_get_pte(pdir, (void *)addr);
+    return pte && PTE_IS_PRESENT(*pte) && zero_page_is((void *)PTE_FRAME_ADDR(*pte));
+}
+
+static bool zero_intact(void) {
+    uint32_t *zero = PHYS_TO_VIRT(zero_page_frame());
+    for (uint32_t i = 0; i < VMM_PAGE_SIZE / sizeof(uint32_t); i++) {
+        if (zero[i]) return false;
+    }
+    return true;
+}
+
+// ------------ A write copies the zero page off ------------
+void test_zeropage_cow() {
+    ASSERT_NOT_NULL(zero_page_frame(), "no zero page");
+
+    pagedir_t *pdir = test_make_space();
+    ASSERT_NOT_NULL(pdir, "address space setup failed");
+
+    bool mapped = zero_page_map(pdir, ZERO_TEST_ADDR, ZERO_USER_FLAGS) &&
+                  zero_page_map(pdir, ZERO_TEST_ADDR + VMM_PAGE_SIZE, ZERO_USER_FLAGS);
+    pte_t *pte  = pgtable_get_pte(pdir, (void *)ZERO_TEST_ADDR);
+    bool cow    = pte && (*pte & PTE_COW) && !PTE_IS_WRITABLE(*pte);
+    bool pinned = frame_refcount(zero_page_frame()) > 1;
+
+    /* CR0.WP is set, the kernel's first write faults into copy on write */
+    uint32_t copies = cow_get_stats()->zero_copies;
+    pagedir_t *saved = vmm_get_current_pagedir();
+    vmm_switch_pagedir(pdir);
+    volatile uint32_t *page = (uint32_t *)ZERO_TEST_ADDR;
+    bool zeroed = page[0] == 0 && page[VMM_PAGE_SIZE / 4 - 1] == 0;
+    if (mapped) page[0] = 0xDEADBEEF;
+    vmm_switch_pagedir(saved);
+
+    bool own  = mapped && !maps_zero(pdir, ZERO_TEST_ADDR) &&
+                cow_get_stats()->zero_copies == copies + 1;
+    bool kept = maps_zero(pdir, ZERO_TEST_ADDR + VMM_PAGE_SIZE);
+
+    vmm_destroy_space(pdir);
+
+    ASSERT_TRUE(mapped && cow, "zero page not mapped copy on write");
+    ASSERT_TRUE(pinned, "zero page looks privately owned");
+    ASSERT_TRUE(own && zeroed, "write did not get a zeroed frame");
+    ASSERT_TRUE(kept, "other page lost the zero page");
+    ASSERT_TRUE(zero_intact() && zero_page_frame(), "zero page was written");
+    PASS();
+}
+
+// ------------ Zeroing whole pages maps the zero page ------------
+void test_zeropage_fill() {
+    pagedir_t *pdir = test_make_space();
+    ASSERT_NOT_NULL(pdir, "address space setup failed");
+
+    bool ok = vma_alloc_region(pdir, (void *)ZERO_TEST_ADDR,
+                               ZERO_TEST_PAGES * VMM_PAGE_SIZE, ZERO_USER_FLAGS);
+    if (!ok) vmm_destroy_space(pdir);
+    ASSERT_TRUE(ok, "region allocation failed");
+
+    uint32_t bss  = zero_page_get_stats()->bss_pages;
+    uint32_t used = kmm_get_used_frames();
+
+    /* like a .bss that starts inside the first page and ends in the last */
+    pagedir_t *saved = vmm_get_current_pagedir();
+    vmm_switch_pagedir(pdir);
+    memset((void *)ZERO_TEST_ADDR, 0x55, ZERO_TEST_PAGES * VMM_PAGE_SIZE);
+    zero_page_fill((void *)(ZERO_TEST_ADDR + 100), 0,
+                   (ZERO_TEST_PAGES - 1) * VMM_PAGE_SIZE);
+    volatile uint8_t *mem = (uint8_t *)ZERO_TEST_ADDR;
+    bool head  = mem[99] == 0x55 && mem[100] == 0;
+    bool tail  = mem[(ZERO_TEST_PAGES - 1) * VMM_PAGE_SIZE + 99] == 0 &&
+                 mem[(ZERO_TEST_PAGES - 1) * VMM_PAGE_SIZE + 100] == 0x55;
+    bool inner = mem[VMM_PAGE_SIZE] == 0 && mem[3 * VMM_PAGE_SIZE - 1] == 0;
+    vmm_switch_pagedir(saved);
+
+    bool shared = !maps_zero(pdir, ZERO_TEST_ADDR) &&
+                  maps_zero(pdir, ZERO_TEST_ADDR + VMM_PAGE_SIZE) &&
+                  maps_zero(pdir, ZERO_TEST_ADDR + 2 * VMM_PAGE_SIZE) &&
+                  !maps_zero(pdir, ZERO_TEST_ADDR + 3 * VMM_PAGE_SIZE);
+    bool counted = zero_page_get_stats()->bss_pages == bss + 2;
+    bool freed   = used - kmm_get_used_frames() == 2;
+
+    vmm_destroy_space(pdir);
+
+    ASSERT_TRUE(head && tail && inner, "wrong bytes zeroed");
+    ASSERT_TRUE(shared && counted, "whole pages not mapped to the zero page");
+    ASSERT_TRUE(freed, "replaced frames not freed");
+    ASSERT_TRUE(zero_intact(), "zero page was written");
+    PASS();
+}
@@ -0,0 +1,17 @@
+import pytest
+
+pytestmark = pytest.mark.zeropage
+
+
+def assert_passed(result: str):
+    """Helper: ensure PASSED and not FAILED."""
+    assert "FAILED" not in result, f"Zero page test failed: {result}"
+    assert "PASSED" in result, f"Unexpected output: {result}"
+
+
+def test_cow(runner):
+    assert_passed(runner.send_serial("zeropage_cow"))
+
+
+def test_fill(runner):
+    assert_passed(runner.send_serial("zeropage_fill"))
@@ -37,6 +37,110 @@ extern void test_kheap_random_stress(void);
 extern void test_kheap_realloc_integrity(void);
 extern void test_kheap_buddy_multilevel(void);
 extern void test_kheap_buddy_symmetry(void);
+extern void test_kheap_grow_on_demand(void);
+extern void test_kheap_pages(void);
+extern void test_kheap_kvrealloc(void);
+
+// ----------------- SLAB (object caches) tests -----------------
+extern void test_slab_create_destroy(void);
+extern void test_slab_create_too_large(void);
+extern void test_slab_alloc_free_reuse(void);
+extern void test_slab_alignment(void);
+extern void test_slab_ctor(void);
+extern void test_slab_multi_slab(void);
+extern void test_slab_shrink_returns_frames(void);
+extern void test_slab_destroy_busy(void);
+extern void test_slab_invalid_free(void);
+extern void test_slab_cache_of(void);
+
+// ----------------- VMALLOC (large kernel buffers) tests -----------------
+extern void test_vmalloc_basic(void);
+extern void test_vmalloc_find(void);
+extern void test_vmalloc_no_overlap(void);
+extern void test_vmalloc_frees_frames(void);
+extern void test_vmalloc_invalid_free(void);
+
+// ----------------- SHRINKER (memory pressure) tests -----------------
+extern void test_shrinker_low_watermark(void);
+extern void test_shrinker_noheap(void);
+extern void test_shrinker_slab(void);
+extern void test_shrinker_vmm(void);
+
+// ----------------- COW (copy on write fork) tests -----------------
+extern void test_cow_clone_shares(void);
+extern void test_cow_write_fault(void);
+extern void test_cow_load_readonly(void);
+extern void test_cow_fork_benchmark(void);
+
+// ----------------- VMA (address space areas) tests -----------------
+extern void test_vma_insert_find(void);
+extern void test_vma_many(void);
+extern void test_vma_alloc_region(void);
+extern void test_vma_clone(void);
+
+// ----------------- DEMAND (demand paging) tests -----------------
+extern void test_demand_reserve_lazy(void);
+extern void test_demand_stack_growth(void);
+extern void test_demand_reserve_invalid(void);
+extern void test_demand_mmap(void);
+
+// ----------------- TLB (global pages, batched flushes) tests -----------------
+extern void test_tlb_global(void);
+extern void test_tlb_batch(void);
+extern void test_tlb_switch_benchmark(void);
+
+// ----------------- PSE (4MB pages) tests -----------------
+extern void test_pse_physmap(void);
+extern void test_pse_benchmark(void);
+
+// ----------------- HUGEPAGE (4MB user pages) tests -----------------
+extern void test_hugepage_alloc(void);
+extern void test_hugepage_split(void);
+extern void test_hugepage_fallback(void);
+
+// ----------------- FIXMAP (recursive mapping, fixmap) tests -----------------
+extern void test_fixmap_recursive(void);
+extern void test_fixmap_slots(void);
+
+// ----------------- SWAP (page reclaim to a block device) tests -----------------
+extern void test_swap_roundtrip(void);
+extern void test_swap_release(void);
+extern void test_swap_swappiness(void);
+
+// ----------------- SHM (shared memory segments) tests -----------------
+extern void test_shm_attach(void);
+extern void test_shm_detach(void);
+extern void test_shm_remove(void);
+extern void test_shm_owner(void);
+
+// ----------------- ZEROPAGE (shared zero page) tests -----------------
+extern void test_zeropage_cow(void);
+extern void test_zeropage_fill(void);
+
+// ----------------- KSM (same page merging) tests -----------------
+extern void test_ksm_merge(void);
+extern void test_ksm_zero(void);
+
+// ----------------- User copy tests -----------------
+extern void test_uaccess_copy(void);
+extern void test_uaccess_fault(void);
+extern void test_uaccess_cow(void);
+
+// ----------------- Page fault profiling tests -----------------
+extern void test_pgfault_counts(void);
+extern void test_pgfault_trace(void);
+
+// ----------------- High memory tests -----------------
+extern void test_highmem_pde(void);
+extern void test_highmem_kmap_nest(void);
+extern void test_highmem_chunk(void);
+extern void test_highmem_hugepage(void);
+
+// ----------------- Kernel stack tests -----------------
+extern void test_kstack_guard(void);
+extern void test_kstack_recycle(void);
+extern void test_kstack_thread(void);
+extern void test_kstack_df_gate(void);
 
 // ----------------- VMM (virtual memory manager) tests -----------------
 extern void test_vmm_init(void); // test 8
@@ -0,0 +1,104 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <proc/procmem.h>
+#include <proc/process.h>
+#include <proc/pobj.h>
+#include <mm/demand.h>
+#include <mm/pgtable.h>
+#include <mm/vma.h>
+#include <mm/vmm.h>
+#include <mm/kheap.h>
+#include <mem.h>
+#include <testmain.h>
+#include "../mm/space.h"
+
+#define PROCMEM_TEST_ADDR    0x40000000
+#define PROCMEM_DEMAND_ADDR  0x48000000
+#define PROCMEM_TEST_PAGES   4
+#define PROCMEM_USER_FLAGS   (PTE_PRESENT | PTE_WRITABLE | PTE_USER)
+
+// ------------ Resident pages follow mapping and unmapping ------------
+void test_procmem_rss() {
+    pagedir_t *pdir = test_make_space();
+    ASSERT_NOT_NULL(pdir, "address space setup failed");
+
+    bool ok = vma_alloc_region(pdir, (void *)PROCMEM_TEST_ADDR,
+                               PROCMEM_TEST_PAGES * VMM_PAGE_SIZE, PROCMEM_USER_FLAGS) &&
+              vmm_reserve_region(pdir, (void *)PROCMEM_DEMAND_ADDR,
+                                 PROCMEM_TEST_PAGES * VMM_PAGE_SIZE, PROCMEM_USER_FLAGS);
+    if (!ok) vmm_destroy_space(pdir);
+    ASSERT_TRUE(ok, "region setup failed");
+
+    const vm_usage_t *usage = vma_get_usage(pdir);
+    uint32_t allocated = usage->rss;
+
+    /* two first touches of the reservation */
+    pagedir_t *saved = vmm_get_current_pagedir();
+    vmm_switch_pagedir(pdir);
+    *(volatile uint32_t *)PROCMEM_DEMAND_ADDR = 1;
+    *(volatile uint32_t *)(PROCMEM_DEMAND_ADDR + VMM_PAGE_SIZE) = 2;
+    vmm_switch_pagedir(saved);
+    uint32_t touched = usage->rss;
+
+    /* the two regions lie under two page tables */
+    uint32_t tables = usage->pgtables;
+
+    pgtable_unmap_range(pdir, PROCMEM_TEST_ADDR, 2 * VMM_PAGE_SIZE);
+    uint32_t unmapped = usage->rss;
+    bool objects = usage->kobjects >= sizeof(vm_space_t) + 2 * sizeof(vm_area_t);
+
+    vmm_destroy_space(pdir);
+
+    ASSERT_EQ(allocated, PROCMEM_TEST_PAGES, "allocated pages not charged");
+    ASSERT_EQ(touched, PROCMEM_TEST_PAGES + 2, "demand pages not charged");
+    ASSERT_EQ(unmapped, PROCMEM_TEST_PAGES, "unmapped pages still charged");
+    ASSERT_EQ(tables, 2, "page tables not charged");
+    ASSERT_TRUE(objects, "area descriptors not charged");
+    PASS();
+}
+
+// ------------ A process is charged for its stacks and objects ------------
+void test_procmem_process() {
+    /* allocated the way the process code allocates it */
+    process_t *proc = pobj_process_alloc();
+    ASSERT_NOT_NULL(proc, "allocation failed for process");
+
+    process_create(proc, "memhog", PROCESS_PRI_DEFAULT);
+
+    proc_mem_t mem, grown, shrunk;
+    bool got     = procmem_get(proc, &mem) == 0;
+    bool named   = got && mem.pid == proc->pid && strcmp(mem.name, "memhog") == 0;
+    bool stacks  = got && mem.kstack >= KSTACK_SIZE;
+    bool objects = got && mem.kheap >= sizeof(process_t) + sizeof(thread_t);
+
+    /* a second thread is charged when it is made and given back when it
+        is destroyed */
+    thread_t *thread = thread_create(proc, NULL, NULL);
+    bool more = thread && procmem_get(proc, &grown) == 0 &&
+                grown.kstack == mem.kstack + thread->kstack_size &&
+                grown.kheap > mem.kheap;
+    bool back = thread && thread_destroy(thread) == 0 &&
+                procmem_get(proc, &shrunk) == 0 &&
+                shrunk.kstack == mem.kstack && shrunk.kheap == mem.kheap;
+
+    bool past    = procmem_get_nth(0xFFFF, &mem) == -1;
+    bool null    = procmem_get(NULL, &mem) == -1;
+
+    /* the threads go with the process, the object itself is freed last */
+    process_destroy(proc);
+    bool dropped = procmem_get(proc, &mem) == 0 && mem.kstack == 0 &&
+                   mem.kheap == sizeof(process_t);
+    pobj_free(proc);
+
+    ASSERT_TRUE(named, "process not identified");
+    ASSERT_TRUE(stacks, "kernel stack not reported");
+    ASSERT_TRUE(objects, "kernel objects not reported");
+    ASSERT_TRUE(more, "new thread not charged");
+    ASSERT_TRUE(back, "destroyed thread still charged");
+    ASSERT_TRUE(past && null, "bad lookups succeeded");
+    ASSERT_TRUE(dropped, "thread charges kept after the process was destroyed");
+    PASS();
+}
@@ -0,0 +1,17 @@
+import pytest
+
+pytestmark = pytest.mark.procmem
+
+
+def assert_passed(result: str):
+    """Helper: ensure PASSED and not FAILED."""
+    assert "FAILED" not in result, f"Process memory test failed: {result}"
+    assert "PASSED" in result, f"Unexpected output: {result}"
+
+
+def test_rss(runner):
+    assert_passed(runner.send_serial("procmem_rss"))
+
+
+def test_process(runner):
+    assert_passed(runner.send_serial("procmem_process"))
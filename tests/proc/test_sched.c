@@ -0,0 +1,423 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <proc/process.h>
+#include <proc/sched.h>
+#include <mm/kheap.h>
+#include <utils.h>
+#include <testmain.h>
+
+#define SCHED_TEST_PROCS  3
+
+static const int32_t test_prios[SCHED_TEST_PROCS] = { 3, 9, 5 };
+
+// ------------ Ready priorities show up in the bitmap ------------
+void test_sched_bitmap() {
+    process_t *procs[SCHED_TEST_PROCS];
+    const char *class = sched_get_class();
+
+    /* the bitmap belongs to the priority class */
+    sched_set_class("prio");
+
+    for (int i = 0; i < SCHED_TEST_PROCS; i++) {
+        procs[i] = malloc(sizeof(process_t));
+        ASSERT_NOT_NULL(procs[i], "malloc failed for process");
+        process_create(procs[i], "sched", test_prios[i]);
+    }
+
+    /* the threads have nothing to run, they must not be picked meanwhile */
+    cli();
+
+    uint32_t before = sched_ready_bitmap();
+    uint32_t ready  = sched_nr_running();
+
+    for (int i = 0; i < SCHED_TEST_PROCS; i++) {
+        scheduler_post(_get_main_thread(procs[i]));
+    }
+
+    uint32_t bitmap = sched_ready_bitmap();
+    bool counted    = sched_nr_running() == ready + SCHED_TEST_PROCS;
+
+    /* the lowest set bit is the highest ready priority */
+    bool highest = (before & (SCHED_PRIO_BIT(9) - 1)) ||
+                   __builtin_ctz(bitmap) == PROCESS_PRI_MAX - 9;
+
+    for (int i = 0; i < SCHED_TEST_PROCS; i++) {
+        sched_dequeue(_get_main_thread(procs[i]));
+    }
+
+    uint32_t after = sched_ready_bitmap();
+    bool drained   = sched_nr_running() == ready;
+
+    sti();
+
+    sched_set_class(class);
+
+    for (int i = 0; i < SCHED_TEST_PROCS; i++) {
+        process_destroy(procs[i]);
+        free(procs[i]);
+    }
+
+    for (int i = 0; i < SCHED_TEST_PROCS; i++) {
+        ASSERT_TRUE(bitmap & SCHED_PRIO_BIT(test_prios[i]), "ready priority not in the bitmap");
+    }
+    ASSERT_TRUE(counted, "run queue length not tracked");
+    ASSERT_TRUE(highest, "bitmap order wrong");
+    ASSERT_EQ(after, before, "bitmap not cleared on dequeue");
+    ASSERT_TRUE(drained, "run queue length not restored");
+    PASS();
+}
+
+// ------------ Scheduler state stays off the kernel stack ------------
+void test_sched_data() {
+    process_t *proc = malloc(sizeof(process_t));
+    ASSERT_NOT_NULL(proc, "malloc failed for process");
+    process_create(proc, "sched", PROCESS_PRI_DEFAULT);
+
+    thread_t *thread = _get_main_thread(proc);
+    uint8_t  *stack  = thread->esp0_start;
+
+    cli();
+
+    bool unowned = sched_thread_owner(thread) == NULL;
+    uint8_t *data = sched_thread_data(thread, &sched_mlfq_class);
+    memset(data, 0xA5, SCHED_DATA_SIZE - sizeof(void *));
+
+    bool outside = data + SCHED_DATA_SIZE <= stack ||
+                   data >= stack + thread->kstack_size;
+    bool owned   = sched_thread_owner(thread) == &sched_mlfq_class;
+
+    bool clean = true;
+    for (uint32_t i = 0; i < SCHED_DATA_SIZE; i++) {
+        clean &= stack[i] == 0;
+    }
+
+    sched_thread_data(thread, NULL);
+    sti();
+
+    process_destroy(proc);
+    free(proc);
+
+    ASSERT_TRUE(unowned, "new thread has an owner class");
+    ASSERT_TRUE(outside, "scheduler bytes on the kernel stack");
+    ASSERT_TRUE(owned, "owner class not recorded");
+    ASSERT_TRUE(clean, "stack bottom written");
+    PASS();
+}
+
+// ------------ Fair class shares the cpu by weight ------------
+static volatile uint32_t fair_counts[2];
+static volatile bool     fair_stop;
+
+static void fair_worker(volatile uint32_t *count) {
+    while (!fair_stop) {
+        (*count)++;
+    }
+
+    /* take ourselves off the cpu, the next tick does not post us back */
+    get_current_thread()->state = STATE_BLOCKED;
+    while (1) {}
+}
+
+static void fair_worker_low(void)  { fair_worker(&fair_counts[0]); }
+static void fair_worker_high(void) { fair_worker(&fair_counts[1]); }
+
+void test_sched_fair() {
+    const char *class = sched_get_class();
+    void (*entries[2])(void) = { fair_worker_low, fair_worker_high };
+    const int32_t prios[2]   = { 2, 8 };
+    process_t *procs[2];
+
+    ASSERT_EQ(sched_set_class("nosuch"), -1, "unknown class selected");
+    ASSERT_EQ(sched_set_class("fair"), 0, "fair class not found");
+
+    fair_counts[0] = fair_counts[1] = 0;
+    fair_stop = false;
+
+    for (int i = 0; i < 2; i++) {
+        procs[i] = malloc(sizeof(process_t));
+        ASSERT_NOT_NULL(procs[i], "malloc failed for process");
+        process_create(procs[i], "fair", prios[i]);
+        _get_main_thread(procs[i])->trap_frame->eip = (uint32_t) entries[i];
+    }
+
+    cli();
+    for (int i = 0; i < 2; i++) {
+        scheduler_post(_get_main_thread(procs[i]));
+    }
+    sti();
+
+    for (volatile int i = 0; i < 0x3FFFFFF; i++) {
+        /* busy wait */
+    }
+
+    fair_stop = true;
+
+    for (volatile int i = 0; i < 0xFFFFFF; i++) {
+        /* let both threads block */
+    }
+
+    uint32_t low  = fair_counts[0];
+    uint32_t high = fair_counts[1];
+
+    sched_set_class(class);
+
+    for (int i = 0; i < 2; i++) {
+        process_destroy(procs[i]);
+        free(procs[i]);
+    }
+
+    ASSERT_TRUE(low > 0, "low priority thread starved");
+    ASSERT_TRUE(high > low, "higher weight did not get more cpu");
+    PASS();
+}
+
+// ------------ MLFQ moves hogs down and keeps sleepers on top ------------
+static volatile uint32_t mlfq_hog_count;
+static volatile uint32_t mlfq_sleeper_runs;
+static volatile bool     mlfq_stop;
+
+static void mlfq_hog(void) {
+    while (!mlfq_stop) {
+        mlfq_hog_count++;
+    }
+
+    get_current_thread()->state = STATE_BLOCKED;
+    while (1) {}
+}
+
+/* runs a moment and then waits, like a thread reading the keyboard */
+static void mlfq_sleeper(void) {
+    thread_t *self = get_current_thread();
+
+    while (!mlfq_stop) {
+        mlfq_sleeper_runs++;
+        self->state = STATE_BLOCKED;
+        while (self->state != STATE_RUNNING) {
+            asm volatile ("" ::: "memory");
+        }
+    }
+
+    self->state = STATE_BLOCKED;
+    while (1) {}
+}
+
+void test_sched_mlfq() {
+    const char *class = sched_get_class();
+    void (*entries[2])(void) = { mlfq_hog, mlfq_sleeper };
+    process_t *procs[2];
+
+    ASSERT_EQ(sched_set_class("mlfq"), 0, "mlfq class not found");
+
+    uint32_t demotions = sched_mlfq_get_stats()->demotions;
+    mlfq_hog_count = mlfq_sleeper_runs = 0;
+    mlfq_stop = false;
+
+    for (int i = 0; i < 2; i++) {
+        procs[i] = malloc(sizeof(process_t));
+        ASSERT_NOT_NULL(procs[i], "malloc failed for process");
+        process_create(procs[i], "mlfq", PROCESS_PRI_DEFAULT);
+        _get_main_thread(procs[i])->trap_frame->eip = (uint32_t) entries[i];
+    }
+
+    thread_t *hog     = _get_main_thread(procs[0]);
+    thread_t *sleeper = _get_main_thread(procs[1]);
+
+    cli();
+    scheduler_post(hog);
+    scheduler_post(sleeper);
+    sti();
+
+    /* wake the sleeper now and then, as a key press would */
+    for (volatile int i = 0; i < 0x3FFFFFF; i++) {
+        if ((i & 0xFFFFF) == 0) {
+            sched_wake(sleeper);
+        }
+    }
+
+    uint32_t sleeper_level = sched_mlfq_level(sleeper);
+    uint32_t demoted       = sched_mlfq_get_stats()->demotions - demotions;
+
+    mlfq_stop = true;
+    sched_wake(sleeper);
+
+    for (volatile int i = 0; i < 0xFFFFFF; i++) {
+        /* let both threads block */
+    }
+
+    uint32_t hog_count = mlfq_hog_count;
+    uint32_t runs      = mlfq_sleeper_runs;
+
+    sched_set_class(class);
+
+    for (int i = 0; i < 2; i++) {
+        process_destroy(procs[i]);
+        free(procs[i]);
+    }
+
+    ASSERT_TRUE(hog_count > 0, "hog never ran");
+    ASSERT_TRUE(runs > 1, "sleeper not woken");
+    ASSERT_TRUE(demoted > 0, "hog not demoted for using up its slices");
+    ASSERT_EQ(sleeper_level, 0, "sleeper moved off the top level");
+    PASS();
+}
+
+// ------------ The mlfq boost counts every tick, not just its own ------------
+void test_sched_mlfq_boost() {
+    const char *class = sched_get_class();
+    ASSERT_EQ(sched_set_class("mlfq"), 0, "mlfq class not found");
+
+    /* the clock runs on every tick, even one that finds nothing to run */
+    cli();
+    uint32_t boosts = sched_mlfq_get_stats()->boosts;
+    for (uint32_t i = 0; i < SCHED_MLFQ_BOOST_TICKS; i++) {
+        sched_mlfq_class.clock(sched_clock());
+    }
+    uint32_t boosted = sched_mlfq_get_stats()->boosts - boosts;
+    sti();
+
+    sched_set_class(class);
+
+    ASSERT_EQ(boosted, 1, "boost not driven by the clock");
+    PASS();
+}
+
+// ------------ Deadline class admits, runs and throttles reservations ------------
+static volatile uint32_t dl_counts[2];
+static volatile bool     dl_stop;
+
+static void dl_worker(volatile uint32_t *count) {
+    while (!dl_stop) {
+        (*count)++;
+    }
+
+    get_current_thread()->state = STATE_BLOCKED;
+    while (1) {}
+}
+
+static void dl_worker_a(void) { dl_worker(&dl_counts[0]); }
+static void dl_worker_b(void) { dl_worker(&dl_counts[1]); }
+
+void test_sched_dl() {
+    void (*entries[3])(void) = { dl_worker_a, dl_worker_b, dl_worker_a };
+    process_t *procs[3];
+    thread_t *threads[3];
+
+    for (int i = 0; i < 3; i++) {
+        procs[i] = malloc(sizeof(process_t));
+        ASSERT_NOT_NULL(procs[i], "malloc failed for process");
+        process_create(procs[i], "dl", PROCESS_PRI_DEFAULT);
+        threads[i] = _get_main_thread(procs[i]);
+        threads[i]->trap_frame->eip = (uint32_t) entries[i];
+    }
+
+    uint32_t bandwidth = sched_dl_bandwidth();
+    uint32_t throttles = sched_get_stats()->dl_throttles;
+    dl_counts[0] = dl_counts[1] = 0;
+    dl_stop = false;
+
+    /* 40% and 50% fit, another 10% would overload the cpu */
+    ASSERT_EQ(sched_set_deadline(threads[0], 40000, 100000, 0), 0, "reservation refused");
+    ASSERT_EQ(sched_set_deadline(threads[1], 50000, 100000, 100000), 0, "reservation refused");
+    ASSERT_EQ(sched_set_deadline(threads[2], 10000, 100000, 0), -1, "overload admitted");
+    ASSERT_EQ(sched_set_deadline(threads[2], 20000, 10000, 0), -1, "runtime above period admitted");
+
+    cli();
+    scheduler_post(threads[0]);
+    scheduler_post(threads[1]);
+    sti();
+
+    /* the test thread only gets what the reservations leave */
+    for (volatile int i = 0; i < 0xFFFFFF; i++) {
+        /* busy wait */
+    }
+
+    dl_stop = true;
+
+    /* a throttled thread only sees the flag in its next period */
+    while (threads[0]->state != STATE_BLOCKED ||
+           threads[1]->state != STATE_BLOCKED) {
+        asm volatile ("" ::: "memory");
+    }
+
+    sched_dl_attr_t attr[2];
+    int32_t got_a = sched_get_deadline(threads[0], &attr[0]);
+    int32_t got_b = sched_get_deadline(threads[1], &attr[1]);
+    uint32_t throttled = sched_get_stats()->dl_throttles - throttles;
+
+    for (int i = 0; i < 2; i++) {
+        sched_set_deadline(threads[i], 0, 0, 0);
+    }
+    uint32_t released = sched_dl_bandwidth();
+
+    for (int i = 0; i < 3; i++) {
+        process_destroy(procs[i]);
+        free(procs[i]);
+    }
+
+    ASSERT_TRUE(dl_counts[0] > 0 && dl_counts[1] > 0, "deadline thread never ran");
+    ASSERT_TRUE(got_a == 0 && got_b == 0, "reservation lost");
+    ASSERT_EQ(attr[0].deadline, 100000, "implicit deadline not the period");
+    ASSERT_EQ(attr[0].misses + attr[1].misses, 0, "deadline missed below the limit");
+    ASSERT_TRUE(throttled > 0, "runtime not enforced");
+    ASSERT_EQ(released, bandwidth, "bandwidth not released");
+    PASS();
+}
+
+// ------------ Destroying a queued deadline thread releases it ------------
+void test_sched_dl_destroy() {
+    process_t *proc = malloc(sizeof(process_t));
+    ASSERT_NOT_NULL(proc, "malloc failed for process");
+    process_create(proc, "dl", PROCESS_PRI_DEFAULT);
+    thread_t *thread = _get_main_thread(proc);
+
+    uint32_t bandwidth = sched_dl_bandwidth();
+
+    /* the thread must not run, it has nothing to run */
+    cli();
+    uint32_t ready = sched_nr_running();
+
+    int32_t reserved = sched_set_deadline(thread, 10000, 100000, 0);
+    scheduler_post(thread);
+    bool queued = sched_is_queued(thread) && sched_nr_running() == ready + 1;
+
+    process_destroy(proc);
+
+    bool drained  = sched_nr_running() == ready;
+    uint32_t left = sched_dl_bandwidth();
+    sti();
+
+    free(proc);
+
+    ASSERT_EQ(reserved, 0, "reservation refused");
+    ASSERT_TRUE(queued, "thread not queued");
+    ASSERT_TRUE(drained, "destroyed thread left on the queues");
+    ASSERT_EQ(left, bandwidth, "bandwidth of a destroyed thread kept");
+    PASS();
+}
+
+// ------------ A deadline thread that yields alone gets its next period ------------
+void test_sched_dl_yield_idle() {
+    thread_t *self = get_current_thread();
+    ASSERT_NOT_NULL(self, "no current thread");
+
+    ASSERT_EQ(sched_set_deadline(self, 8000, 40000, 0), 0, "reservation refused");
+
+    /* each yield must come back once the next period starts, whether or not
+        another thread is ready */
+    uint64_t start = sched_clock();
+    for (int i = 0; i < 3; i++) {
+        sched_dl_yield();
+    }
+    uint64_t elapsed = sched_clock() - start;
+
+    sched_dl_attr_t attr;
+    sched_get_deadline(self, &attr);
+    sched_set_deadline(self, 0, 0, 0);
+
+    ASSERT_TRUE(elapsed <= 4 * 40000, "yield outlasted its periods");
+    ASSERT_EQ(attr.misses, 0, "deadline missed while yielding");
+    PASS();
+}
@@ -0,0 +1,41 @@
+import pytest
+
+pytestmark = pytest.mark.sched
+
+
+def assert_passed(result: str):
+    """Helper: ensure PASSED and not FAILED."""
+    assert "FAILED" not in result, f"Scheduler test failed: {result}"
+    assert "PASSED" in result, f"Unexpected output: {result}"
+
+
+def test_bitmap(runner):
+    assert_passed(runner.send_serial("sched_bitmap"))
+
+
+def test_data(runner):
+    assert_passed(runner.send_serial("sched_data"))
+
+
+def test_fair(runner):
+    assert_passed(runner.send_serial("sched_fair"))
+
+
+def test_mlfq(runner):
+    assert_passed(runner.send_serial("sched_mlfq"))
+
+
+def test_mlfq_boost(runner):
+    assert_passed(runner.send_serial("sched_mlfq_boost"))
+
+
+def test_dl(runner):
+    assert_passed(runner.send_serial("sched_dl"))
+
+
+def test_dl_destroy(runner):
+    assert_passed(runner.send_serial("sched_dl_destroy"))
+
+
+def test_dl_yield_idle(runner):
+    assert_passed(runner.send_serial("sched_dl_yield_idle"))
@@ -10,6 +10,22 @@ extern void test_tick_count_incrementing(void);
 extern void test_sleep_duration(void);
 extern void test_multiple_sleeps(void);
 
+// -- Process memory accounting tests --
+
+extern void test_procmem_rss(void);
+extern void test_procmem_process(void);
+
+// -- Scheduler ready queue tests --
+
+extern void test_sched_bitmap(void);
+extern void test_sched_data(void);
+extern void test_sched_fair(void);
+extern void test_sched_mlfq(void);
+extern void test_sched_mlfq_boost(void);
+extern void test_sched_dl(void);
+extern void test_sched_dl_destroy(void);
+extern void test_sched_dl_yield_idle(void);
+
 /* hidden */
 extern void test_timer_sleep_zero(void);
 extern void test_timer_reinit(void);
@@ -114,6 +114,9 @@ static struct test_case test_cases[] = {
 	{ "kheap_realloc_integrity",        test_kheap_realloc_integrity },
 	{ "kheap_buddy_multilevel",         test_kheap_buddy_multilevel },
 	{ "kheap_buddy_symmetry",          	test_kheap_buddy_symmetry },
+	{ "kheap_grow_on_demand",          	test_kheap_grow_on_demand },
+	{ "kheap_pages",          			test_kheap_pages },
+	{ "kheap_kvrealloc",          		test_kheap_kvrealloc },
 
     // ---- KMM tests ----
     { "kmm_init_total",       	test_kmm_init_total },
@@ -129,6 +132,107 @@ static struct test_case test_cases[] = {
 	{ "kmm_frame0",				test_kmm_frame0_always_reserved_hidden},
 	{ "kmm_fuzz_hidden",		test_kmm_fuzz_hidden},
 
+    // ---- SLAB tests ----
+    { "slab_create_destroy",    test_slab_create_destroy },
+    { "slab_create_too_large",  test_slab_create_too_large },
+    { "slab_alloc_free_reuse",  test_slab_alloc_free_reuse },
+    { "slab_alignment",         test_slab_alignment },
+    { "slab_ctor",              test_slab_ctor },
+    { "slab_multi_slab",        test_slab_multi_slab },
+    { "slab_shrink",            test_slab_shrink_returns_frames },
+    { "slab_destroy_busy",      test_slab_destroy_busy },
+    { "slab_invalid_free",      test_slab_invalid_free },
+    { "slab_cache_of",          test_slab_cache_of },
+
+    // ---- VMALLOC tests ----
+    { "vmalloc_basic",          test_vmalloc_basic },
+    { "vmalloc_find",           test_vmalloc_find },
+    { "vmalloc_no_overlap",     test_vmalloc_no_overlap },
+    { "vmalloc_frees_frames",   test_vmalloc_frees_frames },
+    { "vmalloc_invalid_free",   test_vmalloc_invalid_free },
+
+    // ---- SHRINKER tests ----
+    { "shrinker_low_watermark", test_shrinker_low_watermark },
+    { "shrinker_noheap",        test_shrinker_noheap },
+    { "shrinker_slab",          test_shrinker_slab },
+    { "shrinker_vmm",           test_shrinker_vmm },
+
+    // ---- COW tests ----
+    { "cow_clone_shares",       test_cow_clone_shares },
+    { "cow_write_fault",        test_cow_write_fault },
+    { "cow_load_readonly",      test_cow_load_readonly },
+    { "cow_fork_benchmark",     test_cow_fork_benchmark },
+
+    // ---- VMA tests ----
+    { "vma_insert_find",        test_vma_insert_find },
+    { "vma_many",               test_vma_many },
+    { "vma_alloc_region",       test_vma_alloc_region },
+    { "vma_clone",              test_vma_clone },
+
+    // ---- DEMAND tests ----
+    { "demand_reserve_lazy",    test_demand_reserve_lazy },
+    { "demand_stack_growth",    test_demand_stack_growth },
+    { "demand_reserve_invalid", test_demand_reserve_invalid },
+    { "demand_mmap",            test_demand_mmap },
+
+    // ---- TLB tests ----
+    { "tlb_global",             test_tlb_global },
+    { "tlb_batch",              test_tlb_batch },
+    { "tlb_switch_benchmark",   test_tlb_switch_benchmark },
+
+    // ---- PSE tests ----
+    { "pse_physmap",            test_pse_physmap },
+    { "pse_benchmark",          test_pse_benchmark },
+
+    // ---- HUGEPAGE tests ----
+    { "hugepage_alloc",         test_hugepage_alloc },
+    { "hugepage_split",         test_hugepage_split },
+    { "hugepage_fallback",      test_hugepage_fallback },
+
+    // ---- FIXMAP tests ----
+    { "fixmap_recursive",       test_fixmap_recursive },
+    { "fixmap_slots",           test_fixmap_slots },
+
+    // ---- SWAP tests ----
+    { "swap_roundtrip",         test_swap_roundtrip },
+    { "swap_release",           test_swap_release },
+    { "swap_swappiness",        test_swap_swappiness },
+
+    // ---- SHM tests ----
+    { "shm_attach",             test_shm_attach },
+    { "shm_detach",             test_shm_detach },
+    { "shm_remove",             test_shm_remove },
+    { "shm_owner",              test_shm_owner },
+
+    // ---- ZEROPAGE tests ----
+    { "zeropage_cow",           test_zeropage_cow },
+    { "zeropage_fill",          test_zeropage_fill },
+
+    // ---- KSM tests ----
+    { "ksm_merge",              test_ksm_merge },
+    { "ksm_zero",               test_ksm_zero },
+
+    // ---- User copy tests ----
+    { "uaccess_copy",           test_uaccess_copy },
+    { "uaccess_fault",          test_uaccess_fault },
+    { "uaccess_cow",            test_uaccess_cow },
+
+    // ---- Page fault profiling tests ----
+    { "pgfault_counts",         test_pgfault_counts },
+    { "pgfault_trace",          test_pgfault_trace },
+
+    // ---- High memory tests ----
+    { "highmem_pde",            test_highmem_pde },
+    { "highmem_kmap_nest",      test_highmem_kmap_nest },
+    { "highmem_chunk",          test_highmem_chunk },
+    { "highmem_hugepage",       test_highmem_hugepage },
+
+    // ---- Kernel stack tests ----
+    { "kstack_guard",           test_kstack_guard },
+    { "kstack_recycle",         test_kstack_recycle },
+    { "kstack_thread",          test_kstack_thread },
+    { "kstack_df_gate",         test_kstack_df_gate },
+
     // ---- VMM tests ----
 	{ "vmm_init",             					test_vmm_init },
     { "vmm_get_kerneldir",    					test_vmm_get_kerneldir },
@@ -195,6 +299,20 @@ static struct test_case test_cases[] = {
 	{ "test_scheduler_ordering_two",				test_scheduler_ordering_two },
 	{ "test_scheduler_ordering_three",				test_scheduler_ordering_three },
 
+	// -- Process memory accounting tests --
+	{ "procmem_rss",								test_procmem_rss },
+	{ "procmem_process",							test_procmem_process },
+
+	// -- Scheduler ready queue tests --
+	{ "sched_bitmap",								test_sched_bitmap },
+	{ "sched_data",									test_sched_data },
+	{ "sched_fair",									test_sched_fair },
+	{ "sched_mlfq",									test_sched_mlfq },
+	{ "sched_mlfq_boost",							test_sched_mlfq_boost },
+	{ "sched_dl",									test_sched_dl },
+	{ "sched_dl_destroy",							test_sched_dl_destroy },
+	{ "sched_dl_yield_idle",						test_sched_dl_yield_idle },
+
 	// -- HFS tests
 	{ "test_01_format_mount", 					test_01_format_mount },
 	{ "test_02_single_directory", 				test_02_single_directory },
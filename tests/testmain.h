@@ -32,6 +32,9 @@ void utoa (unsigned val, char *buf);
 #define PASS() send_msg ("PASSED")
 #define FAIL() send_msg ("FAILED")
 
+/* for a test that cannot run on this machine, says why */
+#define SKIP(msg) send_msg ("SKIPPED: " msg)
+
 /* these assertions are helpful, send a failure msg too */
 
 #define ASSERT_TRUE(cond, msg) do { \
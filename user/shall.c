@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdbool.h>
+#include <unistd.h>
 bool run_cmd(char* cmd)
 {
 
@@ -39,6 +40,8 @@ bool run_cmd(char* cmd)
 		printf (" - open: open <filename>\n");
 		printf (" - elf: elf <filename>\n");
 		printf (" - break: trigger int3 breakpoint\n");
+		printf (" - ps: memory used by each process\n");
+		printf (" - lat: keyboard to echo latency\n");
 		printf (" - help: displays this message\n");
 		printf (" - exit: quits and halts the system\n");
 	}
@@ -151,6 +154,32 @@ bool run_cmd(char* cmd)
 
 	}
 
+	else if (strcmp (cmd, "ps") == 0) {
+
+		struct procmem mem;
+
+		printf ("  PID NAME               RSS   SWAP  PGTBL  KSTACK   KHEAP\n");
+		for (int i = 0; procmem (i, &mem) == 0; i++) {
+			printf ("%5u %-16s %5uK %5uK %5uK %6uK %6uB\n", mem.pid, mem.name,
+					mem.rss * 4, mem.swapped * 4, mem.pgtables * 4,
+					mem.kstack / 1024, mem.kheap);
+		}
+	}
+
+	else if (strcmp (cmd, "lat") == 0) {
+
+		struct kbdlat lat;
+
+		if (kbdlat (&lat) == 0) {
+			printf ("%u keys under %s, %u sleeps, average %u ms, max %u ms\n",
+					lat.keys, lat.sched, lat.sleeps,
+					lat.keys ? lat.total_ms / lat.keys : 0, lat.max_ms);
+			printf ("<1ms %u, <4ms %u, <16ms %u, <64ms %u, more %u\n",
+					lat.buckets[0], lat.buckets[1], lat.buckets[2],
+					lat.buckets[3], lat.buckets[4]);
+		}
+	}
+
 	else if (strcmp (cmd, "color") == 0) {
 		// terminal_settext_color(10);
 	}